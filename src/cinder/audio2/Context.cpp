@@ -23,13 +23,18 @@
 
 #include "cinder/audio2/Context.h"
 #include "cinder/audio2/NodeInput.h"
-#include "cinder/audio2/dsp/Converter.h"
+#include "cinder/audio2/RenderBufferPool.h"
+#include "cinder/audio2/RenderGraph.h"
+#include "cinder/audio2/RenderPool.h"
 #include "cinder/audio2/Debug.h"
 
 #include "cinder/Cinder.h"
 
 #include "cinder/app/App.h"		// for app::console()
 
+#include <algorithm>
+#include <thread>
+
 #if defined( CINDER_COCOA )
 	#include "cinder/audio2/cocoa/ContextAudioUnit.h"
 	#if defined( CINDER_MAC )
@@ -110,11 +115,21 @@ void Context::setMaster( Context *masterContext, DeviceManager *deviceManager )
 	sDeviceManager.reset( deviceManager );
 }
 
+Context::Context()
+	: mEnabled( false ), mRenderGraph( nullptr ), mRenderEpoch( 0 ), mRenderGraphDirty( true ), mProfilingEnabled( false ), mModulationMatrixPtr( nullptr )
+{
+}
+
 Context::~Context()
 {
 	stop();
 	lock_guard<mutex> lock( mMutex );
 	uninitializeAllNodes();
+
+	// audio is no longer being processed, so everything can be released now.
+	mRenderGraph = nullptr;
+	mPublishedRenderGraph.reset();
+	mDeferredReleases.clear();
 }
 
 void Context::start()
@@ -128,6 +143,8 @@ void Context::start()
 	if( ! output->isInitialized() )
 		output->initializeImpl();
 
+	updateRenderGraph();
+
 	mEnabled = true;
 	getOutput()->start();
 }
@@ -145,6 +162,8 @@ void Context::initializeAllNodes()
 {
 	set<NodeRef> traversedNodes;
 	initRecursisve( mOutput, traversedNodes );
+
+	updateRenderGraph();
 }
 
 void Context::uninitializeAllNodes()
@@ -159,6 +178,22 @@ void Context::disconnectAllNodes()
 	disconnectRecursive( mOutput, traversedNodes );
 }
 
+void Context::prepare( size_t maxFramesPerBlock, size_t maxNumChannels )
+{
+	{
+		lock_guard<mutex> lock( mMutex );
+
+		set<NodeRef> traversedNodes;
+		prepareRecursive( getOutput(), traversedNodes, maxFramesPerBlock, maxNumChannels );
+		for( const auto &node : mAutoPulledNodes )
+			prepareRecursive( node, traversedNodes, maxFramesPerBlock, maxNumChannels );
+
+		invalidateRenderGraph();
+	}
+
+	updateRenderGraph();
+}
+
 void Context::setEnabled( bool enabled )
 {
 	if( enabled )
@@ -169,19 +204,29 @@ void Context::setEnabled( bool enabled )
 
 void Context::setOutput( const NodeOutputRef &output )
 {
-	mOutput = output;
+	{
+		lock_guard<mutex> lock( mMutex );
+
+		mOutput = output;
+		invalidateRenderGraph();
+	}
+
+	updateRenderGraph();
 }
 
 const NodeOutputRef& Context::getOutput()
 {
-	if( ! mOutput )
+	if( ! mOutput ) {
 		mOutput = createLineOut();
+		invalidateRenderGraph();
+	}
 	return mOutput;
 }
 
 void Context::initializeNode( const NodeRef &node )
 {
 	node->initializeImpl();
+	updateRenderGraph();
 }
 
 void Context::uninitializeNode( const NodeRef &node )
@@ -215,6 +260,21 @@ void Context::initRecursisve( const NodeRef &node, set<NodeRef> &traversedNodes
 	node->configureConnections();
 }
 
+void Context::prepareRecursive( const NodeRef &node, set<NodeRef> &traversedNodes, size_t maxFramesPerBlock, size_t maxNumChannels )
+{
+	if( ! node || traversedNodes.count( node ) )
+		return;
+
+	traversedNodes.insert( node );
+
+	for( auto &in : node->getInputs() )
+		prepareRecursive( in.second, traversedNodes, maxFramesPerBlock, maxNumChannels );
+
+	// initializing first is what allocates most Node's buffers (and starts a FilePlayer's read thread), prepare() then reserves room to grow.
+	node->configureConnections();
+	node->prepare( maxFramesPerBlock, maxNumChannels );
+}
+
 void Context::uninitRecursisve( const NodeRef &node, set<NodeRef> &traversedNodes )
 {
 	if( ! node || traversedNodes.count( node ) )
@@ -230,52 +290,243 @@ void Context::uninitRecursisve( const NodeRef &node, set<NodeRef> &traversedNode
 
 void Context::addAutoPulledNode( const NodeRef &node )
 {
-	mAutoPulledNodes.insert( node );
-	mAutoPullRequired = true;
-	mAutoPullCacheDirty = true;
+	{
+		lock_guard<mutex> lock( mMutex );
 
-	// if not done already, allocate a buffer for auto-pulling that is large enough for stereo processing
-	size_t framesPerBlock = getFramesPerBlock();
-	if( mAutoPullBuffer.getNumFrames() < framesPerBlock )
-		mAutoPullBuffer.setSize( framesPerBlock, 2 );
+		mAutoPulledNodes.insert( node );
+		invalidateRenderGraph();
+	}
+
+	updateRenderGraph();
 }
 
 void Context::removeAutoPulledNode( const NodeRef &node )
 {
-	size_t result = mAutoPulledNodes.erase( node );
-	CI_ASSERT( result );
+	{
+		lock_guard<mutex> lock( mMutex );
+
+		size_t result = mAutoPulledNodes.erase( node );
+		CI_ASSERT( result );
+
+		invalidateRenderGraph();
+	}
+
+	updateRenderGraph();
+}
+
+void Context::setNumRenderThreads( size_t numThreads )
+{
+	{
+		lock_guard<mutex> lock( mMutex );
+
+		if( getNumRenderThreads() == numThreads )
+			return;
+
+		// the published RenderGraph keeps the previous RenderPool alive until the audio thread is done with it.
+		mRenderPool = numThreads ? make_shared<RenderPool>( numThreads ) : shared_ptr<RenderPool>();
+		invalidateRenderGraph();
+	}
+
+	updateRenderGraph();
+}
+
+size_t Context::getNumRenderThreads() const
+{
+	return mRenderPool ? mRenderPool->getNumThreads() : 0;
+}
+
+void Context::setProfilingEnabled( bool enable )
+{
+	{
+		lock_guard<mutex> lock( mMutex );
+
+		if( mProfilingEnabled == enable )
+			return;
+
+		// profiling is compiled into the RenderGraph, so that when disabled the audio thread doesn't need to check anything else.
+		mProfilingEnabled = enable;
+		invalidateRenderGraph();
+	}
+
+	updateRenderGraph();
+}
+
+vector<NodeProfile> Context::getProfile()
+{
+	vector<NodeProfile> result;
+
+	auto renderGraph = getRenderGraph();
+	if( ! renderGraph || ! renderGraph->isProfilingEnabled() )
+		return result;
+
+	set<Node *> profiledNodes;
+	for( const NodeRef &node : renderGraph->getNodes() ) {
+		if( node->mProfiler && profiledNodes.insert( node.get() ).second )
+			result.push_back( node->mProfiler->getProfile( node ) );
+	}
+
+	sort( result.begin(), result.end(), []( const NodeProfile &a, const NodeProfile &b ) { return a.getTotalNanoseconds() > b.getTotalNanoseconds(); } );
+	return result;
+}
+
+void Context::resetProfile()
+{
+	auto renderGraph = getRenderGraph();
+	if( ! renderGraph )
+		return;
+
+	for( const NodeRef &node : renderGraph->getNodes() ) {
+		if( node->mProfiler )
+			node->mProfiler->reset();
+	}
+}
+
+const ModulationMatrixRef& Context::getModulationMatrix()
+{
+	lock_guard<mutex> lock( mMutex );
 
-	mAutoPullCacheDirty = true;
-	if( mAutoPulledNodes.empty() )
-		mAutoPullRequired = false;
+	if( ! mModulationMatrix ) {
+		mModulationMatrix.reset( new ModulationMatrix( shared_from_this() ) );
+		mModulationMatrixPtr = mModulationMatrix.get();
+	}
+
+	return mModulationMatrix;
 }
 
-void Context::processAutoPulledNodes()
+// ----------------------------------------------------------------------------------------------------
+// MARK: - RenderGraph publishing
+// ----------------------------------------------------------------------------------------------------
+
+void Context::updateRenderGraph()
 {
-	if( ! mAutoPullRequired )
+	lock_guard<mutex> lock( mMutex );
+
+	if( ! mRenderGraphDirty )
 		return;
 
-	for( Node *node : getAutoPulledNodes() ) {
-		mAutoPullBuffer.setNumChannels( node->getNumChannels() );
-		node->pullInputs( &mAutoPullBuffer );
-		if( ! node->getProcessInPlace() )
-			dsp::mixBuffers( node->getInternalBuffer(), &mAutoPullBuffer );
+	mRenderGraphDirty = false;
+
+	// without a NodeOutput there is nothing to drive processing, so no RenderGraph is published.
+	shared_ptr<RenderGraph> renderGraph;
+	if( mOutput ) {
+		// Buffer's are shared with the published RenderGraph, which is fine as the two are never processed at the same time. If the block size
+		// has changed, the published RenderGraph keeps the previous RenderBufferPool alive until the audio thread is done with it.
+		size_t framesPerBlock = mOutput->getOutputFramesPerBlock();
+		if( ! mRenderBufferPool || mRenderBufferPool->getFramesPerBlock() != framesPerBlock )
+			mRenderBufferPool = make_shared<RenderBufferPool>( framesPerBlock );
+
+		renderGraph.reset( new RenderGraph( mOutput, mAutoPulledNodes, framesPerBlock, mRenderPool, mRenderBufferPool ) );
+		if( mProfilingEnabled )
+			renderGraph->enableProfiling();
+	}
+
+	publishRenderGraph( renderGraph );
+}
+
+shared_ptr<const RenderGraph> Context::getRenderGraph()
+{
+	lock_guard<mutex> lock( mRenderGraphMutex );
+
+	return mPublishedRenderGraph;
+}
+
+void Context::suspendRenderGraph( const Node *node )
+{
+	lock_guard<mutex> lock( mRenderGraphMutex );
+
+	if( mPublishedRenderGraph && mPublishedRenderGraph->contains( node ) )
+		suspendRenderGraphImpl();
+}
+
+void Context::suspendRenderGraph( const Buffer *buffer )
+{
+	lock_guard<mutex> lock( mRenderGraphMutex );
+
+	if( mPublishedRenderGraph && mPublishedRenderGraph->references( buffer ) )
+		suspendRenderGraphImpl();
+}
+
+void Context::deferRelease( const shared_ptr<const void> &object )
+{
+	lock_guard<mutex> lock( mRenderGraphMutex );
+
+	deferReleaseImpl( object );
+	releaseDeferred();
+}
+
+void Context::processRenderGraph()
+{
+	mRenderEpoch++;
+
+	RenderGraph *renderGraph = mRenderGraph;
+	if( renderGraph ) {
+		// modulation is written before any Node can read the Param's it is routed to.
+		ModulationMatrix *modulationMatrix = mModulationMatrixPtr;
+		if( modulationMatrix )
+			modulationMatrix->process();
+
+		renderGraph->process( getNumProcessedFrames() );
 	}
+
+	mRenderEpoch++;
 }
 
-const std::vector<Node *>& Context::getAutoPulledNodes()
+void Context::publishRenderGraph( const shared_ptr<RenderGraph> &renderGraph )
 {
-	if( mAutoPullCacheDirty ) {
-		mAutoPullCache.clear();
-		for( const NodeRef &node : mAutoPulledNodes )
-			mAutoPullCache.push_back( node.get() );
+	lock_guard<mutex> lock( mRenderGraphMutex );
+
+	mRenderGraph = renderGraph.get();
+
+	deferReleaseImpl( mPublishedRenderGraph );
+	mPublishedRenderGraph = renderGraph;
+
+	releaseDeferred();
+}
+
+// Called with mRenderGraphMutex locked.
+void Context::suspendRenderGraphImpl()
+{
+	mRenderGraph = nullptr;
+	mRenderGraphDirty = true;
+
+	// wait for the audio thread to finish any block that began before mRenderGraph was cleared.
+	uint64_t epoch = mRenderEpoch;
+	if( epoch & 1 ) {
+		while( mRenderEpoch == epoch )
+			this_thread::yield();
 	}
-	return mAutoPullCache;
+
+	// nothing can be referenced by the audio thread at this point.
+	mPublishedRenderGraph.reset();
+	mDeferredReleases.clear();
+}
+
+// Called with mRenderGraphMutex locked, after the audio thread's pointer to object has been replaced.
+void Context::deferReleaseImpl( const shared_ptr<const void> &object )
+{
+	if( ! object )
+		return;
+
+	// if the audio thread is between blocks, the next one will not see object so it can be released immediately.
+	uint64_t epoch = mRenderEpoch;
+	if( epoch & 1 )
+		mDeferredReleases.push_back( make_pair( epoch, object ) );
+}
+
+// Called with mRenderGraphMutex locked.
+void Context::releaseDeferred()
+{
+	uint64_t epoch = mRenderEpoch;
+	mDeferredReleases.erase( remove_if( mDeferredReleases.begin(), mDeferredReleases.end(),
+										[epoch]( const pair<uint64_t, shared_ptr<const void> > &deferred ) { return deferred.first != epoch; } ),
+							mDeferredReleases.end() );
 }
 
 namespace {
 
-void printRecursive( const NodeRef &node, size_t depth, set<NodeRef> &traversedNodes )
+typedef map<Node *, NodeProfile> ProfileMap;
+
+void printRecursive( const NodeRef &node, size_t depth, set<NodeRef> &traversedNodes, const ProfileMap &profiles, size_t framesPerBlock, double blockNanoseconds )
 {
 	if( ! node )
 		return;
@@ -300,10 +551,21 @@ void printRecursive( const NodeRef &node, size_t depth, set<NodeRef> &traversedN
 	app::console() << ", ch: " << node->getNumChannels();
 	app::console() << ", ch mode: " << channelMode;
 	app::console() << ", " << ( node->getProcessInPlace() ? "in-place" : "sum" );
+	app::console() << ", buffer: " << node->getNumChannels() << " x " << framesPerBlock;
+
+	auto profileIt = profiles.find( node.get() );
+	if( profileIt != profiles.end() ) {
+		const NodeProfile &profile = profileIt->second;
+		app::console() << ", calls: " << profile.getNumCalls();
+		app::console() << ", mean: " << profile.getMeanNanoseconds() / 1000.0 << " us (" << 100.0 * profile.getMeanNanoseconds() / blockNanoseconds << "% of block)";
+		app::console() << ", p99: " << profile.getP99Nanoseconds() / 1000.0 << " us";
+		app::console() << ", max: " << profile.getMaxNanoseconds() / 1000.0 << " us";
+	}
+
 	app::console() << " ]" << endl;
 
 	for( const auto &in : node->getInputs() )
-		printRecursive( in.second, depth + 1, traversedNodes );
+		printRecursive( in.second, depth + 1, traversedNodes, profiles, framesPerBlock, blockNanoseconds );
 };
 
 } // anonymous namespace
@@ -312,13 +574,26 @@ void Context::printGraph()
 {
 	set<NodeRef> traversedNodes;
 
+	ProfileMap profiles;
+	for( const auto &profile : getProfile() )
+		profiles[profile.getNode().get()] = profile;
+
+	size_t framesPerBlock = getFramesPerBlock();
+	double blockNanoseconds = 1e9 * framesPerBlock / getSampleRate();
+
 	app::console() << "-------------- Graph configuration: --------------" << endl;
-	printRecursive( getOutput(), 0, traversedNodes );
+	printRecursive( getOutput(), 0, traversedNodes, profiles, framesPerBlock, blockNanoseconds );
 
 	if( ! mAutoPulledNodes.empty() ) {
 		app::console() << "(auto-pulled:)" << endl;
 		for( const auto& node : mAutoPulledNodes )
-			printRecursive( node, 0, traversedNodes );
+			printRecursive( node, 0, traversedNodes, profiles, framesPerBlock, blockNanoseconds );
+	}
+
+	auto renderGraph = getRenderGraph();
+	if( renderGraph ) {
+		app::console() << "buffers: " << renderGraph->getNumBuffersUsed() << " used for " << renderGraph->getNumBufferSlots() << " slots, ";
+		app::console() << renderGraph->getNumBytesPooled() / 1024 << " KB (" << renderGraph->getNumBytesUnpooled() / 1024 << " KB unpooled)" << endl;
 	}
 	app::console() << "--------------------------------------------------" << endl;
 }
@@ -23,16 +23,23 @@
 
 #pragma once
 
+#include "cinder/audio2/ModulationMatrix.h"
 #include "cinder/audio2/Node.h"
 #include "cinder/audio2/NodeInput.h"
 #include "cinder/audio2/NodeOutput.h"
+#include "cinder/audio2/NodeProfiler.h"
 
+#include <atomic>
 #include <mutex>
 #include <set>
+#include <vector>
 
 namespace cinder { namespace audio2 {
 
 class DeviceManager;
+class RenderBufferPool;
+class RenderGraph;
+class RenderPool;
 
 class Context : public std::enable_shared_from_this<Context> {
   public:
@@ -66,9 +73,11 @@ class Context : public std::enable_shared_from_this<Context> {
 	void setEnabled( bool enabled = true );
 	//! Returns whether or not this \a Context is current enabled and processing audio.
 	bool isEnabled() const		{ return mEnabled; }
+	//! Returns whether this Context processes audio in real-time, driven by a hardware clock. Default implementation returns true, ContextOffline returns false.
+	virtual bool isRealTime() const	{ return true; }
 
-	//! Called by \a node when it's connections have changed, default implementation is empty.
-	virtual void connectionsDidChange( const NodeRef &node ) {} 
+	//! Called by \a node when it's connections have changed. Default implementation publishes an updated RenderGraph.
+	virtual void connectionsDidChange( const NodeRef &node )	{ updateRenderGraph(); }
 
 	//! Returns the samplerate of this Context, which is governed by the current NodeOutput.
 	size_t		getSampleRate()				{ return getOutput()->getOutputSampleRate(); }
@@ -78,6 +87,7 @@ class Context : public std::enable_shared_from_this<Context> {
 	uint64_t	getNumProcessedFrames()		{ return getOutput()->getNumProcessedFrames(); }
 	double		getNumProcessedSeconds()	{ return (double)getNumProcessedFrames() / (double)getSampleRate(); }
 
+	//! Returns the mutex that synchronizes changes to the Node graph between non-audio threads. The audio thread never locks it, it only sees the most recently published RenderGraph.
 	std::mutex& getMutex() const			{ return mMutex; }
 
 	void initializeNode( const NodeRef &node );
@@ -90,36 +100,90 @@ class Context : public std::enable_shared_from_this<Context> {
 	//! Disconnect all Node's related by this Context
 	virtual void disconnectAllNodes();
 
-	//! Add \a node to the list of auto-pulled nodes, who will have their Node::pullInputs() method called after a LineOut implementation finishes pulling its inputs.
-	//! \note Callers on the non-audio thread must synchronize with getMutex().
+	//! \brief Allocates everything the Node graph needs for processing up front, so that neither the audio thread nor later parameter changes have to.
+	//!
+	//! Initializes every Node reachable from the output or auto-pulled, then calls Node::prepare() on each to reserve room for blocks of up to \a maxFramesPerBlock
+	//! frames and \a maxNumChannels channels (0 uses the current values), and finally compiles and publishes the RenderGraph. Call again after changing the graph.
+	//! \note Synchronizes with getMutex(), so callers must not already hold it.
+	void prepare( size_t maxFramesPerBlock = 0, size_t maxNumChannels = 0 );
+
+	//! Add \a node to the list of auto-pulled nodes, who will be processed after the NodeOutput's inputs each block, even though they have no outputs.
+	//! \note Synchronizes with getMutex(), so callers must not already hold it.
 	void addAutoPulledNode( const NodeRef &node );
 	//! Remove \a node from the list of auto-pulled nodes.
-	//! \note Callers on the non-audio thread must synchronize with getMutex().
+	//! \note Synchronizes with getMutex(), so callers must not already hold it.
 	void removeAutoPulledNode( const NodeRef &node );
 
-	//! Calls Node::pullInputs() for any Node's that have registered with addAutoPulledNode()
-	//! \note Expected to be called on the audio thread by a LineOut implementation at the end of its render loop.
-	void processAutoPulledNodes();
-
-	//! Prints the Node graph to console()
+	//! Marks the published RenderGraph as out of date, so that a new one is compiled during the next call to updateRenderGraph().
+	//! \note Must be called from a non-audio thread, with getMutex() locked.
+	void invalidateRenderGraph()	{ mRenderGraphDirty = true; }
+	//! If the RenderGraph has been invalidated, compiles a new one and publishes it to the audio thread, which picks it up at the start of the next block without blocking.
+	//! The previous RenderGraph is released once the audio thread is no longer processing it. \note Must be called from a non-audio thread, synchronizes with getMutex().
+	void updateRenderGraph();
+	//! If \a node is part of the published RenderGraph, unpublishes it and blocks the calling thread until the audio thread has finished the current block, so that \a node can be safely reconfigured.
+	//! Silence is rendered until the next call to updateRenderGraph(). \note Must be called from a non-audio thread.
+	void suspendRenderGraph( const Node *node );
+	//! Same as suspendRenderGraph( const Node * ), but only suspends if \a buffer is used by the published RenderGraph.
+	void suspendRenderGraph( const Buffer *buffer );
+	//! Keeps \a object alive until the audio thread can no longer be referencing it, after which it is released on a non-audio thread.
+	//! Use this when replacing an object that process() reads through a raw pointer. \note Must be called from a non-audio thread after the raw pointer has been updated.
+	void deferRelease( const std::shared_ptr<const void> &object );
+	//! Processes one block of the most recently published RenderGraph, including any auto-pulled Node's. Does nothing if no RenderGraph is published.
+	//! \note Expected to be called on the audio thread by a NodeOutput implementation. Lock-free.
+	void processRenderGraph();
+
+	//! Enables processing independent parts of the Node graph in parallel on \a numThreads worker threads, which help the audio thread each block.
+	//! Only inputs of a summing Node in which every Node has exactly one output are parallelized, such as a bank of voices mixed together. 0 disables parallel processing (default).
+	void	setNumRenderThreads( size_t numThreads );
+	//! Returns the number of worker threads used for parallel processing, or 0 if it is disabled.
+	size_t	getNumRenderThreads() const;
+
+	//! Returns the most recently published RenderGraph, or null if there is none. The returned RenderGraph is for inspection only (ex. its Buffer usage), it must not be processed.
+	std::shared_ptr<const RenderGraph>	getRenderGraph();
+
+	//! Enables timing each Node's process() calls, the results of which are returned by getProfile(). When disabled (default), the render path only pays for a single branch per Node.
+	//! \note Node's that are pulled by a Param are processed outside of the RenderGraph and are not profiled.
+	void	setProfilingEnabled( bool enable = true );
+	//! Returns whether Node's are being profiled.
+	bool	isProfilingEnabled() const		{ return mProfilingEnabled; }
+	//! Returns the statistics of each Node processed since profiling was enabled or last reset, sorted from the most total time spent processing to the least.
+	std::vector<NodeProfile>	getProfile();
+	//! Resets the statistics of all Node's, which takes effect the next time each Node is processed.
+	void	resetProfile();
+
+	//! Returns this Context's ModulationMatrix, which is created on first use and then processed at the start of every block.
+	const ModulationMatrixRef&	getModulationMatrix();
+
+	//! Prints the Node graph to console(). If profiling is enabled, each Node is annotated with the time spent processing it.
 	void printGraph();
 
   protected:
-	Context() : mEnabled( false ), mAutoPullRequired( false ), mAutoPullCacheDirty( false ) {}
-
-	const std::vector<Node *>& getAutoPulledNodes(); // called if there are any nodes besides output that need to be pulled
+	Context();
 
 	NodeOutputRef			mOutput;				// the 'heartbeat'
 
 	// other nodes that don't have any outputs and need to be explictly pulled
 	std::set<NodeRef>		mAutoPulledNodes;
-	std::vector<Node *>		mAutoPullCache;
-	bool					mAutoPullRequired, mAutoPullCacheDirty;
-	BufferDynamic			mAutoPullBuffer;
 
 	mutable std::mutex		mMutex;
 	bool					mEnabled;
 
+	// mRenderGraph is the audio thread's view of mPublishedRenderGraph. mRenderEpoch is incremented before and after each
+	// block is processed, so it is odd while the audio thread may be reading from an object that was since replaced.
+	std::mutex						mRenderGraphMutex;
+	std::shared_ptr<RenderGraph>	mPublishedRenderGraph;
+	std::atomic<RenderGraph *>		mRenderGraph;
+	std::atomic<uint64_t>			mRenderEpoch;
+	std::atomic<bool>				mRenderGraphDirty;
+
+	std::vector<std::pair<uint64_t, std::shared_ptr<const void> > >	mDeferredReleases;
+
+	std::shared_ptr<RenderPool>		mRenderPool;
+	std::shared_ptr<RenderBufferPool>	mRenderBufferPool;
+	std::atomic<bool>				mProfilingEnabled;
+	ModulationMatrixRef				mModulationMatrix;
+	std::atomic<ModulationMatrix *>	mModulationMatrixPtr;	// read by the audio thread, only set once mModulationMatrix is created
+
 	// TODO: if this is singleton, why hold in shared_ptr?
 	// - it's still stored in Node classes as a weak_ptr, so it needs to (for now) be created as a shared_ptr
 	static std::shared_ptr<Context>			sMasterContext;
@@ -130,6 +194,12 @@ class Context : public std::enable_shared_from_this<Context> {
 	void disconnectRecursive( const NodeRef &node, std::set<NodeRef> &traversedNodes );
 	void initRecursisve( const NodeRef &node, std::set<NodeRef> &traversedNodes  );
 	void uninitRecursisve( const NodeRef &node, std::set<NodeRef> &traversedNodes  );
+	void prepareRecursive( const NodeRef &node, std::set<NodeRef> &traversedNodes, size_t maxFramesPerBlock, size_t maxNumChannels );
+
+	void publishRenderGraph( const std::shared_ptr<RenderGraph> &renderGraph );
+	void suspendRenderGraphImpl();
+	void deferReleaseImpl( const std::shared_ptr<const void> &object );
+	void releaseDeferred();
 
 	static void registerClearStatics();
 };
@@ -0,0 +1,139 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/audio2/ContextOffline.h"
+#include "cinder/audio2/Target.h"
+#include "cinder/audio2/Exception.h"
+#include "cinder/audio2/CinderAssert.h"
+
+using namespace std;
+
+namespace cinder { namespace audio2 {
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - NodeOutputOffline
+// ----------------------------------------------------------------------------------------------------
+
+NodeOutputOffline::NodeOutputOffline( size_t sampleRate, size_t framesPerBlock, const Format &format )
+	: NodeOutput( format ), mSampleRate( sampleRate ), mFramesPerBlock( framesPerBlock )
+{
+	CI_ASSERT( mSampleRate && mFramesPerBlock );
+
+	if( mChannelMode != ChannelMode::SPECIFIED ) {
+		mChannelMode = ChannelMode::SPECIFIED;
+		setNumChannels( 2 );
+	}
+}
+
+void NodeOutputOffline::initialize()
+{
+	setupInternalBuffer();
+}
+
+void NodeOutputOffline::renderBlock()
+{
+	CI_ASSERT_MSG( mInitialized, "NodeOutputOffline must be initialized before rendering" );
+
+	processGraph();
+
+	if( checkNotClipping() )
+		mInternalBuffer.zero();
+
+	postProcess();
+}
+
+void NodeOutputOffline::render( Buffer *buffer )
+{
+	CI_ASSERT( buffer->getNumChannels() == mNumChannels );
+
+	const size_t numFrames = buffer->getNumFrames();
+	for( size_t frame = 0; frame < numFrames; frame += mFramesPerBlock ) {
+		renderBlock();
+		buffer->copyOffset( mInternalBuffer, min( mFramesPerBlock, numFrames - frame ), frame, 0 );
+	}
+}
+
+void NodeOutputOffline::render( TargetFile *target, size_t numFrames )
+{
+	CI_ASSERT( target );
+
+	for( size_t frame = 0; frame < numFrames; frame += mFramesPerBlock ) {
+		renderBlock();
+		target->write( &mInternalBuffer, 0, min( mFramesPerBlock, numFrames - frame ) );
+	}
+}
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - ContextOffline
+// ----------------------------------------------------------------------------------------------------
+
+ContextOffline::ContextOffline( size_t sampleRate, size_t framesPerBlock, size_t numChannels )
+	: mSampleRate( sampleRate ), mFramesPerBlock( framesPerBlock ), mNumChannels( numChannels )
+{
+}
+
+ContextOffline::~ContextOffline()
+{
+}
+
+LineOutRef ContextOffline::createLineOut( const DeviceRef &, const Node::Format & )
+{
+	throw AudioContextExc( "ContextOffline does not support LineOut" );
+}
+
+LineInRef ContextOffline::createLineIn( const DeviceRef &, const Node::Format & )
+{
+	throw AudioContextExc( "ContextOffline does not support LineIn" );
+}
+
+const NodeOutputRef& ContextOffline::getOutput()
+{
+	if( ! mOutput )
+		mOutput = makeNode( new NodeOutputOffline( mSampleRate, mFramesPerBlock, Node::Format().channels( mNumChannels ) ) );
+
+	return mOutput;
+}
+
+void ContextOffline::render( Buffer *buffer )
+{
+	start();
+	getOutputOffline()->render( buffer );
+}
+
+void ContextOffline::render( TargetFile *target, size_t numFrames )
+{
+	start();
+	getOutputOffline()->render( target, numFrames );
+}
+
+NodeOutputOffline* ContextOffline::getOutputOffline()
+{
+	auto output = dynamic_cast<NodeOutputOffline *>( getOutput().get() );
+	if( ! output )
+		throw AudioContextExc( "ContextOffline can only render when its output is a NodeOutputOffline" );
+
+	return output;
+}
+
+} } // namespace cinder::audio2
@@ -0,0 +1,89 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/audio2/Context.h"
+
+namespace cinder { namespace audio2 {
+
+typedef std::shared_ptr<class NodeOutputOffline>		NodeOutputOfflineRef;
+typedef std::shared_ptr<class ContextOffline>			ContextOfflineRef;
+
+class TargetFile;
+
+//! NodeOutput that is not connected to any hardware device. Instead, audio is processed on the calling thread as fast as possible
+//! by one of the render() methods, which makes it suitable for headless rendering, testing and benchmarking.
+class NodeOutputOffline : public NodeOutput {
+  public:
+	NodeOutputOffline( size_t sampleRate, size_t framesPerBlock, const Format &format = Format() );
+	virtual ~NodeOutputOffline() {}
+
+	size_t getOutputSampleRate() override			{ return mSampleRate; }
+	size_t getOutputFramesPerBlock() override		{ return mFramesPerBlock; }
+
+	//! Processes one block of audio, the results of which are then available from getInternalBuffer().
+	void renderBlock();
+	//! Processes enough blocks to fill \a buffer, which must have the same number of channels as this NodeOutputOffline. Any frames beyond the final block are discarded.
+	void render( Buffer *buffer );
+	//! Processes \a numFrames of audio and writes them to \a target.
+	void render( TargetFile *target, size_t numFrames );
+
+  protected:
+	void initialize() override;
+
+  private:
+	size_t	mSampleRate, mFramesPerBlock;
+};
+
+//! Context that processes audio faster than real-time, without any hardware I/O. A NodeOutputOffline is used as the output by default, and audio is
+//! processed by calling render() from any non-audio thread. Node's that need to know whether they are running against an audio clock can check isRealTime().
+//! \note As with all Context's, this must be owned by a shared_ptr.
+class ContextOffline : public Context {
+  public:
+	ContextOffline( size_t sampleRate = 44100, size_t framesPerBlock = 512, size_t numChannels = 2 );
+	virtual ~ContextOffline();
+
+	//! Not supported by ContextOffline, throws AudioContextExc.
+	LineOutRef		createLineOut( const DeviceRef &device = Device::getDefaultOutput(), const Node::Format &format = Node::Format() ) override;
+	//! Not supported by ContextOffline, throws AudioContextExc.
+	LineInRef		createLineIn( const DeviceRef &device = Device::getDefaultInput(), const Node::Format &format = Node::Format() ) override;
+
+	//! If the output has not already been set, it is a NodeOutputOffline with the sample rate, frames per block and channels this Context was constructed with.
+	const NodeOutputRef& getOutput() override;
+
+	bool isRealTime() const override	{ return false; }
+
+	//! Enables processing if needed, then fills \a buffer with rendered audio. \see NodeOutputOffline::render()
+	void render( Buffer *buffer );
+	//! Enables processing if needed, then renders \a numFrames of audio to \a target. \see NodeOutputOffline::render()
+	void render( TargetFile *target, size_t numFrames );
+
+  private:
+	NodeOutputOffline* getOutputOffline();
+
+	size_t	mSampleRate, mFramesPerBlock, mNumChannels;
+};
+
+} } // namespace cinder::audio2
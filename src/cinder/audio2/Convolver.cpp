@@ -0,0 +1,277 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/audio2/Convolver.h"
+#include "cinder/audio2/Source.h"
+#include "cinder/audio2/Debug.h"
+
+#include <functional>
+#include <map>
+#include <tuple>
+
+using namespace std;
+
+namespace cinder { namespace audio2 {
+
+namespace {
+
+// Frequency-domain impulse responses shared between Convolver's, by the Buffer they were made from and their partition sizes. The Buffer
+// is also kept as a weak_ptr, so that an entry isn't mistaken for a new Buffer that happens to be allocated at the same address.
+struct ImpulseResponseCache {
+	struct Entry {
+		weak_ptr<const Buffer>					mBuffer;
+		weak_ptr<const dsp::ImpulseResponse>	mImpulseResponse;
+	};
+
+	mutex												mMutex;
+	map<tuple<const Buffer *, size_t, size_t>, Entry>	mEntries;
+};
+
+ImpulseResponseCache& getImpulseResponseCache()
+{
+	static ImpulseResponseCache sCache;
+	return sCache;
+}
+
+// Called with the cache's mutex locked.
+void removeExpiredImpulseResponses( ImpulseResponseCache *cache )
+{
+	for( auto it = cache->mEntries.begin(); it != cache->mEntries.end(); ) {
+		if( it->second.mImpulseResponse.expired() )
+			it = cache->mEntries.erase( it );
+		else
+			++it;
+	}
+}
+
+dsp::ImpulseResponseRef getSharedImpulseResponse( const BufferRef &buffer, size_t partitionSize, size_t tailPartitionSize )
+{
+	ImpulseResponseCache &cache = getImpulseResponseCache();
+	lock_guard<mutex> lock( cache.mMutex );
+
+	removeExpiredImpulseResponses( &cache );
+
+	ImpulseResponseCache::Entry &entry = cache.mEntries[make_tuple( buffer.get(), partitionSize, tailPartitionSize )];
+	dsp::ImpulseResponseRef result = entry.mImpulseResponse.lock();
+	if( ! result || entry.mBuffer.lock() != buffer ) {
+		result = make_shared<dsp::ImpulseResponse>( *buffer, partitionSize, tailPartitionSize );
+		entry.mBuffer = buffer;
+		entry.mImpulseResponse = result;
+	}
+
+	return result;
+}
+
+// Impulse response files loaded by Convolver's, by file path and samplerate.
+struct FileCache {
+	mutex										mMutex;
+	map<pair<string, size_t>, weak_ptr<Buffer> >	mBuffers;
+};
+
+FileCache& getFileCache()
+{
+	static FileCache sCache;
+	return sCache;
+}
+
+BufferRef loadFile( const DataSourceRef &dataSource, size_t sampleRate )
+{
+	// only files can be recognized when they are loaded again.
+	string filePath = dataSource->isFilePath() ? dataSource->getFilePath().string() : string();
+
+	FileCache &cache = getFileCache();
+	lock_guard<mutex> lock( cache.mMutex );
+
+	BufferRef result;
+	if( ! filePath.empty() )
+		result = cache.mBuffers[make_pair( filePath, sampleRate )].lock();
+
+	if( ! result ) {
+		SourceFileRef sourceFile = load( dataSource );
+		sourceFile->setOutputFormat( sampleRate );
+		result = sourceFile->loadBuffer();
+
+		if( ! filePath.empty() )
+			cache.mBuffers[make_pair( filePath, sampleRate )] = result;
+	}
+
+	return result;
+}
+
+} // anonymous namespace
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - Convolver
+// ----------------------------------------------------------------------------------------------------
+
+Convolver::Convolver( const Format &format )
+	: NodeEffect( format ), mTailPartitionFrames( 0 ), mProcessConvolver( nullptr ), mTailShouldQuit( false )
+{
+}
+
+Convolver::Convolver( const BufferRef &impulseResponse, const Format &format )
+	: NodeEffect( format ), mImpulseResponse( impulseResponse ), mTailPartitionFrames( 0 ), mProcessConvolver( nullptr ), mTailShouldQuit( false )
+{
+}
+
+Convolver::~Convolver()
+{
+	destroyTailThreadImpl();
+}
+
+void Convolver::setImpulseResponse( const BufferRef &impulseResponse )
+{
+	auto ctx = getContext();
+	lock_guard<mutex> lock( ctx->getMutex() );
+
+	mImpulseResponse = impulseResponse;
+	if( isInitialized() )
+		updateConvolver();
+}
+
+void Convolver::loadImpulseResponse( const DataSourceRef &dataSource )
+{
+	setImpulseResponse( loadFile( dataSource, getSampleRate() ) );
+}
+
+size_t Convolver::getLatencyFrames() const
+{
+	return dsp::PartitionedConvolver::getPartitionSize( getFramesPerBlock() );
+}
+
+uint64_t Convolver::getNumTailUnderruns() const
+{
+	const dsp::PartitionedConvolver *convolver = mProcessConvolver;
+	return convolver ? convolver->getNumTailUnderruns() : 0;
+}
+
+double Convolver::getTailSeconds() const
+{
+	const dsp::PartitionedConvolver *convolver = mProcessConvolver;
+	if( ! convolver )
+		return 0;
+
+	return double( convolver->getImpulseResponse()->getNumFrames() + convolver->getLatencyFrames() ) / double( getSampleRate() );
+}
+
+size_t Convolver::getNumCachedImpulseResponses()
+{
+	ImpulseResponseCache &cache = getImpulseResponseCache();
+	lock_guard<mutex> lock( cache.mMutex );
+
+	removeExpiredImpulseResponses( &cache );
+	return cache.mEntries.size();
+}
+
+void Convolver::initialize()
+{
+	// when not running against a real-time clock, the tail thread could fall behind, so the tail is processed on the processing thread instead.
+	if( mTailPartitionFrames && getContext()->isRealTime() ) {
+		mTailShouldQuit = false;
+		mTailThread = unique_ptr<thread>( new thread( bind( &Convolver::processTailAsyncImpl, this ) ) );
+	}
+
+	updateConvolver();
+}
+
+void Convolver::uninitialize()
+{
+	destroyTailThreadImpl();
+
+	mConvolver.reset();
+	mProcessConvolver = nullptr;
+}
+
+void Convolver::process( Buffer *buffer )
+{
+	dsp::PartitionedConvolver *convolver = mProcessConvolver;
+	if( ! convolver ) {
+		buffer->zero();
+		return;
+	}
+
+	convolver->process( buffer, buffer );
+
+	// Only notified when there is work, which is at most once per block until the tail thread takes it. mTailMutex isn't locked, as that could block
+	// the audio thread, so a notification can be lost between the tail thread checking for work and waiting. It then sleeps until the next block,
+	// which the tail's slack of a whole tail partition covers, and if it falls too far behind anyway, the tail starts over.
+	if( convolver->isTailAsync() && convolver->isTailPending() )
+		mTailCond.notify_one();
+}
+
+// Called with the Context's mutex locked.
+void Convolver::updateConvolver()
+{
+	shared_ptr<dsp::PartitionedConvolver> convolver;
+	if( mImpulseResponse ) {
+		size_t partitionSize = dsp::PartitionedConvolver::getPartitionSize( getFramesPerBlock() );
+		size_t tailPartitionSize = dsp::PartitionedConvolver::getTailPartitionSize( partitionSize, mTailPartitionFrames );
+		auto impulseResponse = getSharedImpulseResponse( mImpulseResponse, partitionSize, tailPartitionSize );
+		convolver = make_shared<dsp::PartitionedConvolver>( impulseResponse, getNumChannels(), mTailThread != nullptr );
+
+		CI_LOG_V( "impulse response frames: " << mImpulseResponse->getNumFrames() << ", channels: " << mImpulseResponse->getNumChannels() << ", partition size: " << partitionSize
+				  << ", tail partition size: " << tailPartitionSize << ", head partitions: " << impulseResponse->getNumHeadPartitions() << ", tail partitions: " << impulseResponse->getNumTailPartitions() );
+	}
+
+	// process() may still be using the previous PartitionedConvolver, so the Context holds onto it until that is no longer possible.
+	shared_ptr<dsp::PartitionedConvolver> previousConvolver;
+	{
+		lock_guard<mutex> lock( mTailMutex );
+		previousConvolver = mConvolver;
+		mConvolver = convolver;
+		mProcessConvolver = convolver.get();
+	}
+
+	getContext()->deferRelease( previousConvolver );
+}
+
+void Convolver::processTailAsyncImpl()
+{
+	unique_lock<mutex> lock( mTailMutex );
+	while( true ) {
+		mTailCond.wait( lock, [this] { return mTailShouldQuit || ( mConvolver && mConvolver->isTailPending() ); } );
+
+		if( mTailShouldQuit )
+			return;
+
+		mConvolver->processTail();
+	}
+}
+
+void Convolver::destroyTailThreadImpl()
+{
+	if( ! mTailThread )
+		return;
+
+	{
+		lock_guard<mutex> lock( mTailMutex );
+		mTailShouldQuit = true;
+	}
+
+	mTailCond.notify_one();
+	mTailThread->join();
+	mTailThread.reset();
+}
+
+} } // namespace cinder::audio2
@@ -0,0 +1,99 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/audio2/NodeEffect.h"
+#include "cinder/audio2/dsp/PartitionedConvolver.h"
+#include "cinder/DataSource.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace cinder { namespace audio2 {
+
+typedef std::shared_ptr<class Convolver>	ConvolverRef;
+
+//! \brief NodeEffect that convolves its input with an impulse response, ex. for convolution reverb. Only the convolved (wet) signal is output.
+//!
+//! Uses partitioned FFT convolution (see dsp::PartitionedConvolver), which delays the output by one block, see getLatencyFrames(). The tail of a long
+//! impulse response can be split into larger partitions with setTailPartitionFrames(), which are processed on a background thread when the Context
+//! is real-time. The frequency-domain impulse response is shared by all Convolver's that use the same Buffer or file with the same block size.
+//!
+//! The impulse response can either have one channel per channel (or only one, for all channels), or the square of the number of channels for
+//! true multichannel convolution, ex. four channels for true stereo (left to left, left to right, right to left and right to right).
+class Convolver : public NodeEffect {
+  public:
+	Convolver( const Format &format = Format() );
+	//! Constructs a Convolver with \a impulseResponse, see setImpulseResponse().
+	Convolver( const BufferRef &impulseResponse, const Format &format = Format() );
+	virtual ~Convolver();
+
+	//! Sets the impulse response, which must not be modified afterwards. Can be called while the Convolver is processing, the previous impulse response is released
+	//! once the audio thread is done with it. Outputs silence until an impulse response is set.
+	void setImpulseResponse( const BufferRef &impulseResponse );
+	//! Loads the impulse response from \a dataSource, resampled to the Context's samplerate. A file is only loaded once while any Convolver is using it.
+	void loadImpulseResponse( const DataSourceRef &dataSource );
+	const BufferRef& getImpulseResponse() const	{ return mImpulseResponse; }
+
+	//! Sets the minimum number of frames in each tail partition. 0 (the default) uses block sized partitions for the entire impulse response, otherwise the frames after
+	//! the first two tail partitions use tail partitions, which reduces the work for long impulse responses. Takes effect once the Convolver is next initialized.
+	void	setTailPartitionFrames( size_t frames )	{ mTailPartitionFrames = frames; }
+	size_t	getTailPartitionFrames() const			{ return mTailPartitionFrames; }
+
+	//! Returns the number of frames that the output is delayed by, which is at least getFramesPerBlock().
+	size_t		getLatencyFrames() const;
+	//! Returns the number of partitions for which the background thread processed the tail too late, and it was left out of the output.
+	uint64_t	getNumTailUnderruns() const;
+
+	//! Returns the length of the impulse response plus the latency.
+	double getTailSeconds() const override;
+
+	//! Returns the number of frequency-domain impulse responses currently shared between Convolver's.
+	static size_t getNumCachedImpulseResponses();
+
+  protected:
+	void initialize()				override;
+	void uninitialize()				override;
+	void process( Buffer *buffer )	override;
+
+  private:
+	void updateConvolver();
+	void processTailAsyncImpl();
+	void destroyTailThreadImpl();
+
+	BufferRef										mImpulseResponse;
+	size_t											mTailPartitionFrames;
+
+	std::shared_ptr<dsp::PartitionedConvolver>		mConvolver;
+	std::atomic<dsp::PartitionedConvolver *>		mProcessConvolver;	// the audio thread's view of mConvolver
+
+	std::unique_ptr<std::thread>					mTailThread;
+	std::mutex										mTailMutex;			// held by the tail thread while processing, and when replacing mConvolver
+	std::condition_variable							mTailCond;
+	bool											mTailShouldQuit;
+};
+
+} } // namespace cinder::audio2
@@ -23,6 +23,9 @@
 
 #include "cinder/audio2/Filter.h"
 
+#include <algorithm>
+#include <cmath>
+
 using namespace std;
 
 namespace cinder { namespace audio2 {
@@ -32,16 +35,16 @@ void FilterBiquad::initialize()
 	// Convert from Hertz to normalized frequency 0 -> 1.
 	mNiquist = getSampleRate() / 2;
 
-	mBufferd = BufferT<double>( getFramesPerBlock(), mNumChannels );
-	mBiquads.resize( mNumChannels );
+	mBiquadBank.setPrecision( mPrecision );
+	mBiquadBank.setNumFilters( mNumChannels );
 
-	if( mCoeffsDirty )
-		updateBiquadParams();
+	// the new filters need their coefficients, even if the parameters haven't changed.
+	updateBiquadParams();
 }
 
 void FilterBiquad::uninitialize()
 {
-	mBiquads.clear();
+	mBiquadBank.setNumFilters( 0 );
 }
 
 void FilterBiquad::process( Buffer *buffer )
@@ -49,12 +52,19 @@ void FilterBiquad::process( Buffer *buffer )
 	if( mCoeffsDirty )
 		updateBiquadParams();
 
-	size_t numFrames = buffer->getNumFrames();
+	dsp::BiquadBank::Precision precision = mPrecision;
+	if( mBiquadBank.getPrecision() != precision )
+		mBiquadBank.setPrecision( precision );
 
-	for( size_t ch = 0; ch < mNumChannels; ch++ ) {
-		float *channel = buffer->getChannel( ch );
-		mBiquads[ch].process( channel, channel, numFrames );
-	}
+	mBiquadBank.process( buffer, buffer );
+}
+
+double FilterBiquad::getTailSeconds() const
+{
+	if( ! mBiquadBank.getNumFilters() )
+		return numeric_limits<double>::infinity();
+
+	return mBiquad.getTailFrames() / double( mNiquist * 2 );
 }
 
 void FilterBiquad::updateBiquadParams()
@@ -64,41 +74,360 @@ void FilterBiquad::updateBiquadParams()
 
 	switch( mMode ) {
 		case Mode::LOWPASS:
-			for( size_t ch = 0; ch < mNumChannels; ch++ )
-				mBiquads[ch].setLowpassParams( normalizedFrequency, mQ );
+			mBiquad.setLowpassParams( normalizedFrequency, mQ );
 			break;
 		case Mode::HIGHPASS:
-			for( size_t ch = 0; ch < mNumChannels; ch++ )
-				mBiquads[ch].setHighpassParams( normalizedFrequency, mQ );
+			mBiquad.setHighpassParams( normalizedFrequency, mQ );
 			break;
 		case Mode::BANDPASS:
-			for( size_t ch = 0; ch < mNumChannels; ch++ )
-				mBiquads[ch].setBandpassParams( normalizedFrequency, mQ );
+			mBiquad.setBandpassParams( normalizedFrequency, mQ );
 			break;
 		case Mode::LOWSHELF:
-			for( size_t ch = 0; ch < mNumChannels; ch++ )
-				mBiquads[ch].setLowShelfParams( mFreq, mGain );;
+			mBiquad.setLowShelfParams( mFreq, mGain );
 			break;
 		case Mode::HIGHSHELF:
-			for( size_t ch = 0; ch < mNumChannels; ch++ )
-				mBiquads[ch].setHighShelfParams( mFreq, mGain );;
+			mBiquad.setHighShelfParams( mFreq, mGain );
 			break;
 		case Mode::PEAKING:
-			for( size_t ch = 0; ch < mNumChannels; ch++ )
-				mBiquads[ch].setPeakingParams( normalizedFrequency, mQ, mGain );
+			mBiquad.setPeakingParams( normalizedFrequency, mQ, mGain );
 			break;
 		case Mode::ALLPASS:
-			for( size_t ch = 0; ch < mNumChannels; ch++ )
-				mBiquads[ch].setBandpassParams( normalizedFrequency, mQ );
+			mBiquad.setBandpassParams( normalizedFrequency, mQ );
 			break;
 		case Mode::NOTCH:
-			for( size_t ch = 0; ch < mNumChannels; ch++ )
-				mBiquads[ch].setNotchParams( normalizedFrequency, mQ );
+			mBiquad.setNotchParams( normalizedFrequency, mQ );
 			break;
 		default:
 			break;
 	}
+
+	for( size_t ch = 0; ch < mNumChannels; ch++ )
+		mBiquadBank.setCoefficients( ch, mBiquad );
+}
+
+namespace {
+
+// Normalized frequencies are kept away from 0 and the Nyquist frequency, where the coefficients degenerate.
+const double MIN_NORMALIZED_FREQ = 0.000001;
+const double MAX_NORMALIZED_FREQ = 0.49;
+
+// The number of frames that FilterCascade runs each of its constant sections over per call to the BiquadBank.
+const size_t PIPELINE_CHUNK_FRAMES = 32;
+
+// Returns tan( x ) for x in [0, pi / 2), as ( cos( y ) + sin( y ) ) / ( cos( y ) - sin( y ) ) with y = x - pi / 4, using Taylor polynomials for
+// sin() and cos(), which are accurate to about 1e-9 over [-pi / 4, pi / 4].
+double fastTan( double x )
+{
+	const double y = x - M_PI / 4;
+	const double y2 = y * y;
+	const double sinY = y * ( 1 + y2 * ( -1.0 / 6 + y2 * ( 1.0 / 120 + y2 * ( -1.0 / 5040 + y2 / 362880 ) ) ) );
+	const double cosY = 1 + y2 * ( -1.0 / 2 + y2 * ( 1.0 / 24 + y2 * ( -1.0 / 720 + y2 * ( 1.0 / 40320 - y2 / 3628800 ) ) ) );
+
+	return ( cosY + sinY ) / ( cosY - sinY );
+}
+
+// Returns the value of \a param at \a frame, which can be \a numFrames (the end of the block), given the evaluation returned by evalCheapest().
+float getValueAtFrame( const Param &param, Param::Evaluation evaluation, size_t frame, size_t numFrames )
+{
+	switch( evaluation ) {
+		case Param::AUDIO_VALUES:
+			return param.getValueArray()[std::min( frame, numFrames - 1 )];
+		case Param::CONTROL_VALUES: {
+			const float *controlValues = param.getControlValues();
+			const size_t controlFrames = param.getControlFrames();
+			const size_t i = frame / controlFrames;
+			if( i + 1 >= param.getNumControlValues() )
+				return controlValues[param.getNumControlValues() - 1];
+
+			const size_t count = std::min( controlFrames, numFrames - i * controlFrames );
+			const float t = float( frame - i * controlFrames ) / float( count );
+			return controlValues[i] + ( controlValues[i + 1] - controlValues[i] ) * t;
+		}
+		case Param::CONSTANT:
+		default:
+			return param.getValue();
+	}
+}
+
+} // anonymous namespace
+
+FilterCascade::Section::Section( Node *parent )
+	: mMode( FilterBiquad::LOWPASS ), mFreq( parent, 1000 ), mQ( parent, 0.7071f ), mGain( parent, 0 ), mLastMode( FilterBiquad::LOWPASS ),
+	mLastFreq( 0 ), mLastQ( 0 ), mLastGain( 0 ), mFreqEval( Param::CONSTANT ), mQEval( Param::CONSTANT ), mGainEval( Param::CONSTANT ), mIsVarying( false )
+{
+	mFreq.setCheapestEvalOnly();
+	mQ.setCheapestEvalOnly();
+	mGain.setCheapestEvalOnly();
+}
+
+FilterCascade::FilterCascade( size_t numSections, const Format &format )
+	: NodeEffect( format ), mSubBlockFrames( 32 ), mSampleRate( 0 )
+{
+	for( size_t i = 0; i < numSections; i++ )
+		mSections.emplace_back( new Section( this ) );
+}
+
+void FilterCascade::initialize()
+{
+	mSampleRate = double( getSampleRate() );
+
+	// also clears the state.
+	mBiquadBank.setNumFilters( mSections.size() * mNumChannels );
+	mSources.resize( mBiquadBank.getNumFilters() );
+	mDests.resize( mBiquadBank.getNumFilters() );
+
+	for( size_t i = 0; i < mSections.size(); i++ ) {
+		Section &section = *mSections[i];
+		section.mLastMode = section.mMode;
+		section.mLastFreq = section.mFreq.getValue();
+		section.mLastQ = section.mQ.getValue();
+		section.mLastGain = section.mGain.getValue();
+		setCoefficients( i, computeCoefficients( section.mLastMode, section.mLastFreq, section.mLastQ, section.mLastGain ) );
+	}
 }
 
+void FilterCascade::process( Buffer *buffer )
+{
+	// A section whose Param's are constant only needs new coefficients if its mode or values changed since the last block, in which case
+	// they are interpolated over the first sub-block.
+	for( auto &section : mSections ) {
+		section->mFreqEval = section->mFreq.evalCheapest();
+		section->mQEval = section->mQ.evalCheapest();
+		section->mGainEval = section->mGain.evalCheapest();
+
+		section->mIsVarying = section->mFreqEval != Param::CONSTANT || section->mQEval != Param::CONSTANT || section->mGainEval != Param::CONSTANT
+								|| section->mMode != section->mLastMode || section->mFreq.getValue() != section->mLastFreq
+								|| section->mQ.getValue() != section->mLastQ || section->mGain.getValue() != section->mLastGain;
+	}
+
+	// the sections run in series, a varying one over the whole block before the next and each run of constant ones together.
+	for( size_t i = 0; i < mSections.size(); ) {
+		if( mSections[i]->mIsVarying ) {
+			processVaryingSection( i, buffer );
+			i++;
+			continue;
+		}
+
+		size_t end = i + 1;
+		while( end < mSections.size() && ! mSections[end]->mIsVarying )
+			end++;
+
+		processConstantSections( i, end, buffer );
+		i = end;
+	}
+}
+
+// Sets the coefficients of section \a index, which its BiquadBank filters share.
+void FilterCascade::setCoefficients( size_t index, const Coefficients &coefficients )
+{
+	mSections[index]->mCoefficients = coefficients;
+
+	for( size_t ch = 0; ch < mNumChannels; ch++ )
+		mBiquadBank.setCoefficients( index * mNumChannels + ch, coefficients.mB0, coefficients.mB1, coefficients.mB2, coefficients.mA1, coefficients.mA2 );
+}
+
+// Runs section \a index over the block one sub-block at a time, interpolating its coefficients towards the values of its Param's at the end of each.
+void FilterCascade::processVaryingSection( size_t index, Buffer *buffer )
+{
+	Section &section = *mSections[index];
+	const size_t numFrames = buffer->getNumFrames();
+	const size_t subBlockFrames = mSubBlockFrames;
+
+	for( size_t frame = 0; frame < numFrames; frame += subBlockFrames ) {
+		const size_t subBlockEnd = min( frame + subBlockFrames, numFrames );
+
+		section.mLastMode = section.mMode;
+		section.mLastFreq = getValueAtFrame( section.mFreq, section.mFreqEval, subBlockEnd, numFrames );
+		section.mLastQ = getValueAtFrame( section.mQ, section.mQEval, subBlockEnd, numFrames );
+		section.mLastGain = getValueAtFrame( section.mGain, section.mGainEval, subBlockEnd, numFrames );
+
+		const Coefficients target = computeCoefficients( section.mLastMode, section.mLastFreq, section.mLastQ, section.mLastGain );
+		const Coefficients &current = section.mCoefficients;
+		const double scale = 1.0 / double( subBlockEnd - frame );
+		const Coefficients increments = {
+			( target.mB0 - current.mB0 ) * scale, ( target.mB1 - current.mB1 ) * scale, ( target.mB2 - current.mB2 ) * scale,
+			( target.mA1 - current.mA1 ) * scale, ( target.mA2 - current.mA2 ) * scale
+		};
+
+		processSection( index, increments, buffer, frame, subBlockEnd - frame );
+		setCoefficients( index, target );
+	}
+}
+
+// Runs section \a index over \a numFrames frames of each channel from \a frame, in transposed direct form II, with its coefficients advanced
+// by \a increments every frame so that they reach their target on the last frame. The state is kept in the section's BiquadBank filters.
+void FilterCascade::processSection( size_t index, const Coefficients &increments, Buffer *buffer, size_t frame, size_t numFrames )
+{
+	for( size_t ch = 0; ch < mNumChannels; ch++ ) {
+		float *channel = buffer->getChannel( ch ) + frame;
+		double s1, s2;
+		mBiquadBank.getState( index * mNumChannels + ch, &s1, &s2 );
+
+		Coefficients c = mSections[index]->mCoefficients;
+		for( size_t i = 0; i < numFrames; i++ ) {
+			c.mB0 += increments.mB0;
+			c.mB1 += increments.mB1;
+			c.mB2 += increments.mB2;
+			c.mA1 += increments.mA1;
+			c.mA2 += increments.mA2;
+
+			const double x = channel[i];
+			const double y = c.mB0 * x + s1;
+			s1 = c.mB1 * x - c.mA1 * y + s2;
+			s2 = c.mB2 * x - c.mA2 * y;
+			channel[i] = float( y );
+		}
+
+		mBiquadBank.setState( index * mNumChannels + ch, s1, s2 );
+	}
+}
+
+// Runs the constant sections [beginIndex, endIndex) over the block in one pass. Each section filters a chunk behind the section before it, which
+// has just filtered that chunk in place, so every call to the BiquadBank runs a chunk of each section in its own SIMD lanes and their recursions
+// overlap instead of running one after another. The frames after the last whole chunk are filtered one section at a time.
+void FilterCascade::processConstantSections( size_t beginIndex, size_t endIndex, Buffer *buffer )
+{
+	const size_t numSections = endIndex - beginIndex;
+	const size_t numFrames = buffer->getNumFrames();
+	const size_t numChunks = numFrames / PIPELINE_CHUNK_FRAMES;
+
+	for( size_t step = 0; numChunks && step < numChunks + numSections - 1; step++ ) {
+		// section k (relative to beginIndex) filters chunk step - k, the first and last steps fill and drain the pipeline.
+		const size_t firstSection = step < numChunks ? 0 : step - numChunks + 1;
+		const size_t lastSection = min( step + 1, numSections );
+
+		size_t filter = 0;
+		for( size_t k = firstSection; k < lastSection; k++ ) {
+			const size_t frame = ( step - k ) * PIPELINE_CHUNK_FRAMES;
+			for( size_t ch = 0; ch < mNumChannels; ch++ ) {
+				mSources[filter] = mDests[filter] = buffer->getChannel( ch ) + frame;
+				filter++;
+			}
+		}
+
+		mBiquadBank.process( mSources.data(), mDests.data(), PIPELINE_CHUNK_FRAMES, ( beginIndex + firstSection ) * mNumChannels, filter );
+	}
+
+	const size_t remainderFrame = numChunks * PIPELINE_CHUNK_FRAMES;
+	if( remainderFrame == numFrames )
+		return;
+
+	for( size_t ch = 0; ch < mNumChannels; ch++ )
+		mSources[ch] = mDests[ch] = buffer->getChannel( ch ) + remainderFrame;
+
+	for( size_t i = beginIndex; i < endIndex; i++ )
+		mBiquadBank.process( mSources.data(), mDests.data(), numFrames - remainderFrame, i * mNumChannels, mNumChannels );
+}
+
+// The coefficients are the bilinear transforms of the analog prototypes, written in terms of k = tan( pi * freq / sampleRate ). The peaking and shelving
+// filters swap their numerator and denominator for cuts, so that boosts and cuts of the same gain cancel.
+FilterCascade::Coefficients FilterCascade::computeCoefficients( Mode mode, float freq, float q, float gain ) const
+{
+	const double normalizedFreq = max( MIN_NORMALIZED_FREQ, min( MAX_NORMALIZED_FREQ, freq / mSampleRate ) );
+	const double k = fastTan( M_PI * normalizedFreq );
+	const double kk = k * k;
+	const double kq = k / max( double( q ), 0.0001 );
+
+	Coefficients c = { 1, 0, 0, 0, 0 };
+	switch( mode ) {
+		case FilterBiquad::LOWPASS: {
+			const double norm = 1 / ( 1 + kq + kk );
+			c.mB0 = kk * norm;
+			c.mB1 = 2 * c.mB0;
+			c.mB2 = c.mB0;
+			c.mA1 = 2 * ( kk - 1 ) * norm;
+			c.mA2 = ( 1 - kq + kk ) * norm;
+			break;
+		}
+		case FilterBiquad::HIGHPASS: {
+			const double norm = 1 / ( 1 + kq + kk );
+			c.mB0 = norm;
+			c.mB1 = -2 * norm;
+			c.mB2 = norm;
+			c.mA1 = 2 * ( kk - 1 ) * norm;
+			c.mA2 = ( 1 - kq + kk ) * norm;
+			break;
+		}
+		case FilterBiquad::BANDPASS: {
+			const double norm = 1 / ( 1 + kq + kk );
+			c.mB0 = kq * norm;
+			c.mB1 = 0;
+			c.mB2 = -c.mB0;
+			c.mA1 = 2 * ( kk - 1 ) * norm;
+			c.mA2 = ( 1 - kq + kk ) * norm;
+			break;
+		}
+		case FilterBiquad::NOTCH: {
+			const double norm = 1 / ( 1 + kq + kk );
+			c.mB0 = ( 1 + kk ) * norm;
+			c.mB1 = 2 * ( kk - 1 ) * norm;
+			c.mB2 = c.mB0;
+			c.mA1 = c.mB1;
+			c.mA2 = ( 1 - kq + kk ) * norm;
+			break;
+		}
+		case FilterBiquad::ALLPASS: {
+			const double norm = 1 / ( 1 + kq + kk );
+			c.mB0 = ( 1 - kq + kk ) * norm;
+			c.mB1 = 2 * ( kk - 1 ) * norm;
+			c.mB2 = 1;
+			c.mA1 = c.mB1;
+			c.mA2 = c.mB0;
+			break;
+		}
+		case FilterBiquad::PEAKING: {
+			const double v = pow( 10.0, fabs( gain ) / 20.0 );
+			const double boost = gain >= 0 ? v : 1, cut = gain >= 0 ? 1 : v;
+			const double norm = 1 / ( 1 + cut * kq + kk );
+			c.mB0 = ( 1 + boost * kq + kk ) * norm;
+			c.mB1 = 2 * ( kk - 1 ) * norm;
+			c.mB2 = ( 1 - boost * kq + kk ) * norm;
+			c.mA1 = c.mB1;
+			c.mA2 = ( 1 - cut * kq + kk ) * norm;
+			break;
+		}
+		case FilterBiquad::LOWSHELF:
+		case FilterBiquad::HIGHSHELF: {
+			const double v = pow( 10.0, fabs( gain ) / 20.0 );
+			const double sv = sqrt( v );
+			double num[3], den[3];
+			if( mode == FilterBiquad::LOWSHELF ) {
+				num[0] = 1 + sv * kq + v * kk;	num[1] = 2 * ( v * kk - 1 );	num[2] = 1 - sv * kq + v * kk;
+				den[0] = 1 + kq + kk;			den[1] = 2 * ( kk - 1 );		den[2] = 1 - kq + kk;
+			}
+			else {
+				num[0] = v + sv * kq + kk;		num[1] = 2 * ( kk - v );		num[2] = v - sv * kq + kk;
+				den[0] = 1 + kq + kk;			den[1] = 2 * ( kk - 1 );		den[2] = 1 - kq + kk;
+			}
+			if( gain < 0 )
+				swap( num, den );
+
+			const double norm = 1 / den[0];
+			c.mB0 = num[0] * norm;
+			c.mB1 = num[1] * norm;
+			c.mB2 = num[2] * norm;
+			c.mA1 = den[1] * norm;
+			c.mA2 = den[2] * norm;
+			break;
+		}
+		default:
+			break;
+	}
+
+	return c;
+}
+
+double FilterCascade::getTailSeconds() const
+{
+	if( ! mSampleRate )
+		return numeric_limits<double>::infinity();
+
+	// the sections run in series, so their tails add up.
+	double tailFrames = 0;
+	for( const auto &section : mSections )
+		tailFrames += dsp::Biquad::getTailFrames( section->mCoefficients.mA1, section->mCoefficients.mA2 );
+
+	return tailFrames / mSampleRate;
+}
 
 } } // namespace cinder::audio2
\ No newline at end of file
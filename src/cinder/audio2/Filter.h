@@ -25,7 +25,9 @@
 
 #include "cinder/audio2/NodeEffect.h"
 #include "cinder/audio2/dsp/Biquad.h"
+#include "cinder/audio2/dsp/BiquadBank.h"
 
+#include <memory>
 #include <vector>
 
 // rename file to Filter.h/cpp
@@ -37,13 +39,14 @@ namespace cinder { namespace audio2 {
 typedef std::shared_ptr<class FilterLowPass>		FilterLowPassRef;
 typedef std::shared_ptr<class FilterHighPass>		FilterHighPassRef;
 typedef std::shared_ptr<class FilterBandPass>		FilterBandPassRef;
+typedef std::shared_ptr<class FilterCascade>		FilterCascadeRef;
 
-//! Base class for filter nodes that use Biquad
+//! Base class for filter nodes that use Biquad. All channels are filtered at once by a dsp::BiquadBank.
 class FilterBiquad : public NodeEffect {
   public:
 	enum Mode { LOWPASS, HIGHPASS, BANDPASS, LOWSHELF, HIGHSHELF, PEAKING, ALLPASS, NOTCH, CUSTOM };
 
-	FilterBiquad( Mode mode = LOWPASS, const Format &format = Format() ) : NodeEffect( format ), mMode( mode ), mCoeffsDirty( true ), mFreq( 200.0f ), mQ( 1.0f ), mGain( 0.0f ) {}
+	FilterBiquad( Mode mode = LOWPASS, const Format &format = Format() ) : NodeEffect( format ), mMode( mode ), mCoeffsDirty( true ), mPrecision( dsp::BiquadBank::DOUBLE ), mFreq( 200.0f ), mQ( 1.0f ), mGain( 0.0f ) {}
 	virtual ~FilterBiquad() {}
 
 	void setMode( Mode mode )	{ mMode = mode; mCoeffsDirty = true; }
@@ -58,6 +61,13 @@ class FilterBiquad : public NodeEffect {
 	void setGain( float gain )	{ mGain = gain; mCoeffsDirty = true; }
 	float getGain() const		{ return mGain; }
 
+	//! Sets the precision of the filter arithmetic, which takes effect on the next processing block. Defaults to dsp::BiquadBank::DOUBLE. \see dsp::BiquadBank::Precision
+	void setPrecision( dsp::BiquadBank::Precision precision )	{ mPrecision = precision; }
+	dsp::BiquadBank::Precision getPrecision() const				{ return mPrecision; }
+
+	//! Returns the time it takes for the filter's impulse response to decay to -120 dB.
+	double getTailSeconds() const override;
+
   protected:
 	void initialize()				override;
 	void uninitialize()				override;
@@ -65,9 +75,10 @@ class FilterBiquad : public NodeEffect {
 
 	void updateBiquadParams();
 
-	std::vector<dsp::Biquad> mBiquads;
+	dsp::Biquad mBiquad;			// computes the coefficients, which all channels share
+	dsp::BiquadBank mBiquadBank;
 	std::atomic<bool> mCoeffsDirty;
-	BufferT<double> mBufferd;
+	std::atomic<dsp::BiquadBank::Precision> mPrecision;
 	size_t mNiquist;
 
 	Mode mMode;
@@ -110,5 +121,72 @@ public:
 	float getWidth() const			{ return mQ; }
 };
 
+//! \brief A cascade of second order sections, all processed in one pass over each block.
+//!
+//! Each section has its own Mode and Param's for frequency in Hertz, Q and gain in decibels, which can be ramped or driven by a processing Node.
+//! While any of them vary, the section's coefficients are computed every getSubBlockFrames() frames and interpolated over the frames in between,
+//! so sweeps don't produce zipper noise. Consecutive sections with constant coefficients are run together in the SIMD lanes of a dsp::BiquadBank. The coefficients are derived from tan( pi * freq / sampleRate ), using a polynomial approximation of
+//! tan(), so modulating every section at audio rate stays cheap. Unlike FilterBiquad, LOWPASS and HIGHPASS take Q, where 0.7071 is Butterworth,
+//! and LOWSHELF and HIGHSHELF take Q as their slope. CUSTOM passes the input through unchanged.
+class FilterCascade : public NodeEffect {
+  public:
+	typedef FilterBiquad::Mode Mode;
+
+	//! Constructs a FilterCascade with \a numSections sections, each a LOWPASS at 1000 Hz with a Q of 0.7071 and no gain.
+	FilterCascade( size_t numSections = 1, const Format &format = Format() );
+	virtual ~FilterCascade() {}
+
+	size_t	getNumSections() const					{ return mSections.size(); }
+
+	void	setMode( size_t section, Mode mode )	{ mSections.at( section )->mMode = mode; }
+	Mode	getMode( size_t section ) const			{ return mSections.at( section )->mMode; }
+
+	Param*	getParamFreq( size_t section )			{ return &mSections.at( section )->mFreq; }
+	Param*	getParamQ( size_t section )				{ return &mSections.at( section )->mQ; }
+	Param*	getParamGain( size_t section )			{ return &mSections.at( section )->mGain; }
+
+	//! Sets the number of frames between coefficient updates while a section's Param's vary (default = 32). Smaller values follow fast modulation more closely, at a higher cost.
+	void	setSubBlockFrames( size_t frames )		{ mSubBlockFrames = std::max<size_t>( frames, 1 ); }
+	size_t	getSubBlockFrames() const				{ return mSubBlockFrames; }
+
+	//! Returns the time it takes for the impulse response of all sections to decay to -120 dB.
+	double getTailSeconds() const override;
+
+  protected:
+	void initialize()				override;
+	void process( Buffer *buffer )	override;
+
+  private:
+	struct Coefficients {
+		double mB0, mB1, mB2, mA1, mA2;
+	};
+
+	struct Section {
+		Section( Node *parent );
+
+		std::atomic<Mode>	mMode;
+		Param				mFreq, mQ, mGain;
+
+		// audio thread only
+		Mode				mLastMode;
+		float				mLastFreq, mLastQ, mLastGain;		// the values that mCoefficients were computed from
+		Coefficients		mCoefficients;
+		Param::Evaluation	mFreqEval, mQEval, mGainEval;
+		bool				mIsVarying;							// whether mCoefficients change during the current block
+	};
+
+	Coefficients computeCoefficients( Mode mode, float freq, float q, float gain ) const;
+	void setCoefficients( size_t index, const Coefficients &coefficients );
+	void processVaryingSection( size_t index, Buffer *buffer );
+	void processSection( size_t index, const Coefficients &increments, Buffer *buffer, size_t frame, size_t numFrames );
+	void processConstantSections( size_t beginIndex, size_t endIndex, Buffer *buffer );
+
+	std::vector<std::unique_ptr<Section> >	mSections;
+	dsp::BiquadBank							mBiquadBank;		// one filter per section per channel, which holds their state
+	std::vector<const float *>				mSources;
+	std::vector<float *>					mDests;
+	std::atomic<size_t>						mSubBlockFrames;
+	double									mSampleRate;
+};
 
 } } // namespace cinder::audio2
\ No newline at end of file
@@ -26,10 +26,11 @@
 #include "cinder/audio2/dsp/Dsp.h"
 #include "cinder/audio2/Utilities.h"
 #include "cinder/audio2/Debug.h"
-#include "cinder/Rand.h"
 
 #define DEFAULT_TABLE_SIZE 4096
 #define DEFAULT_BANDLIMITED_TABLES 40
+#define BANK_COMMANDS_PER_OSCILLATOR 4
+#define BANK_MIN_COMMANDS 1024
 
 using namespace std;
 
@@ -66,13 +67,48 @@ void Gen::initialize()
 // MARK: - GenNoise
 // ----------------------------------------------------------------------------------------------------
 
+namespace {
+
+uint32_t getNextNoiseSeed()
+{
+	static atomic<uint32_t> sNumConstructed( 0 );
+	return sNumConstructed++;
+}
+
+} // anonymous namespace
+
+GenNoise::GenNoise( const Format &format )
+	: Gen( format ), mType( WHITE ), mSeed( getNextNoiseSeed() ), mSeedChanged( false )
+{
+	mGenerator.setSeed( mSeed );
+}
+
+GenNoise::GenNoise( Type type, const Format &format )
+	: Gen( format ), mType( type ), mSeed( getNextNoiseSeed() ), mSeedChanged( false )
+{
+	mGenerator.setSeed( mSeed );
+}
+
+void GenNoise::setSeed( uint32_t seed )
+{
+	mSeed = seed;
+	mSeedChanged = true;
+}
+
 void GenNoise::process( Buffer *buffer )
 {
+	if( mSeedChanged.exchange( false ) )
+		mGenerator.setSeed( mSeed );
+
 	float *data = buffer->getData();
-	size_t count = buffer->getSize();
+	const size_t count = buffer->getSize();
 
-	for( size_t i = 0; i < count; i++ )
-		data[i] = ci::randFloat( -1.0f, 1.0f );
+	switch( mType ) {
+		case WHITE:	mGenerator.fillWhite( data, count );	break;
+		case PINK:	mGenerator.fillPink( data, count );		break;
+		case BROWN:	mGenerator.fillBrown( data, count );	break;
+		default:	CI_ASSERT_NOT_REACHABLE();
+	}
 }
 
 // ----------------------------------------------------------------------------------------------------
@@ -211,12 +247,12 @@ void GenTable::process( Buffer *buffer )
 // ----------------------------------------------------------------------------------------------------
 
 GenOscillator::GenOscillator( const Format &format )
-	: Gen( format ), mWaveformType( format.getWaveform() )
+	: Gen( format ), mProcessWaveTable( nullptr ), mWaveformType( format.getWaveform() )
 {
 }
 
 GenOscillator::GenOscillator( float freq, const Format &format )
-	: Gen( freq, format ), mWaveformType( format.getWaveform() )
+	: Gen( freq, format ), mProcessWaveTable( nullptr ), mWaveformType( format.getWaveform() )
 {
 }
 
@@ -225,16 +261,12 @@ void GenOscillator::initialize()
 	Gen::initialize();
 
 	size_t sampleRate = getSampleRate();
-	bool needsFill = false;
-	if( ! mWaveTable ) {
-		mWaveTable.reset( new dsp::WaveTable2d( sampleRate, DEFAULT_TABLE_SIZE, DEFAULT_BANDLIMITED_TABLES ) );
-		needsFill = true;
-	}
+	if( ! mWaveTable )
+		mWaveTable = dsp::WaveTable2d::getBandlimited( mWaveformType, sampleRate, DEFAULT_TABLE_SIZE, DEFAULT_BANDLIMITED_TABLES );
 	else if( sampleRate != mWaveTable->getSampleRate() )
-		needsFill = true;
+		mWaveTable = dsp::WaveTable2d::getBandlimited( mWaveformType, sampleRate, mWaveTable->getTableSize(), mWaveTable->getNumTables() );
 
-	if( needsFill )
-		mWaveTable->fillBandlimited( mWaveformType );
+	mProcessWaveTable = mWaveTable.get();
 }
 
 void GenOscillator::setWaveform( WaveformType type )
@@ -242,19 +274,35 @@ void GenOscillator::setWaveform( WaveformType type )
 	if( mWaveformType == type )
 		return;
 
-	// TODO: to prevent the entire graph from blocking, use our own lock and tryLock / fail when blocked in process()
-	lock_guard<mutex> lock( getContext()->getMutex() );
-
 	mWaveformType = type;
-	mWaveTable->fillBandlimited( type );
+
+	// if not yet initialized, the tables are filled in initialize()
+	if( ! mWaveTable )
+		return;
+
+	setWaveTable( dsp::WaveTable2d::getBandlimited( type, mWaveTable->getSampleRate(), mWaveTable->getTableSize(), mWaveTable->getNumTables() ) );
+}
+
+void GenOscillator::setWaveTable( const dsp::WaveTable2dConstRef &waveTable )
+{
+	dsp::WaveTable2dConstRef previousWaveTable = mWaveTable;
+	mWaveTable = waveTable;
+	mProcessWaveTable = waveTable.get();
+
+	// process() may still be reading from the previous table, so the Context holds onto it until that is no longer possible.
+	auto ctx = getContext();
+	if( ctx )
+		ctx->deferRelease( previousWaveTable );
 }
 
 void GenOscillator::process( Buffer *buffer )
 {
+	const dsp::WaveTable2d *waveTable = mProcessWaveTable;
+
 	if( mFreq.eval() )
-		mPhase = mWaveTable->lookupBandlimited( buffer->getData(), buffer->getSize(), mPhase, mFreq.getValueArray() );
+		mPhase = waveTable->lookupBandlimited( buffer->getData(), buffer->getSize(), mPhase, mFreq.getValueArray() );
 	else
-		mPhase = mWaveTable->lookupBandlimited( buffer->getData(), buffer->getSize(), mPhase, mFreq.getValue() );
+		mPhase = waveTable->lookupBandlimited( buffer->getData(), buffer->getSize(), mPhase, mFreq.getValue() );
 }
 
 // ----------------------------------------------------------------------------------------------------
@@ -278,16 +326,8 @@ void GenPulse::initialize()
 	mBuffer2.setNumFrames( getFramesPerBlock() );
 
 	size_t sampleRate = getSampleRate();
-	bool needsFill = false;
-	if( ! mWaveTable ) {
-		mWaveTable.reset( new dsp::WaveTable2d( sampleRate, DEFAULT_TABLE_SIZE, DEFAULT_BANDLIMITED_TABLES ) );
-		needsFill = true;
-	}
-	else if( sampleRate != mWaveTable->getSampleRate() )
-		needsFill = true;
-
-	if( needsFill )
-		mWaveTable->fillBandlimited( WaveformType::SAWTOOTH );
+	if( ! mWaveTable || sampleRate != mWaveTable->getSampleRate() )
+		mWaveTable = dsp::WaveTable2d::getBandlimited( WaveformType::SAWTOOTH, sampleRate, DEFAULT_TABLE_SIZE, DEFAULT_BANDLIMITED_TABLES );
 }
 
 void GenPulse::process( Buffer *buffer )
@@ -347,4 +387,73 @@ void GenPulse::process( Buffer *buffer )
 	dsp::sub( buffer->getData(), mBuffer2.getData(), buffer->getData(), buffer->getSize() );
 }
 
+// ----------------------------------------------------------------------------------------------------
+// MARK: - GenBank
+// ----------------------------------------------------------------------------------------------------
+
+GenBank::GenBank( size_t numOscillators, const Format &format )
+	: NodeInput( format ), mBank( numOscillators ), mCommands( max<size_t>( numOscillators * BANK_COMMANDS_PER_OSCILLATOR, BANK_MIN_COMMANDS ) ),
+	mFreqs( numOscillators, 0 ), mAmps( numOscillators, 0 ), mWaveformType( format.getWaveform() )
+{
+	mChannelMode = ChannelMode::SPECIFIED;
+	setNumChannels( 1 );
+}
+
+void GenBank::initialize()
+{
+	size_t sampleRate = getSampleRate();
+	if( ! mBank.getWaveTable() || sampleRate != mBank.getWaveTable()->getSampleRate() )
+		mBank.setWaveTable( dsp::WaveTable2d::getBandlimited( mWaveformType, sampleRate, DEFAULT_TABLE_SIZE, DEFAULT_BANDLIMITED_TABLES ) );
+}
+
+void GenBank::setFreq( size_t index, float freq )
+{
+	lock_guard<mutex> lock( mCommandsMutex );
+
+	mFreqs.at( index ) = freq;
+	sendCommand( index );
+}
+
+void GenBank::setAmp( size_t index, float amp )
+{
+	lock_guard<mutex> lock( mCommandsMutex );
+
+	mAmps.at( index ) = amp;
+	sendCommand( index );
+}
+
+void GenBank::set( size_t index, float freq, float amp )
+{
+	lock_guard<mutex> lock( mCommandsMutex );
+
+	mFreqs.at( index ) = freq;
+	mAmps.at( index ) = amp;
+	sendCommand( index );
+}
+
+// Each command carries the full state of its oscillator, so that the audio thread can apply them in any number at once.
+void GenBank::sendCommand( size_t index )
+{
+	const Command command = { index, mFreqs[index], mAmps[index] };
+	if( ! mCommands.write( &command, 1 ) )
+		CI_LOG_E( "command buffer is full, dropping change to oscillator " << index );
+}
+
+void GenBank::applyCommands()
+{
+	Command command;
+	while( mCommands.read( &command, 1 ) ) {
+		mBank.setFreq( command.mIndex, command.mFreq );
+		mBank.setAmp( command.mIndex, command.mAmp );
+	}
+}
+
+void GenBank::process( Buffer *buffer )
+{
+	applyCommands();
+
+	buffer->zero();
+	mBank.process( buffer->getData(), buffer->getNumFrames() );
+}
+
 } } // namespace cinder::audio2
\ No newline at end of file
@@ -25,12 +25,17 @@
 
 #include "cinder/audio2/NodeInput.h"
 #include "cinder/audio2/dsp/WaveTable.h"
+#include "cinder/audio2/dsp/RingBuffer.h"
+#include "cinder/audio2/dsp/NoiseGenerator.h"
+
+#include <mutex>
 
 namespace cinder { namespace audio2 {
 
 typedef std::shared_ptr<class Gen>						GenRef;
 typedef std::shared_ptr<class GenOscillator>			GenOscillatorRef;
 typedef std::shared_ptr<class GenPulse>					GenPulseRef;
+typedef std::shared_ptr<class GenBank>					GenBankRef;
 
 //! Base class for NodeInput's that generate audio samples.
 class Gen : public NodeInput {
@@ -53,13 +58,30 @@ class Gen : public NodeInput {
 	float mPhase;
 };
 
-//! Noise generator. \note freq param is ignored
+//! Noise generator, producing white, pink or brown noise with a dsp::NoiseGenerator of its own. \note freq param is ignored
 class GenNoise : public Gen {
   public:
-	GenNoise( const Format &format = Format() ) : Gen( format ) {}
+	enum Type { WHITE, PINK, BROWN };
+
+	GenNoise( const Format &format = Format() );
+	GenNoise( Type type, const Format &format = Format() );
+
+	void	setType( Type type )	{ mType = type; }
+	Type	getType() const			{ return mType; }
+
+	//! Restarts the noise from \a seed at the start of the next processing block, so that it repeats the same samples. By default, each
+	//! GenNoise is seeded with the number of GenNoise's constructed before it, so that they are uncorrelated, and reproducible as long as they are constructed in the same order.
+	void		setSeed( uint32_t seed );
+	uint32_t	getSeed() const		{ return mSeed; }
 
   protected:
 	void process( Buffer *buffer ) override;
+
+  private:
+	dsp::NoiseGenerator		mGenerator;
+	std::atomic<Type>		mType;
+	std::atomic<uint32_t>	mSeed;
+	std::atomic<bool>		mSeedChanged;
 };
 
 //! Phase generator, i.e. ramping waveform that runs from 0 to 1.
@@ -136,10 +158,13 @@ class GenOscillator : public Gen {
 	GenOscillator( float freq, const Format &format = Format() );
 
 
+	//! Sets the waveform type. The band-limited tables are shared with all other oscillators of the same waveform and sample rate (see dsp::WaveTable2d::getBandlimited()).
+	//! If no other oscillator uses them yet they are filled on the calling thread, processing continues with the previous ones until they are ready.
 	void setWaveform( WaveformType type );
 
-	void setWaveTable( const dsp::WaveTable2dRef &waveTable )	{ mWaveTable = waveTable; }
-	const dsp::WaveTable2dRef getWaveTable() const				{ return mWaveTable; }
+	//! Replaces the WaveTable2d used for lookup. Can be called while the GenOscillator is processing, the previous table is released once the audio thread is done with it.
+	void setWaveTable( const dsp::WaveTable2dConstRef &waveTable );
+	const dsp::WaveTable2dConstRef getWaveTable() const			{ return mWaveTable; }
 
 	WaveformType	getWaveForm() const			{ return mWaveformType; }
 	size_t			getTableSize() const		{ return mWaveTable->getTableSize(); }
@@ -149,8 +174,9 @@ class GenOscillator : public Gen {
 	void process( Buffer *buffer ) override;
 
 
-	dsp::WaveTable2dRef		mWaveTable;
-	WaveformType			mWaveformType;
+	dsp::WaveTable2dConstRef				mWaveTable;
+	std::atomic<const dsp::WaveTable2d *>	mProcessWaveTable; // the audio thread's view of mWaveTable
+	WaveformType							mWaveformType;
 };
 
 //! Pulse waveform generator with variable pulse width. Based on wavetable lookup of two band-limited sawtooth waveforms, subtracted from each other.
@@ -170,9 +196,72 @@ class GenPulse : public Gen {
 	void initialize() override;
 	void process( Buffer *buffer ) override;
 
-	dsp::WaveTable2dRef		mWaveTable;
-	BufferDynamic			mBuffer2;
-	Param					mWidth;
+	dsp::WaveTable2dConstRef	mWaveTable;
+	BufferDynamic				mBuffer2;
+	Param						mWidth;
+};
+
+//! \brief A bank of band-limited wavetable oscillators of one waveform, rendered and summed into a single channel in one pass.
+//!
+//! Suited to additive synthesis or beds of hundreds to thousands of voices, where a GenOscillator per voice would cost far more than its DSP
+//! in Param evaluation, graph traversal and summing. Each oscillator has its own frequency and amplitude, there are no Params. The oscillators
+//! are silent until their amplitude is set. \see dsp::WaveTableBank
+//!
+//! setFreq(), setAmp() and set() can be called from any thread other than the audio thread while the GenBank is processing. The changes
+//! are passed to the audio thread through a lock-free command buffer and applied at the start of the next processing block. The buffer holds
+//! four changes per oscillator (and at least 1024) between blocks, changes beyond that are dropped with an error.
+class GenBank : public NodeInput {
+  public:
+
+	struct Format : public Node::Format {
+		Format() : mWaveformType( WaveformType::SINE )	{}
+
+		Format&		waveform( WaveformType type )	{ mWaveformType = type; return *this; }
+
+		const WaveformType& getWaveform() const	{ return mWaveformType; }
+
+	  private:
+		WaveformType mWaveformType;
+	};
+
+	GenBank( size_t numOscillators, const Format &format = Format() );
+
+	size_t	getNumOscillators() const	{ return mFreqs.size(); }
+
+	//! Sets the frequency of oscillator \a index in Hertz.
+	void	setFreq( size_t index, float freq );
+	//! Sets the amplitude of oscillator \a index, which it ramps to over one processing block.
+	void	setAmp( size_t index, float amp );
+	//! Sets both the frequency and amplitude of oscillator \a index with a single command.
+	void	set( size_t index, float freq, float amp );
+
+	//! Returns the frequency last set for oscillator \a index, which may not have been applied by the audio thread yet.
+	float	getFreq( size_t index ) const	{ return mFreqs.at( index ); }
+	//! Returns the amplitude last set for oscillator \a index, which may not have been applied by the audio thread yet.
+	float	getAmp( size_t index ) const	{ return mAmps.at( index ); }
+
+	WaveformType				getWaveform() const		{ return mWaveformType; }
+	//! Returns the band-limited tables that the oscillators read from, which are shared as described in dsp::WaveTable2d::getBandlimited(). Null until initialized.
+	const dsp::WaveTable2dConstRef&	getWaveTable() const	{ return mBank.getWaveTable(); }
+
+  protected:
+	void initialize() override;
+	void process( Buffer *buffer ) override;
+
+  private:
+	struct Command {
+		size_t	mIndex;
+		float	mFreq, mAmp;
+	};
+
+	void sendCommand( size_t index );
+	void applyCommands();
+
+	dsp::WaveTableBank				mBank; // only accessed by the audio thread once initialized
+	dsp::RingBufferT<Command>		mCommands;
+	std::mutex						mCommandsMutex; // serializes the writers and guards mFreqs and mAmps, the audio thread reads commands without locking
+	std::vector<float>				mFreqs, mAmps;
+	WaveformType					mWaveformType;
 };
 
 } } // namespace cinder::audio2
\ No newline at end of file
@@ -0,0 +1,223 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/audio2/ModulationMatrix.h"
+#include "cinder/audio2/Context.h"
+#include "cinder/audio2/Param.h"
+#include "cinder/audio2/RealtimeCheck.h"
+#include "cinder/audio2/dsp/Dsp.h"
+#include "cinder/audio2/Debug.h"
+
+using namespace std;
+
+namespace cinder { namespace audio2 {
+
+ModulationMatrix::Route::Route( const shared_ptr<Source> &source, Param *param, const NodeRef &paramNode, size_t framesPerBlock )
+	: mSource( source ), mParam( param ), mParamNode( paramNode ), mDepth( 1 ), mOffset( 0 ), mBuffer( framesPerBlock, 1 )
+{
+	// the Param may read this before the audio thread first writes it, so start from its current value.
+	dsp::fill( param->getValue(), mBuffer.getData(), mBuffer.getSize() );
+}
+
+ModulationMatrix::ModulationMatrix( const ContextRef &context )
+	: mContext( context ), mRoutingPtr( nullptr )
+{
+}
+
+void ModulationMatrix::addSource( const string &name, const NodeRef &node )
+{
+	if( ! node )
+		return;
+
+	auto ctx = getContext();
+	{
+		lock_guard<mutex> lock( ctx->getMutex() );
+
+		// force node to be mono and initialize it. Like a Param's processing Node, it is pulled outside of the RenderGraph.
+		node->setNumChannels( 1 );
+		node->setPulledByParam();
+		node->initializeImpl();
+	}
+
+	// setting the channels may have suspended the RenderGraph if node was already part of it
+	ctx->updateRenderGraph();
+
+	lock_guard<mutex> lock( mMutex );
+
+	auto sourceIt = mSources.find( name );
+	if( sourceIt != mSources.end() )
+		disconnectRoutes( sourceIt->second );
+
+	mSources[name] = make_shared<Source>( node, ctx->getFramesPerBlock() );
+	publishRouting();
+
+	CI_LOG_V( "added modulation source '" << name << "': " << node->getName() );
+}
+
+void ModulationMatrix::removeSource( const string &name )
+{
+	lock_guard<mutex> lock( mMutex );
+
+	auto sourceIt = mSources.find( name );
+	if( sourceIt == mSources.end() )
+		return;
+
+	disconnectRoutes( sourceIt->second );
+
+	mSources.erase( sourceIt );
+	publishRouting();
+}
+
+NodeRef ModulationMatrix::getSource( const string &name ) const
+{
+	lock_guard<mutex> lock( mMutex );
+
+	auto sourceIt = mSources.find( name );
+	return sourceIt != mSources.end() ? sourceIt->second->mNode : NodeRef();
+}
+
+size_t ModulationMatrix::getNumSources() const
+{
+	lock_guard<mutex> lock( mMutex );
+
+	return mSources.size();
+}
+
+bool ModulationMatrix::connect( const string &sourceName, Param *param, float depth, float offset )
+{
+	CI_ASSERT( param );
+
+	lock_guard<mutex> lock( mMutex );
+
+	auto sourceIt = mSources.find( sourceName );
+	if( sourceIt == mSources.end() ) {
+		CI_LOG_E( "no modulation source named '" << sourceName << "'" );
+		return false;
+	}
+
+	auto routeIt = mRoutes.find( param );
+	if( routeIt != mRoutes.end() && routeIt->second->mSource == sourceIt->second ) {
+		routeIt->second->mDepth = depth;
+		routeIt->second->mOffset = offset;
+		return true;
+	}
+
+	auto route = make_shared<Route>( sourceIt->second, param, param->mParentNode->shared_from_this(), getContext()->getFramesPerBlock() );
+	route->mDepth = depth;
+	route->mOffset = offset;
+	mRoutes[param] = route;
+	publishRouting();
+
+	// the Param only reads the Route's Buffer once the audio thread can be writing it.
+	param->mModulation = route->mBuffer.getData();
+	return true;
+}
+
+void ModulationMatrix::disconnect( Param *param )
+{
+	lock_guard<mutex> lock( mMutex );
+
+	auto routeIt = mRoutes.find( param );
+	if( routeIt == mRoutes.end() )
+		return;
+
+	param->mModulation = nullptr;
+	mRoutes.erase( routeIt );
+	publishRouting();
+}
+
+bool ModulationMatrix::isConnected( const Param *param ) const
+{
+	lock_guard<mutex> lock( mMutex );
+
+	return mRoutes.count( param ) != 0;
+}
+
+size_t ModulationMatrix::getNumRoutes() const
+{
+	lock_guard<mutex> lock( mMutex );
+
+	return mRoutes.size();
+}
+
+void ModulationMatrix::process()
+{
+	CI_AUDIO_REALTIME_SCOPE();
+
+	Routing *routing = mRoutingPtr.load( memory_order_acquire );
+	if( ! routing )
+		return;
+
+	for( const auto &source : routing->mSources )
+		source->mNode->pullInputs( &source->mBuffer );
+
+	for( const auto &route : routing->mRoutes ) {
+		float *values = route->mBuffer.getData();
+		const size_t numFrames = route->mBuffer.getNumFrames();
+
+		dsp::mulAdd( route->mSource->mBuffer.getData(), route->mDepth, route->mOffset, values, numFrames );
+		route->mParam->mValue = values[numFrames - 1];
+	}
+}
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - Private
+// ----------------------------------------------------------------------------------------------------
+
+// Called with mMutex locked. A Param that is no longer routed must already have stopped reading from its Route, which the previous Routing
+// keeps alive until the audio thread is done with it.
+void ModulationMatrix::publishRouting()
+{
+	shared_ptr<Routing> routing( new Routing );
+	for( const auto &source : mSources ) {
+		routing->mSources.push_back( source.second );
+		for( const auto &route : mRoutes ) {
+			if( route.second->mSource == source.second )
+				routing->mRoutes.push_back( route.second );
+		}
+	}
+
+	mRoutingPtr.store( routing.get(), memory_order_release );
+	swap( mRouting, routing );
+	getContext()->deferRelease( routing );
+}
+
+void ModulationMatrix::disconnectRoutes( const shared_ptr<Source> &source )
+{
+	for( auto routeIt = mRoutes.begin(); routeIt != mRoutes.end(); /* */ ) {
+		if( routeIt->second->mSource == source ) {
+			routeIt->second->mParam->mModulation = nullptr;
+			routeIt = mRoutes.erase( routeIt );
+		}
+		else
+			++routeIt;
+	}
+}
+
+ContextRef ModulationMatrix::getContext() const
+{
+	return mContext.lock();
+}
+
+} } // namespace cinder::audio2
@@ -0,0 +1,118 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/audio2/Buffer.h"
+#include "cinder/audio2/Node.h"
+
+#include <boost/noncopyable.hpp>
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace cinder { namespace audio2 {
+
+class Param;
+
+typedef std::shared_ptr<class ModulationMatrix>		ModulationMatrixRef;
+
+//! \brief Routes named modulation sources to any number of Param's, computing each source only once per block.
+//!
+//! A source is a Node (ex. a GenSine used as an LFO) whose mono output is computed once per block, no matter how many Param's it drives.
+//! Each route applies its own depth and offset, so that a routed Param takes the value offset + depth * source on every frame, in place of
+//! its Ramp's and value. At the start of each block the audio thread computes every source and then writes every route in a single pass,
+//! ordered by source, before any Node is processed. Routing changes are made on non-audio threads and published to the audio thread whole,
+//! without blocking it. Each Context has one ModulationMatrix, see Context::getModulationMatrix().
+class ModulationMatrix : public boost::noncopyable {
+  public:
+	//! Adds a modulation source named \a name, replacing any existing source of the same name and disconnecting its routes. Forces \a node to be mono.
+	void	addSource( const std::string &name, const NodeRef &node );
+	//! Removes the source named \a name and disconnects all of its routes.
+	void	removeSource( const std::string &name );
+	//! Returns the Node of the source named \a name, or null if there is none.
+	NodeRef	getSource( const std::string &name ) const;
+	//! Returns the number of sources.
+	size_t	getNumSources() const;
+
+	//! Routes the source named \a sourceName to \a param, which then takes the value \a offset + \a depth * source. If \a param is already routed to the same source,
+	//! only its depth and offset are updated, which the audio thread picks up without republishing. Otherwise any existing route to \a param is replaced.
+	//! \return false if there is no source named \a sourceName.
+	bool	connect( const std::string &sourceName, Param *param, float depth = 1, float offset = 0 );
+	//! Removes the route to \a param, which returns to its own Ramp's and value.
+	void	disconnect( Param *param );
+	//! Returns whether \a param is routed to a source.
+	bool	isConnected( const Param *param ) const;
+	//! Returns the number of routes.
+	size_t	getNumRoutes() const;
+
+	//! Computes each source and writes every route for the current block. Called by the Context at the start of each block, before the RenderGraph is processed.
+	//! \note Must be called on the audio thread. Lock-free and never allocates.
+	void	process();
+
+  private:
+	ModulationMatrix( const ContextRef &context );
+
+	struct Source {
+		Source( const NodeRef &node, size_t framesPerBlock ) : mNode( node ), mBuffer( framesPerBlock, 1 )	{}
+
+		NodeRef		mNode;
+		Buffer		mBuffer;
+	};
+
+	struct Route {
+		Route( const std::shared_ptr<Source> &source, Param *param, const NodeRef &paramNode, size_t framesPerBlock );
+
+		std::shared_ptr<Source>	mSource;
+		Param*					mParam;
+		NodeRef					mParamNode;		// keeps mParam alive while the audio thread may write to it
+		std::atomic<float>		mDepth, mOffset;
+		Buffer					mBuffer;		// read by mParam in place of its own values
+	};
+
+	// The audio thread's view of the routing, which is never modified once published. Routes are ordered by source.
+	struct Routing {
+		std::vector<std::shared_ptr<Source> >	mSources;
+		std::vector<std::shared_ptr<Route> >	mRoutes;
+	};
+
+	// non-locking private methods
+	void		publishRouting();
+	void		disconnectRoutes( const std::shared_ptr<Source> &source );
+	ContextRef	getContext() const;
+
+	std::weak_ptr<Context>							mContext;
+	mutable std::mutex								mMutex;
+	std::map<std::string, std::shared_ptr<Source> >	mSources;
+	std::map<const Param *, std::shared_ptr<Route> >	mRoutes;
+	std::shared_ptr<Routing>						mRouting;
+	std::atomic<Routing *>							mRoutingPtr;	// read by the audio thread, the previous Routing is released with Context::deferRelease()
+
+	friend class Context;
+};
+
+} } // namespace cinder::audio2
@@ -25,6 +25,8 @@
 #include "cinder/audio2/Node.h"
 #include "cinder/audio2/Context.h"
 #include "cinder/audio2/NodeEffect.h"
+#include "cinder/audio2/NodeProfiler.h"
+#include "cinder/audio2/Param.h"
 #include "cinder/audio2/dsp/Dsp.h"
 #include "cinder/audio2/dsp/Converter.h"
 #include "cinder/audio2/Debug.h"
@@ -33,6 +35,7 @@
 
 #include "cinder/Utilities.h"
 
+#include <cmath>
 #include <limits>
 
 using namespace std;
@@ -45,7 +48,9 @@ namespace cinder { namespace audio2 {
 
 Node::Node( const Format &format )
 	: mInitialized( false ), mEnabled( false ),	mChannelMode( format.getChannelMode() ),
-		mNumChannels( 1 ), mAutoEnabled( false ), mProcessInPlace( true ), mLastProcessedFrame( numeric_limits<uint64_t>::max() )
+		mNumChannels( 1 ), mAutoEnabled( false ), mProcessInPlace( true ), mIsPulledByParam( false ),
+		mLastProcessedFrame( numeric_limits<uint64_t>::max() ), mSilentSinceFrame( numeric_limits<uint64_t>::max() ),
+		mScheduledStartFrame( numeric_limits<uint64_t>::max() ), mScheduledStopFrame( numeric_limits<uint64_t>::max() )
 {
 	if( format.getChannels() ) {
 		mNumChannels = format.getChannels();
@@ -125,12 +130,23 @@ void Node::disconnectAllOutputs()
 
 void Node::disconnectAllInputs()
 {
+	// the inputs belong to the same Context, so there is nothing left to disconnect from once it is destroyed.
+	auto ctx = getContext();
+	if( ! ctx )
+		return;
+
 	NodeRef thisRef = shared_from_this();
 
 	for( auto &in : mInputs )
 		in.second->disconnectOutput( thisRef );
 
-	mInputs.clear();
+	{
+		lock_guard<mutex> lock( ctx->getMutex() );
+
+		mInputs.clear();
+		ctx->invalidateRenderGraph();
+	}
+
 	notifyConnectionsDidChange();
 }
 
@@ -139,12 +155,21 @@ void Node::connectInput( const NodeRef &input, size_t bus )
 	lock_guard<mutex> lock( getContext()->getMutex() );
 
 	mInputs[bus] = input;
+
+	// a Param pulls the whole tree below this Node, so the new input must be set up for it before connections are configured.
+	if( mIsPulledByParam )
+		input->setPulledByParam();
+
 	configureConnections();
 }
 
 void Node::disconnectInput( const NodeRef &input )
 {
-	lock_guard<mutex> lock( getContext()->getMutex() );
+	auto ctx = getContext();
+	if( ! ctx )
+		return;
+
+	lock_guard<mutex> lock( ctx->getMutex() );
 
 	for( auto inIt = mInputs.begin(); inIt != mInputs.end(); ++inIt ) {
 		if( inIt->second == input ) {
@@ -152,6 +177,9 @@ void Node::disconnectInput( const NodeRef &input )
 			break;
 		}
 	}
+
+	// input may now be destroyed, so the RenderGraph must be rebuilt before it is processed again.
+	ctx->invalidateRenderGraph();
 }
 
 void Node::disconnectOutput( const NodeRef &output )
@@ -192,6 +220,24 @@ void Node::setEnabled( bool enabled )
 		stop();
 }
 
+void Node::start( double when )
+{
+	if( ! scheduleFrame( when, &mScheduledStartFrame ) )
+		start();
+}
+
+void Node::stop( double when )
+{
+	if( ! scheduleFrame( when, &mScheduledStopFrame ) )
+		stop();
+}
+
+void Node::cancelScheduled()
+{
+	mScheduledStartFrame = numeric_limits<uint64_t>::max();
+	mScheduledStopFrame = numeric_limits<uint64_t>::max();
+}
+
 size_t Node::getNumConnectedInputs() const
 {
 	return mInputs.size();
@@ -220,6 +266,11 @@ void Node::uninitializeImpl()
 	if( ! mInitialized )
 		return;
 
+	// the audio thread must not be processing this Node while it is uninitialized. Context is null when it is being destroyed.
+	auto ctx = getContext();
+	if( ctx )
+		ctx->suspendRenderGraph( this );
+
 	if( mAutoEnabled )
 		stop();
 
@@ -323,12 +374,23 @@ void Node::configureConnections()
 		setupProcessWithSumming();
 
 	initializeImpl();
+
+	auto ctx = getContext();
+	if( ctx )
+		ctx->invalidateRenderGraph();
 }
 
 void Node::pullInputs( Buffer *inPlaceBuffer )
 {
 	CI_ASSERT( getContext() );
 
+	// Node's pulled by a Param are processed outside of the RenderGraph, so scheduled events are applied at the start of the block they fall in.
+	if( getNextScheduledFrame() != numeric_limits<uint64_t>::max() ) {
+		uint64_t endFrame = getContext()->getNumProcessedFrames() + getFramesPerBlock();
+		while( applyScheduledEvent( endFrame ) )
+			;
+	}
+
 	if( mProcessInPlace ) {
 		if( mInputs.empty() ) {
 			// Fastest route: no inputs and process in-place. If disabled, get rid of any previously processsed samples.
@@ -381,10 +443,111 @@ void Node::setupProcessWithSumming()
 	CI_ASSERT( getContext() );
 
 	mProcessInPlace = false;
+
+	// The RenderGraph assigns Buffer's from the Context's RenderBufferPool to summing Node's, which are shared between Node's
+	// that are not processed at the same time. A Node pulled by a Param is processed outside of the RenderGraph, so it needs its own.
+	if( mIsPulledByParam ) {
+		setupBuffer( &mInternalBuffer );
+		setupBuffer( &mSummingBuffer );
+	}
+}
+
+void Node::setupInternalBuffer()
+{
+	CI_ASSERT( getContext() );
+
+	setupBuffer( &mInternalBuffer );
+}
+
+void Node::setPulledByParam()
+{
+	if( mIsPulledByParam )
+		return;
+
+	mIsPulledByParam = true;
+
+	if( ! mProcessInPlace )
+		setupProcessWithSumming();
+
+	for( auto &in : mInputs )
+		in.second->setPulledByParam();
+}
+
+void Node::setupBuffer( BufferDynamic *buffer )
+{
 	size_t framesPerBlock = getFramesPerBlock();
+	if( buffer->getNumFrames() == framesPerBlock && buffer->getNumChannels() == mNumChannels )
+		return;
+
+	// the buffer is about to be resized, so make sure the audio thread isn't using it.
+	getContext()->suspendRenderGraph( buffer );
+
+	buffer->setSize( framesPerBlock, mNumChannels );
+}
+
+void Node::prepare( size_t maxFramesPerBlock, size_t maxNumChannels )
+{
+	size_t numFrames = max( maxFramesPerBlock, getFramesPerBlock() );
+	size_t numChannels = max( maxNumChannels, mNumChannels );
+
+	// only Buffer's that are in use are reserved, the rest are assigned by the RenderGraph.
+	for( BufferDynamic *buffer : { &mInternalBuffer, &mSummingBuffer, &mPartialBuffer } ) {
+		if( ! buffer->isEmpty() )
+			reserveBuffer( buffer, numFrames, numChannels );
+	}
+
+	for( Param *param : mParams )
+		param->prepare( numFrames );
+}
+
+void Node::reserveBuffer( BufferDynamic *buffer, size_t numFrames, size_t numChannels )
+{
+	if( buffer->getAllocatedSize() >= numFrames * numChannels )
+		return;
+
+	// growing the storage reallocates it, so make sure the audio thread isn't using it.
+	getContext()->suspendRenderGraph( this );
+
+	size_t currentFrames = buffer->getNumFrames();
+	size_t currentChannels = buffer->getNumChannels();
+	buffer->setSize( numFrames, numChannels );
+	buffer->setSize( currentFrames, currentChannels );
+}
 
-	mInternalBuffer.setSize( framesPerBlock, mNumChannels );
-	mSummingBuffer.setSize( framesPerBlock, mNumChannels );
+// Stores the frame for \a when in \a scheduledFrame, or returns false if it has already been processed.
+bool Node::scheduleFrame( double when, atomic<uint64_t> *scheduledFrame )
+{
+	auto ctx = getContext();
+	uint64_t frame = (uint64_t)llround( max( when, 0.0 ) * ctx->getSampleRate() );
+	if( frame <= ctx->getNumProcessedFrames() )
+		return false;
+
+	// allocated before the frame is published, so the audio thread can always split the block it falls in.
+	setupBuffer( &mPartialBuffer );
+	*scheduledFrame = frame;
+	return true;
+}
+
+// Calls start() or stop() for the earliest event scheduled before \a endFrame, returning false if there is none. Called on the audio thread.
+bool Node::applyScheduledEvent( uint64_t endFrame )
+{
+	const uint64_t notScheduled = numeric_limits<uint64_t>::max();
+	uint64_t startFrame = mScheduledStartFrame;
+	uint64_t stopFrame = mScheduledStopFrame;
+
+	// the event is only applied if it wasn't re-scheduled or canceled in the meantime.
+	if( startFrame <= stopFrame && startFrame < endFrame ) {
+		if( mScheduledStartFrame.compare_exchange_strong( startFrame, notScheduled ) )
+			start();
+		return true;
+	}
+	else if( stopFrame < endFrame ) {
+		if( mScheduledStopFrame.compare_exchange_strong( stopFrame, notScheduled ) )
+			stop();
+		return true;
+	}
+
+	return false;
 }
 
 bool Node::checkCycle( const NodeRef &sourceNode, const NodeRef &destNode ) const
@@ -29,8 +29,10 @@
 #include <boost/noncopyable.hpp>
 #include <boost/logic/tribool.hpp>
 
+#include <algorithm>
 #include <memory>
 #include <atomic>
+#include <limits>
 #include <map>
 
 namespace cinder { namespace audio2 {
@@ -38,6 +40,9 @@ namespace cinder { namespace audio2 {
 typedef std::shared_ptr<class Context>			ContextRef;
 typedef std::shared_ptr<class Node>				NodeRef;
 
+class NodeProfiler;
+class Param;
+
 //! \brief Fundamental building block for creating an audio processing graph.
 //!
 //!	Node's allow for flexible combinations of synthesis, analysis, effects, file reading/writing, etc, and are designed so that
@@ -89,6 +94,15 @@ class Node : public std::enable_shared_from_this<Node>, public boost::noncopyabl
 	virtual void start()		{ mEnabled = true; }
 	//! Disables this Node for processing. Same as setEnabled( false ).
 	virtual void stop()			{ mEnabled = false; }
+	//! \brief Schedules start() to be called at \a when, in seconds of the Context's processed time (see Context::getNumProcessedSeconds()).
+	//!
+	//! The block containing \a when is split so that processing begins on that exact frame, rather than at the next block boundary. start() is
+	//! called on the audio thread at that point. If \a when has already passed, start() is called immediately. Replaces any previously scheduled start.
+	void start( double when );
+	//! Schedules stop() to be called at \a when, in seconds of the Context's processed time. \see start( double when )
+	void stop( double when );
+	//! Cancels any start or stop that has been scheduled but not yet reached.
+	void cancelScheduled();
 	//! Sets whether this Node is enabled for processing or not.
 	void setEnabled( bool b = true );
 	//! Returns whether this Node is enabled for processing or not.
@@ -154,6 +168,13 @@ class Node : public std::enable_shared_from_this<Node>, public boost::noncopyabl
 	//! Returns whether this Node will process audio with an in-place Buffer.
 	bool getProcessInPlace() const				{ return mProcessInPlace; }
 
+	//! \brief Returns the number of seconds that this Node continues to produce output after its input becomes silent.
+	//!
+	//! Once a Node's input has been silent for longer than this, its output is known to be silent and process() is skipped until the input
+	//! is no longer silent. The default returns infinity, which means the Node is always processed. Override for Node's whose output
+	//! is silent given silent input, ex. 0 for a Gain or the delay length for a Delay.
+	virtual double getTailSeconds() const		{ return std::numeric_limits<double>::infinity(); }
+
 	//! Returns a string representing the name of this Node type. TODO: use typeid + abi de-mangling to ease the burden on sub-classes
 	virtual std::string getName();
 
@@ -190,6 +211,9 @@ class Node : public std::enable_shared_from_this<Node>, public boost::noncopyabl
 	virtual bool supportsInputNumChannels( size_t numChannels ) const	{ return mNumChannels == numChannels; }
 	//! Default implementation returns false, return true if it makes sense for the Node to be processed in a cycle (eg. Delay).
 	virtual bool supportsCycles() const									{ return false; }
+	//! Called by Context::prepare() to allocate anything process() may need for blocks of up to \a maxFramesPerBlock frames and \a maxNumChannels channels.
+	//! The default reserves this Node's own Buffer's and prepares its Param's. Override to also reserve other storage (ex. a delay line), calling the base.
+	virtual void prepare( size_t maxFramesPerBlock, size_t maxNumChannels );
 
 	//! Stores \a input at bus \a inputBus, replacing any Node currently existing there. Stores this Node at input's output bus \a outputBus. Returns whether a new connection was made or not.
 	//! \note Must be called on a non-audio thread and synchronized with the Context's mutex.
@@ -200,7 +224,15 @@ class Node : public std::enable_shared_from_this<Node>, public boost::noncopyabl
 	virtual void configureConnections();
 	void pullInputs( Buffer *inPlaceBuffer );
 	const Buffer* getInternalBuffer() const		{ return &mInternalBuffer; }
+	//! Configures this Node to sum its inputs. Its Buffer's are then assigned by the RenderGraph, unless it is pulled by a Param.
 	void setupProcessWithSumming();
+	//! Allocates mInternalBuffer, for Node's whose results must be available outside of the RenderGraph (ex. a NodeOutput).
+	void setupInternalBuffer();
+	//! Marks this Node and all of its inputs as being pulled by a Param with pullInputs(), so they must allocate their own summing Buffer's.
+	void setPulledByParam();
+	//! Grows \a buffer's storage to hold \a numFrames frames of \a numChannels channels without changing its size, so later resizes up to that don't allocate.
+	//! \note Suspends the RenderGraph if the storage must be reallocated.
+	void reserveBuffer( BufferDynamic *buffer, size_t numFrames, size_t numChannels );
 	void notifyConnectionsDidChange();
 
 	//! Only Node subclasses can specify num channels directly - users specify via Format at construction time
@@ -222,19 +254,34 @@ class Node : public std::enable_shared_from_this<Node>, public boost::noncopyabl
 	bool					mInitialized;
 	bool					mAutoEnabled;
 	bool					mProcessInPlace;
+	bool					mIsPulledByParam;
 	size_t					mNumChannels;
 	ChannelMode				mChannelMode;
 	uint64_t				mLastProcessedFrame;
+	uint64_t				mSilentSinceFrame;	// first frame of the block at which the input became silent, or max if it isn't
 
+	// only allocated when this Node is processed outside of a RenderGraph, otherwise the RenderGraph assigns pooled Buffer's.
 	BufferDynamic			mInternalBuffer, mSummingBuffer;
 
   private:
 
 	void setContext( const ContextRef &context )	{ mContext = context; }
+	void setupBuffer( BufferDynamic *buffer );
+	bool scheduleFrame( double when, std::atomic<uint64_t> *scheduledFrame );
+	uint64_t getNextScheduledFrame() const		{ return std::min( mScheduledStartFrame.load(), mScheduledStopFrame.load() ); }
+	bool applyScheduledEvent( uint64_t endFrame );
+
+	std::atomic<uint64_t>	mScheduledStartFrame, mScheduledStopFrame;
+	BufferDynamic			mPartialBuffer;		// used to process the part of a block that follows a scheduled start or stop, only allocated once scheduled
+
+	std::vector<Param *>	mParams;			// each Param whose parent is this Node, registered at construction so that prepare() can reach it
+	std::unique_ptr<NodeProfiler>	mProfiler;	// allocated by the RenderGraph once profiling is enabled, then kept for the Node's lifetime
 
 	std::weak_ptr<Context>	mContext;
 	friend class Context;
+	friend class ModulationMatrix;
 	friend class Param;
+	friend class RenderGraph;
 };
 
 //! Enable connection syntax: \code input >> output; \endcode. Connects on the first available input and output bus.  \return the connected \a output
@@ -50,23 +50,43 @@ NodeEffect::NodeEffect( const Format &format )
 Gain::Gain( const Format &format )
 : NodeEffect( format ), mParam( this, 1 ), mMin( 0 ), mMax( 1 )
 {
+	mParam.setCheapestEvalOnly();
 }
 
 Gain::Gain( float initialValue, const Format &format )
 : NodeEffect( format ), mParam( this, initialValue ), mMin( 0 ), mMax( 1 )
 {
+	mParam.setCheapestEvalOnly();
 }
 
 void Gain::process( Buffer *buffer )
 {
-	if( mParam.eval() ) {
-		for( size_t ch = 0; ch < mNumChannels; ch++ ) {
-			float *channel = buffer->getChannel( ch );
-			dsp::mul( channel, mParam.getValueArray(), channel, buffer->getNumFrames() );
+	const size_t numFrames = buffer->getNumFrames();
+
+	switch( mParam.evalCheapest() ) {
+		case Param::AUDIO_VALUES:
+			for( size_t ch = 0; ch < mNumChannels; ch++ ) {
+				float *channel = buffer->getChannel( ch );
+				dsp::mul( channel, mParam.getValueArray(), channel, numFrames );
+			}
+			break;
+		case Param::CONTROL_VALUES: {
+			const float *controlValues = mParam.getControlValues();
+			const size_t controlFrames = mParam.getControlFrames();
+			for( size_t ch = 0; ch < mNumChannels; ch++ ) {
+				float *channel = buffer->getChannel( ch );
+				for( size_t i = 0, frame = 0; frame < numFrames; i++, frame += controlFrames ) {
+					size_t count = min( controlFrames, numFrames - frame );
+					dsp::mulRamp( channel + frame, controlValues[i], ( controlValues[i + 1] - controlValues[i] ) / float( count ), channel + frame, count );
+				}
+			}
+			break;
 		}
+		case Param::CONSTANT:
+		default:
+			dsp::mul( buffer->getData(), mParam.getValue(), buffer->getData(), buffer->getSize() );
+			break;
 	}
-	else
-		dsp::mul( buffer->getData(), mParam.getValue(), buffer->getData(), buffer->getSize() );
 }
 
 // ----------------------------------------------------------------------------------------------------
@@ -76,6 +96,8 @@ void Gain::process( Buffer *buffer )
 Add::Add( const Format &format )
 	: Node( format ), mParam( this, 0 )
 {
+	mParam.setCheapestEvalOnly();
+
 	if( boost::indeterminate( format.getAutoEnable() ) )
 		setAutoEnabled();
 }
@@ -83,20 +105,40 @@ Add::Add( const Format &format )
 Add::Add( float initialValue, const Format &format )
 	: Node( format ), mParam( this, initialValue )
 {
+	mParam.setCheapestEvalOnly();
+
 	if( boost::indeterminate( format.getAutoEnable() ) )
 		setAutoEnabled();
 }
 
 void Add::process( Buffer *buffer )
 {
-	if( mParam.eval() ) {
-		for( size_t ch = 0; ch < mNumChannels; ch++ ) {
-			float *channel = buffer->getChannel( ch );
-			dsp::add( channel, mParam.getValueArray(), channel, buffer->getNumFrames() );
+	const size_t numFrames = buffer->getNumFrames();
+
+	switch( mParam.evalCheapest() ) {
+		case Param::AUDIO_VALUES:
+			for( size_t ch = 0; ch < mNumChannels; ch++ ) {
+				float *channel = buffer->getChannel( ch );
+				dsp::add( channel, mParam.getValueArray(), channel, numFrames );
+			}
+			break;
+		case Param::CONTROL_VALUES: {
+			const float *controlValues = mParam.getControlValues();
+			const size_t controlFrames = mParam.getControlFrames();
+			for( size_t ch = 0; ch < mNumChannels; ch++ ) {
+				float *channel = buffer->getChannel( ch );
+				for( size_t i = 0, frame = 0; frame < numFrames; i++, frame += controlFrames ) {
+					size_t count = min( controlFrames, numFrames - frame );
+					dsp::addRamp( channel + frame, controlValues[i], ( controlValues[i + 1] - controlValues[i] ) / float( count ), channel + frame, count );
+				}
+			}
+			break;
 		}
+		case Param::CONSTANT:
+		default:
+			dsp::add( buffer->getData(), mParam.getValue(), buffer->getData(), buffer->getSize() );
+			break;
 	}
-	else
-		dsp::add( buffer->getData(), mParam.getValue(), buffer->getData(), buffer->getSize() );
 }
 
 // ----------------------------------------------------------------------------------------------------
@@ -218,20 +260,33 @@ void Pan2d::setPos( float pos )
 // ----------------------------------------------------------------------------------------------------
 
 Delay::Delay( const Format &format )
-	: NodeEffect( format ), mDelaySeconds( 0 ), mReadIndex( 0 ), mDelayFrames( 0 )
+	: NodeEffect( format ), mReadIndex( 0 ), mDelayFrames( 0 ), mPendingDelayFrames( NO_PENDING_DELAY ), mDelaySeconds( 0 ), mMaxDelaySeconds( 0 )
 {
 }
 
 void Delay::setDelaySeconds( float seconds )
 {
-	mDelayFrames = lroundf( seconds * getSampleRate() );
+	size_t delayFrames = lroundf( seconds * getSampleRate() );
 	mDelaySeconds = seconds;
 
-	size_t delayBufferFrames = 1 + max( mDelayFrames, getFramesPerBlock() );
-	mDelayBuffer.setSize( delayBufferFrames, getNumChannels() );
-	mReadIndex = 0;
+	size_t delayBufferFrames = 1 + max( delayFrames, getFramesPerBlock() );
+
+	if( mDelayBuffer.getAllocatedSize() < delayBufferFrames * getNumChannels() ) {
+		// the delay line has to grow, so it is reallocated while the audio thread isn't processing this Node.
+		auto ctx = getContext();
+		ctx->suspendRenderGraph( this );
 
-	CI_LOG_V( "seconds: " << seconds << ", frames: " << mDelayFrames << ", delay buffer frames: " << delayBufferFrames );
+		mPendingDelayFrames = NO_PENDING_DELAY;
+		mDelayFrames = delayFrames;
+		mDelayBuffer.setSize( delayBufferFrames, getNumChannels() );
+		mReadIndex = 0;
+
+		ctx->updateRenderGraph();
+	}
+	else
+		mPendingDelayFrames = delayFrames;
+
+	CI_LOG_V( "seconds: " << seconds << ", frames: " << delayFrames << ", delay buffer frames: " << delayBufferFrames );
 }
 
 void Delay::initialize()
@@ -240,8 +295,25 @@ void Delay::initialize()
 		mDelayBuffer.setNumChannels( getNumChannels() );
 }
 
+void Delay::prepare( size_t maxFramesPerBlock, size_t maxNumChannels )
+{
+	NodeEffect::prepare( maxFramesPerBlock, maxNumChannels );
+
+	size_t maxDelayFrames = lroundf( max( mMaxDelaySeconds, mDelaySeconds.load() ) * getSampleRate() );
+	size_t numFrames = 1 + max( maxDelayFrames, max( maxFramesPerBlock, getFramesPerBlock() ) );
+	reserveBuffer( &mDelayBuffer, numFrames, max( maxNumChannels, getNumChannels() ) );
+}
+
 void Delay::process( Buffer *buffer )
 {
+	// the delay line already holds the new length, so resizing it here doesn't allocate.
+	size_t pendingDelayFrames = mPendingDelayFrames.exchange( NO_PENDING_DELAY );
+	if( pendingDelayFrames != NO_PENDING_DELAY ) {
+		mDelayFrames = pendingDelayFrames;
+		mDelayBuffer.setNumFrames( 1 + max( pendingDelayFrames, getFramesPerBlock() ) );
+		mReadIndex = 0;
+	}
+
 	size_t numFrames = buffer->getNumFrames();
 	size_t maxDelayFrames = mDelayBuffer.getNumFrames();
 	size_t readIndex = mReadIndex;
@@ -59,6 +59,8 @@ class Gain : public NodeEffect {
 	void setMax( float max )		{ mMax = max; }
 	float getMax() const			{ return mMax; }
 
+	double getTailSeconds() const override	{ return 0; }
+
   protected:
 	void process( Buffer *buffer ) override;
 
@@ -98,6 +100,8 @@ class Pan2d : public NodeEffect {
 	void enableMonoInputMode( bool enable = true )	{ mMonoInputMode = enable; }
 	bool isMonoInputModeEnabled() const				{ return mMonoInputMode; }
 
+	double getTailSeconds() const override			{ return 0; }
+
 protected:
 	void process( Buffer *buffer ) override;
 
@@ -115,17 +119,30 @@ class Delay : public NodeEffect {
   public:
 	Delay( const Format &format = Format() );
 
+	//! Sets the delay length. Allocates only if the delay line can't hold \a seconds, which Context::prepare() avoids when \a seconds is within getMaxDelaySeconds().
+	//! Otherwise the new length is passed to the audio thread, which applies it at the start of its next block.
 	void	setDelaySeconds( float seconds );
 	float	getDelaySeconds() const				{ return mDelaySeconds; }
+	//! Sets the longest delay that the delay line is allocated for by Context::prepare(). Default is 0, in which case only the current delay length is allocated.
+	void	setMaxDelaySeconds( float seconds )	{ mMaxDelaySeconds = seconds; }
+	float	getMaxDelaySeconds() const			{ return mMaxDelaySeconds; }
+
+	//! Returns the delay length, after which silent input has replaced any previous input in the delay line.
+	double	getTailSeconds() const override		{ return mDelaySeconds; }
 
   protected:
 	void initialize()				override;
 	void process( Buffer *buffer )	override;
 	bool supportsCycles() const		override	{ return true; }
+	void prepare( size_t maxFramesPerBlock, size_t maxNumChannels )	override;
+
+	static const size_t NO_PENDING_DELAY = size_t( -1 );
 
-	size_t			mReadIndex, mDelayFrames;
-	float			mDelaySeconds;
-	BufferDynamic	mDelayBuffer;
+	size_t				mReadIndex, mDelayFrames;
+	std::atomic<size_t>	mPendingDelayFrames;	// set by setDelaySeconds() when the delay line can hold it, NO_PENDING_DELAY once applied by process()
+	std::atomic<float>	mDelaySeconds;
+	float				mMaxDelaySeconds;
+	BufferDynamic		mDelayBuffer;
 };
 
 } } // namespace cinder::audio2
\ No newline at end of file
@@ -45,9 +45,14 @@ void NodeOutput::connect( const NodeRef &output, size_t outputBus, size_t inputB
 	CI_ASSERT_MSG( 0, "NodeOutput does not support outputs" );
 }
 
+void NodeOutput::processGraph()
+{
+	mInternalBuffer.zero();
+	getContext()->processRenderGraph();
+}
+
 void NodeOutput::postProcess()
 {
-	getContext()->processAutoPulledNodes();
 	incrementFrameCount();
 }
 
@@ -60,8 +65,6 @@ uint64_t NodeOutput::getLastClip()
 
 void NodeOutput::enableClipDetection( bool enable, float threshold )
 {
-	lock_guard<mutex> lock( getContext()->getMutex() );
-
 	mClipDetectionEnabled = enable;
 	mClipThreshold = threshold;
 }
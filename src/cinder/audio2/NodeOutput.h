@@ -52,14 +52,16 @@ class NodeOutput : public Node {
   protected:
 	NodeOutput( const Format &format = Format() );
 
+	//! Implementations should call this once per rendering block to process the Context's Node graph, the results of which are left in the internal buffer.
+	void processGraph();
 	//! Implementations should call this to detect if the internal audio buffer is clipping. Always returns false if clip detection is disabled.
 	bool checkNotClipping();
 	//! Implementations should call this at the end of each rendering block.
 	void postProcess();
 
 	std::atomic<uint64_t>		mNumProcessedFrames, mLastClip;
-	bool						mClipDetectionEnabled;
-	float						mClipThreshold;
+	std::atomic<bool>			mClipDetectionEnabled;
+	std::atomic<float>			mClipThreshold;
 
   private:
 	// NodeOutput does not have outputs, overridden to assert this method isn't called
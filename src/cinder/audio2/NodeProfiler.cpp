@@ -0,0 +1,115 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/audio2/NodeProfiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace std;
+
+namespace cinder { namespace audio2 {
+
+NodeProfiler::NodeProfiler()
+	: mResetPending( false )
+{
+	clear();
+}
+
+void NodeProfiler::record( uint64_t nanoseconds )
+{
+	if( mResetPending.load( memory_order_relaxed ) ) {
+		clear();
+		mResetPending = false;
+	}
+
+	mNumCalls.store( mNumCalls.load( memory_order_relaxed ) + 1, memory_order_relaxed );
+	mTotal.store( mTotal.load( memory_order_relaxed ) + nanoseconds, memory_order_relaxed );
+
+	if( nanoseconds < mMin.load( memory_order_relaxed ) )
+		mMin.store( nanoseconds, memory_order_relaxed );
+	if( nanoseconds > mMax.load( memory_order_relaxed ) )
+		mMax.store( nanoseconds, memory_order_relaxed );
+
+	atomic<uint64_t> &bucket = mHistogram[getBucket( nanoseconds )];
+	bucket.store( bucket.load( memory_order_relaxed ) + 1, memory_order_relaxed );
+}
+
+NodeProfile NodeProfiler::getProfile( const NodeRef &node ) const
+{
+	NodeProfile result;
+	result.mNode = node;
+
+	if( mResetPending )
+		return result;
+
+	result.mNumCalls = mNumCalls;
+	if( ! result.mNumCalls )
+		return result;
+
+	result.mTotal = mTotal;
+	result.mMin = mMin;
+	result.mMax = mMax;
+
+	// find the bucket where the cumulative count reaches 99% of calls, the upper limit of that bucket is the estimate.
+	uint64_t numCalls = 0;
+	for( size_t i = 0; i < NUM_BUCKETS; i++ )
+		numCalls += mHistogram[i];
+
+	uint64_t targetCount = (uint64_t)ceil( numCalls * 0.99 );
+	uint64_t count = 0;
+	for( size_t i = 0; i < NUM_BUCKETS; i++ ) {
+		count += mHistogram[i];
+		if( count >= targetCount ) {
+			result.mP99 = min( getBucketLimit( i ), result.mMax );
+			break;
+		}
+	}
+
+	return result;
+}
+
+size_t NodeProfiler::getBucket( uint64_t nanoseconds )
+{
+	return min( NUM_BUCKETS - 1, size_t( log2( double( nanoseconds + 1 ) ) * 4 ) );
+}
+
+uint64_t NodeProfiler::getBucketLimit( size_t bucket )
+{
+	return (uint64_t)ceil( pow( 2.0, ( bucket + 1 ) / 4.0 ) );
+}
+
+void NodeProfiler::clear()
+{
+	mNumCalls = 0;
+	mTotal = 0;
+	mMin = numeric_limits<uint64_t>::max();
+	mMax = 0;
+
+	for( size_t i = 0; i < NUM_BUCKETS; i++ )
+		mHistogram[i] = 0;
+}
+
+} } // namespace cinder::audio2
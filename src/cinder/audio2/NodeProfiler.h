@@ -0,0 +1,92 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include <boost/noncopyable.hpp>
+
+#include <atomic>
+#include <memory>
+
+namespace cinder { namespace audio2 {
+
+typedef std::shared_ptr<class Node>				NodeRef;
+
+//! A snapshot of the time spent in one Node's process() calls, returned by Context::getProfile(). Times are in nanoseconds.
+class NodeProfile {
+  public:
+	NodeProfile() : mNumCalls( 0 ), mTotal( 0 ), mMin( 0 ), mMax( 0 ), mP99( 0 )	{}
+
+	//! Returns the Node that was profiled.
+	const NodeRef&	getNode() const					{ return mNode; }
+	//! Returns the number of times the Node was processed.
+	uint64_t		getNumCalls() const				{ return mNumCalls; }
+	//! Returns the total time spent processing the Node.
+	double			getTotalNanoseconds() const		{ return double( mTotal ); }
+	//! Returns the shortest time taken by one call.
+	double			getMinNanoseconds() const		{ return double( mMin ); }
+	//! Returns the average time taken by one call.
+	double			getMeanNanoseconds() const		{ return mNumCalls ? double( mTotal ) / double( mNumCalls ) : 0; }
+	//! Returns the longest time taken by one call.
+	double			getMaxNanoseconds() const		{ return double( mMax ); }
+	//! Returns the time that 99% of calls took less than, estimated to within a quarter octave (about 19%).
+	double			getP99Nanoseconds() const		{ return double( mP99 ); }
+
+  private:
+	NodeRef		mNode;
+	uint64_t	mNumCalls, mTotal, mMin, mMax, mP99;
+
+	friend class NodeProfiler;
+};
+
+//! \brief Lock-free statistics for the process() calls of one Node, used while profiling is enabled on its Context.
+//!
+//! Only one thread processes a Node at a time, so the counters are updated with plain atomic loads and stores rather than read-modify-write
+//! operations. They can be read at any time from any other thread, a snapshot taken while a call is being recorded may not include it.
+class NodeProfiler : public boost::noncopyable {
+  public:
+	NodeProfiler();
+
+	//! Records a process() call that took \a nanoseconds. \note Must only be called by the thread that is currently processing the Node.
+	void		record( uint64_t nanoseconds );
+	//! Requests that all statistics be cleared, which happens when the next call is recorded.
+	void		reset()		{ mResetPending = true; }
+	//! Returns a snapshot of the current statistics for \a node.
+	NodeProfile	getProfile( const NodeRef &node ) const;
+
+  private:
+	// buckets are spaced a quarter octave apart, the last one covers calls longer than about four seconds.
+	static const size_t NUM_BUCKETS = 128;
+
+	static size_t	getBucket( uint64_t nanoseconds );
+	static uint64_t	getBucketLimit( size_t bucket );
+
+	void clear();
+
+	std::atomic<uint64_t>	mNumCalls, mTotal, mMin, mMax;
+	std::atomic<uint64_t>	mHistogram[NUM_BUCKETS];
+	std::atomic<bool>		mResetPending;
+};
+
+} } // namespace cinder::audio2
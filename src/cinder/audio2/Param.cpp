@@ -34,88 +34,130 @@ namespace cinder { namespace audio2 {
 
 void rampLinear( float *array, size_t count, float t, float tIncr, const std::pair<float, float> &valueRange )
 {
-	for( size_t i = 0; i < count; i++ ) {
-		float factor = t;
-		array[i] = lerp( valueRange.first, valueRange.second, factor );
-		t += tIncr;
-	}
+	const float valueDelta = valueRange.second - valueRange.first;
+	dsp::fillRamp( valueRange.first + valueDelta * t, valueDelta * tIncr, array, count );
 }
 
 void rampInQuad( float *array, size_t count, float t, float tIncr, const std::pair<float, float> &valueRange )
 {
+	const float valueDelta = valueRange.second - valueRange.first;
 	for( size_t i = 0; i < count; i++ ) {
-		float factor = t * t;
-		array[i] = lerp( valueRange.first, valueRange.second, factor );
-		t += tIncr;
+		float ti = t + tIncr * float( i );
+		array[i] = valueRange.first + valueDelta * ti * ti;
 	}
 }
 
 void rampOutQuad( float *array, size_t count, float t, float tIncr, const std::pair<float, float> &valueRange )
 {
+	const float valueDelta = valueRange.second - valueRange.first;
 	for( size_t i = 0; i < count; i++ ) {
-		float factor = -t * ( t - 2 );
-		array[i] = lerp( valueRange.first, valueRange.second, factor );
-		t += tIncr;
+		float ti = t + tIncr * float( i );
+		array[i] = valueRange.first + valueDelta * ti * ( 2 - ti );
 	}
 }
 
-Ramp::Ramp( float timeBegin, float timeEnd, float valueBegin, float valueEnd, const RampFn &rampFn )
-	: mTimeBegin( timeBegin ), mTimeEnd( timeEnd ), mDuration( timeEnd - timeBegin ),
-	mValueBegin( valueBegin ), mValueEnd( valueEnd ), mRampFn( rampFn ), mIsComplete( false ), mIsCanceled( false )
+void Ramp::cancel() const
+{
+	if( mParam )
+		mParam->cancelRamp( mId );
+}
+
+bool Ramp::isComplete() const
+{
+	return ! mParam || ! mParam->isScheduled( mId );
+}
+
+void Param::Timeline::removeRamp( size_t index )
+{
+	// swapping keeps the removed RampFn in this Timeline, rather than destroying it.
+	for( size_t i = index + 1; i < mNumRamps; i++ )
+		swap( mRamps[i - 1], mRamps[i] );
+
+	mNumRamps--;
+}
+
+Param::Options& Param::Options::rampFn( const RampFn &rampFn )
 {
+	typedef void (*RampFnPtr)( float *, size_t, float, float, const std::pair<float, float>& );
+
+	// the built-in functions are evaluated with their curve's kernel, rather than through the std::function.
+	const RampFnPtr *fnPtr = rampFn.target<RampFnPtr>();
+	if( fnPtr && *fnPtr == rampLinear )
+		mCurve = Ramp::LINEAR;
+	else if( fnPtr && *fnPtr == rampInQuad )
+		mCurve = Ramp::IN_QUAD;
+	else if( fnPtr && *fnPtr == rampOutQuad )
+		mCurve = Ramp::OUT_QUAD;
+	else
+		mCurve = Ramp::CUSTOM;
+
+	mRampFn = rampFn;
+	return *this;
 }
 
 Param::Param( Node *parentNode, float initialValue )
-	: mParentNode( parentNode ), mValue( initialValue )
+	: mAutomationPtr( nullptr ), mValue( initialValue ), mLastRampId( 0 ), mParentNode( parentNode ), mProcessorPtr( nullptr ), mNumControlValues( 0 ), mControlFrames( 0 ),
+	mRate( AUDIO_RATE ), mControlPeriod( 0 ), mAutoRateThreshold( 1 ), mCheapestEvalOnly( false ),
+	mModulation( nullptr ), mModulationArray( nullptr )
 {
+	if( mParentNode )
+		mParentNode->mParams.push_back( this );
 }
 
 void Param::setValue( float value )
 {
-	lock_guard<mutex> lock( getContext()->getMutex() );
+	lock_guard<mutex> lock( mMutex );
 
 	resetImpl();
 	mValue = value;
+
+	// the audio thread may be part way through a Ramp, so it also applies the value once it picks up the Timeline.
+	if( mAutomation ) {
+		Timeline &timeline = mAutomation->mTimelines[mAutomation->mControl];
+		timeline.mValue = value;
+		timeline.mValueEpoch++;
+		publishTimeline();
+	}
 }
 
-RampRef Param::applyRamp( float valueEnd, float rampSeconds, const Options &options )
+Ramp Param::applyRamp( float valueEnd, float rampSeconds, const Options &options )
 {
 	return applyRamp( mValue, valueEnd, rampSeconds, options );
 }
 
-RampRef Param::applyRamp( float valueBegin, float valueEnd, float rampSeconds, const Options &options )
+Ramp Param::applyRamp( float valueBegin, float valueEnd, float rampSeconds, const Options &options )
 {
-	initInternalBuffer();
-
-	auto ctx = getContext();
-	float timeBegin = (float)ctx->getNumProcessedSeconds() + options.getDelay();
-	float timeEnd = timeBegin + rampSeconds;
-
-	RampRef ramp( new Ramp( timeBegin, timeEnd, valueBegin, valueEnd, options.getRampFn() ) );
+	return applyRampFrames( valueBegin, valueEnd, secondsToFrames( rampSeconds ), options );
+}
 
-	lock_guard<mutex> lock( ctx->getMutex() );
-	resetImpl();
-	mRamps.push_back( ramp );
+Ramp Param::appendRamp( float valueEnd, float rampSeconds, const Options &options )
+{
+	return appendRampFrames( valueEnd, secondsToFrames( rampSeconds ), options );
+}
 
-	return ramp;
+Ramp Param::applyRampFrames( float valueEnd, uint64_t rampFrames, const Options &options )
+{
+	return applyRampFrames( mValue, valueEnd, rampFrames, options );
 }
 
-RampRef Param::appendRamp( float valueEnd, float rampSeconds, const Options &options )
+Ramp Param::applyRampFrames( float valueBegin, float valueEnd, uint64_t rampFrames, const Options &options )
 {
-	initInternalBuffer();
+	uint64_t frameBegin = getContext()->getNumProcessedFrames() + getDelayFrames( options );
 
-	auto ctx = getContext();
-	auto endTimeAndValue = findEndTimeAndValue();
+	lock_guard<mutex> lock( mMutex );
+	resetImpl();
 
-	float timeBegin = endTimeAndValue.first + options.getDelay();
-	float timeEnd = timeBegin + rampSeconds;
+	return scheduleRampImpl( frameBegin, frameBegin + rampFrames, valueBegin, valueEnd, options );
+}
 
-	RampRef ramp( new Ramp( timeBegin, timeEnd, endTimeAndValue.second, valueEnd, options.getRampFn() ) );
+Ramp Param::appendRampFrames( float valueEnd, uint64_t rampFrames, const Options &options )
+{
+	lock_guard<mutex> lock( mMutex );
 
-	lock_guard<mutex> lock( ctx->getMutex() );
-	mRamps.push_back( ramp );
+	auto endFrameAndValue = findEndFrameAndValueImpl();
+	uint64_t frameBegin = endFrameAndValue.first + getDelayFrames( options );
 
-	return ramp;
+	return scheduleRampImpl( frameBegin, frameBegin + rampFrames, endFrameAndValue.second, valueEnd, options );
 }
 
 void Param::setProcessor( const NodeRef &node )
@@ -123,62 +165,105 @@ void Param::setProcessor( const NodeRef &node )
 	if( ! node )
 		return;
 
-	initInternalBuffer();
+	auto ctx = getContext();
+	{
+		lock_guard<mutex> lock( ctx->getMutex() );
 
-	lock_guard<mutex> lock( getContext()->getMutex() );
+		// force node to be mono and initialize it. It is pulled from eval(), outside of the RenderGraph.
+		node->setNumChannels( 1 );
+		node->setPulledByParam();
+		node->initializeImpl();
+	}
 
-	resetImpl();
+	// setting the channels may have suspended the RenderGraph if node was already part of it
+	ctx->updateRenderGraph();
+
+	{
+		lock_guard<mutex> lock( mMutex );
+
+		// a processing Node is pulled into the per-frame buffer, whatever the rate.
+		resetImpl();
+		initAutomation();
+		reserveBuffers( AUDIO_RATE, 0, 0 );
+		mProcessor = node;
+		mProcessorPtr = node.get();
+	}
+
+	ctx->updateRenderGraph();
+
+	CI_LOG_V( "set processing Node to: " << node->getName() );
+}
+
+void Param::setRate( Rate rate, size_t controlPeriod )
+{
+	{
+		lock_guard<mutex> lock( mMutex );
 
-	// force node to be mono and initialize it
-	node->setNumChannels( 1 );
-	node->initializeImpl();
+		// the buffers for the new rate are in place before the audio thread can see it.
+		if( mAutomation )
+			reserveBuffers( rate, controlPeriod, getContext()->getFramesPerBlock() );
 
-	mProcessor = node;
+		mControlPeriod = controlPeriod;
+		mRate = rate;
+	}
 
-	CI_LOG_V( "set processing Node to: " << mProcessor->getName() );
+	// reserving may have suspended the RenderGraph
+	getContext()->updateRenderGraph();
 }
 
 void Param::reset()
 {
-	lock_guard<mutex> lock( getContext()->getMutex() );
+	lock_guard<mutex> lock( mMutex );
+
 	resetImpl();
 }
 
-
 size_t Param::getNumRamps() const
 {
-	lock_guard<mutex> lock( getContext()->getMutex() );
-	return mRamps.size();
+	lock_guard<mutex> lock( mMutex );
+
+	if( ! mAutomation )
+		return 0;
+
+	const Timeline &timeline = mAutomation->mTimelines[mAutomation->mControl];
+	uint64_t frame = getContext()->getNumProcessedFrames();
+
+	size_t result = 0;
+	for( size_t i = 0; i < timeline.mNumRamps; i++ ) {
+		if( timeline.mRamps[i].mFrameEnd > frame )
+			result++;
+	}
+
+	return result;
 }
 
 float Param::findDuration() const
 {
 	auto ctx = getContext();
-	lock_guard<mutex> lock( ctx->getMutex() );
+	lock_guard<mutex> lock( mMutex );
 
-	if( mRamps.empty() )
-		return 0;
-	else {
-		const RampRef &ramp = mRamps.back();
-		return ramp->mTimeEnd - (float)ctx->getNumProcessedSeconds();
-	}
+	uint64_t endFrame = findEndFrameAndValueImpl().first;
+	return float( double( endFrame - ctx->getNumProcessedFrames() ) / (double)ctx->getSampleRate() );
 }
 
-pair<float, float> Param::findEndTimeAndValue() const
+pair<double, float> Param::findEndTimeAndValue() const
 {
-	auto ctx = getContext();
-	lock_guard<mutex> lock( ctx->getMutex() );
+	auto endFrameAndValue = findEndFrameAndValue();
+	return make_pair( (double)endFrameAndValue.first / (double)getContext()->getSampleRate(), endFrameAndValue.second );
+}
 
-	if( mRamps.empty() )
-		return make_pair( (float)ctx->getNumProcessedSeconds(), mValue.load() );
-	else {
-		const RampRef &ramp = mRamps.back();
-		return make_pair( ramp->mTimeEnd, ramp->mValueEnd );
-	}
+pair<uint64_t, float> Param::findEndFrameAndValue() const
+{
+	lock_guard<mutex> lock( mMutex );
+
+	return findEndFrameAndValueImpl();
 }
 
 const float* Param::getValueArray() const
 {
+	if( mModulationArray )
+		return mModulationArray;
+
 	CI_ASSERT( ! mInternalBuffer.isEmpty() );
 
 	return mInternalBuffer.getData();
@@ -186,94 +271,436 @@ const float* Param::getValueArray() const
 
 bool Param::eval()
 {
-	if( mProcessor ) {
-		mProcessor->pullInputs( &mInternalBuffer );
+	Evaluation evaluation = evalCheapest();
+	if( evaluation != CONTROL_VALUES )
+		return evaluation == AUDIO_VALUES;
+
+	// interpolate the control values for Node's that need one per frame.
+	float *valueArray = mInternalBuffer.getData();
+	const float *controlValues = mControlValues.getData();
+	const size_t numFrames = mInternalBuffer.getSize();
+	for( size_t i = 0, frame = 0; frame < numFrames; i++, frame += mControlFrames ) {
+		size_t count = min( mControlFrames, numFrames - frame );
+		dsp::fillRamp( controlValues[i], ( controlValues[i + 1] - controlValues[i] ) / float( count ), valueArray + frame, count );
+	}
+
+	return true;
+}
+
+Param::Evaluation Param::evalCheapest()
+{
+	// a ModulationMatrix has already written this block's values, and mValue.
+	mModulationArray = mModulation.load( memory_order_acquire );
+	if( mModulationArray )
+		return AUDIO_VALUES;
+
+	Node *processor = mProcessorPtr;
+	if( processor ) {
+		processor->pullInputs( &mInternalBuffer );
 		mValue = mInternalBuffer[mInternalBuffer.getNumFrames() - 1]; // TODO: why not add last() ?
-		return true;
+		return AUDIO_VALUES;
 	}
-	else {
-		auto ctx = getContext();
-		return eval( (float)ctx->getNumProcessedSeconds(), mInternalBuffer.getData(), mInternalBuffer.getSize(), ctx->getSampleRate() );
+
+	Timeline *timeline = acquireTimeline();
+	if( ! timeline || ! timeline->mNumRamps )
+		return CONSTANT;
+
+	auto ctx = getContext();
+	const uint64_t frameBegin = ctx->getNumProcessedFrames();
+	const size_t numFrames = ctx->getFramesPerBlock();
+	const Rate rate = mRate;
+	float value = mValue;
+
+	if( rate == AUDIO_RATE || ( rate == AUTO_RATE && exceedsAutoRateThreshold( *timeline, frameBegin, numFrames, ctx->getSampleRate() ) ) ) {
+		bool varying = evalImpl( timeline, frameBegin, mInternalBuffer.getData(), mInternalBuffer.getSize(), &value );
+		mValue = value;
+		return varying ? AUDIO_VALUES : CONSTANT;
+	}
+
+	// evaluates one frame at each control point, the last being the first frame of the next block.
+	const size_t controlPeriod = mControlPeriod;
+	const size_t controlFrames = controlPeriod ? min( controlPeriod, numFrames ) : numFrames;
+	const size_t numControlValues = calcNumControlValues( numFrames, controlPeriod );
+	CI_ASSERT( mControlValues.getAllocatedSize() >= numControlValues );
+
+	float *controlValues = mControlValues.getData();
+	bool varying = false;
+	for( size_t i = 0; i < numControlValues; i++ ) {
+		evalImpl( timeline, frameBegin + min( i * controlFrames, numFrames ), &controlValues[i], 1, &value );
+		varying |= controlValues[i] != controlValues[0];
+	}
+
+	mValue = value;
+	mNumControlValues = numControlValues;
+	mControlFrames = controlFrames;
+	return varying ? CONTROL_VALUES : CONSTANT;
+}
+
+bool Param::eval( uint64_t frameBegin, float *array, size_t arrayLength )
+{
+	lock_guard<mutex> lock( mMutex );
+
+	float value = mValue;
+	if( ! mAutomation ) {
+		dsp::fill( value, array, arrayLength );
+		return false;
 	}
+
+	// evaluates a copy, as evalImpl() removes the Ramp's that it completes.
+	Timeline timeline = mAutomation->mTimelines[mAutomation->mControl];
+	return evalImpl( &timeline, frameBegin, array, arrayLength, &value );
+}
+
+void Param::prepare( size_t maxFramesPerBlock )
+{
+	lock_guard<mutex> lock( mMutex );
+
+	initAutomation();
+
+	reserveBuffers( mRate, mControlPeriod, maxFramesPerBlock );
 }
 
-bool Param::eval( float timeBegin, float *array, size_t arrayLength, size_t sampleRate )
+// ----------------------------------------------------------------------------------------------------
+// MARK: - Protected
+// ----------------------------------------------------------------------------------------------------
+
+// Ramp's cover frames [mFrameBegin, mFrameEnd) and are in the order they were scheduled, which is also the order in which they begin.
+bool Param::evalImpl( Timeline *timeline, uint64_t frameBegin, float *array, size_t arrayLength, float *value )
 {
-	size_t samplesWritten = 0;
-	const float samplePeriod = 1.0f / (float)sampleRate;
+	const uint64_t frameEnd = frameBegin + arrayLength;
+	size_t framesWritten = 0;
+	bool varying = false;
 
-	for( auto rampIt = mRamps.begin(); rampIt != mRamps.end(); /* */ ) {
-		RampRef &ramp = *rampIt;
+	for( size_t rampIndex = 0; rampIndex < timeline->mNumRamps; /* */ ) {
+		RampEvent &ramp = timeline->mRamps[rampIndex];
 
-		// first remove dead ramps
-		if( ramp->mTimeEnd < timeBegin || ramp->mIsCanceled ) {
-			rampIt = mRamps.erase( rampIt );
+		// first remove dead ramps. A ramp may have ended without being evaluated (ex. its Node was asleep), in which case its end value still applies.
+		if( ramp.mFrameEnd <= frameBegin ) {
+			*value = ramp.mValueEnd;
+			timeline->removeRamp( rampIndex );
 			continue;
 		}
 
-		const float timeEnd = timeBegin + arrayLength * samplePeriod;
+		if( ramp.mFrameBegin >= frameEnd ) {
+			++rampIndex;
+			continue;
+		}
 
-		if( ramp->mTimeBegin < timeEnd && ramp->mTimeEnd > timeBegin ) {
-			size_t startIndex = timeBegin >= ramp->mTimeBegin ? 0 : size_t( ( ramp->mTimeBegin - timeBegin ) * sampleRate );
-			size_t endIndex = timeEnd < ramp->mTimeEnd ? arrayLength : size_t( ( ramp->mTimeEnd - timeBegin ) * sampleRate );
+		size_t startIndex = ramp.mFrameBegin > frameBegin ? size_t( ramp.mFrameBegin - frameBegin ) : 0;
+		size_t endIndex = ramp.mFrameEnd < frameEnd ? size_t( ramp.mFrameEnd - frameBegin ) : arrayLength;
 
-			CI_ASSERT( startIndex <= arrayLength && endIndex <= arrayLength );
+		if( startIndex > framesWritten )
+			dsp::fill( *value, array + framesWritten, startIndex - framesWritten );
 
-			if( startIndex > 0 && samplesWritten == 0 )
-				dsp::fill( mValue, array, startIndex );
+		startIndex = max( startIndex, framesWritten );
+		if( startIndex < endIndex )
+			fillCurve( ramp, frameBegin + startIndex - ramp.mFrameBegin, array + startIndex, endIndex - startIndex );
 
-			size_t count = size_t( endIndex - startIndex );
-			float timeBeginNormalized = float( timeBegin - ramp->mTimeBegin + startIndex * samplePeriod ) / ramp->mDuration;
-			float timeEndNormalized = float( timeBegin - ramp->mTimeBegin + endIndex * samplePeriod ) / ramp->mDuration;
-			float timeIncr = ( timeEndNormalized - timeBeginNormalized ) / (float)count;
+		framesWritten = max( framesWritten, endIndex );
+		varying = true;
 
-			ramp->mRampFn( array + startIndex, count, timeBeginNormalized, timeIncr, make_pair( ramp->mValueBegin, ramp->mValueEnd ) );
-			samplesWritten += count;
+		// if this ramp ends within the current processing block, the following frames hold its end value.
+		if( ramp.mFrameEnd <= frameEnd ) {
+			*value = ramp.mValueEnd;
+			timeline->removeRamp( rampIndex );
+		}
+		else {
+			*value = array[arrayLength - 1];
+			break;
+		}
+	}
 
-			// if this ramp ended with the current processing block, update mValue then remove ramp
-			if( endIndex < arrayLength ) {
-				ramp->mIsComplete = true;
-				mValue = ramp->mValueEnd;
-				rampIt = mRamps.erase( rampIt );
+	if( framesWritten < arrayLength )
+		dsp::fill( *value, array + framesWritten, arrayLength - framesWritten );
+
+	return varying;
+}
+
+// Fills \a count frames of \a ramp's curve into \a array, starting \a rampFrame frames into the ramp. Each built-in curve has a closed form in the
+// frame index, so segments are computed directly from where they start and the loops have no dependencies between iterations.
+void Param::fillCurve( const RampEvent &ramp, uint64_t rampFrame, float *array, size_t count )
+{
+	const double numFrames = double( ramp.mFrameEnd - ramp.mFrameBegin );
+	const double frame = double( rampFrame );
+	const float valueBegin = ramp.mValueBegin;
+	const float valueEnd = ramp.mValueEnd;
+
+	switch( ramp.mCurve ) {
+		case Ramp::LINEAR: {
+			const double slope = ( valueEnd - valueBegin ) / numFrames;
+			dsp::fillRamp( float( valueBegin + slope * frame ), float( slope ), array, count );
+			break;
+		}
+		case Ramp::IN_QUAD:
+			rampInQuad( array, count, float( frame / numFrames ), float( 1 / numFrames ), make_pair( valueBegin, valueEnd ) );
+			break;
+		case Ramp::OUT_QUAD:
+			rampOutQuad( array, count, float( frame / numFrames ), float( 1 / numFrames ), make_pair( valueBegin, valueEnd ) );
+			break;
+		case Ramp::EXPONENTIAL: {
+			if( valueBegin * valueEnd <= 0 ) {
+				// no exponential curve passes through both values, so fall back to linear.
+				const double slope = ( valueEnd - valueBegin ) / numFrames;
+				dsp::fillRamp( float( valueBegin + slope * frame ), float( slope ), array, count );
+				break;
 			}
-			else if( samplesWritten == arrayLength ) {
-				mValue = array[arrayLength - 1];
+
+			const double ratio = pow( double( valueEnd ) / double( valueBegin ), 1 / numFrames );
+			dsp::fillGeometric( float( valueBegin * pow( ratio, frame ) ), float( ratio ), array, count );
+			break;
+		}
+		case Ramp::TARGET: {
+			// the distance to the end value decays by a constant ratio per frame.
+			const double timeConstantFrames = ramp.mTimeConstantFrames > 0 ? ramp.mTimeConstantFrames : numFrames / 5;
+			const double ratio = exp( -1 / timeConstantFrames );
+			dsp::fillGeometric( float( ( valueBegin - valueEnd ) * pow( ratio, frame ) ), float( ratio ), array, count );
+			dsp::add( array, valueEnd, array, count );
+			break;
+		}
+		case Ramp::VALUE_CURVE: {
+			const Buffer *curve = ramp.mValueCurve.get();
+			if( ! curve || curve->getNumFrames() < 2 ) {
+				dsp::fill( curve && curve->getNumFrames() ? valueBegin + ( valueEnd - valueBegin ) * curve->getData()[0] : valueBegin, array, count );
 				break;
 			}
-			else
-				++rampIt;
+
+			// linearly interpolates the curve, which spans the ramp from its first to its last element.
+			const float *curveData = curve->getData();
+			const size_t lastIndex = curve->getNumFrames() - 1;
+			const float valueDelta = valueEnd - valueBegin;
+			const double curveIncr = double( lastIndex ) / numFrames;
+			const double curvePos = frame * curveIncr;
+			for( size_t i = 0; i < count; i++ ) {
+				double pos = curvePos + curveIncr * double( i );
+				size_t index = min( size_t( pos ), lastIndex - 1 );
+				float fract = float( pos - double( index ) );
+				float shape = curveData[index] + ( curveData[index + 1] - curveData[index] ) * fract;
+				array[i] = valueBegin + valueDelta * shape;
+			}
+			break;
+		}
+		case Ramp::CUSTOM:
+		default:
+			ramp.mRampFn( array, count, float( frame / numFrames ), float( 1 / numFrames ), make_pair( valueBegin, valueEnd ) );
+			break;
+	}
+}
+
+// Allocates the Timeline's and the buffers that eval() writes to, the latter first as eval() may use them once mAutomationPtr is set.
+void Param::initAutomation()
+{
+	if( mAutomation )
+		return;
+
+	const size_t framesPerBlock = getContext()->getFramesPerBlock();
+	if( mRate != CONTROL_RATE || ! mCheapestEvalOnly )
+		mInternalBuffer.setNumFrames( framesPerBlock );
+	if( mRate != AUDIO_RATE )
+		mControlValues.setNumFrames( calcNumControlValues( framesPerBlock, mControlPeriod ) );
+
+	mAutomation.reset( new Automation );
+	mAutomationPtr.store( mAutomation.get(), memory_order_release );
+}
+
+// The buffers may be in use by the audio thread, in which case the parent Node's reserveBuffer() suspends it while they grow.
+void Param::reserveBuffers( Rate rate, size_t controlPeriod, size_t maxFramesPerBlock )
+{
+	const size_t framesPerBlock = getContext()->getFramesPerBlock();
+	maxFramesPerBlock = max( maxFramesPerBlock, framesPerBlock );
+
+	if( rate != CONTROL_RATE || ! mCheapestEvalOnly ) {
+		mParentNode->reserveBuffer( &mInternalBuffer, maxFramesPerBlock, 1 );
+		mInternalBuffer.setNumFrames( framesPerBlock );
+	}
+	if( rate != AUDIO_RATE ) {
+		const size_t numControlValues = calcNumControlValues( maxFramesPerBlock, controlPeriod );
+		mParentNode->reserveBuffer( &mControlValues, numControlValues, 1 );
+		mControlValues.setNumFrames( max( mControlValues.getNumFrames(), numControlValues ) );
+	}
+}
+
+// Picks up the most recently published Timeline, if there is one, and applies any value that was set directly.
+Param::Timeline* Param::acquireTimeline()
+{
+	Automation *automation = mAutomationPtr.load( memory_order_acquire );
+	if( ! automation )
+		return nullptr;
+
+	if( automation->mMiddle.load( memory_order_relaxed ) & Automation::PUBLISHED )
+		automation->mFront = automation->mMiddle.exchange( automation->mFront, memory_order_acq_rel ) & ~Automation::PUBLISHED;
+
+	Timeline *timeline = &automation->mTimelines[automation->mFront];
+	if( timeline->mValueEpoch != automation->mAppliedValueEpoch ) {
+		automation->mAppliedValueEpoch = timeline->mValueEpoch;
+		mValue = timeline->mValue;
+	}
+
+	return timeline;
+}
+
+// Returns true if any Ramp overlapping the block has an average slope above the threshold. Custom curves can have any shape, so they always exceed it.
+bool Param::exceedsAutoRateThreshold( const Timeline &timeline, uint64_t frameBegin, size_t numFrames, size_t sampleRate ) const
+{
+	const float threshold = mAutoRateThreshold;
+	const uint64_t frameEnd = frameBegin + numFrames;
+	for( size_t i = 0; i < timeline.mNumRamps; i++ ) {
+		const RampEvent &ramp = timeline.mRamps[i];
+		if( ramp.mFrameEnd <= frameBegin || ramp.mFrameBegin >= frameEnd )
+			continue;
+		if( ramp.mCurve == Ramp::CUSTOM )
+			return true;
+
+		double slope = fabs( double( ramp.mValueEnd - ramp.mValueBegin ) ) * double( sampleRate ) / double( ramp.mFrameEnd - ramp.mFrameBegin );
+		if( slope > threshold )
+			return true;
+	}
+
+	return false;
+}
+
+// One value at the beginning of each control period, plus the first value of the next block.
+size_t Param::calcNumControlValues( size_t numFrames, size_t controlPeriod )
+{
+	if( ! controlPeriod || controlPeriod >= numFrames )
+		return 2;
+
+	return ( numFrames + controlPeriod - 1 ) / controlPeriod + 1;
+}
+
+void Param::publishTimeline()
+{
+	Automation *automation = mAutomation.get();
+	pruneTimeline( &automation->mTimelines[automation->mControl], getContext()->getNumProcessedFrames() );
+
+	// copying assigns RampFn's over those the audio thread has discarded, so any memory they held is released here.
+	Timeline &back = automation->mTimelines[automation->mBack];
+	const Timeline &control = automation->mTimelines[automation->mControl];
+	for( size_t i = 0; i < control.mNumRamps; i++ )
+		back.mRamps[i] = control.mRamps[i];
+
+	back.mNumRamps = control.mNumRamps;
+	back.mValueEpoch = control.mValueEpoch;
+	back.mValue = control.mValue;
+
+	automation->mBack = automation->mMiddle.exchange( automation->mBack | Automation::PUBLISHED, memory_order_acq_rel ) & ~Automation::PUBLISHED;
+}
+
+// Removes Ramp's that ended by \a frame, which the audio thread has already passed. The last one's end value is kept as the Timeline's value,
+// in case the audio thread didn't evaluate it.
+void Param::pruneTimeline( Timeline *timeline, uint64_t frame )
+{
+	for( size_t i = 0; i < timeline->mNumRamps; /* */ ) {
+		const RampEvent &ramp = timeline->mRamps[i];
+		if( ramp.mFrameEnd <= frame ) {
+			timeline->mValue = ramp.mValueEnd;
+			timeline->mValueEpoch++;
+			timeline->removeRamp( i );
 		}
 		else
-			++rampIt;
+			i++;
 	}
+}
 
-	// if after all ramps we still haven't written enough samples, fill with the final mValue, which was updated above to be the last ramp's mValueEnd.
-	if( samplesWritten < arrayLength )
-		dsp::fill( mValue, array + (size_t)samplesWritten, size_t( arrayLength - samplesWritten ) );
+void Param::cancelRamp( uint32_t id )
+{
+	lock_guard<mutex> lock( mMutex );
 
-	return samplesWritten != 0;
+	if( ! mAutomation )
+		return;
+
+	Timeline &timeline = mAutomation->mTimelines[mAutomation->mControl];
+	for( size_t i = 0; i < timeline.mNumRamps; i++ ) {
+		if( timeline.mRamps[i].mId == id ) {
+			timeline.removeRamp( i );
+			publishTimeline();
+			return;
+		}
+	}
 }
 
-// ----------------------------------------------------------------------------------------------------
-// MARK: - Protected
-// ----------------------------------------------------------------------------------------------------
+bool Param::isScheduled( uint32_t id ) const
+{
+	lock_guard<mutex> lock( mMutex );
 
-void Param::resetImpl()
+	if( ! mAutomation )
+		return false;
+
+	const Timeline &timeline = mAutomation->mTimelines[mAutomation->mControl];
+	uint64_t frame = getContext()->getNumProcessedFrames();
+	for( size_t i = 0; i < timeline.mNumRamps; i++ ) {
+		if( timeline.mRamps[i].mId == id )
+			return timeline.mRamps[i].mFrameEnd > frame;
+	}
+
+	return false;
+}
+
+Ramp Param::scheduleRampImpl( uint64_t frameBegin, uint64_t frameEnd, float valueBegin, float valueEnd, const Options &options )
 {
-	if( ! mRamps.empty() ) {
-		for( auto &ramp : mRamps )
-			ramp->cancel();
+	initAutomation();
 
-		mRamps.clear();
+	auto ctx = getContext();
+	Timeline &timeline = mAutomation->mTimelines[mAutomation->mControl];
+	pruneTimeline( &timeline, ctx->getNumProcessedFrames() );
+
+	if( timeline.mNumRamps == MAX_NUM_RAMPS ) {
+		CI_LOG_E( "cannot schedule more than " << MAX_NUM_RAMPS << " Ramp's" );
+		return Ramp();
+	}
+
+	RampEvent &ramp = timeline.mRamps[timeline.mNumRamps++];
+	ramp.mId = ++mLastRampId;
+	ramp.mFrameBegin = frameBegin;
+	ramp.mFrameEnd = frameEnd;
+	ramp.mValueBegin = valueBegin;
+	ramp.mValueEnd = valueEnd;
+	ramp.mCurve = options.getCurve();
+	ramp.mTimeConstantFrames = float( options.getTimeConstant() * ctx->getSampleRate() );
+	ramp.mValueCurve = options.getValueCurve();
+	ramp.mRampFn = options.getCurve() == Ramp::CUSTOM ? options.getRampFn() : RampFn();
+
+	publishTimeline();
+
+	return Ramp( this, ramp.mId, frameBegin, frameEnd, ctx->getSampleRate(), valueBegin, valueEnd );
+}
+
+pair<uint64_t, float> Param::findEndFrameAndValueImpl() const
+{
+	uint64_t frame = getContext()->getNumProcessedFrames();
+
+	if( mAutomation ) {
+		const Timeline &timeline = mAutomation->mTimelines[mAutomation->mControl];
+		if( timeline.mNumRamps && timeline.mRamps[timeline.mNumRamps - 1].mFrameEnd > frame ) {
+			const RampEvent &ramp = timeline.mRamps[timeline.mNumRamps - 1];
+			return make_pair( ramp.mFrameEnd, ramp.mValueEnd );
+		}
 	}
 
-	mProcessor.reset();
+	return make_pair( frame, mValue.load() );
 }
 
-void Param::initInternalBuffer()
+uint64_t Param::getDelayFrames( const Options &options ) const
 {
-	if( mInternalBuffer.isEmpty() )
-		mInternalBuffer.setNumFrames( getContext()->getFramesPerBlock() );
+	return secondsToFrames( options.getDelay() ) + options.getDelayFrames();
+}
+
+uint64_t Param::secondsToFrames( double seconds ) const
+{
+	return seconds > 0 ? uint64_t( seconds * (double)getContext()->getSampleRate() + 0.5 ) : 0;
+}
+
+void Param::resetImpl()
+{
+	if( mAutomation && mAutomation->mTimelines[mAutomation->mControl].mNumRamps ) {
+		mAutomation->mTimelines[mAutomation->mControl].mNumRamps = 0;
+		publishTimeline();
+	}
+
+	if( mProcessor ) {
+		mProcessorPtr = nullptr;
+		getContext()->deferRelease( mProcessor );
+		mProcessor.reset();
+	}
 }
 
 ContextRef Param::getContext() const
@@ -25,8 +25,8 @@
 
 #include "cinder/audio2/Buffer.h"
 
-#include <list>
 #include <atomic>
+#include <mutex>
 #include <functional>
 
 namespace cinder { namespace audio2 {
@@ -34,8 +34,10 @@ namespace cinder { namespace audio2 {
 typedef std::shared_ptr<class Context>		ContextRef;
 typedef std::shared_ptr<class Node>			NodeRef;
 
-//! A Reference to Ramp's returned by the ramping methods. \see applyRamp() \see appendRamp()
-typedef std::shared_ptr<class Ramp>			RampRef;
+class Param;
+
+//! Custom ramping function, called with \a count elements of the array to fill, the normalized time of the first element and the increment per element,
+//! and the [begin, end] value range. Only used by Ramp's with the Ramp::CUSTOM curve, the built-in curves are evaluated without it.
 //! note: unless we want to add _VARIADIC_MAX=6 in preprocessor definitions to all projects, number of args here has to be 5 or less for vc11 support
 typedef std::function<void ( float *, size_t, float, float, const std::pair<float, float>& )>	RampFn;
 
@@ -46,68 +48,170 @@ void rampInQuad( float *array, size_t count, float t, float tIncr, const std::pa
 //! Array-based quadradic (t^2) ease-out ramping function.
 void rampOutQuad( float *array, size_t count, float t, float tIncr, const std::pair<float, float> &valueRange );
 
+//! Handle to a Ramp scheduled on a Param, returned by the ramping methods. \see Param::applyRamp() \see Param::appendRamp()
+//! Ramp's are cheap to copy, but must not be used once their Param has been destroyed.
 class Ramp {
   public:
-	float getTimeBegin()		const	{ return mTimeBegin; }
-	float getTimeEnd()			const	{ return mTimeEnd; }
-	float getDuration()			const	{ return mDuration; }
-	float getValueBegin()		const	{ return mValueBegin; }
-	float getValueEnd()			const	{ return mValueEnd; }
-	const RampFn& getRampFn()	const	{ return mRampFn; }
+	//! The curves that a Ramp can follow from its begin value to its end value. \see Param::Options::curve()
+	enum Curve {
+		LINEAR,			//! straight line
+		IN_QUAD,		//! quadradic (t^2) ease-in
+		OUT_QUAD,		//! quadradic (t^2) ease-out
+		EXPONENTIAL,	//! constant ratio per frame, which sounds linear for frequencies and gains. Linear if the begin and end values differ in sign or either is 0.
+		TARGET,			//! one-pole approach towards the end value with Param::Options::timeConstant(), jumping to the end value once the Ramp ends
+		VALUE_CURVE,	//! the first channel of Param::Options::valueCurve() stretched over the Ramp, as a shape from the begin value (0) to the end value (1)
+		CUSTOM			//! Param::Options::rampFn()
+	};
 
-	void cancel()				{ mIsCanceled = true; }
-	bool isComplete() const		{ return mIsComplete; }
+	//! Constructs an invalid Ramp, which doesn't belong to any Param.
+	Ramp() : mParam( nullptr ), mId( 0 ), mFrameBegin( 0 ), mFrameEnd( 0 ), mSampleRate( 0 ), mValueBegin( 0 ), mValueEnd( 0 )	{}
+
+	//! Returns the frame at which the Ramp begins, in the timeline of its Param's Context (see Context::getNumProcessedFrames()).
+	uint64_t	getFrameBegin()		const	{ return mFrameBegin; }
+	//! Returns the frame at which the Ramp ends, from which on its Param holds getValueEnd().
+	uint64_t	getFrameEnd()		const	{ return mFrameEnd; }
+	uint64_t	getNumFrames()		const	{ return mFrameEnd - mFrameBegin; }
+	double		getTimeBegin()		const	{ return mSampleRate ? (double)mFrameBegin / (double)mSampleRate : 0; }
+	double		getTimeEnd()		const	{ return mSampleRate ? (double)mFrameEnd / (double)mSampleRate : 0; }
+	double		getDuration()		const	{ return mSampleRate ? (double)getNumFrames() / (double)mSampleRate : 0; }
+	float		getValueBegin()		const	{ return mValueBegin; }
+	float		getValueEnd()		const	{ return mValueEnd; }
+
+	//! Returns whether this Ramp was scheduled, which fails if its Param already has Param::MAX_NUM_RAMPS Ramp's.
+	bool isValid() const		{ return mParam != nullptr; }
+	//! Cancels this Ramp if it is still scheduled, after which its Param holds the value that the Ramp had reached. \note Must be called from a non-audio thread.
+	void cancel() const;
+	//! Returns whether this Ramp is no longer scheduled, because it has ended, was canceled, or was discarded by its Param (ex. by applyRamp()).
+	bool isComplete() const;
 
   private:
-	Ramp( float timeBegin, float timeEnd, float valueBegin, float valueEnd, const RampFn &rampFn );
+	Ramp( Param *param, uint32_t id, uint64_t frameBegin, uint64_t frameEnd, size_t sampleRate, float valueBegin, float valueEnd )
+		: mParam( param ), mId( id ), mFrameBegin( frameBegin ), mFrameEnd( frameEnd ), mSampleRate( sampleRate ), mValueBegin( valueBegin ), mValueEnd( valueEnd )
+	{}
 
-	float				mTimeBegin, mTimeEnd, mDuration;
-	float				mValueBegin, mValueEnd;
-	std::atomic<bool>	mIsComplete, mIsCanceled;
-	RampFn	mRampFn;
+	Param*		mParam;
+	uint32_t	mId;
+	uint64_t	mFrameBegin, mFrameEnd;
+	size_t		mSampleRate;
+	float		mValueBegin, mValueEnd;
 
 	friend class Param;
 };
 
+//! \brief A value that can be automated with Ramp's, or driven by a processing Node, and is evaluated once per block on the audio thread.
+//!
+//! Ramp's are positioned at exact frames of the Context's timeline (see Context::getNumProcessedFrames()), so they stay sample-accurate
+//! regardless of how long the Context has been running. They are scheduled on non-audio threads into a fixed-capacity timeline, which is handed to the audio thread whole through a lock-free
+//! triple buffer. Scheduling never waits on the audio thread and eval() never locks or allocates. The timeline (and the Buffer that eval()
+//! writes to) is allocated by the first ramping method, or by Context::prepare(), so Param's that are never ramped cost nothing extra.
+//!
+//! Slow automation can be evaluated at control rate (see setRate()), in which case only a handful of values are computed per block. Node's
+//! that can use them directly call evalCheapest() rather than eval(), which skips the per-frame buffer altogether.
 class Param {
   public:
+	//! The maximum number of Ramp's that can be scheduled at once, beyond which appendRamp() fails and returns an invalid Ramp.
+	static const size_t MAX_NUM_RAMPS = 32;
+
+	//! The rate at which Ramp's are evaluated. \see setRate()
+	enum Rate {
+		AUDIO_RATE,		//! every frame is evaluated (default)
+		CONTROL_RATE,	//! one value is evaluated every control period, and the frames in between are linearly interpolated
+		AUTO_RATE		//! CONTROL_RATE for blocks in which no Ramp is steeper than getAutoRateThreshold(), otherwise AUDIO_RATE
+	};
+
+	//! The cheapest form of the Param's values over the current processing block. \see evalCheapest()
+	enum Evaluation {
+		CONSTANT,		//! the value is constant, use getValue()
+		CONTROL_VALUES,	//! use getControlValues(), to be linearly interpolated over getControlFrames() frames each
+		AUDIO_VALUES	//! use getValueArray()
+	};
 
 	//! Optional parameters when applying or appending ramps. \see applyRamp() \see appendRamp()
 	struct Options {
-		Options() : mDelay( 0 ), mRampFn( rampLinear ) {}
+		Options() : mDelay( 0 ), mDelayFrames( 0 ), mCurve( Ramp::LINEAR ), mTimeConstant( 0 ) {}
 
 		//! Specifies a delay of \a delay in seconds.
 		Options& delay( float delay )				{ mDelay = delay; return *this; }
-		//! Specifies the ramping function used during evaluation.
-		Options& rampFn( const RampFn &rampFn )		{ mRampFn = rampFn; return *this; }
+		//! Specifies a delay of \a delayFrames frames, which is added to any delay in seconds.
+		Options& delayFrames( uint64_t frames )		{ mDelayFrames = frames; return *this; }
+		//! Specifies the curve that the Ramp follows (default = Ramp::LINEAR).
+		Options& curve( Ramp::Curve curve )			{ mCurve = curve; return *this; }
+		//! Specifies a custom ramping function used during evaluation, which sets the curve to Ramp::CUSTOM. rampLinear(), rampInQuad() and rampOutQuad() map to their built-in curves.
+		Options& rampFn( const RampFn &rampFn );
+		//! Specifies the time constant in seconds of a Ramp::TARGET curve, after which it has covered 63% of the way to its end value. 0 (default) uses a fifth of the Ramp's duration.
+		Options& timeConstant( float seconds )		{ mTimeConstant = seconds; return *this; }
+		//! Specifies the shape of a Ramp::VALUE_CURVE curve, and sets the curve to Ramp::VALUE_CURVE.
+		Options& valueCurve( const BufferRef &curve )	{ mValueCurve = curve; mCurve = Ramp::VALUE_CURVE; return *this; }
 
 		//! Returns the delay specified in seconds.
 		float getDelay() const				{ return mDelay; }
-		//! Returns the ramping function that will be used during evaluation.
+		//! Returns the delay specified in frames.
+		uint64_t getDelayFrames() const		{ return mDelayFrames; }
+		//! Returns the curve that the Ramp follows.
+		Ramp::Curve		getCurve() const	{ return mCurve; }
+		//! Returns the custom ramping function, which is only used with Ramp::CUSTOM.
 		const RampFn&	getRampFn() const	{ return mRampFn; }
+		//! Returns the time constant of a Ramp::TARGET curve, in seconds.
+		float			getTimeConstant() const	{ return mTimeConstant; }
+		//! Returns the shape of a Ramp::VALUE_CURVE curve.
+		const BufferRef&	getValueCurve() const	{ return mValueCurve; }
 
 	  private:
-		float mDelay;
-		RampFn	mRampFn;
+		float		mDelay;
+		uint64_t	mDelayFrames;
+		Ramp::Curve	mCurve;
+		RampFn		mRampFn;
+		float		mTimeConstant;
+		BufferRef	mValueCurve;
 	};
 
 	//! Constructs a Param with a pointer (weak reference) to the owning parent Node and an optional \a initialValue (default = 0).
 	Param( Node *parentNode, float initialValue = 0 );
 
-	//! Sets the value of the Param, blowing away any scheduled Event's or processing Node. \note Must be called from a non-audio thread.
+	//! Sets the value of the Param, blowing away any scheduled Ramp's or processing Node. \note Must be called from a non-audio thread.
 	void	setValue( float value );
 	//! Returns the current value of the Param.
 	float	getValue() const	{ return mValue; }
 	//! Returns a pointer to the buffer used when evaluating a Param that is varying over the current processing block, of equal size to the owning Context's frames per block.
 	//! \note If not varying (eval() returns false), the returned pointer will be invalid.
 	const float*	getValueArray() const;
+	//! Returns the values evaluated at control rate by the last call to evalCheapest() that returned CONTROL_VALUES. Value \a i is at frame
+	//! min( i * getControlFrames(), frames per block ) of the block, so the last one is the value at the beginning of the next block.
+	const float*	getControlValues() const	{ return mControlValues.getData(); }
+	//! Returns the number of values returned by getControlValues().
+	size_t			getNumControlValues() const	{ return mNumControlValues; }
+	//! Returns the number of frames between the values returned by getControlValues(). The last pair may be closer, if the block isn't a multiple of it.
+	size_t			getControlFrames() const	{ return mControlFrames; }
 
 	//! Replaces any existing Ramp's with a Ramp from the current value to \a valueEnd over \a rampSeconds, according to \a options. Any existing processing Node is disconnected.
-	RampRef applyRamp( float valueEnd, float rampSeconds, const Options &options = Options() );
+	Ramp applyRamp( float valueEnd, float rampSeconds, const Options &options = Options() );
 	//! Replaces any existing Ramp's with a Ramp from \a valueBegin to \a valueEnd over \a rampSeconds, according to \a options. Any existing processing Node is disconnected.
-	RampRef applyRamp( float valueBegin, float valueEnd, float rampSeconds, const Options &options = Options() );
+	Ramp applyRamp( float valueBegin, float valueEnd, float rampSeconds, const Options &options = Options() );
 	//! Appends a Ramp from the end of the last scheduled Param (or the current time) to \a valueEnd over \a rampSeconds, according to \a options. Any existing processing Node is disconnected.
-	RampRef appendRamp( float valueEnd, float rampSeconds, const Options &options = Options() );
+	Ramp appendRamp( float valueEnd, float rampSeconds, const Options &options = Options() );
+	//! Same as applyRamp( float, float, const Options & ), with the duration specified as \a rampFrames frames.
+	Ramp applyRampFrames( float valueEnd, uint64_t rampFrames, const Options &options = Options() );
+	//! Same as applyRamp( float, float, float, const Options & ), with the duration specified as \a rampFrames frames.
+	Ramp applyRampFrames( float valueBegin, float valueEnd, uint64_t rampFrames, const Options &options = Options() );
+	//! Same as appendRamp(), with the duration specified as \a rampFrames frames.
+	Ramp appendRampFrames( float valueEnd, uint64_t rampFrames, const Options &options = Options() );
+
+	//! Sets the \a rate at which Ramp's are evaluated. At CONTROL_RATE or AUTO_RATE, one value is evaluated every \a controlPeriod frames (0 = once per processing block). A processing Node is always evaluated at audio rate.
+	//! \note Must be called from a non-audio thread.
+	void	setRate( Rate rate, size_t controlPeriod = 0 );
+	//! Returns the rate at which Ramp's are evaluated.
+	Rate	getRate() const						{ return mRate; }
+	//! Returns the number of frames between values evaluated at control rate, or 0 if they are evaluated once per processing block.
+	size_t	getControlPeriod() const			{ return mControlPeriod; }
+	//! Sets the average slope, in value per second, above which an AUTO_RATE Param evaluates a Ramp at audio rate (default = 1).
+	void	setAutoRateThreshold( float slope )	{ mAutoRateThreshold = slope; }
+	//! Returns the average slope, in value per second, above which an AUTO_RATE Param evaluates a Ramp at audio rate.
+	float	getAutoRateThreshold() const		{ return mAutoRateThreshold; }
+	//! Declares that the parent Node only evaluates this Param with evalCheapest(), so no per-frame buffer is allocated at CONTROL_RATE. Called from the parent Node's constructor.
+	void	setCheapestEvalOnly()				{ mCheapestEvalOnly = true; }
+
+	//! Returns whether this Param is routed to a source by the Context's ModulationMatrix, in which case its Ramp's, value and processing Node are ignored.
+	bool isModulated() const	{ return mModulation.load() != nullptr; }
 
 	//! Sets this Param's input to be the processing performed by \a node. Any existing Ramp's are discarded.
 	//! \note Forces \a node to be mono.
@@ -120,30 +224,108 @@ class Param {
 
 	//! Evaluates the Param for the current processing block, with current time determined from the parent Node's Context.
 	//! \return true if the Param is varying this block (there are Ramp's or a processing Node) and getValueArray() should be used, or false if the Param's value is constant for this block (use getValue()).
-	//! \note Safe to call on the audio thread.
+	//! \note Must be called on the audio thread. Lock-free and never allocates.
+	//! At CONTROL_RATE or AUTO_RATE, values evaluated at control rate are interpolated into getValueArray().
 	bool	eval();
-	//! Evaluates the Param from \a timeBegin for \a arrayLength samples at \a sampleRate.
-	//! \return true if the Param is varying this block (there are Ramp's or a processing Node) and getValueArray() should be used, or false if the Param's value is constant for this block (use getValue()).
-	//! \note Safe to call on the audio thread.
-	bool	eval( float timeBegin, float *array, size_t arrayLength, size_t sampleRate );
-
-	//! Returns the total duration of any scheduled Param's, including delay, or 0 if none are scheduled.
-	float					findDuration() const;
-	//! Returns the end time and value of the latest scheduled Param, or [0, getValue()] if none are scheduled.
-	std::pair<float, float> findEndTimeAndValue() const;
+	//! Evaluates the Param for the current processing block, into the cheapest form of values that it can supply. \see Evaluation
+	//! \note Must be called on the audio thread. Lock-free and never allocates.
+	Evaluation	evalCheapest();
+	//! Evaluates the currently scheduled Ramp's from \a frameBegin for \a arrayLength frames, without affecting what the audio thread evaluates (ex. to render them offline).
+	//! \return true if there are Ramp's in the evaluated range, or false if \a array was filled with the current value.
+	//! \note Must be called from a non-audio thread.
+	bool	eval( uint64_t frameBegin, float *array, size_t arrayLength );
+
+	//! Returns the total duration in seconds of any scheduled Ramp's from the current time, including delay, or 0 if none are scheduled.
+	float						findDuration() const;
+	//! Returns the end time in seconds and value of the latest scheduled Ramp, or [current time, getValue()] if none are scheduled.
+	std::pair<double, float>	findEndTimeAndValue() const;
+	//! Returns the end frame and value of the latest scheduled Ramp, or [current frame, getValue()] if none are scheduled.
+	std::pair<uint64_t, float>	findEndFrameAndValue() const;
+
+	//! Allocates the Ramp timeline and the buffer used by eval() for blocks of up to \a maxFramesPerBlock frames, so that scheduling Ramp's doesn't allocate. Called by Node::prepare().
+	//! \note Must be called from a non-audio thread.
+	void	prepare( size_t maxFramesPerBlock );
 
   protected:
+	struct RampEvent {
+		RampEvent() : mId( 0 ), mFrameBegin( 0 ), mFrameEnd( 0 ), mValueBegin( 0 ), mValueEnd( 0 ), mCurve( Ramp::LINEAR ), mTimeConstantFrames( 0 )	{}
+
+		uint32_t	mId;
+		uint64_t	mFrameBegin, mFrameEnd;
+		float		mValueBegin, mValueEnd;
+		Ramp::Curve	mCurve;
+		float		mTimeConstantFrames;	// Ramp::TARGET only
+		BufferRef	mValueCurve;			// Ramp::VALUE_CURVE only
+		RampFn		mRampFn;				// Ramp::CUSTOM only
+	};
+
+	// The scheduled Ramp's in the order they were scheduled, plus the most recent value that was set directly.
+	struct Timeline {
+		Timeline() : mNumRamps( 0 ), mValueEpoch( 0 ), mValue( 0 )	{}
+
+		RampEvent	mRamps[MAX_NUM_RAMPS];
+		size_t		mNumRamps;
+		uint64_t	mValueEpoch;	// incremented each time mValue is set, so that the audio thread only applies it once
+		float		mValue;
+
+		void		removeRamp( size_t index );
+	};
+
+	// Allocated once and then never reallocated. mTimelines[mControl] is the authoritative copy, modified under mMutex by non-audio threads,
+	// which is published by copying it to mTimelines[mBack] and exchanging that with mMiddle. The audio thread exchanges mMiddle with mFront
+	// whenever it has been published to, then only ever modifies mTimelines[mFront]. Discarded RampFn's are therefore destroyed on a non-audio thread.
+	struct Automation {
+		Automation() : mControl( 0 ), mBack( 1 ), mMiddle( 2 ), mFront( 3 ), mAppliedValueEpoch( 0 )	{}
+
+		static const size_t PUBLISHED = 4; // flag set on mMiddle when it holds a Timeline that mFront hasn't seen
+
+		Timeline			mTimelines[4];
+		size_t				mControl, mBack;
+		std::atomic<size_t>	mMiddle;
+		size_t				mFront;
+		uint64_t			mAppliedValueEpoch;
+	};
 
 	// non-locking protected methods
-	void		initInternalBuffer();
+	void		initAutomation();
+	void		reserveBuffers( Rate rate, size_t controlPeriod, size_t maxFramesPerBlock );
+	Timeline*	acquireTimeline();
+	bool		exceedsAutoRateThreshold( const Timeline &timeline, uint64_t frameBegin, size_t numFrames, size_t sampleRate ) const;
+	static size_t	calcNumControlValues( size_t numFrames, size_t controlPeriod );
+	void		publishTimeline();
+	void		pruneTimeline( Timeline *timeline, uint64_t frame );
+	void		cancelRamp( uint32_t id );
+	bool		isScheduled( uint32_t id ) const;
+	Ramp		scheduleRampImpl( uint64_t frameBegin, uint64_t frameEnd, float valueBegin, float valueEnd, const Options &options );
+	std::pair<uint64_t, float> findEndFrameAndValueImpl() const;
+	uint64_t	getDelayFrames( const Options &options ) const;
+	uint64_t	secondsToFrames( double seconds ) const;
 	void		resetImpl();
+	bool		evalImpl( Timeline *timeline, uint64_t frameBegin, float *array, size_t arrayLength, float *value );
+	static void	fillCurve( const RampEvent &ramp, uint64_t rampFrame, float *array, size_t count );
 	ContextRef	getContext() const;
 
-	std::list<RampRef>	mRamps;
-	std::atomic<float>	mValue;
-	Node*				mParentNode;
-	NodeRef				mProcessor;
-	BufferDynamic		mInternalBuffer;
+	// synchronizes modifications on non-audio threads, eval() never locks it.
+	mutable std::mutex			mMutex;
+	std::unique_ptr<Automation>	mAutomation;
+	std::atomic<Automation *>	mAutomationPtr;		// read by the audio thread, only set once mAutomation is allocated
+	std::atomic<float>			mValue;
+	uint32_t					mLastRampId;
+	Node*						mParentNode;
+	NodeRef						mProcessor;
+	std::atomic<Node *>			mProcessorPtr;		// read by the audio thread, mProcessor is released with Context::deferRelease() after it is replaced
+	BufferDynamic				mInternalBuffer;	// not allocated at CONTROL_RATE if mCheapestEvalOnly
+	BufferDynamic				mControlValues;		// only allocated at CONTROL_RATE or AUTO_RATE
+	size_t						mNumControlValues, mControlFrames;
+	std::atomic<Rate>			mRate;
+	std::atomic<size_t>			mControlPeriod;
+	std::atomic<float>			mAutoRateThreshold;
+	bool						mCheapestEvalOnly;
+	std::atomic<const float *>	mModulation;		// set by a ModulationMatrix while routed, which writes it at the start of each block
+	const float*				mModulationArray;	// audio thread copy of mModulation, for getValueArray()
+
+	friend class ModulationMatrix;
+	friend class Ramp;
 };
 
 } } // namespace cinder::audio2
\ No newline at end of file
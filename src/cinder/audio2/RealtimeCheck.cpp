@@ -0,0 +1,338 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/audio2/RealtimeCheck.h"
+#include "cinder/audio2/Node.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+
+#if defined( CI_AUDIO_ENABLE_REALTIME_CHECKS )
+	#if defined( __GLIBC__ ) || defined( __APPLE__ )
+		#include <execinfo.h>
+		#define CI_AUDIO_HAS_BACKTRACE
+	#endif
+	#if defined( __GLIBC__ )
+		#include <dlfcn.h>
+		#include <pthread.h>
+	#endif
+
+	#if defined( _MSC_VER )
+		#define CI_AUDIO_THREAD_LOCAL __declspec( thread )
+	#else
+		#define CI_AUDIO_THREAD_LOCAL __thread
+	#endif
+#endif
+
+using namespace std;
+
+namespace cinder { namespace audio2 {
+
+const char* RealtimeViolation::typeToString( Type type )
+{
+	switch( type ) {
+		case Type::ALLOCATION:		return "allocation";
+		case Type::DEALLOCATION:	return "deallocation";
+		case Type::LOCK:			return "lock";
+	}
+
+	return "unknown";
+}
+
+#if defined( CI_AUDIO_ENABLE_REALTIME_CHECKS )
+
+namespace {
+
+const int MAX_BACKTRACE_FRAMES = 32;
+
+// plain thread-locals, so that reading them from an allocation hook never allocates.
+CI_AUDIO_THREAD_LOCAL size_t	sCheckDepth = 0;		// non-zero while the thread is rendering
+CI_AUDIO_THREAD_LOCAL Node*		sCurrentNode = nullptr;
+CI_AUDIO_THREAD_LOCAL bool		sIsRecording = false;	// set while recording a violation, which itself allocates and locks
+
+mutex						sViolationsMutex;
+vector<RealtimeViolation>	sViolations;
+atomic<size_t>				sNumViolations( 0 );
+
+} // anonymous namespace
+
+bool RealtimeCheck::isAvailable()
+{
+	return true;
+}
+
+vector<RealtimeViolation> RealtimeCheck::getViolations()
+{
+	lock_guard<mutex> lock( sViolationsMutex );
+	return sViolations;
+}
+
+size_t RealtimeCheck::getNumViolations()
+{
+	return sNumViolations;
+}
+
+void RealtimeCheck::clearViolations()
+{
+	lock_guard<mutex> lock( sViolationsMutex );
+	sViolations.clear();
+	sNumViolations = 0;
+}
+
+void RealtimeCheck::check( RealtimeViolation::Type type )
+{
+	if( ! sCheckDepth || sIsRecording )
+		return;
+
+	sIsRecording = true;
+	sNumViolations++;
+
+	// scoped so that the violation is destroyed while still recording, otherwise freeing it would be reported.
+	{
+		RealtimeViolation violation;
+		violation.mType = type;
+		if( sCurrentNode )
+			violation.mNodeName = sCurrentNode->getName();
+
+#if defined( CI_AUDIO_HAS_BACKTRACE )
+		void *frames[MAX_BACKTRACE_FRAMES];
+		int numFrames = backtrace( frames, MAX_BACKTRACE_FRAMES );
+		char **symbols = backtrace_symbols( frames, numFrames );
+		if( symbols ) {
+			// skip this method and the hook that called it
+			for( int i = 2; i < numFrames; i++ )
+				violation.mBacktrace.push_back( symbols[i] );
+
+			free( symbols );
+		}
+#endif
+
+		lock_guard<mutex> lock( sViolationsMutex );
+		if( sViolations.size() < getMaxNumViolations() )
+			sViolations.push_back( move( violation ) );
+	}
+
+	sIsRecording = false;
+}
+
+ScopedRealtimeCheck::ScopedRealtimeCheck()
+{
+	sCheckDepth++;
+}
+
+ScopedRealtimeCheck::~ScopedRealtimeCheck()
+{
+	sCheckDepth--;
+}
+
+ScopedRealtimeNode::ScopedRealtimeNode( Node *node )
+	: mPrevNode( sCurrentNode )
+{
+	sCurrentNode = node;
+}
+
+ScopedRealtimeNode::~ScopedRealtimeNode()
+{
+	sCurrentNode = mPrevNode;
+}
+
+#else
+
+bool RealtimeCheck::isAvailable()
+{
+	return false;
+}
+
+vector<RealtimeViolation> RealtimeCheck::getViolations()
+{
+	return vector<RealtimeViolation>();
+}
+
+size_t RealtimeCheck::getNumViolations()
+{
+	return 0;
+}
+
+void RealtimeCheck::clearViolations()					{}
+void RealtimeCheck::check( RealtimeViolation::Type )	{}
+
+ScopedRealtimeCheck::ScopedRealtimeCheck()				{}
+ScopedRealtimeCheck::~ScopedRealtimeCheck()				{}
+ScopedRealtimeNode::ScopedRealtimeNode( Node * )		: mPrevNode( nullptr )	{}
+ScopedRealtimeNode::~ScopedRealtimeNode()				{}
+
+#endif // defined( CI_AUDIO_ENABLE_REALTIME_CHECKS )
+
+} } // namespace cinder::audio2
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - Allocation and locking hooks
+// ----------------------------------------------------------------------------------------------------
+
+#if defined( CI_AUDIO_ENABLE_REALTIME_CHECKS )
+
+using cinder::audio2::RealtimeCheck;
+using cinder::audio2::RealtimeViolation;
+
+#if defined( __GLIBC__ )
+
+// glibc lets the executable replace the malloc family and forward to the __libc_ implementations. operator new / delete, including
+// the aligned variants, are implemented with these, so they don't need replacing. pthread_mutex_lock() is forwarded to the next
+// definition in link order.
+
+extern "C" {
+
+void*	__libc_malloc( size_t size );
+void*	__libc_calloc( size_t count, size_t size );
+void*	__libc_realloc( void *ptr, size_t size );
+void	__libc_free( void *ptr );
+void*	__libc_memalign( size_t alignment, size_t size );
+
+void* malloc( size_t size )
+{
+	RealtimeCheck::check( RealtimeViolation::Type::ALLOCATION );
+	return __libc_malloc( size );
+}
+
+void* calloc( size_t count, size_t size )
+{
+	RealtimeCheck::check( RealtimeViolation::Type::ALLOCATION );
+	return __libc_calloc( count, size );
+}
+
+void* realloc( void *ptr, size_t size )
+{
+	RealtimeCheck::check( RealtimeViolation::Type::ALLOCATION );
+	return __libc_realloc( ptr, size );
+}
+
+void* memalign( size_t alignment, size_t size )
+{
+	RealtimeCheck::check( RealtimeViolation::Type::ALLOCATION );
+	return __libc_memalign( alignment, size );
+}
+
+void* aligned_alloc( size_t alignment, size_t size )
+{
+	RealtimeCheck::check( RealtimeViolation::Type::ALLOCATION );
+	return __libc_memalign( alignment, size );
+}
+
+int posix_memalign( void **ptr, size_t alignment, size_t size )
+{
+	RealtimeCheck::check( RealtimeViolation::Type::ALLOCATION );
+
+	if( ! alignment || ( alignment & ( alignment - 1 ) ) || alignment % sizeof( void * ) )
+		return EINVAL;
+
+	void *result = __libc_memalign( alignment, size );
+	if( ! result )
+		return ENOMEM;
+
+	*ptr = result;
+	return 0;
+}
+
+void free( void *ptr )
+{
+	if( ptr )
+		RealtimeCheck::check( RealtimeViolation::Type::DEALLOCATION );
+
+	__libc_free( ptr );
+}
+
+int pthread_mutex_lock( pthread_mutex_t *mutex )
+{
+	typedef int (*LockFn)( pthread_mutex_t * );
+	static atomic<LockFn> sLockFn( nullptr );
+
+	LockFn lockFn = sLockFn.load( memory_order_relaxed );
+	if( ! lockFn ) {
+		lockFn = (LockFn)dlsym( RTLD_NEXT, "pthread_mutex_lock" );
+		sLockFn.store( lockFn, memory_order_relaxed );
+	}
+
+	RealtimeCheck::check( RealtimeViolation::Type::LOCK );
+	return lockFn( mutex );
+}
+
+} // extern "C"
+
+#else
+
+void* operator new( size_t size )
+{
+	RealtimeCheck::check( RealtimeViolation::Type::ALLOCATION );
+
+	void *ptr = malloc( size ? size : 1 );
+	if( ! ptr )
+		throw std::bad_alloc();
+
+	return ptr;
+}
+
+void* operator new[]( size_t size )
+{
+	return operator new( size );
+}
+
+void* operator new( size_t size, const std::nothrow_t & ) throw()
+{
+	RealtimeCheck::check( RealtimeViolation::Type::ALLOCATION );
+	return malloc( size ? size : 1 );
+}
+
+void* operator new[]( size_t size, const std::nothrow_t &nothrow ) throw()
+{
+	return operator new( size, nothrow );
+}
+
+void operator delete( void *ptr ) throw()
+{
+	if( ptr )
+		RealtimeCheck::check( RealtimeViolation::Type::DEALLOCATION );
+
+	free( ptr );
+}
+
+void operator delete[]( void *ptr ) throw()
+{
+	operator delete( ptr );
+}
+
+void operator delete( void *ptr, const std::nothrow_t & ) throw()
+{
+	operator delete( ptr );
+}
+
+void operator delete[]( void *ptr, const std::nothrow_t & ) throw()
+{
+	operator delete( ptr );
+}
+
+#endif // defined( __GLIBC__ )
+
+#endif // defined( CI_AUDIO_ENABLE_REALTIME_CHECKS )
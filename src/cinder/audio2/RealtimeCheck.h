@@ -0,0 +1,105 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Real-time safety checks, for catching code that allocates or locks while rendering. Only compiled in when CI_AUDIO_ENABLE_REALTIME_CHECKS is defined,
+// which is intended for debug and test builds: every allocation then pays for a thread-local check.
+//
+// While a thread renders a RenderGraph (the audio thread, or a RenderPool worker processing a job), the following are recorded as RealtimeViolation's:
+// - allocating or freeing memory, with operator new / delete everywhere and also malloc() / calloc() / realloc() / free() with glibc (ex. on Linux).
+// - locking a mutex with glibc, which includes std::mutex::lock() (try_lock() is not a violation).
+
+namespace cinder { namespace audio2 {
+
+class Node;
+
+//! Describes an operation that may block, performed by the render thread while checking real-time safety.
+class RealtimeViolation {
+  public:
+	enum class Type { ALLOCATION, DEALLOCATION, LOCK };
+
+	//! Returns the kind of operation that was performed.
+	Type								getType() const			{ return mType; }
+	//! Returns the name of the Node being processed, or an empty string if the operation happened outside of any Node's process().
+	const std::string&					getNodeName() const		{ return mNodeName; }
+	//! Returns the call stack at the point of the operation, one frame per entry (innermost first), or empty where the platform doesn't support it.
+	//! Frames are only symbolized if the executable exports its symbols (ex. linked with -rdynamic), otherwise addresses can be resolved with addr2line.
+	const std::vector<std::string>&		getBacktrace() const	{ return mBacktrace; }
+
+	//! Returns a human-readable description of \a type.
+	static const char*	typeToString( Type type );
+
+  private:
+	Type						mType;
+	std::string					mNodeName;
+	std::vector<std::string>	mBacktrace;
+
+	friend class RealtimeCheck;
+};
+
+//! Collects the RealtimeViolation's of all threads. \note Only functional when CI_AUDIO_ENABLE_REALTIME_CHECKS is defined.
+class RealtimeCheck {
+  public:
+	//! Returns whether real-time checks were compiled in.
+	static bool		isAvailable();
+	//! Returns the violations recorded so far, oldest first. At most getMaxNumViolations() are kept.
+	static std::vector<RealtimeViolation>	getViolations();
+	//! Returns the total number of violations, including those that weren't kept.
+	static size_t	getNumViolations();
+	//! Discards all recorded violations.
+	static void		clearViolations();
+	//! Returns the number of violations that are kept, beyond which they are only counted.
+	static size_t	getMaxNumViolations()	{ return 256; }
+
+	//! Records a violation of \a type on the calling thread, if it is currently checked. Called by the allocation and locking hooks.
+	static void		check( RealtimeViolation::Type type );
+};
+
+//! Marks the calling thread as rendering for the scope of this object, so that it is checked. Scopes may be nested.
+struct ScopedRealtimeCheck {
+	ScopedRealtimeCheck();
+	~ScopedRealtimeCheck();
+};
+
+//! Attributes violations on the calling thread to \a node for the scope of this object.
+struct ScopedRealtimeNode {
+	ScopedRealtimeNode( Node *node );
+	~ScopedRealtimeNode();
+
+  private:
+	Node *mPrevNode;
+};
+
+} } // namespace cinder::audio2
+
+#if defined( CI_AUDIO_ENABLE_REALTIME_CHECKS )
+	#define CI_AUDIO_REALTIME_SCOPE()			::cinder::audio2::ScopedRealtimeCheck ciAudioRealtimeCheck__
+	#define CI_AUDIO_REALTIME_NODE( node )		::cinder::audio2::ScopedRealtimeNode ciAudioRealtimeNode__( node )
+#else
+	#define CI_AUDIO_REALTIME_SCOPE()			do{} while( 0 )
+	#define CI_AUDIO_REALTIME_NODE( node )		do{} while( 0 )
+#endif
@@ -0,0 +1,66 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/audio2/RenderBufferPool.h"
+#include "cinder/audio2/CinderAssert.h"
+
+using namespace std;
+
+namespace cinder { namespace audio2 {
+
+RenderBufferPool::RenderBufferPool( size_t framesPerBlock )
+	: mFramesPerBlock( framesPerBlock )
+{
+}
+
+Buffer* RenderBufferPool::getBuffer( size_t numChannels, size_t index )
+{
+	CI_ASSERT( numChannels );
+
+	auto &buffers = mBuffers[numChannels];
+	while( buffers.size() <= index )
+		buffers.emplace_back( new Buffer( mFramesPerBlock, numChannels ) );
+
+	return buffers[index].get();
+}
+
+size_t RenderBufferPool::getNumBuffers() const
+{
+	size_t result = 0;
+	for( const auto &buffers : mBuffers )
+		result += buffers.second.size();
+
+	return result;
+}
+
+size_t RenderBufferPool::getNumBytes() const
+{
+	size_t result = 0;
+	for( const auto &buffers : mBuffers )
+		result += buffers.second.size() * buffers.first * mFramesPerBlock * sizeof( float );
+
+	return result;
+}
+
+} } // namespace cinder::audio2
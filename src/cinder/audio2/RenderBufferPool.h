@@ -0,0 +1,64 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/audio2/Buffer.h"
+
+#include <boost/noncopyable.hpp>
+
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace cinder { namespace audio2 {
+
+typedef std::shared_ptr<class RenderBufferPool>		RenderBufferPoolRef;
+
+//! \brief Block-sized Buffer's that a RenderGraph assigns to the Node's it processes, instead of each Node owning its own.
+//!
+//! Buffer's are grouped by channel count and identified by an index within that group. A RenderGraph uses as few of them as the liveness
+//! of its Buffer's allows, so consecutively published RenderGraph's share the same Buffer's. This is safe because only one RenderGraph
+//! is processed at a time. The pool only ever grows, and Buffer's are never moved or resized once allocated.
+class RenderBufferPool : public boost::noncopyable {
+  public:
+	RenderBufferPool( size_t framesPerBlock );
+
+	//! Returns the number of frames in every Buffer.
+	size_t	getFramesPerBlock() const	{ return mFramesPerBlock; }
+
+	//! Returns the Buffer at \a index with \a numChannels, allocating it and any before it if necessary. \note Must be called on a non-audio thread.
+	Buffer*	getBuffer( size_t numChannels, size_t index );
+
+	//! Returns the number of Buffer's that have been allocated.
+	size_t	getNumBuffers() const;
+	//! Returns the number of bytes used by all allocated Buffer's.
+	size_t	getNumBytes() const;
+
+  private:
+	std::map<size_t, std::vector<std::unique_ptr<Buffer> > >	mBuffers;	// keyed by number of channels
+	size_t														mFramesPerBlock;
+};
+
+} } // namespace cinder::audio2
@@ -0,0 +1,567 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/audio2/RenderGraph.h"
+#include "cinder/audio2/NodeProfiler.h"
+#include "cinder/audio2/dsp/Converter.h"
+#include "cinder/audio2/CinderAssert.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <queue>
+
+using namespace std;
+
+namespace cinder { namespace audio2 {
+
+RenderGraph::RenderGraph( const NodeRef &output, const set<NodeRef> &autoPulledNodes, size_t framesPerBlock, const RenderPoolRef &renderPool, const RenderBufferPoolRef &bufferPool )
+	: mRenderPool( renderPool ), mBufferPool( bufferPool ), mFramesPerBlock( framesPerBlock ), mSampleRate( 0 ), mNumProcessedFrames( 0 ), mProfilingEnabled( false ),
+		mNumBufferSlots( 0 ), mNumBuffersUsed( 0 ), mNumBytesUnpooled( 0 ), mNumBytesPooled( 0 )
+{
+	if( ! mBufferPool )
+		mBufferPool = make_shared<RenderBufferPool>( framesPerBlock );
+
+	CI_ASSERT( mBufferPool->getFramesPerBlock() == framesPerBlock );
+
+	if( output ) {
+		// the NodeOutput's internal buffer is read after processing, so it is always used directly.
+		Node *outputNode = output.get();
+		mSampleRate = outputNode->getSampleRate();
+		size_t outputSlot = makeSlot( outputNode->mNumChannels, outputNode, true );
+		mInternalSlots[outputNode] = outputSlot;
+
+		compile( outputNode, outputSlot, mSteps, true );
+	}
+
+	for( const NodeRef &node : autoPulledNodes )
+		compile( node.get(), makeSlot( node->getNumChannels() ), mSteps, true );
+
+	assignBuffers();
+
+	mSlots.clear();
+	mInternalSlots.clear();
+	mBufferIds.clear();
+	mCompiledSummingNodes.clear();
+}
+
+// Mirrors the recursive traversal that Node::pullInputs() does each block, except that steps are recorded instead of performed.
+void RenderGraph::compile( Node *node, size_t inPlaceSlot, vector<Step> &steps, bool canParallelize )
+{
+	if( ! node->mProcessInPlace ) {
+		compileSumming( node, steps, canParallelize );
+		return;
+	}
+
+	addNode( node );
+
+	if( node->mInputs.empty() )
+		steps.push_back( Step( Step::PROCESS_INPUT, node, inPlaceSlot ) );
+	else {
+		// can only be one input when in-place
+		Node *input = node->mInputs.begin()->second.get();
+		compile( input, inPlaceSlot, steps, canParallelize );
+
+		if( ! input->mProcessInPlace )
+			steps.push_back( Step( Step::MIX, nullptr, getInternalSlot( input ), inPlaceSlot ) );
+
+		steps.push_back( Step( Step::PROCESS, node, inPlaceSlot ) );
+	}
+}
+
+void RenderGraph::compileSumming( Node *node, vector<Step> &steps, bool canParallelize )
+{
+	size_t internalSlot = getInternalSlot( node );
+
+	// Summing Node's are only processed once, which also terminates any feedback cycles (ex. with a Delay). If the Node is reached again
+	// before it has finished compiling, it is part of a cycle and its inputs read what it processed last block, so its buffer must persist.
+	if( ! mCompiledSummingNodes.insert( node ).second ) {
+		if( mSummingNodesInProgress.count( node ) ) {
+			mSlots[internalSlot].mPersistent = true;
+			mSlots[internalSlot].mInCycle = true;
+		}
+
+		return;
+	}
+
+	mSummingNodesInProgress.insert( node );
+	addNode( node );
+
+	size_t summingSlot = makeSlot( node->mNumChannels );
+	size_t beginStep = steps.size();
+	steps.push_back( Step( Step::SUM_BEGIN, node, summingSlot ) );
+
+	// Find the inputs that can be processed in parallel. Jobs are not nested, since the RenderPool's threads are already busy.
+	vector<Node *> parallelInputs;
+	if( canParallelize && mRenderPool ) {
+		for( auto &in : node->mInputs ) {
+			if( isIndependentTree( in.second.get(), node ) )
+				parallelInputs.push_back( in.second.get() );
+		}
+
+		if( parallelInputs.size() < 2 )
+			parallelInputs.clear();
+	}
+
+	if( ! parallelInputs.empty() ) {
+		Step parallelStep( Step::PARALLEL, node, NO_SLOT );
+		parallelStep.mIndex = mJobs.size();
+		parallelStep.mCount = parallelInputs.size();
+
+		for( Node *input : parallelInputs ) {
+			Job *job = new Job;
+			mJobs.push_back( unique_ptr<Job>( job ) );
+
+			job->mBufferSlot = makeSlot( node->mNumChannels );
+			compile( input, job->mBufferSlot, job->mSteps, false );
+			job->mResultSlot = input->mProcessInPlace ? job->mBufferSlot : getInternalSlot( input );
+		}
+
+		steps.push_back( parallelStep );
+
+		for( size_t i = parallelStep.mIndex; i < mJobs.size(); i++ )
+			steps.push_back( Step( Step::SUM, nullptr, mJobs[i]->mResultSlot, summingSlot ) );
+	}
+
+	// Inputs that process in-place do so in our internal buffer, which is not zero'ed first to allow for feedback.
+	for( auto &in : node->mInputs ) {
+		Node *input = in.second.get();
+		if( find( parallelInputs.begin(), parallelInputs.end(), input ) != parallelInputs.end() )
+			continue;
+
+		compile( input, internalSlot, steps, canParallelize );
+
+		size_t processedSlot = input->mProcessInPlace ? internalSlot : getInternalSlot( input );
+		steps.push_back( Step( Step::SUM, nullptr, processedSlot, summingSlot ) );
+	}
+
+	steps[beginStep].mIndex = steps.size();
+	steps.push_back( Step( Step::SUM_END, node, summingSlot, internalSlot ) );
+
+	mSummingNodesInProgress.erase( node );
+}
+
+void RenderGraph::addNode( Node *node )
+{
+	mNodes.push_back( node->shared_from_this() );
+
+	// a Node that has been scheduled keeps its partial buffer matched to its channel count, which may have just changed.
+	if( node->mPartialBuffer.getAllocatedSize() )
+		node->setupBuffer( &node->mPartialBuffer );
+}
+
+size_t RenderGraph::makeSlot( size_t numChannels, Node *node, bool persistent )
+{
+	mSlots.push_back( Slot( numChannels, node, persistent ) );
+	return mSlots.size() - 1;
+}
+
+// Node's pulled by a Param may be processed before the RenderGraph reaches them, so their results must stay in their own buffer.
+size_t RenderGraph::getInternalSlot( Node *node )
+{
+	auto slotIt = mInternalSlots.find( node );
+	if( slotIt != mInternalSlots.end() )
+		return slotIt->second;
+
+	size_t result = makeSlot( node->mNumChannels, node, node->mIsPulledByParam );
+	mInternalSlots[node] = result;
+	return result;
+}
+
+// Assigns a Buffer to each slot with a linear scan over the steps. A pooled Buffer is reused by the next slot with the same number of channels
+// once the last step using it has been processed. The most recently freed Buffer is reused first, as it is the most likely to still be in cache.
+void RenderGraph::assignBuffers()
+{
+	for( size_t i = 0; i < mSteps.size(); i++ ) {
+		const Step &step = mSteps[i];
+		markSlotUsed( step.mBufferSlot, i );
+		markSlotUsed( step.mDestSlot, i );
+
+		// jobs are processed concurrently, so all of their buffers are in use for the duration of the PARALLEL step.
+		if( step.mType == Step::PARALLEL ) {
+			for( size_t jobIndex = step.mIndex; jobIndex < step.mIndex + step.mCount; jobIndex++ ) {
+				for( const Step &jobStep : mJobs[jobIndex]->mSteps ) {
+					markSlotUsed( jobStep.mBufferSlot, i );
+					markSlotUsed( jobStep.mDestSlot, i );
+				}
+			}
+		}
+	}
+
+	const size_t bytesPerChannel = mFramesPerBlock * sizeof( float );
+
+	vector<size_t> pooledSlots;
+	for( size_t i = 0; i < mSlots.size(); i++ ) {
+		Slot &slot = mSlots[i];
+		if( slot.mFirstStep == NO_SLOT )
+			continue;
+
+		mNumBufferSlots++;
+		mNumBytesUnpooled += slot.mNumChannels * bytesPerChannel;
+
+		if( slot.mPersistent ) {
+			slot.mNode->setupInternalBuffer();
+			slot.mBuffer = &slot.mNode->mInternalBuffer;
+
+			mNumBuffersUsed++;
+			mNumBytesPooled += slot.mNumChannels * bytesPerChannel;
+		}
+		else
+			pooledSlots.push_back( i );
+	}
+
+	sort( pooledSlots.begin(), pooledSlots.end(), [this]( size_t a, size_t b ) { return mSlots[a].mFirstStep < mSlots[b].mFirstStep; } );
+
+	typedef pair<size_t, size_t> LastStepAndSlot;
+	priority_queue<LastStepAndSlot, vector<LastStepAndSlot>, greater<LastStepAndSlot> > activeSlots;
+	map<size_t, vector<size_t> > freePoolIndices;	// keyed by number of channels
+	map<size_t, size_t> numPoolIndices;
+
+	for( size_t slotIndex : pooledSlots ) {
+		Slot &slot = mSlots[slotIndex];
+
+		while( ! activeSlots.empty() && activeSlots.top().first < slot.mFirstStep ) {
+			const Slot &expiredSlot = mSlots[activeSlots.top().second];
+			freePoolIndices[expiredSlot.mNumChannels].push_back( expiredSlot.mPoolIndex );
+			activeSlots.pop();
+		}
+
+		auto &freeIndices = freePoolIndices[slot.mNumChannels];
+		if( freeIndices.empty() )
+			slot.mPoolIndex = numPoolIndices[slot.mNumChannels]++;
+		else {
+			slot.mPoolIndex = freeIndices.back();
+			freeIndices.pop_back();
+		}
+
+		slot.mBuffer = mBufferPool->getBuffer( slot.mNumChannels, slot.mPoolIndex );
+		activeSlots.push( make_pair( slot.mLastStep, slotIndex ) );
+	}
+
+	for( const auto &poolIndices : numPoolIndices ) {
+		mNumBuffersUsed += poolIndices.second;
+		mNumBytesPooled += poolIndices.second * poolIndices.first * bytesPerChannel;
+	}
+
+	resolveBuffers( mSteps );
+	for( auto &job : mJobs )
+		resolveBuffers( job->mSteps );
+
+	mBufferSilent.resize( mBufferIds.size(), false );
+
+	// A Node's own buffer may be written to by Node::pullInputs() or read by the device, unless it is only used to carry a cycle over
+	// to the next block, so in general its silent flag can't be trusted from one block to the next.
+	for( const Slot &slot : mSlots ) {
+		if( slot.mPersistent && slot.mFirstStep != NO_SLOT && ( ! slot.mInCycle || slot.mNode->mIsPulledByParam ) )
+			mUnownedBufferIds.push_back( mBufferIds.at( slot.mBuffer ) );
+	}
+}
+
+void RenderGraph::markSlotUsed( size_t slot, size_t stepIndex )
+{
+	if( slot == NO_SLOT )
+		return;
+
+	mSlots[slot].mFirstStep = min( mSlots[slot].mFirstStep, stepIndex );
+	mSlots[slot].mLastStep = max( mSlots[slot].mLastStep, stepIndex );
+}
+
+void RenderGraph::resolveBuffers( vector<Step> &steps )
+{
+	for( Step &step : steps ) {
+		step.mBuffer = step.mBufferSlot != NO_SLOT ? mSlots[step.mBufferSlot].mBuffer : nullptr;
+		step.mDest = step.mDestSlot != NO_SLOT ? mSlots[step.mDestSlot].mBuffer : nullptr;
+		step.mBufferId = getBufferId( step.mBuffer );
+		step.mDestId = getBufferId( step.mDest );
+	}
+}
+
+// Slots that share a pooled Buffer also share its silent flag, since the flag describes what the Buffer currently contains.
+size_t RenderGraph::getBufferId( Buffer *buffer )
+{
+	if( ! buffer )
+		return 0;
+
+	auto idIt = mBufferIds.find( buffer );
+	if( idIt != mBufferIds.end() )
+		return idIt->second;
+
+	size_t result = mBufferIds.size();
+	mBufferIds[buffer] = result;
+	return result;
+}
+
+// An input can be processed on another thread if nothing outside of it reads from or writes to the Node's it contains, which is
+// the case when every Node has exactly one output. Node's that support cycles are excluded, as they are usually part of one.
+bool RenderGraph::isIndependentTree( Node *input, const Node *summingNode )
+{
+	if( input == summingNode || input->supportsCycles() || input->mOutputs.size() != 1 )
+		return false;
+
+	for( auto &in : input->mInputs ) {
+		if( ! isIndependentTree( in.second.get(), summingNode ) )
+			return false;
+	}
+
+	return true;
+}
+
+void RenderGraph::enableProfiling()
+{
+	for( const NodeRef &node : mNodes ) {
+		if( ! node->mProfiler )
+			node->mProfiler.reset( new NodeProfiler );
+	}
+
+	mProfilingEnabled = true;
+}
+
+size_t RenderGraph::getNumSteps() const
+{
+	size_t result = mSteps.size();
+	for( const auto &job : mJobs )
+		result += job->mSteps.size();
+
+	return result;
+}
+
+bool RenderGraph::contains( const Node *node ) const
+{
+	for( const auto &compiledNode : mNodes ) {
+		if( compiledNode.get() == node )
+			return true;
+	}
+
+	return false;
+}
+
+bool RenderGraph::references( const Buffer *buffer ) const
+{
+	auto stepReferences = [buffer]( const Step &step ) {
+		return step.mBuffer == buffer || step.mDest == buffer || ( step.mNode && &step.mNode->mPartialBuffer == buffer );
+	};
+
+	if( any_of( mSteps.begin(), mSteps.end(), stepReferences ) )
+		return true;
+
+	for( const auto &job : mJobs ) {
+		if( any_of( job->mSteps.begin(), job->mSteps.end(), stepReferences ) )
+			return true;
+	}
+
+	return false;
+}
+
+void RenderGraph::process( uint64_t numProcessedFrames )
+{
+	CI_AUDIO_REALTIME_SCOPE();
+
+	mNumProcessedFrames = numProcessedFrames;
+
+	for( size_t bufferId : mUnownedBufferIds )
+		mBufferSilent[bufferId] = false;
+
+	processSteps( mSteps );
+}
+
+void RenderGraph::processJob( size_t jobIndex )
+{
+	CI_AUDIO_REALTIME_SCOPE();
+
+	processSteps( mJobs[jobIndex]->mSteps );
+}
+
+void RenderGraph::processSteps( const vector<Step> &steps )
+{
+	const size_t numSteps = steps.size();
+	for( size_t i = 0; i < numSteps; i++ ) {
+		const Step &step = steps[i];
+		Node *node = step.mNode;
+
+		switch( step.mType ) {
+			case Step::PROCESS_INPUT:
+				if( hasScheduledEvent( node ) ) {
+					processScheduled( node, step.mBuffer, true );
+					mBufferSilent[step.mBufferId] = false;
+				}
+				// if disabled, get rid of any previously processsed samples.
+				else if( node->mEnabled ) {
+					processNode( node, step.mBuffer );
+					mBufferSilent[step.mBufferId] = false;
+				}
+				else if( ! mBufferSilent[step.mBufferId] ) {
+					step.mBuffer->zero();
+					mBufferSilent[step.mBufferId] = true;
+				}
+				break;
+			case Step::PROCESS:
+				if( hasScheduledEvent( node ) ) {
+					processScheduled( node, step.mBuffer, false );
+					mBufferSilent[step.mBufferId] = false;
+				}
+				else if( node->mEnabled && ! isAsleep( node, step.mBufferId ) ) {
+					processNode( node, step.mBuffer );
+					mBufferSilent[step.mBufferId] = false;
+				}
+				break;
+			case Step::MIX:
+				mixSilent( step );
+				break;
+			case Step::SUM_BEGIN:
+				// the Node may have already been pulled this block by a Param processor.
+				if( node->mLastProcessedFrame == mNumProcessedFrames ) {
+					i = step.mIndex;
+					break;
+				}
+				node->mLastProcessedFrame = mNumProcessedFrames;
+				if( ! mBufferSilent[step.mBufferId] ) {
+					step.mBuffer->zero();
+					mBufferSilent[step.mBufferId] = true;
+				}
+				break;
+			case Step::SUM:
+				if( ! mBufferSilent[step.mBufferId] ) {
+					dsp::sumBuffers( step.mBuffer, step.mDest );
+					mBufferSilent[step.mDestId] = false;
+				}
+				break;
+			case Step::SUM_END:
+				if( hasScheduledEvent( node ) ) {
+					processScheduled( node, step.mBuffer, false );
+					mBufferSilent[step.mBufferId] = false;
+				}
+				else if( node->mEnabled && ! isAsleep( node, step.mBufferId ) ) {
+					processNode( node, step.mBuffer );
+					mBufferSilent[step.mBufferId] = false;
+				}
+
+				// copy summed buffer back to internal so downstream can get it.
+				mixSilent( step );
+				break;
+			case Step::PARALLEL:
+				mRenderPool->run( this, step.mIndex, step.mIndex + step.mCount );
+				break;
+			default:
+				CI_ASSERT_NOT_REACHABLE();
+		}
+	}
+}
+
+void RenderGraph::processNodeProfiled( Node *node, Buffer *buffer )
+{
+	auto begin = chrono::steady_clock::now();
+	node->process( buffer );
+	auto end = chrono::steady_clock::now();
+
+	node->mProfiler->record( (uint64_t)chrono::duration_cast<chrono::nanoseconds>( end - begin ).count() );
+}
+
+// Returns whether the input in \a inputBufferId has been silent for longer than the Node's tail, in which case its output is also silent
+// and it does not need to be processed. Starts or resets the Node's silence count as necessary.
+bool RenderGraph::isAsleep( Node *node, size_t inputBufferId )
+{
+	if( ! mBufferSilent[inputBufferId] ) {
+		node->mSilentSinceFrame = numeric_limits<uint64_t>::max();
+		return false;
+	}
+
+	if( node->mSilentSinceFrame > mNumProcessedFrames )
+		node->mSilentSinceFrame = mNumProcessedFrames;
+
+	double tailSeconds = node->getTailSeconds();
+	if( tailSeconds == numeric_limits<double>::infinity() )
+		return false;
+
+	uint64_t tailFrames = (uint64_t)ceil( tailSeconds * mSampleRate );
+	return mNumProcessedFrames - node->mSilentSinceFrame >= tailFrames;
+}
+
+// Processes \a buffer in segments, applying each start or stop scheduled within this block at its exact frame. An input Node outputs
+// silence while disabled, any other Node passes its input through.
+void RenderGraph::processScheduled( Node *node, Buffer *buffer, bool isInput )
+{
+	const uint64_t blockEnd = mNumProcessedFrames + mFramesPerBlock;
+
+	size_t segmentBegin = 0;
+	while( true ) {
+		uint64_t eventFrame = node->getNextScheduledFrame();
+		if( eventFrame >= blockEnd )
+			break;
+
+		// events that were scheduled for a frame that has already passed are applied at the start of this block.
+		size_t segmentEnd = size_t( max( eventFrame, mNumProcessedFrames ) - mNumProcessedFrames );
+		processSegment( node, buffer, segmentBegin, segmentEnd, isInput );
+		segmentBegin = max( segmentBegin, segmentEnd );
+
+		node->applyScheduledEvent( blockEnd );
+	}
+
+	processSegment( node, buffer, segmentBegin, mFramesPerBlock, isInput );
+}
+
+void RenderGraph::processSegment( Node *node, Buffer *buffer, size_t beginFrame, size_t endFrame, bool isInput )
+{
+	if( beginFrame >= endFrame )
+		return;
+
+	if( ! node->mEnabled ) {
+		if( isInput )
+			buffer->zero( beginFrame, endFrame - beginFrame );
+		return;
+	}
+
+	if( beginFrame == 0 && endFrame == mFramesPerBlock ) {
+		processNode( node, buffer );
+		return;
+	}
+
+	// the partial buffer was sized for the Node when it was scheduled, it only needs to be shortened to the length of the segment.
+	BufferDynamic *partialBuffer = &node->mPartialBuffer;
+	CI_ASSERT( partialBuffer->getNumChannels() == buffer->getNumChannels() );
+
+	size_t numFrames = endFrame - beginFrame;
+	partialBuffer->setNumFrames( numFrames );
+
+	if( ! isInput )
+		partialBuffer->copyOffset( *buffer, numFrames, 0, beginFrame );
+
+	processNode( node, partialBuffer );
+	buffer->copyOffset( *partialBuffer, numFrames, beginFrame, 0 );
+}
+
+// Mixes mBuffer into mDest, or makes sure mDest is zero'ed if mBuffer is silent.
+void RenderGraph::mixSilent( const Step &step )
+{
+	if( ! mBufferSilent[step.mBufferId] ) {
+		dsp::mixBuffers( step.mBuffer, step.mDest );
+		mBufferSilent[step.mDestId] = false;
+	}
+	else if( ! mBufferSilent[step.mDestId] ) {
+		step.mDest->zero();
+		mBufferSilent[step.mDestId] = true;
+	}
+}
+
+} } // namespace cinder::audio2
@@ -0,0 +1,205 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/audio2/Node.h"
+#include "cinder/audio2/RenderBufferPool.h"
+#include "cinder/audio2/RenderPool.h"
+#include "cinder/audio2/RealtimeCheck.h"
+
+#include <boost/noncopyable.hpp>
+
+#include <map>
+#include <set>
+#include <vector>
+
+namespace cinder { namespace audio2 {
+
+//! \brief A flattened, topologically sorted representation of a Context's Node graph, which is what gets processed on the audio thread.
+//!
+//! The graph is compiled on construction by walking the Node's in the same order that they would be pulled recursively, recording a
+//! linear list of steps with the Buffer each one operates on. Processing is then a single loop over that list, with no recursion, map
+//! iteration or Context lookups. A RenderGraph is immutable once compiled, it is rebuilt on a non-audio thread whenever connections
+//! change and then published to the audio thread by the Context. It holds a reference to each compiled Node, keeping them alive
+//! for as long as the audio thread may be processing them.
+//!
+//! When compiled with a RenderPool, the inputs of a summing Node that form independent trees (every Node in them has exactly one
+//! output) are compiled into separate jobs, which are processed in parallel into their own Buffer's and then summed in order.
+//!
+//! Summing Node's, parallel jobs and auto-pulled Node's do not own the Buffer's they are processed with. Each Buffer is recorded as
+//! a slot, and once the graph is compiled, slots whose steps do not overlap are assigned the same Buffer from a RenderBufferPool,
+//! in the same way that a register allocator shares registers between variables. Slots that must keep their contents between blocks,
+//! such as a Node in a feedback cycle or the NodeOutput's, use the Node's own Buffer.
+//!
+//! Each Buffer also has a silent flag, which is set when it is known to contain only zeros (ex. it was zero'ed for a disabled Node). The flag
+//! propagates through mixing and summing, and a Node whose input has been silent for longer than its Node::getTailSeconds() is not
+//! processed, leaving its output silent. In this way idle parts of the graph, such as stopped voices, stop costing any processing.
+//!
+//! When a Node has a start or stop scheduled within the current block (see Node::start( double when )), it is processed in segments
+//! split at the scheduled frames, so that its enabled state changes on the exact frame.
+//!
+//! If enableProfiling() is called before the RenderGraph is published, each process() call is timed and recorded in the Node's NodeProfiler.
+class RenderGraph : public boost::noncopyable, private RenderPool::Batch {
+  public:
+	//! Compiles the graph terminating at \a output, followed by each of \a autoPulledNodes.
+	//! If \a renderPool is provided, independent inputs to summing Node's are processed on its threads. Buffer's are assigned from
+	//! \a bufferPool, or from a pool owned by this RenderGraph if none is provided.
+	RenderGraph( const NodeRef &output, const std::set<NodeRef> &autoPulledNodes, size_t framesPerBlock, const RenderPoolRef &renderPool = RenderPoolRef(),
+					const RenderBufferPoolRef &bufferPool = RenderBufferPoolRef() );
+
+	//! Processes one block of audio for all compiled Node's. \a numProcessedFrames is used to ensure summing Node's are only processed once per block.
+	void process( uint64_t numProcessedFrames );
+
+	//! Returns the number of steps that are performed each block, including those within parallel jobs.
+	size_t getNumSteps() const;
+	//! Returns the number of jobs that are processed in parallel each block, or 0 if none are.
+	size_t getNumParallelJobs() const	{ return mJobs.size(); }
+	//! Allocates a NodeProfiler for each compiled Node that doesn't have one and times all process() calls from then on.
+	//! \note Must be called on a non-audio thread, before the RenderGraph is published.
+	void enableProfiling();
+	//! Returns whether process() calls are timed.
+	bool isProfilingEnabled() const			{ return mProfilingEnabled; }
+
+	//! Returns the Node's processed by this RenderGraph, in the order they are first processed.
+	const std::vector<NodeRef>&	getNodes() const	{ return mNodes; }
+	//! Returns whether \a node is processed by this RenderGraph.
+	bool contains( const Node *node ) const;
+	//! Returns whether \a buffer is read from or written to by this RenderGraph.
+	bool references( const Buffer *buffer ) const;
+
+	//! Returns the number of distinct Buffer's processed, which is the number each Node would own without pooling.
+	size_t getNumBufferSlots() const		{ return mNumBufferSlots; }
+	//! Returns the number of Buffer's that are actually used, pooled Buffer's plus those owned by Node's.
+	size_t getNumBuffersUsed() const		{ return mNumBuffersUsed; }
+	//! Returns the number of bytes that the Buffer's processed would use if each Node owned its own.
+	size_t getNumBytesUnpooled() const		{ return mNumBytesUnpooled; }
+	//! Returns the number of bytes used by the Buffer's that are actually processed, pooled Buffer's plus those owned by Node's.
+	size_t getNumBytesPooled() const		{ return mNumBytesPooled; }
+
+  private:
+	static const size_t NO_SLOT = size_t( -1 );
+
+	struct Step {
+		enum Type {
+			PROCESS_INPUT,	// Node has no inputs and processes in-place, mBuffer is zeroed if it is disabled
+			PROCESS,		// Node processes mBuffer in-place
+			MIX,			// mBuffer is mixed into mDest
+			SUM_BEGIN,		// summing begins for Node, mBuffer is its summing buffer. Skips to mIndex if already processed this block.
+			SUM,			// mBuffer is summed into mDest
+			SUM_END,		// Node processes the summing buffer mBuffer, which is then mixed into its internal buffer mDest
+			PARALLEL		// jobs [mIndex, mIndex + mCount) are processed on the RenderPool
+		};
+
+		Step( Type type, Node *node, size_t bufferSlot, size_t destSlot = NO_SLOT )
+			: mType( type ), mNode( node ), mBuffer( nullptr ), mDest( nullptr ), mBufferId( 0 ), mDestId( 0 ), mIndex( 0 ), mCount( 0 ),
+				mBufferSlot( bufferSlot ), mDestSlot( destSlot )
+		{}
+
+		Type	mType;
+		Node*	mNode;
+		Buffer*	mBuffer;
+		Buffer*	mDest;
+		size_t	mBufferId, mDestId;		// indices of mBuffer and mDest in mBufferSilent
+		size_t	mIndex, mCount;
+		size_t	mBufferSlot, mDestSlot;	// only used while compiling, to assign mBuffer and mDest
+	};
+
+	// An independent input of a summing Node. mResultSlot holds the processed input, which is mBufferSlot if it processes in-place.
+	struct Job {
+		std::vector<Step>	mSteps;
+		size_t				mBufferSlot, mResultSlot;
+	};
+
+	// A Buffer that steps read from or write to. mFirstStep and mLastStep are the range of top-level steps that use it, steps within a job
+	// count as their PARALLEL step. mNode is set if this is a summing Node's internal buffer, which is used directly when mPersistent.
+	// mInCycle is set if the buffer is only written to by this RenderGraph and carries over to the next block.
+	struct Slot {
+		Slot( size_t numChannels, Node *node, bool persistent )
+			: mNumChannels( numChannels ), mNode( node ), mPersistent( persistent ), mInCycle( false ), mFirstStep( NO_SLOT ), mLastStep( 0 ),
+				mPoolIndex( 0 ), mBuffer( nullptr )
+		{}
+
+		size_t	mNumChannels;
+		Node*	mNode;
+		bool	mPersistent, mInCycle;
+		size_t	mFirstStep, mLastStep;
+		size_t	mPoolIndex;
+		Buffer*	mBuffer;
+	};
+
+	void compile( Node *node, size_t inPlaceSlot, std::vector<Step> &steps, bool canParallelize );
+	void compileSumming( Node *node, std::vector<Step> &steps, bool canParallelize );
+	void addNode( Node *node );
+	size_t makeSlot( size_t numChannels, Node *node = nullptr, bool persistent = false );
+	size_t getInternalSlot( Node *node );
+	void assignBuffers();
+	void markSlotUsed( size_t slot, size_t stepIndex );
+	void resolveBuffers( std::vector<Step> &steps );
+	size_t getBufferId( Buffer *buffer );
+
+	void processSteps( const std::vector<Step> &steps );
+	void processNode( Node *node, Buffer *buffer )
+	{
+		CI_AUDIO_REALTIME_NODE( node );
+
+		if( mProfilingEnabled )
+			processNodeProfiled( node, buffer );
+		else
+			node->process( buffer );
+	}
+	void processNodeProfiled( Node *node, Buffer *buffer );
+	bool isAsleep( Node *node, size_t inputBufferId );
+	bool hasScheduledEvent( const Node *node ) const	{ return node->getNextScheduledFrame() < mNumProcessedFrames + mFramesPerBlock; }
+	void processScheduled( Node *node, Buffer *buffer, bool isInput );
+	void processSegment( Node *node, Buffer *buffer, size_t beginFrame, size_t endFrame, bool isInput );
+	void mixSilent( const Step &step );
+	void processJob( size_t jobIndex ) override;
+
+	static bool isIndependentTree( Node *input, const Node *summingNode );
+
+	std::vector<Step>							mSteps;
+	std::vector<std::unique_ptr<Job> >			mJobs;
+	std::vector<NodeRef>						mNodes;
+	RenderPoolRef								mRenderPool;
+	RenderBufferPoolRef							mBufferPool;
+	size_t										mFramesPerBlock, mSampleRate;
+	uint64_t									mNumProcessedFrames;
+	bool										mProfilingEnabled;
+
+	// One flag per distinct Buffer, set when it contains only zeros. The flags of Buffer's that may also be written to outside of
+	// the RenderGraph, listed in mUnownedBufferIds, are cleared at the start of each block.
+	std::vector<char>							mBufferSilent;
+	std::vector<size_t>							mUnownedBufferIds;
+
+	size_t										mNumBufferSlots, mNumBuffersUsed, mNumBytesUnpooled, mNumBytesPooled;
+
+	// only used while compiling
+	std::vector<Slot>							mSlots;
+	std::map<Node *, size_t>					mInternalSlots;
+	std::map<Buffer *, size_t>					mBufferIds;
+	std::set<Node *>							mCompiledSummingNodes, mSummingNodesInProgress;
+};
+
+} } // namespace cinder::audio2
@@ -0,0 +1,199 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/audio2/RenderPool.h"
+#include "cinder/audio2/CinderAssert.h"
+#include "cinder/audio2/Debug.h"
+
+#include "cinder/Cinder.h"
+
+#if defined( CINDER_MSW )
+	#include <windows.h>
+#else
+	#include <pthread.h>
+	#include <sched.h>
+	#if defined( __linux__ )
+		#include <sys/resource.h>
+	#endif
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <functional>
+
+using namespace std;
+
+namespace cinder { namespace audio2 {
+
+namespace {
+
+// number of times an idle worker checks for a new batch before going to sleep.
+const size_t WORKER_SPIN_COUNT = 10000;
+
+void setCurrentThreadRealTimePriority()
+{
+#if defined( CINDER_MSW )
+	if( ! ::SetThreadPriority( ::GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL ) )
+		CI_LOG_V( "failed to set worker thread priority." );
+#else
+	sched_param param;
+	param.sched_priority = sched_get_priority_max( SCHED_FIFO );
+	int result = pthread_setschedparam( pthread_self(), SCHED_FIFO, &param );
+
+#if defined( __linux__ )
+	// without CAP_SYS_NICE, Linux only allows priorities up to RLIMIT_RTPRIO, which is 0 unless raised, ex. for the audio group in /etc/security/limits.conf.
+	rlimit limit;
+	if( result == EPERM && getrlimit( RLIMIT_RTPRIO, &limit ) == 0 && limit.rlim_cur > 0 ) {
+		param.sched_priority = int( min<rlim_t>( limit.rlim_cur, param.sched_priority ) );
+		result = pthread_setschedparam( pthread_self(), SCHED_FIFO, &param );
+	}
+#endif
+
+	if( result != 0 )
+		CI_LOG_V( "failed to set worker thread priority: " << strerror( result ) );
+#endif
+}
+
+} // anonymous namespace
+
+RenderPool::RenderPool( size_t numThreads )
+	: mNumQueues( numThreads + 1 ), mBatch( nullptr ), mNumJobsRemaining( 0 ), mGeneration( 0 ), mNumActiveWorkers( 0 ), mQuit( false )
+{
+	mQueues.reset( new Queue[mNumQueues] );
+
+	for( size_t i = 0; i < numThreads; i++ )
+		mThreads.emplace_back( bind( &RenderPool::workerLoop, this, i ) );
+}
+
+RenderPool::~RenderPool()
+{
+	mQuit = true;
+	mWakeCondition.notify_all();
+
+	for( auto &thread : mThreads )
+		thread.join();
+}
+
+void RenderPool::run( Batch *batch, size_t jobBegin, size_t jobEnd )
+{
+	CI_ASSERT( jobBegin <= jobEnd );
+
+	size_t numJobs = jobEnd - jobBegin;
+	if( ! numJobs )
+		return;
+
+	// Make the generation odd so that workers don't start on the queues while they are being filled, then wait for any that
+	// are still leaving the previous batch. They can only find empty queues, so this is brief.
+	mGeneration++;
+	while( mNumActiveWorkers )
+		;
+
+	mBatch = batch;
+	mNumJobsRemaining = numJobs;
+
+	size_t jobsPerQueue = numJobs / mNumQueues;
+	size_t remainder = numJobs % mNumQueues;
+	size_t job = jobBegin;
+	for( size_t i = 0; i < mNumQueues; i++ ) {
+		size_t count = jobsPerQueue + ( i < remainder ? 1 : 0 );
+		mQueues[i].mNext = job;
+		mQueues[i].mEnd = job + count;
+		job += count;
+	}
+
+	mGeneration++;
+
+	// the mutex is not locked here, so a worker that is just going to sleep may miss this. It then wakes on its timeout,
+	// in the meantime its queue is stolen by the other threads.
+	mWakeCondition.notify_all();
+
+	// the calling thread owns the last queue.
+	processJobs( mNumQueues - 1 );
+
+	// any remaining jobs are being processed by workers that have already claimed them.
+	while( mNumJobsRemaining )
+		;
+}
+
+void RenderPool::workerLoop( size_t queueIndex )
+{
+	setCurrentThreadRealTimePriority();
+
+	uint64_t lastGeneration = 0;
+	auto isBatchAvailable = [&] {
+		uint64_t generation = mGeneration;
+		return ( generation & 1 ) == 0 && generation != lastGeneration;
+	};
+
+	while( ! mQuit ) {
+		// see run() for how mNumActiveWorkers and the generation synchronize.
+		mNumActiveWorkers++;
+		uint64_t generation = mGeneration;
+		bool available = ( generation & 1 ) == 0 && generation != lastGeneration;
+		if( available ) {
+			lastGeneration = generation;
+			processJobs( queueIndex );
+		}
+		mNumActiveWorkers--;
+
+		if( available )
+			continue;
+
+		// batches usually arrive once per block, so spin for a short while before sleeping.
+		bool woken = false;
+		for( size_t i = 0; i < WORKER_SPIN_COUNT; i++ ) {
+			if( isBatchAvailable() || mQuit ) {
+				woken = true;
+				break;
+			}
+		}
+
+		if( ! woken ) {
+			unique_lock<mutex> lock( mWakeMutex );
+			mWakeCondition.wait_for( lock, chrono::milliseconds( 1 ), [&] { return isBatchAvailable() || mQuit; } );
+		}
+	}
+}
+
+void RenderPool::processJobs( size_t queueIndex )
+{
+	Batch *batch = mBatch;
+
+	// drain our own queue first, then steal from the others.
+	for( size_t i = 0; i < mNumQueues; i++ ) {
+		Queue &queue = mQueues[( queueIndex + i ) % mNumQueues];
+		while( true ) {
+			size_t job = queue.mNext++;
+			if( job >= queue.mEnd )
+				break;
+
+			batch->processJob( job );
+			mNumJobsRemaining--;
+		}
+	}
+}
+
+} } // namespace cinder::audio2
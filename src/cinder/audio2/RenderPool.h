@@ -0,0 +1,95 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include <boost/noncopyable.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cinder { namespace audio2 {
+
+typedef std::shared_ptr<class RenderPool>		RenderPoolRef;
+
+//! \brief A pool of pre-spawned worker threads that help the audio thread process independent parts of a RenderGraph.
+//!
+//! Jobs are split into one queue per thread, each thread drains its own queue and then steals from the others. run() is lock-free
+//! and does not allocate: workers are woken without holding a mutex and the calling thread processes jobs alongside them, so a
+//! late worker only costs parallelism, never correctness.
+class RenderPool : public boost::noncopyable {
+  public:
+	//! Interface for a set of jobs that can be processed in any order, on any thread.
+	class Batch {
+	  public:
+		virtual ~Batch() {}
+		//! Processes the job at \a jobIndex.
+		virtual void processJob( size_t jobIndex ) = 0;
+	};
+
+	//! Spawns \a numThreads worker threads, which are given real-time priority where the platform allows it. On Linux and other POSIX platforms
+	//! this is SCHED_FIFO, which needs CAP_SYS_NICE or an RLIMIT_RTPRIO above 0 on Linux, and the workers run at normal priority otherwise.
+	RenderPool( size_t numThreads );
+	~RenderPool();
+
+	//! Returns the number of worker threads, which does not include the thread calling run().
+	size_t getNumThreads() const	{ return mThreads.size(); }
+
+	//! Processes jobs [jobBegin, jobEnd) of \a batch across the worker threads and the calling thread, returning once all have completed.
+	//! \note Expected to be called on the audio thread, from only one thread at a time.
+	void run( Batch *batch, size_t jobBegin, size_t jobEnd );
+
+  private:
+	// padded so that threads claiming jobs from different queues do not share cache lines.
+	struct Queue {
+		Queue() : mNext( 0 ), mEnd( 0 )	{}
+
+		std::atomic<size_t>	mNext;
+		size_t				mEnd;
+		char				mPadding[64];
+	};
+
+	void workerLoop( size_t queueIndex );
+	void processJobs( size_t queueIndex );
+
+	std::vector<std::thread>	mThreads;
+	std::unique_ptr<Queue[]>	mQueues;		// one per worker, plus one for the thread calling run()
+	size_t						mNumQueues;
+
+	Batch*						mBatch;
+	std::atomic<size_t>			mNumJobsRemaining;
+	std::atomic<uint64_t>		mGeneration;	// odd while run() is setting up a batch, incremented to even once it is available to workers
+	std::atomic<size_t>			mNumActiveWorkers;
+	std::atomic<bool>			mQuit;
+
+	// only used to let idle workers sleep, run() never locks it.
+	std::mutex					mWakeMutex;
+	std::condition_variable		mWakeCondition;
+};
+
+} } // namespace cinder::audio2
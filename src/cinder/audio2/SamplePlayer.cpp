@@ -94,12 +94,12 @@ size_t SamplePlayer::getNumSeconds() const
 // ----------------------------------------------------------------------------------------------------
 
 BufferPlayer::BufferPlayer( const Format &format )
-	: SamplePlayer( format )
+	: SamplePlayer( format ), mProcessBuffer( nullptr )
 {
 }
 
 BufferPlayer::BufferPlayer( const BufferRef &buffer, const Format &format )
-	: SamplePlayer( format ), mBuffer( buffer )
+	: SamplePlayer( format ), mBuffer( buffer ), mProcessBuffer( buffer.get() )
 {
 	mNumFrames = mLoopEnd = mBuffer->getNumFrames();
 
@@ -135,25 +135,36 @@ void BufferPlayer::seek( size_t readPositionFrames )
 
 void BufferPlayer::setBuffer( const BufferRef &buffer )
 {
-	lock_guard<mutex> lock( getContext()->getMutex() );
+	auto ctx = getContext();
+	{
+		lock_guard<mutex> lock( ctx->getMutex() );
 
-	bool enabled = mEnabled;
-	if( mEnabled )
-		stop();
+		bool enabled = mEnabled;
+		if( mEnabled )
+			stop();
 
-	if( mNumChannels != buffer->getNumChannels() ) {
-		setNumChannels( buffer->getNumChannels() );
-		configureConnections();
-	}
+		if( mNumChannels != buffer->getNumChannels() ) {
+			setNumChannels( buffer->getNumChannels() );
+			configureConnections();
+		}
 
-	mBuffer = buffer;
-	mNumFrames = buffer->getNumFrames();
+		// process() may still be reading from the previous buffer, so the Context holds onto it until that is no longer possible.
+		BufferRef previousBuffer = mBuffer;
+		mBuffer = buffer;
+		mProcessBuffer = buffer.get();
+		ctx->deferRelease( previousBuffer );
 
-	if( ! mLoopEnd  || mLoopEnd > mNumFrames )
-		mLoopEnd = mNumFrames;
+		mNumFrames = buffer->getNumFrames();
+
+		if( ! mLoopEnd  || mLoopEnd > mNumFrames )
+			mLoopEnd = mNumFrames;
+
+		if( enabled )
+			start();
+	}
 
-	if( enabled )
-		start();
+	// publish the new graph if the channel count changed
+	ctx->updateRenderGraph();
 }
 
 void BufferPlayer::loadBuffer( const SourceFileRef &sourceFile )
@@ -166,12 +177,15 @@ void BufferPlayer::loadBuffer( const SourceFileRef &sourceFile )
 
 void BufferPlayer::process( Buffer *buffer )
 {
+	const Buffer *sourceBuffer = mProcessBuffer;
+
+	// mNumFrames and mLoopEnd may have been updated for a Buffer that this block does not yet see, so clamp to the one being read.
 	size_t readPos = mReadPos;
 	size_t numFrames = buffer->getNumFrames();
-	size_t readEnd = mLoop ? mLoopEnd.load() : mNumFrames;
+	size_t readEnd = min( mLoop ? mLoopEnd.load() : mNumFrames, sourceBuffer->getNumFrames() );
 	size_t readCount = readEnd < readPos ? 0 : min( readEnd - readPos, numFrames );
 
-	buffer->copyOffset( *mBuffer, readCount, 0, readPos );
+	buffer->copyOffset( *sourceBuffer, readCount, 0, readPos );
 
 	if( readCount < numFrames  ) {
 		// TODO: if looping, copy from mLoopBegin instead of zero'ing
@@ -233,6 +247,12 @@ void FilePlayer::initialize()
 
 	mBufferFramesThreshold = mRingBuffers[0].getSize() / 2;
 
+	// when not running against a real-time clock, the read thread could fall behind and cause underruns, so read on the processing thread instead.
+	if( mIsReadAsync && ! getContext()->isRealTime() ) {
+		CI_LOG_V( "Context is not real-time, disabling async reads." );
+		mIsReadAsync = false;
+	}
+
 	if( mIsReadAsync ) {
 		mAsyncReadShouldQuit = false;
 		mReadThread = unique_ptr<thread>( new thread( bind( &FilePlayer::readAsyncImpl, this ) ) );
@@ -270,10 +290,8 @@ void FilePlayer::seek( size_t readPositionFrames )
 		return;
 	}
 
-	// Synchronize with the mutex that protects the read thread, which is different depending on if
-	// read is async or sync (done on audio thread)
-	mutex &m = mIsReadAsync ? mAsyncReadMutex : getContext()->getMutex();
-	lock_guard<mutex> lock( m );
+	// Synchronize with the read thread, or process() if reading is done on the audio thread.
+	lock_guard<mutex> lock( mReadMutex );
 
 	mIsEof = false;
 	seekImpl( readPositionFrames );
@@ -284,25 +302,35 @@ void FilePlayer::setSourceFile( const SourceFileRef &sourceFile )
 	// update source's samplerate to match context
 	sourceFile->setOutputFormat( getSampleRate(), sourceFile->getNumChannels() );
 
-	lock_guard<mutex> lock( getContext()->getMutex() );
+	auto ctx = getContext();
+	{
+		lock_guard<mutex> lock( ctx->getMutex() );
 
-	bool enabled = mEnabled;
-	if( mEnabled )
-		stop();
+		bool enabled = mEnabled;
+		if( mEnabled )
+			stop();
 
-	if( mNumChannels != sourceFile->getNumChannels() ) {
-		setNumChannels( sourceFile->getNumChannels() );
-		configureConnections();
-	}
+		if( mNumChannels != sourceFile->getNumChannels() ) {
+			setNumChannels( sourceFile->getNumChannels() );
+			configureConnections();
+		}
 
-	mSourceFile = sourceFile;
-	mNumFrames = sourceFile->getNumFrames();
+		{
+			lock_guard<mutex> readLock( mReadMutex );
 
-	if( ! mLoopEnd  || mLoopEnd > mNumFrames )
-		mLoopEnd = mNumFrames;
+			mSourceFile = sourceFile;
+			mNumFrames = sourceFile->getNumFrames();
+		}
+
+		if( ! mLoopEnd  || mLoopEnd > mNumFrames )
+			mLoopEnd = mNumFrames;
 
-	if( enabled )
-		start();
+		if( enabled )
+			start();
+	}
+
+	// publish the new graph if the channel count changed
+	ctx->updateRenderGraph();
 }
 
 uint64_t FilePlayer::getLastUnderrun()
@@ -321,6 +349,13 @@ uint64_t FilePlayer::getLastOverrun()
 
 void FilePlayer::process( Buffer *buffer )
 {
+	// when reading on the audio thread, the source file is modified by seek() and setSourceFile(). Rather than wait for them, output silence this block.
+	unique_lock<mutex> readLock( mReadMutex, defer_lock );
+	if( ! mIsReadAsync && ! readLock.try_lock() ) {
+		buffer->zero();
+		return;
+	}
+
 	size_t numFrames = buffer->getNumFrames();
 	size_t readPos = mReadPos;
 	size_t numReadAvail = mRingBuffers[0].getAvailableRead();
@@ -328,8 +363,10 @@ void FilePlayer::process( Buffer *buffer )
 	if( numReadAvail < mBufferFramesThreshold ) {
 		if( mIsReadAsync )
 			mIssueAsyncReadCond.notify_one();
-		else
+		else {
 			readImpl();
+			numReadAvail = mRingBuffers[0].getAvailableRead();
+		}
 	}
 
 	size_t readCount = std::min( numReadAvail, numFrames );
@@ -359,7 +396,7 @@ void FilePlayer::readAsyncImpl()
 {
 	size_t lastReadPos = mReadPos;
 	while( true ) {
-		unique_lock<mutex> lock( mAsyncReadMutex );
+		unique_lock<mutex> lock( mReadMutex );
 		mIssueAsyncReadCond.wait( lock );
 
 		if( mAsyncReadShouldQuit )
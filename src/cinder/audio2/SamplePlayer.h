@@ -107,18 +107,23 @@ class BufferPlayer : public SamplePlayer {
 
 	virtual void start() override;
 	virtual void stop() override;
+	//! Also exposes start( double when ) and stop( double when ), which would otherwise be hidden by the overrides above.
+	using SamplePlayer::start;
+	using SamplePlayer::stop;
 	virtual void seek( size_t readPositionFrames ) override;
 
 	//! Loads and stores a reference to a Buffer created from the entire contents of \a sourceFile.
 	void loadBuffer( const SourceFileRef &sourceFile );
 
+	//! Replaces the Buffer that is played. Can be called while the BufferPlayer is processing, the previous Buffer is released once the audio thread is done with it.
 	void setBuffer( const BufferRef &buffer );
 	const BufferRef& getBuffer() const	{ return mBuffer; }
 
   protected:
 	virtual void process( Buffer *buffer )	override;
 
-	BufferRef mBuffer;
+	BufferRef				mBuffer;
+	std::atomic<Buffer *>	mProcessBuffer; // the audio thread's view of mBuffer
 };
 
 class FilePlayer : public SamplePlayer {
@@ -130,6 +135,9 @@ class FilePlayer : public SamplePlayer {
 
 	virtual void start() override;
 	virtual void stop() override;
+	//! Also exposes start( double when ) and stop( double when ), which would otherwise be hidden by the overrides above.
+	using SamplePlayer::start;
+	using SamplePlayer::stop;
 	virtual void seek( size_t readPositionFrames ) override;
 
 	bool isReadAsync() const	{ return mIsReadAsync; }
@@ -161,7 +169,7 @@ class FilePlayer : public SamplePlayer {
 	std::atomic<uint64_t>						mLastUnderrun, mLastOverrun;
 
 	std::unique_ptr<std::thread>				mReadThread;
-	std::mutex									mAsyncReadMutex;
+	std::mutex									mReadMutex;		// synchronizes reads from mSourceFile, with the read thread or process() if not async
 	std::condition_variable						mIssueAsyncReadCond;
 	bool										mIsReadAsync, mAsyncReadShouldQuit;
 };
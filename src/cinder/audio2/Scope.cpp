@@ -53,8 +53,6 @@ void Scope::initialize()
 {
 	if( ! mWindowSize )
 		mWindowSize = getFramesPerBlock();
-	else if( ! isPowerOf2( mWindowSize ) )
-		mWindowSize = nextPowerOf2( static_cast<uint32_t>( mWindowSize ) );
 
 	for( size_t ch = 0; ch < mNumChannels; ch++ )
 		mRingBuffers.emplace_back( mWindowSize * mRingBufferPaddingFactor );
@@ -116,8 +114,8 @@ void ScopeSpectral::initialize()
 
 	if( mFftSize < mWindowSize )
 		mFftSize = mWindowSize;
-	if( ! isPowerOf2( mFftSize ) )
-		mFftSize = nextPowerOf2( static_cast<uint32_t>( mFftSize ) );
+
+	mFftSize = dsp::Fft::getNextSupportedSize( mFftSize );
 	
 	mFft = unique_ptr<dsp::Fft>( new dsp::Fft( mFftSize ) );
 	mFftBuffer = audio2::Buffer( mFftSize );
@@ -126,8 +124,6 @@ void ScopeSpectral::initialize()
 
 	if( ! mWindowSize  )
 		mWindowSize = mFftSize;
-	else if( ! isPowerOf2( mWindowSize ) )
-		mWindowSize = nextPowerOf2( static_cast<uint32_t>( mWindowSize ) );
 
 	mWindowingTable = makeAlignedArray<float>( mWindowSize );
 	generateWindow( mWindowType, mWindowingTable.get(), mWindowSize );
@@ -53,7 +53,6 @@ class Scope : public NodeAutoPullable {
 		Format() : mWindowSize( 0 ) {}
 
 		//! Sets the window size, the number of samples that are recorded for one 'window' into the audio signal. Default is the Context's frames-per-block.
-		//! \note will be rounded up to the nearest power of two.
 		Format& windowSize( size_t size )		{ mWindowSize = size; return *this; }
 		//! Returns the window size.
 		size_t getWindowSize() const			{ return mWindowSize; }
@@ -94,7 +93,7 @@ class ScopeSpectral : public Scope {
 	struct Format : public Scope::Format {
 		Format() : Scope::Format(), mFftSize( 0 ), mWindowType( dsp::WindowType::BLACKMAN ) {}
 
-		//! Sets the FFT size, rounded up to the nearest power of 2 greater or equal to \a windowSize. Setting this larger than \a windowSize causes the FFT transform to be 'zero-padded'. Default is the same as windowSize.
+		//! Sets the FFT size, rounded up to the nearest size supported by dsp::Fft (such as a power of 2, or 480) greater or equal to \a windowSize. Setting this larger than \a windowSize causes the FFT transform to be 'zero-padded'. Default is the same as windowSize.
 		//! \note resulting number of output spectral bins is equal to (\a size / 2)
 		Format&     fftSize( size_t size )              { mFftSize = size; return *this; }
 		//! defaults to WindowType::BLACKMAN
@@ -77,7 +77,7 @@ LineOutAudioUnit::LineOutAudioUnit( const DeviceRef &device, const Format &forma
 void LineOutAudioUnit::initialize()
 {
 	// LineOut always needs an internal buffer to deliver to the ouput AU, so force one to be made.
-	setupProcessWithSumming();
+	setupInternalBuffer();
 
 	mRenderData.node = this;
 	mRenderData.context = dynamic_cast<ContextAudioUnit *>( getContext().get() );
@@ -141,19 +141,10 @@ OSStatus LineOutAudioUnit::renderCallback( void *data, ::AudioUnitRenderActionFl
 		return noErr;
 	}
 
-	lock_guard<mutex> lock( renderData->context->getMutex() );
-
-	// verify associated context still exists proceeding, which may not be true if we blocked in ~Context() and were then subsequently deallocated.
-	if( ! renderData->context ) {
-		zeroBufferList( bufferList );
-		return noErr;
-	}
-
 	LineOutAudioUnit *lineOut = static_cast<LineOutAudioUnit *>( renderData->node );
-	lineOut->mInternalBuffer.zero();
 
 	renderData->context->setCurrentTimeStamp( timeStamp );
-	lineOut->pullInputs( &lineOut->mInternalBuffer );
+	lineOut->processGraph();
 
 	// if clip detection is enabled and buffer clipped, silence it
 	if( lineOut->checkNotClipping() )
@@ -61,7 +61,9 @@
 	#include <Accelerate/Accelerate.h>
 #endif
 
+#include <algorithm>
 #include <complex>
+#include <limits>
 
 namespace cinder { namespace audio2 { namespace dsp {
 
@@ -172,6 +174,42 @@ void Biquad::getFrequencyResponse( int nFrequencies, const float *frequency, flo
     }
 }
 
+double Biquad::getTailFrames( double threshold ) const
+{
+    return getTailFrames( mA1, mA2, threshold );
+}
+
+double Biquad::getTailFrames( double a1, double a2, double threshold )
+{
+    // The impulse response decays with the magnitude of the largest pole, which are the roots of z^2 + a1*z + a2.
+    double poleRadius;
+    double discriminant = a1 * a1 - 4 * a2;
+    if( discriminant < 0 )
+        poleRadius = sqrt( a2 );
+    else {
+        double root = sqrt( discriminant );
+        poleRadius = std::max( fabs( -a1 + root ), fabs( -a1 - root ) ) / 2;
+    }
+
+    if( poleRadius >= 1 )
+        return std::numeric_limits<double>::infinity();
+
+    // the output depends on the previous two inputs even without any feedback.
+    if( poleRadius < threshold )
+        return 2;
+
+    return 2 + ceil( log( threshold ) / log( poleRadius ) );
+}
+
+void Biquad::getCoefficients( double *b0, double *b1, double *b2, double *a1, double *a2 ) const
+{
+    *b0 = mB0;
+    *b1 = mB1;
+    *b2 = mB2;
+    *a1 = mA1;
+    *a2 = mA2;
+}
+
 void Biquad::setLowpassParams( double cutoffFreq, double resonance )
 {
 	// Limit cutoff to 0 to 1.
@@ -79,6 +79,12 @@ public:
 
 	//! Filter response at a set of n frequencies. The magnitude and phase response are returned in magResponse and phaseResponse. The phase response is in radians.
     void getFrequencyResponse( int nFrequencies, const float *frequency, float *magResponse, float *phaseResponse );
+	//! Returns the number of frames it takes for the filter's impulse response to decay below \a threshold, or infinity if the filter is unstable.
+	double getTailFrames( double threshold = 0.000001 ) const;
+	//! Returns the number of frames it takes for the impulse response of a biquad with feedback coefficients \a a1 and \a a2 to decay below \a threshold, or infinity if it is unstable.
+	static double getTailFrames( double a1, double a2, double threshold = 0.000001 );
+	//! Returns the normalized coefficients, for the filter y[n] + a1 * y[n-1] + a2 * y[n-2] = b0 * x[n] + b1 * x[n-1] + b2 * x[n-2].
+	void getCoefficients( double *b0, double *b1, double *b2, double *a1, double *a2 ) const;
 
 	//! Resets filter state
     void reset();
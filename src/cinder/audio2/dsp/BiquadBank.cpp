@@ -0,0 +1,152 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/audio2/dsp/BiquadBank.h"
+#include "cinder/audio2/dsp/DspSimd.h"
+#include "cinder/audio2/CinderAssert.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace cinder { namespace audio2 { namespace dsp {
+
+BiquadBank::BiquadBank( size_t numFilters, Precision precision )
+	: mNumFilters( 0 ), mPrecision( precision )
+{
+	setNumFilters( numFilters );
+}
+
+void BiquadBank::setNumFilters( size_t numFilters )
+{
+	mNumFilters = numFilters;
+
+	mCoefficients.assign( 5 * numFilters, 0 );
+	mCoefficientsDouble.assign( 5 * numFilters, 0 );
+	mState.assign( 2 * numFilters, 0 );
+	mStateDouble.assign( 2 * numFilters, 0 );
+	mSources.resize( numFilters );
+	mDests.resize( numFilters );
+
+	// b0 = 1, everything else 0
+	for( size_t i = 0; i < numFilters; i++ )
+		setCoefficients( i, 1, 0, 0, 0, 0 );
+}
+
+void BiquadBank::setPrecision( Precision precision )
+{
+	if( mPrecision == precision )
+		return;
+
+	if( precision == FLOAT )
+		copy( mStateDouble.begin(), mStateDouble.end(), mState.begin() );
+	else
+		copy( mState.begin(), mState.end(), mStateDouble.begin() );
+
+	mPrecision = precision;
+}
+
+void BiquadBank::setCoefficients( size_t index, const Biquad &biquad )
+{
+	double b0, b1, b2, a1, a2;
+	biquad.getCoefficients( &b0, &b1, &b2, &a1, &a2 );
+	setCoefficients( index, b0, b1, b2, a1, a2 );
+}
+
+void BiquadBank::setCoefficients( size_t index, double b0, double b1, double b2, double a1, double a2 )
+{
+	CI_ASSERT( index < mNumFilters );
+
+	const double coefficients[5] = { b0, b1, b2, a1, a2 };
+	for( size_t k = 0; k < 5; k++ ) {
+		mCoefficientsDouble[k * mNumFilters + index] = coefficients[k];
+		mCoefficients[k * mNumFilters + index] = float( coefficients[k] );
+	}
+}
+
+void BiquadBank::getState( size_t index, double *s1, double *s2 ) const
+{
+	CI_ASSERT( index < mNumFilters );
+
+	if( mPrecision == FLOAT ) {
+		*s1 = mState[index];
+		*s2 = mState[mNumFilters + index];
+	}
+	else {
+		*s1 = mStateDouble[index];
+		*s2 = mStateDouble[mNumFilters + index];
+	}
+}
+
+void BiquadBank::setState( size_t index, double s1, double s2 )
+{
+	CI_ASSERT( index < mNumFilters );
+
+	if( mPrecision == FLOAT ) {
+		mState[index] = float( s1 );
+		mState[mNumFilters + index] = float( s2 );
+	}
+	else {
+		mStateDouble[index] = s1;
+		mStateDouble[mNumFilters + index] = s2;
+	}
+}
+
+void BiquadBank::process( const Buffer *source, Buffer *dest )
+{
+	CI_ASSERT( source->getNumChannels() >= mNumFilters && dest->getNumChannels() >= mNumFilters );
+	CI_ASSERT( dest->getNumFrames() >= source->getNumFrames() );
+
+	for( size_t i = 0; i < mNumFilters; i++ ) {
+		mSources[i] = source->getChannel( i );
+		mDests[i] = dest->getChannel( i );
+	}
+
+	process( mSources.data(), mDests.data(), source->getNumFrames() );
+}
+
+void BiquadBank::process( const float *const *sources, float *const *dests, size_t numFrames )
+{
+	process( sources, dests, numFrames, 0, mNumFilters );
+}
+
+void BiquadBank::process( const float *const *sources, float *const *dests, size_t numFrames, size_t firstFilter, size_t numFilters )
+{
+	CI_ASSERT( firstFilter + numFilters <= mNumFilters );
+
+	const SimdKernels &kernels = getSimdKernels();
+
+	if( mPrecision == FLOAT )
+		kernels.biquad( sources, dests, numFrames, numFilters, mNumFilters, mCoefficients.data() + firstFilter, mState.data() + firstFilter );
+	else
+		kernels.biquadDouble( sources, dests, numFrames, numFilters, mNumFilters, mCoefficientsDouble.data() + firstFilter, mStateDouble.data() + firstFilter );
+}
+
+void BiquadBank::reset()
+{
+	fill( mState.begin(), mState.end(), 0.0f );
+	fill( mStateDouble.begin(), mStateDouble.end(), 0.0 );
+}
+
+} } } // namespace cinder::audio2::dsp
@@ -0,0 +1,82 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/audio2/Buffer.h"
+#include "cinder/audio2/dsp/Biquad.h"
+
+#include <vector>
+
+namespace cinder { namespace audio2 { namespace dsp {
+
+//! \brief Runs any number of independent biquad filters, each in its own SIMD lane.
+//!
+//! Each vector instruction advances as many filters as it has lanes, for example 8 filters in single precision with AVX2, by interleaving a few frames
+//! of their channels at a time. Every filter has its own coefficients, so a BiquadBank can filter each channel of multichannel audio, or run a bank of
+//! different filters over one signal. The filters are in transposed direct form II.
+class BiquadBank {
+  public:
+	//! The precision of the filter arithmetic. FLOAT runs twice as many filters per instruction, DOUBLE stays accurate with cutoff frequencies far below the sample rate.
+	enum Precision { DOUBLE, FLOAT };
+
+	BiquadBank( size_t numFilters = 0, Precision precision = DOUBLE );
+
+	//! Sets the number of filters, which pass their input through unchanged until their coefficients are set. Allocates.
+	void		setNumFilters( size_t numFilters );
+	size_t		getNumFilters() const		{ return mNumFilters; }
+	//! Sets the precision of the filter arithmetic. The filter state carries over, so this can be changed between calls to process(). Doesn't allocate.
+	void		setPrecision( Precision precision );
+	Precision	getPrecision() const		{ return mPrecision; }
+
+	//! Sets the coefficients of filter \a index to those of \a biquad, keeping its state.
+	void setCoefficients( size_t index, const Biquad &biquad );
+	//! Sets the coefficients of filter \a index, for the filter y[n] + a1 * y[n-1] + a2 * y[n-2] = b0 * x[n] + b1 * x[n-1] + b2 * x[n-2], keeping its state.
+	void setCoefficients( size_t index, double b0, double b1, double b2, double a1, double a2 );
+
+	//! Returns the two state variables of filter \a index, in transposed direct form II.
+	void getState( size_t index, double *s1, double *s2 ) const;
+	//! Sets the two state variables of filter \a index, ex. to continue from where a filter processed elsewhere left off.
+	void setState( size_t index, double s1, double s2 );
+
+	//! Filters channel i of \a source into channel i of \a dest with filter i, for each filter. \a source and \a dest can be the same Buffer.
+	void process( const Buffer *source, Buffer *dest );
+	//! Filters \a numFrames frames of \a sources[i] into \a dests[i] with filter i, for each filter. A source can be passed for more than one filter.
+	void process( const float *const *sources, float *const *dests, size_t numFrames );
+	//! As above, with only the \a numFilters filters from \a firstFilter, so that \a sources[i] and \a dests[i] are for filter \a firstFilter + i.
+	void process( const float *const *sources, float *const *dests, size_t numFrames, size_t firstFilter, size_t numFilters );
+
+	//! Clears the state of all filters.
+	void reset();
+
+  private:
+	size_t					mNumFilters;
+	Precision				mPrecision;
+	std::vector<float>		mCoefficients, mState;		// laid out as the biquad kernels expect, with a stride of mNumFilters
+	std::vector<double>		mCoefficientsDouble, mStateDouble;
+	std::vector<const float *>	mSources;
+	std::vector<float *>		mDests;
+};
+
+} } } // namespace cinder::audio2::dsp
@@ -22,9 +22,12 @@
 */
 
 #include "cinder/audio2/dsp/Dsp.h"
+#include "cinder/audio2/dsp/DspSimd.h"
 
 #include "cinder/CinderMath.h"
 
+#include <algorithm>
+
 #if defined( CINDER_AUDIO_VDSP )
 	#include <Accelerate/Accelerate.h>
 #endif
@@ -55,6 +58,11 @@ void fill( float value, float *array, size_t length )
 	vDSP_vfill( &value, array, 1, length );
 }
 
+void fillRamp( float valueBegin, float increment, float *array, size_t length )
+{
+	vDSP_vramp( &valueBegin, &increment, array, 1, length );
+}
+
 float sum( const float *array, size_t length )
 {
 	float result;
@@ -105,6 +113,31 @@ void addMul( const float *arrayA, const float *arrayB, float scalar, float *resu
 	vDSP_vasm( const_cast<float *>( arrayA ), 1, const_cast<float *>( arrayB ), 1, &scalar, result, 1, length );
 }
 
+static float maxElement( const float *array, size_t length )
+{
+	float result;
+	vDSP_maxv( array, 1, &result, length );
+	return result;
+}
+
+void mulAdd( const float *array, float scalar, float addend, float *result, size_t length )
+{
+	vDSP_vsmsa( array, 1, &scalar, &addend, result, 1, length );
+}
+
+void mulAddComplex( const float *realA, const float *imagA, const float *realB, const float *imagB, float *realResult, float *imagResult, size_t length )
+{
+	DSPSplitComplex a = { const_cast<float *>( realA ), const_cast<float *>( imagA ) };
+	DSPSplitComplex b = { const_cast<float *>( realB ), const_cast<float *>( imagB ) };
+	DSPSplitComplex result = { realResult, imagResult };
+	vDSP_zvma( &a, 1, &b, 1, &result, 1, &result, 1, length );
+}
+
+void mulRamp( const float *array, float valueBegin, float increment, float *result, size_t length )
+{
+	vDSP_vrampmul( array, 1, &valueBegin, &increment, result, 1, length );
+}
+
 #else // ! defined( CINDER_AUDIO_VDSP )
 
 // from WebKit's applyWindow in RealtimeAnalyser.cpp
@@ -132,71 +165,86 @@ void generateHannWindow( float *window, size_t length )
 	CI_ASSERT( 0 && "not implemented" );
 }
 
+// the following are dispatched to the kernels for the best instruction set that the CPU supports, see DspSimd.cpp.
+
 void fill( float value, float *array, size_t length )
+{
+	getSimdKernels().fill( value, array, length );
+}
+
+// computed from the index rather than accumulated, so that there is no dependency between iterations and the loop vectorizes.
+void fillRamp( float valueBegin, float increment, float *array, size_t length )
 {
 	for( size_t i = 0; i < length; i++ )
-		array[i] = value;
+		array[i] = valueBegin + increment * float( i );
 }
 
 float sum( const float *array, size_t length )
 {
-	float result( 0.0f );
-	for( size_t i = 0; i < length; i++ )
-		result += array[i];
-	return result;
+	return getSimdKernels().sum( array, length );
 }
 
 void add( const float *array, float scalar, float *result, size_t length )
 {
-	for( size_t i = 0; i < length; i++ )
-		result[i] = array[i] + scalar;
+	getSimdKernels().addScalar( array, scalar, result, length );
 }
 
 void add( const float *arrayA, const float *arrayB, float *result, size_t length )
 {
-	for( size_t i = 0; i < length; i++ )
-		result[i] = arrayA[i] + arrayB[i];
+	getSimdKernels().add( arrayA, arrayB, result, length );
 }
 
 void sub( const float *array, float scalar, float *result, size_t length )
 {
-	for( size_t i = 0; i < length; i++ )
-		result[i] = array[i] - scalar;
+	getSimdKernels().addScalar( array, -scalar, result, length );
 }
 
 void sub( const float *arrayA, const float *arrayB, float *result, size_t length )
 {
-	for( size_t i = 0; i < length; i++ )
-		result[i] = arrayA[i] - arrayB[i];
+	getSimdKernels().sub( arrayA, arrayB, result, length );
 }
 
 float rms( const float *array, size_t length )
 {
-	float sumSquared( 0.0f );
-	for( size_t i = 0; i < length; i++ ) {
-		float val = array[i];
-		sumSquared += val * val;
-	}
+	float sumSquared = getSimdKernels().sumSquares( array, length );
 
 	return math<float>::sqrt( sumSquared / (float)length );
 }
 
 void mul( const float *array, float scalar, float *result, size_t length )
 {
-	for( size_t i = 0; i < length; i++ )
-		result[i] = array[i] * scalar;
+	getSimdKernels().mulScalar( array, scalar, result, length );
 }
 
 void mul( const float *arrayA, const float *arrayB, float *result, size_t length )
 {
-	for( size_t i = 0; i < length; i++ )
-		result[i] = arrayA[i] * arrayB[i];
+	getSimdKernels().mul( arrayA, arrayB, result, length );
 }
 
 void addMul( const float *arrayA, const float *arrayB, float scalar, float *result, size_t length )
+{
+	getSimdKernels().addMul( arrayA, arrayB, scalar, result, length );
+}
+
+void mulAdd( const float *array, float scalar, float addend, float *result, size_t length )
+{
+	getSimdKernels().mulAdd( array, scalar, addend, result, length );
+}
+
+void mulAddComplex( const float *realA, const float *imagA, const float *realB, const float *imagB, float *realResult, float *imagResult, size_t length )
+{
+	getSimdKernels().mulAddComplex( realA, imagA, realB, imagB, realResult, imagResult, length );
+}
+
+static float maxElement( const float *array, size_t length )
+{
+	return getSimdKernels().max( array, length );
+}
+
+void mulRamp( const float *array, float valueBegin, float increment, float *result, size_t length )
 {
 	for( size_t i = 0; i < length; i++ )
-		result[i] = ( arrayA[i] + arrayB[i] ) * scalar;
+		result[i] = array[i] * ( valueBegin + increment * float( i ) );
 }
 
 #endif // ! defined( CINDER_AUDIO_VDSP )
@@ -221,6 +269,46 @@ void generateWindow( WindowType windowType, float *window, size_t length )
 	}
 }
 
+// Advances 8 independent lanes by ratio^8, so the inner loop vectorizes. Each chunk restarts from an exact power to bound the rounding drift.
+void fillGeometric( float valueBegin, float ratio, float *array, size_t length )
+{
+	const size_t NUM_LANES = 8;
+	const size_t CHUNK_SIZE = 256;
+
+	float lanePowers[NUM_LANES];
+	double power = 1;
+	for( size_t i = 0; i < NUM_LANES; i++ ) {
+		lanePowers[i] = float( power );
+		power *= ratio;
+	}
+	const float laneRatio = float( power );
+
+	for( size_t chunkBegin = 0; chunkBegin < length; chunkBegin += CHUNK_SIZE ) {
+		const size_t chunkEnd = std::min( chunkBegin + CHUNK_SIZE, length );
+		const float chunkValue = float( valueBegin * std::pow( double( ratio ), double( chunkBegin ) ) );
+
+		float lanes[NUM_LANES];
+		for( size_t i = 0; i < NUM_LANES; i++ )
+			lanes[i] = chunkValue * lanePowers[i];
+
+		size_t i = chunkBegin;
+		for( ; i + NUM_LANES <= chunkEnd; i += NUM_LANES ) {
+			for( size_t lane = 0; lane < NUM_LANES; lane++ ) {
+				array[i + lane] = lanes[lane];
+				lanes[lane] *= laneRatio;
+			}
+		}
+		for( size_t lane = 0; i < chunkEnd; i++, lane++ )
+			array[i] = lanes[lane];
+	}
+}
+
+void addRamp( const float *array, float valueBegin, float increment, float *result, size_t length )
+{
+	for( size_t i = 0; i < length; i++ )
+		result[i] = array[i] + valueBegin + increment * float( i );
+}
+
 void divide( const float *array, float scalar, float *result, size_t length )
 {
 	mul( array, 1 / scalar, result, length );
@@ -228,12 +316,7 @@ void divide( const float *array, float scalar, float *result, size_t length )
 
 void normalize( float *array, size_t length, float maxValue )
 {
-	float max = 0;
-	for( size_t i = 0; i < length; i++ ) {
-		if( max < array[i] )
-			max = array[i];
-	}
-
+	float max = maxElement( array, length );
 	if( max > 0.00001f ) {
 		mul( array, maxValue / max, array, length );
 	}
@@ -55,6 +55,10 @@ enum WindowType {
 void generateWindow( WindowType windowType, float *window, size_t length );
 //! fills \a array with value \a value
 void fill( float value, float *array, size_t length );
+//! fills \a array with a linear ramp, starting at \a valueBegin and increasing by \a increment for each element.
+void fillRamp( float valueBegin, float increment, float *array, size_t length );
+//! fills \a array with a geometric sequence, starting at \a valueBegin and multiplied by \a ratio for each element.
+void fillGeometric( float valueBegin, float ratio, float *array, size_t length );
 //! add \a scalar to \a array of length \a length, into \a result.
 void add( const float *array, float scalar, float *result, size_t length );
 //! add \a length elements of \a arrayA and \a arrayB (element-wise) into \a result.
@@ -69,6 +73,14 @@ void mul( const float *array, float scalar, float *result, size_t length );
 void mul( const float *arrayA, const float *arrayB, float *result, size_t length );
 //! sums \a length elements of \a arrayA by \a arrayB (element-wise), then scales by \a scalar and leaves the result at \a result.
 void addMul( const float *arrayA, const float *arrayB, float scalar, float *result, size_t length );
+//! multiplies \a length elements of \a array by \a scalar, adds \a addend and leaves the result at \a result.
+void mulAdd( const float *array, float scalar, float addend, float *result, size_t length );
+//! multiplies \a length elements of the complex arrays \a realA, \a imagA and \a realB, \a imagB (element-wise) and adds the products to \a realResult, \a imagResult.
+void mulAddComplex( const float *realA, const float *imagA, const float *realB, const float *imagB, float *realResult, float *imagResult, size_t length );
+//! multiplies \a length elements of \a array by a linear ramp that starts at \a valueBegin and increases by \a increment for each element, and leaves the result at \a result.
+void mulRamp( const float *array, float valueBegin, float increment, float *result, size_t length );
+//! adds a linear ramp that starts at \a valueBegin and increases by \a increment for each element to \a length elements of \a array, and leaves the result at \a result.
+void addRamp( const float *array, float valueBegin, float increment, float *result, size_t length );
 //! divides \a length elements of \a array by \a scalar and leaves the result at \a result.
 void divide( const float *array, float scalar, float *result, size_t length );
 //! returns the sum of \a array
@@ -78,4 +90,22 @@ float rms( const float *array, size_t length );
 //! normalizes \a array to \a maxValue (default = 1)
 void normalize( float *array, size_t length, float maxValue = 1 );
 
+//! The instruction sets that the dsp functions are dispatched to on platforms without vDSP. \see getSimdInstructionSet()
+enum SimdInstructionSet {
+	SIMD_NONE,		//! portable scalar code
+	SIMD_SSE2,		//! x86 SSE2
+	SIMD_AVX2,		//! x86 AVX2
+	SIMD_AVX512,	//! x86 AVX-512F
+	SIMD_NEON		//! ARM NEON
+};
+
+//! Returns the instruction set that the dsp functions are dispatched to, which is the best one the CPU supports (detected on first use) unless overridden with setSimdInstructionSet(). Always SIMD_NONE with vDSP.
+SimdInstructionSet	getSimdInstructionSet();
+//! Dispatches the dsp functions to \a instructionSet (ex. to compare them). \return false, changing nothing, if this CPU or build doesn't support \a instructionSet.
+bool				setSimdInstructionSet( SimdInstructionSet instructionSet );
+//! Returns whether this CPU and build support \a instructionSet.
+bool				isSimdInstructionSetSupported( SimdInstructionSet instructionSet );
+//! Returns a string representation of \a instructionSet.
+const char*			simdInstructionSetToString( SimdInstructionSet instructionSet );
+
 } } } // namespace cinder::audio2::dsp
\ No newline at end of file
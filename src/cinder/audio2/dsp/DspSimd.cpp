@@ -0,0 +1,637 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+// Multiplies and adds must not be fused, so that each kernel rounds as the scalar code does on every instruction set (the AVX-512 and
+// NEON targets have fused multiply-add, which GCC otherwise uses). Set before any function is defined, so that they can all be inlined.
+#if defined( __clang__ )
+	#pragma STDC FP_CONTRACT OFF
+#elif defined( __GNUC__ )
+	#pragma GCC optimize( "fp-contract=off" )
+#endif
+
+#include "cinder/audio2/dsp/Dsp.h"
+#include "cinder/audio2/dsp/DspSimd.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <cstdint>
+
+#if ! defined( CINDER_AUDIO_VDSP )
+	#if defined( __x86_64__ ) || defined( _M_X64 ) || defined( __i386__ ) || defined( _M_IX86 )
+		#define CI_DSP_SIMD_X86
+		#include <immintrin.h>
+		#if defined( _MSC_VER )
+			#include <intrin.h>
+		#endif
+		// AVX-512 intrinsics need Visual Studio 2017 or later.
+		#if ! defined( _MSC_VER ) || _MSC_VER >= 1910
+			#define CI_DSP_SIMD_AVX512
+		#endif
+	#elif defined( __ARM_NEON ) || defined( __ARM_NEON__ ) || defined( __aarch64__ ) || defined( _M_ARM64 )
+		#define CI_DSP_SIMD_NEON
+		#include <arm_neon.h>
+	#endif
+#endif
+
+// GCC and Clang compile the kernels for each instruction set with it enabled, regardless of the flags the file is built with, and
+// the CPU is checked before they are dispatched to. Visual Studio allows intrinsics for any instruction set without flags.
+#if defined( __clang__ )
+	#define CI_DSP_SIMD_TARGET_BEGIN( isa )	_Pragma( CI_DSP_SIMD_STRINGIFY( clang attribute push( __attribute__(( target( isa ) )), apply_to = function ) ) )
+	#define CI_DSP_SIMD_TARGET_END()		_Pragma( "clang attribute pop" )
+#elif defined( __GNUC__ )
+	#define CI_DSP_SIMD_TARGET_BEGIN( isa )	_Pragma( "GCC push_options" ) _Pragma( CI_DSP_SIMD_STRINGIFY( GCC target( isa ) ) )
+	#define CI_DSP_SIMD_TARGET_END()		_Pragma( "GCC pop_options" )
+#else
+	#define CI_DSP_SIMD_TARGET_BEGIN( isa )
+	#define CI_DSP_SIMD_TARGET_END()
+#endif
+#define CI_DSP_SIMD_STRINGIFY( ... )	#__VA_ARGS__
+
+namespace cinder { namespace audio2 { namespace dsp {
+
+// The scalar kernels are also built with vDSP, where Fft uses the FFT stages for sizes that vDSP doesn't support.
+namespace scalar {
+
+typedef float Vec;
+const size_t WIDTH = 1;
+
+inline Vec	load( const float *p )				{ return *p; }
+inline Vec	loadAligned( const float *p )		{ return *p; }
+inline void	store( float *p, Vec v )			{ *p = v; }
+inline void	storeAligned( float *p, Vec v )		{ *p = v; }
+inline Vec	set1( float x )						{ return x; }
+inline Vec	vadd( Vec a, Vec b )				{ return a + b; }
+inline Vec	vsub( Vec a, Vec b )				{ return a - b; }
+inline Vec	vmul( Vec a, Vec b )				{ return a * b; }
+inline Vec	vmax( Vec a, Vec b )				{ return std::max( a, b ); }
+inline void	transpose( Vec * )					{}
+
+typedef double VecD;
+const size_t WIDTH_D = 1;
+
+inline VecD	load( const double *p )				{ return *p; }
+inline VecD	loadFloats( const float *p )		{ return *p; }
+inline void	store( double *p, VecD v )			{ *p = v; }
+inline void	storeFloats( float *p, VecD v )		{ *p = float( v ); }
+inline VecD	vadd( VecD a, VecD b )				{ return a + b; }
+inline VecD	vsub( VecD a, VecD b )				{ return a - b; }
+inline VecD	vmul( VecD a, VecD b )				{ return a * b; }
+inline void	transpose( VecD * )					{}
+
+typedef uint32_t VecI;
+
+inline VecI	set1i( uint32_t x )					{ return x; }
+inline VecI	loadi( const uint32_t *p )			{ return *p; }
+inline void	storei( uint32_t *p, VecI v )		{ *p = v; }
+inline VecI	vaddi( VecI a, VecI b )				{ return a + b; }
+inline VecI	vandi( VecI a, VecI b )				{ return a & b; }
+inline VecI	vsrli( VecI v, int count )			{ return v >> count; }
+inline VecI	vslli( VecI v, int count )			{ return v << count; }
+inline VecI	vxori( VecI a, VecI b )				{ return a ^ b; }
+inline Vec	toFloat( VecI v )					{ return float( int32_t( v ) ); }
+inline Vec	gather( const float *table, VecI indices )	{ return table[indices]; }
+
+namespace narrower = scalar;
+
+// Nothing to clean up after a kernel.
+struct KernelScope {
+	~KernelScope()		{}
+};
+
+#include "cinder/audio2/dsp/DspSimdKernels.h"
+
+} // namespace scalar
+
+#if ! defined( CINDER_AUDIO_VDSP )
+
+#if defined( CI_DSP_SIMD_X86 )
+
+CI_DSP_SIMD_TARGET_BEGIN( "sse2" )
+namespace sse2 {
+
+typedef __m128 Vec;
+const size_t WIDTH = 4;
+
+inline Vec	load( const float *p )				{ return _mm_loadu_ps( p ); }
+inline Vec	loadAligned( const float *p )		{ return _mm_load_ps( p ); }
+inline void	store( float *p, Vec v )			{ _mm_storeu_ps( p, v ); }
+inline void	storeAligned( float *p, Vec v )		{ _mm_store_ps( p, v ); }
+inline Vec	set1( float x )						{ return _mm_set1_ps( x ); }
+inline Vec	vadd( Vec a, Vec b )				{ return _mm_add_ps( a, b ); }
+inline Vec	vsub( Vec a, Vec b )				{ return _mm_sub_ps( a, b ); }
+inline Vec	vmul( Vec a, Vec b )				{ return _mm_mul_ps( a, b ); }
+inline Vec	vmax( Vec a, Vec b )				{ return _mm_max_ps( a, b ); }
+
+// Transposes the WIDTH x WIDTH matrix in rows.
+inline void transpose( Vec *rows )
+{
+	_MM_TRANSPOSE4_PS( rows[0], rows[1], rows[2], rows[3] );
+}
+
+typedef __m128d VecD;
+const size_t WIDTH_D = 2;
+
+inline VecD	load( const double *p )				{ return _mm_loadu_pd( p ); }
+inline VecD	loadFloats( const float *p )		{ return _mm_cvtps_pd( _mm_castpd_ps( _mm_load_sd( reinterpret_cast<const double *>( p ) ) ) ); }
+inline void	store( double *p, VecD v )			{ _mm_storeu_pd( p, v ); }
+inline void	storeFloats( float *p, VecD v )		{ _mm_store_sd( reinterpret_cast<double *>( p ), _mm_castps_pd( _mm_cvtpd_ps( v ) ) ); }
+inline VecD	vadd( VecD a, VecD b )				{ return _mm_add_pd( a, b ); }
+inline VecD	vsub( VecD a, VecD b )				{ return _mm_sub_pd( a, b ); }
+inline VecD	vmul( VecD a, VecD b )				{ return _mm_mul_pd( a, b ); }
+
+inline void transpose( VecD *rows )
+{
+	VecD t = _mm_unpacklo_pd( rows[0], rows[1] );
+	rows[1] = _mm_unpackhi_pd( rows[0], rows[1] );
+	rows[0] = t;
+}
+
+typedef __m128i VecI;
+
+inline VecI	set1i( uint32_t x )					{ return _mm_set1_epi32( int( x ) ); }
+inline VecI	loadi( const uint32_t *p )			{ return _mm_loadu_si128( reinterpret_cast<const __m128i *>( p ) ); }
+inline void	storei( uint32_t *p, VecI v )		{ _mm_storeu_si128( reinterpret_cast<__m128i *>( p ), v ); }
+inline VecI	vaddi( VecI a, VecI b )				{ return _mm_add_epi32( a, b ); }
+inline VecI	vandi( VecI a, VecI b )				{ return _mm_and_si128( a, b ); }
+inline VecI	vsrli( VecI v, int count )			{ return _mm_srl_epi32( v, _mm_cvtsi32_si128( count ) ); }
+inline VecI	vslli( VecI v, int count )			{ return _mm_sll_epi32( v, _mm_cvtsi32_si128( count ) ); }
+inline VecI	vxori( VecI a, VecI b )				{ return _mm_xor_si128( a, b ); }
+inline Vec	toFloat( VecI v )					{ return _mm_cvtepi32_ps( v ); }
+
+// SSE2 has no gather, so the elements are loaded one at a time.
+inline Vec gather( const float *table, VecI indices )
+{
+	uint32_t i[4];
+	_mm_storeu_si128( reinterpret_cast<__m128i *>( i ), indices );
+	return _mm_setr_ps( table[i[0]], table[i[1]], table[i[2]], table[i[3]] );
+}
+
+namespace narrower = scalar;
+
+struct KernelScope {
+	~KernelScope()		{}
+};
+
+#include "cinder/audio2/dsp/DspSimdKernels.h"
+
+} // namespace sse2
+CI_DSP_SIMD_TARGET_END()
+
+CI_DSP_SIMD_TARGET_BEGIN( "avx2" )
+namespace avx2 {
+
+typedef __m256 Vec;
+const size_t WIDTH = 8;
+
+inline Vec	load( const float *p )				{ return _mm256_loadu_ps( p ); }
+inline Vec	loadAligned( const float *p )		{ return _mm256_load_ps( p ); }
+inline void	store( float *p, Vec v )			{ _mm256_storeu_ps( p, v ); }
+inline void	storeAligned( float *p, Vec v )		{ _mm256_store_ps( p, v ); }
+inline Vec	set1( float x )						{ return _mm256_set1_ps( x ); }
+inline Vec	vadd( Vec a, Vec b )				{ return _mm256_add_ps( a, b ); }
+inline Vec	vsub( Vec a, Vec b )				{ return _mm256_sub_ps( a, b ); }
+inline Vec	vmul( Vec a, Vec b )				{ return _mm256_mul_ps( a, b ); }
+inline Vec	vmax( Vec a, Vec b )				{ return _mm256_max_ps( a, b ); }
+
+// Transposes the WIDTH x WIDTH matrix in rows: interleaves pairs of rows, then pairs of those within each 128-bit lane, then swaps the lanes.
+inline void transpose( Vec *rows )
+{
+	Vec t[8], u[8];
+	for( int i = 0; i < 8; i += 2 ) {
+		t[i] = _mm256_unpacklo_ps( rows[i], rows[i + 1] );
+		t[i + 1] = _mm256_unpackhi_ps( rows[i], rows[i + 1] );
+	}
+	for( int i = 0; i < 8; i += 4 ) {
+		u[i] = _mm256_shuffle_ps( t[i], t[i + 2], 0x44 );
+		u[i + 1] = _mm256_shuffle_ps( t[i], t[i + 2], 0xEE );
+		u[i + 2] = _mm256_shuffle_ps( t[i + 1], t[i + 3], 0x44 );
+		u[i + 3] = _mm256_shuffle_ps( t[i + 1], t[i + 3], 0xEE );
+	}
+	for( int i = 0; i < 4; i++ ) {
+		rows[i] = _mm256_permute2f128_ps( u[i], u[i + 4], 0x20 );
+		rows[i + 4] = _mm256_permute2f128_ps( u[i], u[i + 4], 0x31 );
+	}
+}
+
+typedef __m256d VecD;
+const size_t WIDTH_D = 4;
+
+inline VecD	load( const double *p )				{ return _mm256_loadu_pd( p ); }
+inline VecD	loadFloats( const float *p )		{ return _mm256_cvtps_pd( _mm_loadu_ps( p ) ); }
+inline void	store( double *p, VecD v )			{ _mm256_storeu_pd( p, v ); }
+inline void	storeFloats( float *p, VecD v )		{ _mm_storeu_ps( p, _mm256_cvtpd_ps( v ) ); }
+inline VecD	vadd( VecD a, VecD b )				{ return _mm256_add_pd( a, b ); }
+inline VecD	vsub( VecD a, VecD b )				{ return _mm256_sub_pd( a, b ); }
+inline VecD	vmul( VecD a, VecD b )				{ return _mm256_mul_pd( a, b ); }
+
+inline void transpose( VecD *rows )
+{
+	VecD t[4];
+	for( int i = 0; i < 4; i += 2 ) {
+		t[i] = _mm256_unpacklo_pd( rows[i], rows[i + 1] );
+		t[i + 1] = _mm256_unpackhi_pd( rows[i], rows[i + 1] );
+	}
+	for( int i = 0; i < 2; i++ ) {
+		rows[i] = _mm256_permute2f128_pd( t[i], t[i + 2], 0x20 );
+		rows[i + 2] = _mm256_permute2f128_pd( t[i], t[i + 2], 0x31 );
+	}
+}
+
+typedef __m256i VecI;
+
+inline VecI	set1i( uint32_t x )					{ return _mm256_set1_epi32( int( x ) ); }
+inline VecI	loadi( const uint32_t *p )			{ return _mm256_loadu_si256( reinterpret_cast<const __m256i *>( p ) ); }
+inline void	storei( uint32_t *p, VecI v )		{ _mm256_storeu_si256( reinterpret_cast<__m256i *>( p ), v ); }
+inline VecI	vaddi( VecI a, VecI b )				{ return _mm256_add_epi32( a, b ); }
+inline VecI	vandi( VecI a, VecI b )				{ return _mm256_and_si256( a, b ); }
+inline VecI	vsrli( VecI v, int count )			{ return _mm256_srl_epi32( v, _mm_cvtsi32_si128( count ) ); }
+inline VecI	vslli( VecI v, int count )			{ return _mm256_sll_epi32( v, _mm_cvtsi32_si128( count ) ); }
+inline VecI	vxori( VecI a, VecI b )				{ return _mm256_xor_si256( a, b ); }
+inline Vec	toFloat( VecI v )					{ return _mm256_cvtepi32_ps( v ); }
+inline Vec	gather( const float *table, VecI indices )	{ return _mm256_i32gather_ps( table, indices, 4 ); }
+
+namespace narrower = sse2;
+
+// Clears the upper halves of the vector registers after a kernel, so that the SSE code that called it doesn't pay a transition penalty.
+struct KernelScope {
+	~KernelScope()		{ _mm256_zeroupper(); }
+};
+
+#include "cinder/audio2/dsp/DspSimdKernels.h"
+
+} // namespace avx2
+CI_DSP_SIMD_TARGET_END()
+
+#if defined( CI_DSP_SIMD_AVX512 )
+
+CI_DSP_SIMD_TARGET_BEGIN( "avx512f" )
+namespace avx512 {
+
+typedef __m512 Vec;
+const size_t WIDTH = 16;
+
+inline Vec	load( const float *p )				{ return _mm512_loadu_ps( p ); }
+inline Vec	loadAligned( const float *p )		{ return _mm512_load_ps( p ); }
+inline void	store( float *p, Vec v )			{ _mm512_storeu_ps( p, v ); }
+inline void	storeAligned( float *p, Vec v )		{ _mm512_store_ps( p, v ); }
+inline Vec	set1( float x )						{ return _mm512_set1_ps( x ); }
+inline Vec	vadd( Vec a, Vec b )				{ return _mm512_add_ps( a, b ); }
+inline Vec	vsub( Vec a, Vec b )				{ return _mm512_sub_ps( a, b ); }
+inline Vec	vmul( Vec a, Vec b )				{ return _mm512_mul_ps( a, b ); }
+inline Vec	vmax( Vec a, Vec b )				{ return _mm512_max_ps( a, b ); }
+
+// As avx2::transpose(), with a second round of 128-bit lane shuffles.
+inline void transpose( Vec *rows )
+{
+	Vec t[16], u[16];
+	for( int i = 0; i < 16; i += 2 ) {
+		t[i] = _mm512_unpacklo_ps( rows[i], rows[i + 1] );
+		t[i + 1] = _mm512_unpackhi_ps( rows[i], rows[i + 1] );
+	}
+	for( int i = 0; i < 16; i += 4 ) {
+		u[i] = _mm512_shuffle_ps( t[i], t[i + 2], 0x44 );
+		u[i + 1] = _mm512_shuffle_ps( t[i], t[i + 2], 0xEE );
+		u[i + 2] = _mm512_shuffle_ps( t[i + 1], t[i + 3], 0x44 );
+		u[i + 3] = _mm512_shuffle_ps( t[i + 1], t[i + 3], 0xEE );
+	}
+	for( int i = 0; i < 4; i++ ) {
+		t[i] = _mm512_shuffle_f32x4( u[i], u[i + 4], 0x88 );
+		t[i + 4] = _mm512_shuffle_f32x4( u[i], u[i + 4], 0xDD );
+		t[i + 8] = _mm512_shuffle_f32x4( u[i + 8], u[i + 12], 0x88 );
+		t[i + 12] = _mm512_shuffle_f32x4( u[i + 8], u[i + 12], 0xDD );
+	}
+	for( int i = 0; i < 4; i++ ) {
+		rows[i] = _mm512_shuffle_f32x4( t[i], t[i + 8], 0x88 );
+		rows[i + 8] = _mm512_shuffle_f32x4( t[i], t[i + 8], 0xDD );
+		rows[i + 4] = _mm512_shuffle_f32x4( t[i + 4], t[i + 12], 0x88 );
+		rows[i + 12] = _mm512_shuffle_f32x4( t[i + 4], t[i + 12], 0xDD );
+	}
+}
+
+typedef __m512d VecD;
+const size_t WIDTH_D = 8;
+
+inline VecD	load( const double *p )				{ return _mm512_loadu_pd( p ); }
+inline VecD	loadFloats( const float *p )		{ return _mm512_cvtps_pd( _mm256_loadu_ps( p ) ); }
+inline void	store( double *p, VecD v )			{ _mm512_storeu_pd( p, v ); }
+inline void	storeFloats( float *p, VecD v )		{ _mm256_storeu_ps( p, _mm512_cvtpd_ps( v ) ); }
+inline VecD	vadd( VecD a, VecD b )				{ return _mm512_add_pd( a, b ); }
+inline VecD	vsub( VecD a, VecD b )				{ return _mm512_sub_pd( a, b ); }
+inline VecD	vmul( VecD a, VecD b )				{ return _mm512_mul_pd( a, b ); }
+
+inline void transpose( VecD *rows )
+{
+	VecD t[8], u[8];
+	for( int i = 0; i < 8; i += 2 ) {
+		t[i] = _mm512_unpacklo_pd( rows[i], rows[i + 1] );
+		t[i + 1] = _mm512_unpackhi_pd( rows[i], rows[i + 1] );
+	}
+	for( int i = 0; i < 8; i += 4 ) {
+		u[i] = _mm512_shuffle_f64x2( t[i], t[i + 2], 0x88 );
+		u[i + 1] = _mm512_shuffle_f64x2( t[i + 1], t[i + 3], 0x88 );
+		u[i + 2] = _mm512_shuffle_f64x2( t[i], t[i + 2], 0xDD );
+		u[i + 3] = _mm512_shuffle_f64x2( t[i + 1], t[i + 3], 0xDD );
+	}
+	for( int i = 0; i < 4; i++ ) {
+		rows[i] = _mm512_shuffle_f64x2( u[i], u[i + 4], 0x88 );
+		rows[i + 4] = _mm512_shuffle_f64x2( u[i], u[i + 4], 0xDD );
+	}
+}
+
+typedef __m512i VecI;
+
+inline VecI	set1i( uint32_t x )					{ return _mm512_set1_epi32( int( x ) ); }
+inline VecI	loadi( const uint32_t *p )			{ return _mm512_loadu_si512( p ); }
+inline void	storei( uint32_t *p, VecI v )		{ _mm512_storeu_si512( p, v ); }
+inline VecI	vaddi( VecI a, VecI b )				{ return _mm512_add_epi32( a, b ); }
+inline VecI	vandi( VecI a, VecI b )				{ return _mm512_and_si512( a, b ); }
+inline VecI	vsrli( VecI v, int count )			{ return _mm512_srl_epi32( v, _mm_cvtsi32_si128( count ) ); }
+inline VecI	vslli( VecI v, int count )			{ return _mm512_sll_epi32( v, _mm_cvtsi32_si128( count ) ); }
+inline VecI	vxori( VecI a, VecI b )				{ return _mm512_xor_si512( a, b ); }
+inline Vec	toFloat( VecI v )					{ return _mm512_cvtepi32_ps( v ); }
+inline Vec	gather( const float *table, VecI indices )	{ return _mm512_i32gather_ps( indices, table, 4 ); }
+
+namespace narrower = avx2;
+
+// See avx2::KernelScope.
+struct KernelScope {
+	~KernelScope()		{ _mm256_zeroupper(); }
+};
+
+#include "cinder/audio2/dsp/DspSimdKernels.h"
+
+} // namespace avx512
+CI_DSP_SIMD_TARGET_END()
+
+#endif // defined( CI_DSP_SIMD_AVX512 )
+
+#elif defined( CI_DSP_SIMD_NEON )
+
+namespace neon {
+
+typedef float32x4_t Vec;
+const size_t WIDTH = 4;
+
+inline Vec	load( const float *p )				{ return vld1q_f32( p ); }
+inline Vec	loadAligned( const float *p )		{ return vld1q_f32( p ); }
+inline void	store( float *p, Vec v )			{ vst1q_f32( p, v ); }
+inline void	storeAligned( float *p, Vec v )		{ vst1q_f32( p, v ); }
+inline Vec	set1( float x )						{ return vdupq_n_f32( x ); }
+inline Vec	vadd( Vec a, Vec b )				{ return vaddq_f32( a, b ); }
+inline Vec	vsub( Vec a, Vec b )				{ return vsubq_f32( a, b ); }
+inline Vec	vmul( Vec a, Vec b )				{ return vmulq_f32( a, b ); }
+inline Vec	vmax( Vec a, Vec b )				{ return vmaxq_f32( a, b ); }
+
+// Transposes the WIDTH x WIDTH matrix in rows.
+inline void transpose( Vec *rows )
+{
+	float32x4x2_t t01 = vtrnq_f32( rows[0], rows[1] );
+	float32x4x2_t t23 = vtrnq_f32( rows[2], rows[3] );
+	rows[0] = vcombine_f32( vget_low_f32( t01.val[0] ), vget_low_f32( t23.val[0] ) );
+	rows[1] = vcombine_f32( vget_low_f32( t01.val[1] ), vget_low_f32( t23.val[1] ) );
+	rows[2] = vcombine_f32( vget_high_f32( t01.val[0] ), vget_high_f32( t23.val[0] ) );
+	rows[3] = vcombine_f32( vget_high_f32( t01.val[1] ), vget_high_f32( t23.val[1] ) );
+}
+
+#if defined( __aarch64__ ) || defined( _M_ARM64 )
+typedef float64x2_t VecD;
+const size_t WIDTH_D = 2;
+
+inline VecD	load( const double *p )				{ return vld1q_f64( p ); }
+inline VecD	loadFloats( const float *p )		{ return vcvt_f64_f32( vld1_f32( p ) ); }
+inline void	store( double *p, VecD v )			{ vst1q_f64( p, v ); }
+inline void	storeFloats( float *p, VecD v )		{ vst1_f32( p, vcvt_f32_f64( v ) ); }
+inline VecD	vadd( VecD a, VecD b )				{ return vaddq_f64( a, b ); }
+inline VecD	vsub( VecD a, VecD b )				{ return vsubq_f64( a, b ); }
+inline VecD	vmul( VecD a, VecD b )				{ return vmulq_f64( a, b ); }
+
+inline void transpose( VecD *rows )
+{
+	VecD t = vzip1q_f64( rows[0], rows[1] );
+	rows[1] = vzip2q_f64( rows[0], rows[1] );
+	rows[0] = t;
+}
+#else
+// 32-bit ARM has no double precision vectors.
+typedef double VecD;
+const size_t WIDTH_D = 1;
+
+inline VecD	load( const double *p )				{ return *p; }
+inline VecD	loadFloats( const float *p )		{ return *p; }
+inline void	store( double *p, VecD v )			{ *p = v; }
+inline void	storeFloats( float *p, VecD v )		{ *p = float( v ); }
+inline VecD	vadd( VecD a, VecD b )				{ return a + b; }
+inline VecD	vsub( VecD a, VecD b )				{ return a - b; }
+inline VecD	vmul( VecD a, VecD b )				{ return a * b; }
+inline void	transpose( VecD *rows )				{}
+#endif
+
+typedef uint32x4_t VecI;
+
+inline VecI	set1i( uint32_t x )					{ return vdupq_n_u32( x ); }
+inline VecI	loadi( const uint32_t *p )			{ return vld1q_u32( p ); }
+inline void	storei( uint32_t *p, VecI v )		{ vst1q_u32( p, v ); }
+inline VecI	vaddi( VecI a, VecI b )				{ return vaddq_u32( a, b ); }
+inline VecI	vandi( VecI a, VecI b )				{ return vandq_u32( a, b ); }
+inline VecI	vsrli( VecI v, int count )			{ return vshlq_u32( v, vdupq_n_s32( -count ) ); }
+inline VecI	vslli( VecI v, int count )			{ return vshlq_u32( v, vdupq_n_s32( count ) ); }
+inline VecI	vxori( VecI a, VecI b )				{ return veorq_u32( a, b ); }
+inline Vec	toFloat( VecI v )					{ return vcvtq_f32_u32( v ); }
+
+// NEON has no gather, so the elements are loaded one at a time.
+inline Vec gather( const float *table, VecI indices )
+{
+	uint32_t i[4];
+	vst1q_u32( i, indices );
+	const float elements[4] = { table[i[0]], table[i[1]], table[i[2]], table[i[3]] };
+	return vld1q_f32( elements );
+}
+
+namespace narrower = scalar;
+
+struct KernelScope {
+	~KernelScope()		{}
+};
+
+#include "cinder/audio2/dsp/DspSimdKernels.h"
+
+} // namespace neon
+
+#endif // defined( CI_DSP_SIMD_NEON )
+
+namespace {
+
+#if defined( CI_DSP_SIMD_X86 ) && defined( _MSC_VER )
+
+// Checks the CPUID feature bits, and that the OS saves the extended registers (XCR0) that AVX and AVX-512 use.
+bool cpuSupports( SimdInstructionSet instructionSet )
+{
+	int info[4];
+	__cpuid( info, 0 );
+	const int maxLeaf = info[0];
+
+	__cpuid( info, 1 );
+	if( instructionSet == SIMD_SSE2 )
+		return ( info[3] & ( 1 << 26 ) ) != 0;
+
+	const bool osSavesAvx = ( info[2] & ( 1 << 27 ) ) && ( info[2] & ( 1 << 28 ) ) && ( _xgetbv( 0 ) & 0x06 ) == 0x06;
+	if( ! osSavesAvx || maxLeaf < 7 )
+		return false;
+
+	__cpuidex( info, 7, 0 );
+	if( instructionSet == SIMD_AVX2 )
+		return ( info[1] & ( 1 << 5 ) ) != 0;
+	if( instructionSet == SIMD_AVX512 )
+		return ( info[1] & ( 1 << 16 ) ) != 0 && ( _xgetbv( 0 ) & 0xe6 ) == 0xe6;
+
+	return false;
+}
+
+#elif defined( CI_DSP_SIMD_X86 )
+
+bool cpuSupports( SimdInstructionSet instructionSet )
+{
+	__builtin_cpu_init();
+
+	switch( instructionSet ) {
+		case SIMD_SSE2:		return __builtin_cpu_supports( "sse2" );
+		case SIMD_AVX2:		return __builtin_cpu_supports( "avx2" );
+		case SIMD_AVX512:	return __builtin_cpu_supports( "avx512f" );
+		default:			return false;
+	}
+}
+
+#endif
+
+const SimdKernels* findKernels( SimdInstructionSet instructionSet )
+{
+	switch( instructionSet ) {
+		case SIMD_NONE:
+			return &scalar::KERNELS;
+#if defined( CI_DSP_SIMD_X86 )
+		case SIMD_SSE2:
+			return cpuSupports( SIMD_SSE2 ) ? &sse2::KERNELS : nullptr;
+		case SIMD_AVX2:
+			return cpuSupports( SIMD_AVX2 ) ? &avx2::KERNELS : nullptr;
+	#if defined( CI_DSP_SIMD_AVX512 )
+		case SIMD_AVX512:
+			return cpuSupports( SIMD_AVX512 ) ? &avx512::KERNELS : nullptr;
+	#endif
+#elif defined( CI_DSP_SIMD_NEON )
+		case SIMD_NEON:
+			return &neon::KERNELS;
+#endif
+		default:
+			return nullptr;
+	}
+}
+
+// Both are constant-initialized, so they can be used during static initialization. The kernel tables themselves are never modified.
+std::atomic<const SimdKernels *>	sKernels( nullptr );
+std::atomic<int>					sInstructionSet( SIMD_NONE );
+
+void detectInstructionSet()
+{
+	const SimdInstructionSet preferred[] = { SIMD_AVX512, SIMD_AVX2, SIMD_NEON, SIMD_SSE2 };
+	for( SimdInstructionSet instructionSet : preferred ) {
+		if( setSimdInstructionSet( instructionSet ) )
+			return;
+	}
+
+	setSimdInstructionSet( SIMD_NONE );
+}
+
+} // anonymous namespace
+
+const SimdKernels& getSimdKernels()
+{
+	const SimdKernels *kernels = sKernels.load( std::memory_order_acquire );
+	if( ! kernels ) {
+		detectInstructionSet();
+		kernels = sKernels.load( std::memory_order_acquire );
+	}
+
+	return *kernels;
+}
+
+SimdInstructionSet getSimdInstructionSet()
+{
+	getSimdKernels();
+	return SimdInstructionSet( sInstructionSet.load() );
+}
+
+bool setSimdInstructionSet( SimdInstructionSet instructionSet )
+{
+	const SimdKernels *kernels = findKernels( instructionSet );
+	if( ! kernels )
+		return false;
+
+	sInstructionSet = instructionSet;
+	sKernels.store( kernels, std::memory_order_release );
+	return true;
+}
+
+bool isSimdInstructionSetSupported( SimdInstructionSet instructionSet )
+{
+	return findKernels( instructionSet ) != nullptr;
+}
+
+#else // defined( CINDER_AUDIO_VDSP )
+
+const SimdKernels& getSimdKernels()
+{
+	return scalar::KERNELS;
+}
+
+SimdInstructionSet getSimdInstructionSet()
+{
+	return SIMD_NONE;
+}
+
+bool setSimdInstructionSet( SimdInstructionSet instructionSet )
+{
+	return instructionSet == SIMD_NONE;
+}
+
+bool isSimdInstructionSetSupported( SimdInstructionSet instructionSet )
+{
+	return instructionSet == SIMD_NONE;
+}
+
+#endif // defined( CINDER_AUDIO_VDSP )
+
+const char* simdInstructionSetToString( SimdInstructionSet instructionSet )
+{
+	switch( instructionSet ) {
+		case SIMD_NONE:		return "none";
+		case SIMD_SSE2:		return "SSE2";
+		case SIMD_AVX2:		return "AVX2";
+		case SIMD_AVX512:	return "AVX-512";
+		case SIMD_NEON:		return "NEON";
+		default:			return "unknown";
+	}
+}
+
+} } } // namespace cinder::audio2::dsp
@@ -0,0 +1,76 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace cinder { namespace audio2 { namespace dsp {
+
+// The number of generators that the noise kernel interleaves, which must be a multiple of every instruction set's WIDTH.
+const size_t NUM_NOISE_GENERATORS = 16;
+
+// The kernels behind the dsp functions on platforms without vDSP, with one table per SimdInstructionSet. They are an implementation
+// detail of Dsp.cpp, Fft.cpp, BiquadBank.cpp, WaveTable.cpp and NoiseGenerator.cpp, use the dsp functions instead. With vDSP, only the scalar table exists.
+struct SimdKernels {
+	void	(*fill)( float value, float *array, size_t length );
+	void	(*addScalar)( const float *array, float scalar, float *result, size_t length );
+	void	(*add)( const float *arrayA, const float *arrayB, float *result, size_t length );
+	void	(*sub)( const float *arrayA, const float *arrayB, float *result, size_t length );
+	void	(*mulScalar)( const float *array, float scalar, float *result, size_t length );
+	void	(*mul)( const float *arrayA, const float *arrayB, float *result, size_t length );
+	void	(*addMul)( const float *arrayA, const float *arrayB, float scalar, float *result, size_t length );
+	void	(*mulAdd)( const float *array, float scalar, float addend, float *result, size_t length );
+	void	(*mulAddComplex)( const float *realA, const float *imagA, const float *realB, const float *imagB, float *realResult, float *imagResult, size_t length );
+	float	(*sum)( const float *array, size_t length );
+	float	(*sumSquares)( const float *array, size_t length );
+	float	(*max)( const float *array, size_t length );	// returns -FLT_MAX if length is 0
+
+	// One stage of the split complex FFT used by Fft, see fftRadix2() in DspSimdKernels.h.
+	void	(*fftRadix2)( const float *xr, const float *xi, float *yr, float *yi, const float *twr, const float *twi, size_t n, size_t s );
+	void	(*fftRadix3)( const float *xr, const float *xi, float *yr, float *yi, const float *twr, const float *twi, size_t n, size_t s );
+	void	(*fftRadix4)( const float *xr, const float *xi, float *yr, float *yi, const float *twr, const float *twi, size_t n, size_t s );
+	void	(*fftRadix5)( const float *xr, const float *xi, float *yr, float *yi, const float *twr, const float *twi, size_t n, size_t s );
+
+	// Independent biquads, one per SIMD lane, used by BiquadBank, see biquad() in DspSimdKernels.h.
+	void	(*biquad)( const float *const *sources, float *const *dests, size_t numFrames, size_t numLanes, size_t stride, const float *coefficients, float *state );
+	void	(*biquadDouble)( const float *const *sources, float *const *dests, size_t numFrames, size_t numLanes, size_t stride, const double *coefficients, double *state );
+
+	// Wavetable lookup at 32-bit fixed-point phases, used by WaveTable, see wavetable() in DspSimdKernels.h.
+	void	(*wavetable)( const float *table, const float *table2, float mix, size_t tableBits, uint32_t phase, uint32_t phaseIncr, float *dest, size_t length );
+	void	(*wavetablePhases)( const float *table, const float *table2, float mix, size_t tableBits, const uint32_t *phases, float *dest, size_t length );
+
+	// Sums of wavetable oscillators with ramped amplitudes, used by WaveTableBank, see wavetableBank() in DspSimdKernels.h.
+	void	(*wavetableBank)( const float *tables, size_t tableBits, const uint32_t *tableIndices, uint32_t *phases, const uint32_t *phaseIncrs, float *amps,
+							  const float *targetAmps, size_t numOscillators, float *dest, size_t length );
+
+	// White noise from interleaved xorshift generators, used by NoiseGenerator, see noise() in DspSimdKernels.h.
+	void	(*noise)( uint32_t *states, size_t first, float *dest, size_t length );
+};
+
+// Returns the kernels for the instruction set returned by getSimdInstructionSet().
+const SimdKernels&	getSimdKernels();
+
+} } } // namespace cinder::audio2::dsp
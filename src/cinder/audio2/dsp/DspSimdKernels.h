@@ -0,0 +1,866 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+// The dsp kernels for one instruction set. This file is included by DspSimd.cpp once per instruction set, within a namespace that defines
+// for it Vec, WIDTH (the number of floats in a Vec), load(), loadAligned(), store(), storeAligned(), set1(), vadd(), vsub(), vmul(), vmax(),
+// transpose(), their double precision counterparts VecD and WIDTH_D with loadFloats() and storeFloats(), a vector of WIDTH uint32_t's VecI
+// with set1i(), loadi(), storei(), vaddi(), vandi(), vxori(), vslli(), vsrli(), toFloat() and gather(), KernelScope, which each kernel holds
+// for its duration, and the namespace alias narrower, the instruction set with the next smaller WIDTH.
+// The array kernels handle scalars until the array they write (or read, for reductions) is aligned to the vector width, then whole
+// vectors, and then the remaining scalars. Multiplies and adds are never fused (see DspSimd.cpp), so element-wise kernels round exactly as
+// the scalar code does and results only depend on the instruction set for reductions.
+
+// Returns the number of elements before \a array is aligned to the vector width, at most \a length.
+inline size_t alignHead( const float *array, size_t length )
+{
+	const size_t offset = size_t( reinterpret_cast<uintptr_t>( array ) / sizeof( float ) ) % WIDTH;
+	return std::min( offset ? WIDTH - offset : 0, length );
+}
+
+inline float sumLanes( Vec v )
+{
+	float lanes[WIDTH];
+	store( lanes, v );
+
+	float result = 0;
+	for( size_t i = 0; i < WIDTH; i++ )
+		result += lanes[i];
+
+	return result;
+}
+
+inline float maxLanes( Vec v )
+{
+	float lanes[WIDTH];
+	store( lanes, v );
+
+	float result = lanes[0];
+	for( size_t i = 1; i < WIDTH; i++ )
+		result = std::max( result, lanes[i] );
+
+	return result;
+}
+
+void fill( float value, float *array, size_t length )
+{
+	KernelScope scope;
+
+	size_t i = 0;
+	for( const size_t head = alignHead( array, length ); i < head; i++ )
+		array[i] = value;
+
+	const Vec values = set1( value );
+	for( ; i + WIDTH <= length; i += WIDTH )
+		storeAligned( array + i, values );
+
+	for( ; i < length; i++ )
+		array[i] = value;
+}
+
+void addScalar( const float *array, float scalar, float *result, size_t length )
+{
+	KernelScope scope;
+
+	size_t i = 0;
+	for( const size_t head = alignHead( result, length ); i < head; i++ )
+		result[i] = array[i] + scalar;
+
+	const Vec scalars = set1( scalar );
+	for( ; i + WIDTH <= length; i += WIDTH )
+		storeAligned( result + i, vadd( load( array + i ), scalars ) );
+
+	for( ; i < length; i++ )
+		result[i] = array[i] + scalar;
+}
+
+void add( const float *arrayA, const float *arrayB, float *result, size_t length )
+{
+	KernelScope scope;
+
+	size_t i = 0;
+	for( const size_t head = alignHead( result, length ); i < head; i++ )
+		result[i] = arrayA[i] + arrayB[i];
+
+	for( ; i + WIDTH <= length; i += WIDTH )
+		storeAligned( result + i, vadd( load( arrayA + i ), load( arrayB + i ) ) );
+
+	for( ; i < length; i++ )
+		result[i] = arrayA[i] + arrayB[i];
+}
+
+void sub( const float *arrayA, const float *arrayB, float *result, size_t length )
+{
+	KernelScope scope;
+
+	size_t i = 0;
+	for( const size_t head = alignHead( result, length ); i < head; i++ )
+		result[i] = arrayA[i] - arrayB[i];
+
+	for( ; i + WIDTH <= length; i += WIDTH )
+		storeAligned( result + i, vsub( load( arrayA + i ), load( arrayB + i ) ) );
+
+	for( ; i < length; i++ )
+		result[i] = arrayA[i] - arrayB[i];
+}
+
+void mulScalar( const float *array, float scalar, float *result, size_t length )
+{
+	KernelScope scope;
+
+	size_t i = 0;
+	for( const size_t head = alignHead( result, length ); i < head; i++ )
+		result[i] = array[i] * scalar;
+
+	const Vec scalars = set1( scalar );
+	for( ; i + WIDTH <= length; i += WIDTH )
+		storeAligned( result + i, vmul( load( array + i ), scalars ) );
+
+	for( ; i < length; i++ )
+		result[i] = array[i] * scalar;
+}
+
+void mul( const float *arrayA, const float *arrayB, float *result, size_t length )
+{
+	KernelScope scope;
+
+	size_t i = 0;
+	for( const size_t head = alignHead( result, length ); i < head; i++ )
+		result[i] = arrayA[i] * arrayB[i];
+
+	for( ; i + WIDTH <= length; i += WIDTH )
+		storeAligned( result + i, vmul( load( arrayA + i ), load( arrayB + i ) ) );
+
+	for( ; i < length; i++ )
+		result[i] = arrayA[i] * arrayB[i];
+}
+
+void addMul( const float *arrayA, const float *arrayB, float scalar, float *result, size_t length )
+{
+	KernelScope scope;
+
+	size_t i = 0;
+	for( const size_t head = alignHead( result, length ); i < head; i++ )
+		result[i] = ( arrayA[i] + arrayB[i] ) * scalar;
+
+	const Vec scalars = set1( scalar );
+	for( ; i + WIDTH <= length; i += WIDTH )
+		storeAligned( result + i, vmul( vadd( load( arrayA + i ), load( arrayB + i ) ), scalars ) );
+
+	for( ; i < length; i++ )
+		result[i] = ( arrayA[i] + arrayB[i] ) * scalar;
+}
+
+void mulAdd( const float *array, float scalar, float addend, float *result, size_t length )
+{
+	KernelScope scope;
+
+	size_t i = 0;
+	for( const size_t head = alignHead( result, length ); i < head; i++ )
+		result[i] = array[i] * scalar + addend;
+
+	const Vec scalars = set1( scalar );
+	const Vec addends = set1( addend );
+	for( ; i + WIDTH <= length; i += WIDTH )
+		storeAligned( result + i, vadd( vmul( load( array + i ), scalars ), addends ) );
+
+	for( ; i < length; i++ )
+		result[i] = array[i] * scalar + addend;
+}
+
+// Complex arrays are split, as in a BufferSpectral, so whole vectors of real and imaginary parts are multiplied at once.
+void mulAddComplex( const float *realA, const float *imagA, const float *realB, const float *imagB, float *realResult, float *imagResult, size_t length )
+{
+	KernelScope scope;
+
+	size_t i = 0;
+	for( ; i + WIDTH <= length; i += WIDTH ) {
+		const Vec ar = load( realA + i ), ai = load( imagA + i );
+		const Vec br = load( realB + i ), bi = load( imagB + i );
+		store( realResult + i, vadd( load( realResult + i ), vsub( vmul( ar, br ), vmul( ai, bi ) ) ) );
+		store( imagResult + i, vadd( load( imagResult + i ), vadd( vmul( ar, bi ), vmul( ai, br ) ) ) );
+	}
+
+	for( ; i < length; i++ ) {
+		const float ar = realA[i], ai = imagA[i];
+		const float br = realB[i], bi = imagB[i];
+		realResult[i] = realResult[i] + ( ar * br - ai * bi );
+		imagResult[i] = imagResult[i] + ( ar * bi + ai * br );
+	}
+}
+
+// Reductions use two accumulators, to hide the latency of the additions.
+float sum( const float *array, size_t length )
+{
+	KernelScope scope;
+
+	float result = 0;
+	size_t i = 0;
+	for( const size_t head = alignHead( array, length ); i < head; i++ )
+		result += array[i];
+
+	Vec sumA = set1( 0 ), sumB = set1( 0 );
+	for( ; i + 2 * WIDTH <= length; i += 2 * WIDTH ) {
+		sumA = vadd( sumA, loadAligned( array + i ) );
+		sumB = vadd( sumB, loadAligned( array + i + WIDTH ) );
+	}
+	result += sumLanes( vadd( sumA, sumB ) );
+
+	for( ; i < length; i++ )
+		result += array[i];
+
+	return result;
+}
+
+float sumSquares( const float *array, size_t length )
+{
+	KernelScope scope;
+
+	float result = 0;
+	size_t i = 0;
+	for( const size_t head = alignHead( array, length ); i < head; i++ )
+		result += array[i] * array[i];
+
+	Vec sumA = set1( 0 ), sumB = set1( 0 );
+	for( ; i + 2 * WIDTH <= length; i += 2 * WIDTH ) {
+		Vec a = loadAligned( array + i );
+		Vec b = loadAligned( array + i + WIDTH );
+		sumA = vadd( sumA, vmul( a, a ) );
+		sumB = vadd( sumB, vmul( b, b ) );
+	}
+	result += sumLanes( vadd( sumA, sumB ) );
+
+	for( ; i < length; i++ )
+		result += array[i] * array[i];
+
+	return result;
+}
+
+float max( const float *array, size_t length )
+{
+	KernelScope scope;
+
+	float result = -FLT_MAX;
+	size_t i = 0;
+	for( const size_t head = alignHead( array, length ); i < head; i++ )
+		result = std::max( result, array[i] );
+
+	Vec maxA = set1( result ), maxB = set1( result );
+	for( ; i + 2 * WIDTH <= length; i += 2 * WIDTH ) {
+		maxA = vmax( maxA, loadAligned( array + i ) );
+		maxB = vmax( maxB, loadAligned( array + i + WIDTH ) );
+	}
+	result = maxLanes( vmax( maxA, maxB ) );
+
+	for( ; i < length; i++ )
+		result = std::max( result, array[i] );
+
+	return result;
+}
+
+// Sets (rr, ri) to the complex product of (ar, ai) and (br, bi).
+inline void cmul( Vec ar, Vec ai, Vec br, Vec bi, Vec *rr, Vec *ri )
+{
+	*rr = vsub( vmul( ar, br ), vmul( ai, bi ) );
+	*ri = vadd( vmul( ar, bi ), vmul( ai, br ) );
+}
+
+// One radix-2 stage of a forward Stockham FFT, from the split complex array (xr, xi) to (yr, yi), both of length n * s. For each
+// p < m = n / 2 and q < s, reads x[q + s * ( p + j * m )] for j < 2 and writes y[q + s * ( 2 * p + k )], multiplied by the twiddle
+// factor exp( -2 pi i p k / n ), which is (twr, twi)[p] for k = 1. The loop over q is contiguous, so it is vectorized whenever s is a
+// multiple of WIDTH; the first stages of a transform, where s is smaller, fall back to a narrower instruction set.
+void fftRadix2( const float *xr, const float *xi, float *yr, float *yi, const float *twr, const float *twi, size_t n, size_t s )
+{
+	if( s % WIDTH ) {
+		narrower::fftRadix2( xr, xi, yr, yi, twr, twi, n, s );
+		return;
+	}
+
+	KernelScope scope;
+
+	const size_t m = n / 2;
+	for( size_t p = 0; p < m; p++ ) {
+		const Vec wr = set1( twr[p] ), wi = set1( twi[p] );
+		const size_t x0 = s * p, x1 = s * ( p + m );
+		const size_t y0 = s * 2 * p, y1 = y0 + s;
+
+		for( size_t q = 0; q < s; q += WIDTH ) {
+			const Vec ar = load( xr + x0 + q ), ai = load( xi + x0 + q );
+			const Vec br = load( xr + x1 + q ), bi = load( xi + x1 + q );
+
+			Vec rr, ri;
+			cmul( vsub( ar, br ), vsub( ai, bi ), wr, wi, &rr, &ri );
+
+			store( yr + y0 + q, vadd( ar, br ) );
+			store( yi + y0 + q, vadd( ai, bi ) );
+			store( yr + y1 + q, rr );
+			store( yi + y1 + q, ri );
+		}
+	}
+}
+
+// One radix-3 stage, as fftRadix2() with m = n / 3. The twiddle factors for k = 1, 2 are (twr, twi)[2 * p + k - 1].
+void fftRadix3( const float *xr, const float *xi, float *yr, float *yi, const float *twr, const float *twi, size_t n, size_t s )
+{
+	if( s % WIDTH ) {
+		narrower::fftRadix3( xr, xi, yr, yi, twr, twi, n, s );
+		return;
+	}
+
+	KernelScope scope;
+
+	const Vec half = set1( 0.5f );
+	const Vec sin60 = set1( 0.86602540378443865f );
+
+	const size_t m = n / 3;
+	for( size_t p = 0; p < m; p++ ) {
+		const Vec w1r = set1( twr[2 * p] ), w1i = set1( twi[2 * p] );
+		const Vec w2r = set1( twr[2 * p + 1] ), w2i = set1( twi[2 * p + 1] );
+		const size_t x0 = s * p, x1 = s * ( p + m ), x2 = s * ( p + 2 * m );
+		const size_t y0 = s * 3 * p, y1 = y0 + s, y2 = y1 + s;
+
+		for( size_t q = 0; q < s; q += WIDTH ) {
+			const Vec ar = load( xr + x0 + q ), ai = load( xi + x0 + q );
+			const Vec br = load( xr + x1 + q ), bi = load( xi + x1 + q );
+			const Vec cr = load( xr + x2 + q ), ci = load( xi + x2 + q );
+
+			const Vec bpcr = vadd( br, cr ), bpci = vadd( bi, ci );
+			const Vec tr = vsub( ar, vmul( half, bpcr ) ), ti = vsub( ai, vmul( half, bpci ) );
+			const Vec ur = vmul( sin60, vsub( br, cr ) ), ui = vmul( sin60, vsub( bi, ci ) );
+
+			store( yr + y0 + q, vadd( ar, bpcr ) );
+			store( yi + y0 + q, vadd( ai, bpci ) );
+
+			// t -/+ i u, for k = 1 and 2
+			Vec rr, ri;
+			cmul( vadd( tr, ui ), vsub( ti, ur ), w1r, w1i, &rr, &ri );
+			store( yr + y1 + q, rr );
+			store( yi + y1 + q, ri );
+
+			cmul( vsub( tr, ui ), vadd( ti, ur ), w2r, w2i, &rr, &ri );
+			store( yr + y2 + q, rr );
+			store( yi + y2 + q, ri );
+		}
+	}
+}
+
+// One radix-4 stage, as fftRadix2() with m = n / 4. The twiddle factors for k = 1, 2, 3 are (twr, twi)[3 * p + k - 1].
+void fftRadix4( const float *xr, const float *xi, float *yr, float *yi, const float *twr, const float *twi, size_t n, size_t s )
+{
+	if( s % WIDTH ) {
+		narrower::fftRadix4( xr, xi, yr, yi, twr, twi, n, s );
+		return;
+	}
+
+	KernelScope scope;
+
+	const size_t m = n / 4;
+	for( size_t p = 0; p < m; p++ ) {
+		const Vec w1r = set1( twr[3 * p] ), w1i = set1( twi[3 * p] );
+		const Vec w2r = set1( twr[3 * p + 1] ), w2i = set1( twi[3 * p + 1] );
+		const Vec w3r = set1( twr[3 * p + 2] ), w3i = set1( twi[3 * p + 2] );
+		const size_t x0 = s * p, x1 = s * ( p + m ), x2 = s * ( p + 2 * m ), x3 = s * ( p + 3 * m );
+		const size_t y0 = s * 4 * p, y1 = y0 + s, y2 = y1 + s, y3 = y2 + s;
+
+		for( size_t q = 0; q < s; q += WIDTH ) {
+			const Vec ar = load( xr + x0 + q ), ai = load( xi + x0 + q );
+			const Vec br = load( xr + x1 + q ), bi = load( xi + x1 + q );
+			const Vec cr = load( xr + x2 + q ), ci = load( xi + x2 + q );
+			const Vec dr = load( xr + x3 + q ), di = load( xi + x3 + q );
+
+			const Vec apcr = vadd( ar, cr ), apci = vadd( ai, ci );
+			const Vec amcr = vsub( ar, cr ), amci = vsub( ai, ci );
+			const Vec bpdr = vadd( br, dr ), bpdi = vadd( bi, di );
+			const Vec bmdr = vsub( br, dr ), bmdi = vsub( bi, di );
+
+			store( yr + y0 + q, vadd( apcr, bpdr ) );
+			store( yi + y0 + q, vadd( apci, bpdi ) );
+
+			// multiplying by -i and i, for k = 1 and 3
+			Vec rr, ri;
+			cmul( vadd( amcr, bmdi ), vsub( amci, bmdr ), w1r, w1i, &rr, &ri );
+			store( yr + y1 + q, rr );
+			store( yi + y1 + q, ri );
+
+			cmul( vsub( apcr, bpdr ), vsub( apci, bpdi ), w2r, w2i, &rr, &ri );
+			store( yr + y2 + q, rr );
+			store( yi + y2 + q, ri );
+
+			cmul( vsub( amcr, bmdi ), vadd( amci, bmdr ), w3r, w3i, &rr, &ri );
+			store( yr + y3 + q, rr );
+			store( yi + y3 + q, ri );
+		}
+	}
+}
+
+// One radix-5 stage, as fftRadix2() with m = n / 5. The twiddle factors for k = 1 to 4 are (twr, twi)[4 * p + k - 1].
+void fftRadix5( const float *xr, const float *xi, float *yr, float *yi, const float *twr, const float *twi, size_t n, size_t s )
+{
+	if( s % WIDTH ) {
+		narrower::fftRadix5( xr, xi, yr, yi, twr, twi, n, s );
+		return;
+	}
+
+	KernelScope scope;
+
+	// cos and sin of 2 pi / 5 and 4 pi / 5
+	const Vec cos1 = set1( 0.30901699437494742f ), cos2 = set1( -0.80901699437494742f );
+	const Vec sin1 = set1( 0.95105651629515357f ), sin2 = set1( 0.58778525229247313f );
+
+	const size_t m = n / 5;
+	for( size_t p = 0; p < m; p++ ) {
+		const Vec w1r = set1( twr[4 * p] ), w1i = set1( twi[4 * p] );
+		const Vec w2r = set1( twr[4 * p + 1] ), w2i = set1( twi[4 * p + 1] );
+		const Vec w3r = set1( twr[4 * p + 2] ), w3i = set1( twi[4 * p + 2] );
+		const Vec w4r = set1( twr[4 * p + 3] ), w4i = set1( twi[4 * p + 3] );
+		const size_t x0 = s * p, x1 = s * ( p + m ), x2 = s * ( p + 2 * m ), x3 = s * ( p + 3 * m ), x4 = s * ( p + 4 * m );
+		const size_t y0 = s * 5 * p, y1 = y0 + s, y2 = y1 + s, y3 = y2 + s, y4 = y3 + s;
+
+		for( size_t q = 0; q < s; q += WIDTH ) {
+			const Vec ar = load( xr + x0 + q ), ai = load( xi + x0 + q );
+			const Vec br = load( xr + x1 + q ), bi = load( xi + x1 + q );
+			const Vec cr = load( xr + x2 + q ), ci = load( xi + x2 + q );
+			const Vec dr = load( xr + x3 + q ), di = load( xi + x3 + q );
+			const Vec er = load( xr + x4 + q ), ei = load( xi + x4 + q );
+
+			const Vec bper = vadd( br, er ), bpei = vadd( bi, ei );
+			const Vec bmer = vsub( br, er ), bmei = vsub( bi, ei );
+			const Vec cpdr = vadd( cr, dr ), cpdi = vadd( ci, di );
+			const Vec cmdr = vsub( cr, dr ), cmdi = vsub( ci, di );
+
+			store( yr + y0 + q, vadd( ar, vadd( bper, cpdr ) ) );
+			store( yi + y0 + q, vadd( ai, vadd( bpei, cpdi ) ) );
+
+			const Vec m1r = vadd( ar, vadd( vmul( cos1, bper ), vmul( cos2, cpdr ) ) );
+			const Vec m1i = vadd( ai, vadd( vmul( cos1, bpei ), vmul( cos2, cpdi ) ) );
+			const Vec m2r = vadd( ar, vadd( vmul( cos2, bper ), vmul( cos1, cpdr ) ) );
+			const Vec m2i = vadd( ai, vadd( vmul( cos2, bpei ), vmul( cos1, cpdi ) ) );
+			const Vec n1r = vadd( vmul( sin1, bmer ), vmul( sin2, cmdr ) );
+			const Vec n1i = vadd( vmul( sin1, bmei ), vmul( sin2, cmdi ) );
+			const Vec n2r = vsub( vmul( sin2, bmer ), vmul( sin1, cmdr ) );
+			const Vec n2i = vsub( vmul( sin2, bmei ), vmul( sin1, cmdi ) );
+
+			// m1 -/+ i n1 for k = 1 and 4, m2 -/+ i n2 for k = 2 and 3
+			Vec rr, ri;
+			cmul( vadd( m1r, n1i ), vsub( m1i, n1r ), w1r, w1i, &rr, &ri );
+			store( yr + y1 + q, rr );
+			store( yi + y1 + q, ri );
+
+			cmul( vadd( m2r, n2i ), vsub( m2i, n2r ), w2r, w2i, &rr, &ri );
+			store( yr + y2 + q, rr );
+			store( yi + y2 + q, ri );
+
+			cmul( vsub( m2r, n2i ), vadd( m2i, n2r ), w3r, w3i, &rr, &ri );
+			store( yr + y3 + q, rr );
+			store( yi + y3 + q, ri );
+
+			cmul( vsub( m1r, n1i ), vadd( m1i, n1r ), w4r, w4i, &rr, &ri );
+			store( yr + y4 + q, rr );
+			store( yi + y4 + q, ri );
+		}
+	}
+}
+
+// The coefficients and state of the biquads in one vector of lanes, see biquad().
+struct BiquadLanes {
+	typedef Vec Vector;
+	typedef float Sample;
+	static const size_t LANES = WIDTH;
+
+	static Vec	loadFrames( const float *p )			{ return load( p ); }
+	static void	storeFrames( float *p, Vec v )			{ store( p, v ); }
+
+	void loadLanes( const float *coefficients, const float *state, size_t stride )
+	{
+		mB0 = load( coefficients );
+		mB1 = load( coefficients + stride );
+		mB2 = load( coefficients + 2 * stride );
+		mA1 = load( coefficients + 3 * stride );
+		mA2 = load( coefficients + 4 * stride );
+		mS1 = load( state );
+		mS2 = load( state + stride );
+	}
+
+	void storeState( float *state, size_t stride ) const
+	{
+		store( state, mS1 );
+		store( state + stride, mS2 );
+	}
+
+	Vec process( Vec x )
+	{
+		Vec y = vadd( vmul( mB0, x ), mS1 );
+		mS1 = vadd( vsub( vmul( mB1, x ), vmul( mA1, y ) ), mS2 );
+		mS2 = vsub( vmul( mB2, x ), vmul( mA2, y ) );
+		return y;
+	}
+
+	Vec mB0, mB1, mB2, mA1, mA2, mS1, mS2;
+};
+
+// As BiquadLanes, in double precision.
+struct BiquadLanesD {
+	typedef VecD Vector;
+	typedef double Sample;
+	static const size_t LANES = WIDTH_D;
+
+	static VecD	loadFrames( const float *p )			{ return loadFloats( p ); }
+	static void	storeFrames( float *p, VecD v )			{ storeFloats( p, v ); }
+
+	void loadLanes( const double *coefficients, const double *state, size_t stride )
+	{
+		mB0 = load( coefficients );
+		mB1 = load( coefficients + stride );
+		mB2 = load( coefficients + 2 * stride );
+		mA1 = load( coefficients + 3 * stride );
+		mA2 = load( coefficients + 4 * stride );
+		mS1 = load( state );
+		mS2 = load( state + stride );
+	}
+
+	void storeState( double *state, size_t stride ) const
+	{
+		store( state, mS1 );
+		store( state + stride, mS2 );
+	}
+
+	VecD process( VecD x )
+	{
+		VecD y = vadd( vmul( mB0, x ), mS1 );
+		mS1 = vadd( vsub( vmul( mB1, x ), vmul( mA1, y ) ), mS2 );
+		mS2 = vsub( vmul( mB2, x ), vmul( mA2, y ) );
+		return y;
+	}
+
+	VecD mB0, mB1, mB2, mA1, mA2, mS1, mS2;
+};
+
+// Runs the biquads of GROUPS vectors of lanes, see biquad(). Each vector of lanes loads LANES frames from each of its lanes' channels, which
+// transpose() turns into one vector per frame for the recursion, and back. Every frame depends on the one before, so more than one vector
+// of lanes is run at once to hide the latency of the recursion. The last frames, less than LANES, are interleaved one at a time.
+template <typename LanesT, size_t GROUPS>
+void biquadGroups( const float *const *sources, float *const *dests, size_t numFrames, size_t stride, const typename LanesT::Sample *coefficients, typename LanesT::Sample *state )
+{
+	typedef typename LanesT::Vector Vector;
+	typedef typename LanesT::Sample Sample;
+	const size_t LANES = LanesT::LANES;
+
+	LanesT groups[GROUPS];
+	for( size_t g = 0; g < GROUPS; g++ )
+		groups[g].loadLanes( coefficients + g * LANES, state + g * LANES, stride );
+
+	size_t frame = 0;
+	for( ; frame + LANES <= numFrames; frame += LANES ) {
+		Vector rows[GROUPS][LANES];
+		for( size_t g = 0; g < GROUPS; g++ ) {
+			for( size_t lane = 0; lane < LANES; lane++ )
+				rows[g][lane] = LanesT::loadFrames( sources[g * LANES + lane] + frame );
+			transpose( rows[g] );
+		}
+
+		for( size_t i = 0; i < LANES; i++ ) {
+			for( size_t g = 0; g < GROUPS; g++ )
+				rows[g][i] = groups[g].process( rows[g][i] );
+		}
+
+		for( size_t g = 0; g < GROUPS; g++ ) {
+			transpose( rows[g] );
+			for( size_t lane = 0; lane < LANES; lane++ )
+				LanesT::storeFrames( dests[g * LANES + lane] + frame, rows[g][lane] );
+		}
+	}
+	for( ; frame < numFrames; frame++ ) {
+		for( size_t g = 0; g < GROUPS; g++ ) {
+			Sample x[LANES];
+			for( size_t lane = 0; lane < LANES; lane++ )
+				x[lane] = Sample( sources[g * LANES + lane][frame] );
+
+			store( x, groups[g].process( load( x ) ) );
+			for( size_t lane = 0; lane < LANES; lane++ )
+				dests[g * LANES + lane][frame] = float( x[lane] );
+		}
+	}
+
+	for( size_t g = 0; g < GROUPS; g++ )
+		groups[g].storeState( state + g * LANES, stride );
+}
+
+// Runs numLanes independent biquads in transposed direct form II, each over numFrames frames from its own channel in sources to the same channel
+// in dests, which can be the same. The coefficients b0, b1, b2, a1 and a2 of each lane are at coefficients[k * stride + lane], for k < 5, and its
+// two state variables at state[k * stride + lane], for k < 2. Lanes left over from whole vectors fall back to a narrower instruction set.
+void biquad( const float *const *sources, float *const *dests, size_t numFrames, size_t numLanes, size_t stride, const float *coefficients, float *state )
+{
+	KernelScope scope;
+
+	size_t lane = 0;
+	for( ; lane + 2 * WIDTH <= numLanes; lane += 2 * WIDTH )
+		biquadGroups<BiquadLanes, 2>( sources + lane, dests + lane, numFrames, stride, coefficients + lane, state + lane );
+	if( lane + WIDTH <= numLanes ) {
+		biquadGroups<BiquadLanes, 1>( sources + lane, dests + lane, numFrames, stride, coefficients + lane, state + lane );
+		lane += WIDTH;
+	}
+	if( lane < numLanes )
+		narrower::biquad( sources + lane, dests + lane, numFrames, numLanes - lane, stride, coefficients + lane, state + lane );
+}
+
+// As biquad(), computed in double precision.
+void biquadDouble( const float *const *sources, float *const *dests, size_t numFrames, size_t numLanes, size_t stride, const double *coefficients, double *state )
+{
+	KernelScope scope;
+
+	size_t lane = 0;
+	for( ; lane + 2 * WIDTH_D <= numLanes; lane += 2 * WIDTH_D )
+		biquadGroups<BiquadLanesD, 2>( sources + lane, dests + lane, numFrames, stride, coefficients + lane, state + lane );
+	if( lane + WIDTH_D <= numLanes ) {
+		biquadGroups<BiquadLanesD, 1>( sources + lane, dests + lane, numFrames, stride, coefficients + lane, state + lane );
+		lane += WIDTH_D;
+	}
+	if( lane < numLanes )
+		narrower::biquadDouble( sources + lane, dests + lane, numFrames, numLanes - lane, stride, coefficients + lane, state + lane );
+}
+
+// Linearly interpolated reads from wavetables of 2^tableBits samples, at 32-bit fixed-point phases: the top tableBits bits of a phase are
+// the index into the table and the rest are the fraction between it and the next sample. Phases wrap around by integer overflow.
+struct WavetableReader {
+	WavetableReader( size_t tableBits )
+		: mFracBits( int( 32 - tableBits ) ), mIndexMask( set1i( uint32_t( ( 1u << tableBits ) - 1 ) ) ), mOne( set1i( 1 ) ),
+		mFracMask( set1i( ( 1u << mFracBits ) - 1 ) ), mFracScale( set1( 1.0f / float( 1u << mFracBits ) ) )
+	{}
+
+	void locate( VecI phases )
+	{
+		mIndex1 = vsrli( phases, mFracBits );
+		mIndex2 = vandi( vaddi( mIndex1, mOne ), mIndexMask );
+		mFrac = vmul( toFloat( vandi( phases, mFracMask ) ), mFracScale );
+	}
+
+	Vec read( const float *table ) const
+	{
+		const Vec a = gather( table, mIndex1 );
+		const Vec b = gather( table, mIndex2 );
+		return vadd( a, vmul( mFrac, vsub( b, a ) ) );
+	}
+
+	// Reads from two tables at the located phases and crossfades from the first to the second by mix.
+	Vec read( const float *table, const float *table2, Vec mix ) const
+	{
+		const Vec a = read( table );
+		return vadd( a, vmul( mix, vsub( read( table2 ), a ) ) );
+	}
+
+	int		mFracBits;
+	VecI	mIndexMask, mOne, mFracMask, mIndex1, mIndex2;
+	Vec		mFracScale, mFrac;
+};
+
+// Fills the whole vectors of dest for wavetable(), returning the number of samples filled.
+template <bool CROSSFADE>
+size_t wavetableVectors( const float *table, const float *table2, float mix, size_t tableBits, uint32_t phase, uint32_t phaseIncr, float *dest, size_t length )
+{
+	WavetableReader reader( tableBits );
+	const Vec mixes = set1( mix );
+
+	uint32_t ramp[WIDTH];
+	for( size_t i = 0; i < WIDTH; i++ )
+		ramp[i] = phase + uint32_t( i ) * phaseIncr;
+
+	VecI phases = loadi( ramp );
+	const VecI step = set1i( uint32_t( WIDTH ) * phaseIncr );
+
+	size_t i = 0;
+	for( ; i + WIDTH <= length; i += WIDTH ) {
+		reader.locate( phases );
+		store( dest + i, CROSSFADE ? reader.read( table, table2, mixes ) : reader.read( table ) );
+		phases = vaddi( phases, step );
+	}
+
+	return i;
+}
+
+// Fills dest with length samples of the wavetable oscillator that starts at phase and advances by phaseIncr per sample, which is table
+// crossfaded to table2 by mix if table2 is not null. Both tables have 2^tableBits samples, for 0 < tableBits < 32. The last samples, less
+// than a whole vector, fall back to a narrower instruction set.
+void wavetable( const float *table, const float *table2, float mix, size_t tableBits, uint32_t phase, uint32_t phaseIncr, float *dest, size_t length )
+{
+	KernelScope scope;
+
+	const size_t i = table2 ? wavetableVectors<true>( table, table2, mix, tableBits, phase, phaseIncr, dest, length )
+							: wavetableVectors<false>( table, table2, mix, tableBits, phase, phaseIncr, dest, length );
+	if( i < length )
+		narrower::wavetable( table, table2, mix, tableBits, phase + uint32_t( i ) * phaseIncr, phaseIncr, dest + i, length - i );
+}
+
+// Fills the whole vectors of dest for wavetablePhases(), returning the number of samples filled.
+template <bool CROSSFADE>
+size_t wavetablePhasesVectors( const float *table, const float *table2, float mix, size_t tableBits, const uint32_t *phases, float *dest, size_t length )
+{
+	WavetableReader reader( tableBits );
+	const Vec mixes = set1( mix );
+
+	size_t i = 0;
+	for( ; i + WIDTH <= length; i += WIDTH ) {
+		reader.locate( loadi( phases + i ) );
+		store( dest + i, CROSSFADE ? reader.read( table, table2, mixes ) : reader.read( table ) );
+	}
+
+	return i;
+}
+
+// As wavetable(), reading each sample at the corresponding element of phases.
+void wavetablePhases( const float *table, const float *table2, float mix, size_t tableBits, const uint32_t *phases, float *dest, size_t length )
+{
+	KernelScope scope;
+
+	const size_t i = table2 ? wavetablePhasesVectors<true>( table, table2, mix, tableBits, phases, dest, length )
+							: wavetablePhasesVectors<false>( table, table2, mix, tableBits, phases, dest, length );
+	if( i < length )
+		narrower::wavetablePhases( table, table2, mix, tableBits, phases + i, dest + i, length - i );
+}
+
+// Adds the whole vectors of one oscillator of wavetableBank() to dest, its amplitude ramping from amp by ampIncr per sample. Returns the
+// number of samples added.
+size_t wavetableBankVectors( const float *table, size_t tableBits, uint32_t phase, uint32_t phaseIncr, float amp, float ampIncr, float *dest, size_t length )
+{
+	WavetableReader reader( tableBits );
+
+	uint32_t phaseRamp[WIDTH];
+	float ampRamp[WIDTH];
+	for( size_t i = 0; i < WIDTH; i++ ) {
+		phaseRamp[i] = phase + uint32_t( i ) * phaseIncr;
+		ampRamp[i] = amp + float( i ) * ampIncr;
+	}
+
+	VecI phases = loadi( phaseRamp );
+	Vec amps = load( ampRamp );
+	const VecI phaseStep = set1i( uint32_t( WIDTH ) * phaseIncr );
+	const Vec ampStep = set1( float( WIDTH ) * ampIncr );
+
+	size_t i = 0;
+	for( ; i + WIDTH <= length; i += WIDTH ) {
+		reader.locate( phases );
+		store( dest + i, vadd( load( dest + i ), vmul( amps, reader.read( table ) ) ) );
+		phases = vaddi( phases, phaseStep );
+		amps = vadd( amps, ampStep );
+	}
+
+	return i;
+}
+
+// Adds length samples of each of numOscillators wavetable oscillators to dest. Oscillator i reads table tableIndices[i] of tables, which
+// are laid out one after another with 2^tableBits samples each, starting at phases[i] and advancing by phaseIncrs[i] per sample. Its
+// amplitude ramps linearly from amps[i] to targetAmps[i] over the length samples. phases and amps are updated to where the oscillators
+// end up, and oscillators that are silent throughout are only advanced.
+void wavetableBank( const float *tables, size_t tableBits, const uint32_t *tableIndices, uint32_t *phases, const uint32_t *phaseIncrs, float *amps, const float *targetAmps,
+					size_t numOscillators, float *dest, size_t length )
+{
+	KernelScope scope;
+
+	if( ! length )
+		return;
+
+	const float lengthInv = 1.0f / float( length );
+	for( size_t osc = 0; osc < numOscillators; osc++ ) {
+		const uint32_t phase = phases[osc];
+		const uint32_t phaseIncr = phaseIncrs[osc];
+		const float amp = amps[osc];
+		const float targetAmp = targetAmps[osc];
+
+		phases[osc] = phase + uint32_t( length ) * phaseIncr;
+		amps[osc] = targetAmp;
+
+		if( amp == 0 && targetAmp == 0 )
+			continue;
+
+		const float *table = tables + ( size_t( tableIndices[osc] ) << tableBits );
+		const float ampIncr = ( targetAmp - amp ) * lengthInv;
+
+		const size_t i = wavetableBankVectors( table, tableBits, phase, phaseIncr, amp, ampIncr, dest, length );
+		if( i < length ) {
+			const uint32_t tableIndex = 0;
+			uint32_t tailPhase = phase + uint32_t( i ) * phaseIncr;
+			float tailAmp = amp + float( i ) * ampIncr;
+			narrower::wavetableBank( table, tableBits, &tableIndex, &tailPhase, &phaseIncr, &tailAmp, &targetAmp, 1, dest + i, length - i );
+		}
+	}
+}
+
+// Advances a xorshift32 generator, which only stays at zero if it starts there.
+inline uint32_t nextNoiseState( uint32_t x )
+{
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	return x;
+}
+
+inline VecI nextNoiseStates( VecI x )
+{
+	x = vxori( x, vslli( x, 13 ) );
+	x = vxori( x, vsrli( x, 17 ) );
+	return vxori( x, vslli( x, 5 ) );
+}
+
+// Fills dest with length samples of uniform white noise in [-1:1) from NUM_NOISE_GENERATORS xorshift32 generators, whose states must not
+// be zero, that take turns starting with states[first]. Each sample is the top 23 bits of the generator's next state, which convert to float
+// exactly, so the samples don't depend on the instruction set. Whole turns of the generators are run as vectors.
+void noise( uint32_t *states, size_t first, float *dest, size_t length )
+{
+	KernelScope scope;
+
+	const float scale = 1.0f / float( 1 << 22 );
+
+	size_t i = 0;
+	for( ; i < length && ( first + i ) % NUM_NOISE_GENERATORS; i++ ) {
+		uint32_t &state = states[( first + i ) % NUM_NOISE_GENERATORS];
+		state = nextNoiseState( state );
+		dest[i] = float( state >> 9 ) * scale - 1;
+	}
+
+	if( i + NUM_NOISE_GENERATORS <= length ) {
+		const size_t numVecs = NUM_NOISE_GENERATORS / WIDTH;
+		const Vec scales = set1( scale );
+		const Vec ones = set1( 1 );
+
+		VecI vecStates[numVecs];
+		for( size_t j = 0; j < numVecs; j++ )
+			vecStates[j] = loadi( states + j * WIDTH );
+
+		for( ; i + NUM_NOISE_GENERATORS <= length; i += NUM_NOISE_GENERATORS ) {
+			for( size_t j = 0; j < numVecs; j++ ) {
+				vecStates[j] = nextNoiseStates( vecStates[j] );
+				store( dest + i + j * WIDTH, vsub( vmul( toFloat( vsrli( vecStates[j], 9 ) ), scales ), ones ) );
+			}
+		}
+
+		for( size_t j = 0; j < numVecs; j++ )
+			storei( states + j * WIDTH, vecStates[j] );
+	}
+
+	for( size_t state = 0; i < length; i++, state++ ) {
+		states[state] = nextNoiseState( states[state] );
+		dest[i] = float( states[state] >> 9 ) * scale - 1;
+	}
+}
+
+const SimdKernels KERNELS = { fill, addScalar, add, sub, mulScalar, mul, addMul, mulAdd, mulAddComplex, sum, sumSquares, max, fftRadix2, fftRadix3, fftRadix4, fftRadix5,
+								biquad, biquadDouble, wavetable, wavetablePhases, wavetableBank, noise };
@@ -22,6 +22,7 @@
 */
 
 #include "cinder/audio2/dsp/Fft.h"
+#include "cinder/audio2/dsp/DspSimd.h"
 #include "cinder/audio2/CinderAssert.h"
 #include "cinder/audio2/Exception.h"
 #include "cinder/audio2/Utilities.h"
@@ -30,128 +31,511 @@
 	#include "cinder/audio2/dsp/ooura/fftsg.h"
 #endif
 
+#include <map>
+#include <mutex>
+
+using namespace std;
+
 namespace cinder { namespace audio2 { namespace dsp {
 
+namespace {
+
+#if defined( CINDER_AUDIO_VDSP )
+// The mixed-radix FFT matches the scaling and sign of vDSP_fft_zrip(), which is used for powers of two.
+const float SPECTRAL_SCALE = 2;
+const float IMAG_SIGN = 1;
+#else
+// The mixed-radix FFT matches Ooura's rdft(), which is unscaled and stores the imaginary parts negated.
+const float SPECTRAL_SCALE = 1;
+const float IMAG_SIGN = -1;
+#endif
+
+} // anonymous namespace
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - Plan
+// ----------------------------------------------------------------------------------------------------
+
+// Powers of two use the platform's FFT, if there is one, and all other sizes use the mixed-radix FFT.
+//
+// The mixed-radix real FFT of size N is computed as a complex FFT of size N / 2 on the even (real part) and odd (imaginary part)
+// samples, which is then split into the spectra of the even and odd samples and recombined. The complex FFT is a Stockham autosort FFT
+// on split complex arrays, so that it needs no bit reversal and its inner loops are contiguous.
+struct Fft::Plan {
+	Plan( size_t fftSize );
+	~Plan();
+
+	// The mixed-radix transforms, scratch holds N floats.
+	void forward( const float *waveform, float *real, float *imag, float *scratch ) const;
+	void inverse( const float *real, const float *imag, float *waveform, float *scratch ) const;
+
+	// Runs the complex FFT on (ar, ai), alternating with (br, bi) between stages. The result ends up in (ar, ai) if there is an even
+	// number of stages, otherwise in (br, bi).
+	void transform( float *ar, float *ai, float *br, float *bi ) const;
+
+	bool hasEvenNumStages() const	{ return mStages.size() % 2 == 0; }
+
+	// Each stage reduces the length of the sub-transforms, n, by its radix and multiplies their number, s, by it.
+	struct Stage {
+		size_t	mRadix, mN, mS, mTwiddleOffset;
+	};
+
+	size_t			mSize;
+	bool			mMixedRadix;
+	vector<Stage>	mStages;
+	vector<float>	mTwiddleReal, mTwiddleImag;		// exp( -2 pi i p k / n ) for each stage
+	vector<float>	mSplitCos, mSplitSin;			// cos and sin( 2 pi k / N ) for k <= N / 4, used to split and recombine the spectra
+
+#if defined( CINDER_AUDIO_VDSP )
+	size_t			mLog2FftSize;
+	::FFTSetup		mFftSetup;
+#elif defined( CINDER_AUDIO_FFT_OOURA )
+	vector<int>		mIp;
+	vector<float>	mW;
+#endif
+};
+
+Fft::Plan::Plan( size_t fftSize )
+	: mSize( fftSize ), mMixedRadix( true )
+{
+#if defined( CINDER_AUDIO_VDSP )
+	mFftSetup = nullptr;
+	if( isPowerOf2( fftSize ) ) {
+		mMixedRadix = false;
+		mLog2FftSize = log2f( fftSize );
+		mFftSetup = vDSP_create_fftsetup( mLog2FftSize, FFT_RADIX2 );
+		CI_ASSERT( mFftSetup );
+		return;
+	}
+#elif defined( CINDER_AUDIO_FFT_OOURA )
+	if( isPowerOf2( fftSize ) ) {
+		mMixedRadix = false;
+
+		// rdft() fills in ip and w the first time it is called with them, so that is done here before they are shared.
+		mIp.resize( 2 + (size_t)sqrt( fftSize / 2 ) );
+		mW.resize( fftSize / 2 );
+
+		vector<float> data( fftSize );
+		ooura::rdft( (int)fftSize, 1, data.data(), mIp.data(), mW.data() );
+		return;
+	}
+#endif
+
+	const size_t sizeOverTwo = fftSize / 2;
+
+	// radix-4 and radix-2 stages first, so that s is a multiple of the vector width for as many stages as possible
+	for( size_t n = sizeOverTwo, s = 1; n > 1; ) {
+		const size_t radix = n % 4 == 0 ? 4 : ( n % 2 == 0 ? 2 : ( n % 3 == 0 ? 3 : 5 ) );
+		CI_ASSERT( n % radix == 0 );
+
+		const Stage stage = { radix, n, s, mTwiddleReal.size() };
+		mStages.push_back( stage );
+
+		for( size_t p = 0; p < n / radix; p++ ) {
+			for( size_t k = 1; k < radix; k++ ) {
+				const double phase = -2 * M_PI * double( p * k ) / double( n );
+				mTwiddleReal.push_back( float( cos( phase ) ) );
+				mTwiddleImag.push_back( float( sin( phase ) ) );
+			}
+		}
+
+		n /= radix;
+		s *= radix;
+	}
+
+	for( size_t k = 0; k <= sizeOverTwo / 2; k++ ) {
+		const double phase = 2 * M_PI * double( k ) / double( fftSize );
+		mSplitCos.push_back( float( cos( phase ) ) );
+		mSplitSin.push_back( float( sin( phase ) ) );
+	}
+}
+
+Fft::Plan::~Plan()
+{
+#if defined( CINDER_AUDIO_VDSP )
+	if( mFftSetup )
+		vDSP_destroy_fftsetup( mFftSetup );
+#endif
+}
+
+void Fft::Plan::transform( float *ar, float *ai, float *br, float *bi ) const
+{
+	const SimdKernels &kernels = getSimdKernels();
+
+	for( const Stage &stage : mStages ) {
+		const float *twr = mTwiddleReal.data() + stage.mTwiddleOffset;
+		const float *twi = mTwiddleImag.data() + stage.mTwiddleOffset;
+
+		switch( stage.mRadix ) {
+			case 2: kernels.fftRadix2( ar, ai, br, bi, twr, twi, stage.mN, stage.mS ); break;
+			case 3: kernels.fftRadix3( ar, ai, br, bi, twr, twi, stage.mN, stage.mS ); break;
+			case 4: kernels.fftRadix4( ar, ai, br, bi, twr, twi, stage.mN, stage.mS ); break;
+			case 5: kernels.fftRadix5( ar, ai, br, bi, twr, twi, stage.mN, stage.mS ); break;
+			default: CI_ASSERT_NOT_REACHABLE();
+		}
+
+		swap( ar, br );
+		swap( ai, bi );
+	}
+}
+
+void Fft::Plan::forward( const float *waveform, float *real, float *imag, float *scratch ) const
+{
+	const size_t sizeOverTwo = mSize / 2;
+	float *scratchReal = scratch;
+	float *scratchImag = scratch + sizeOverTwo;
+
+	// pack the even and odd samples into the complex input, in whichever buffer makes the complex FFT finish in (real, imag)
+	const bool evenNumStages = hasEvenNumStages();
+	float *zr = evenNumStages ? real : scratchReal;
+	float *zi = evenNumStages ? imag : scratchImag;
+
+	for( size_t j = 0; j < sizeOverTwo; j++ ) {
+		zr[j] = waveform[j * 2];
+		zi[j] = waveform[j * 2 + 1];
+	}
+
+	if( evenNumStages )
+		transform( real, imag, scratchReal, scratchImag );
+	else
+		transform( scratchReal, scratchImag, real, imag );
+
+	// split into the spectra of the even and odd samples and recombine them, in place. bins k and N / 2 - k depend on each other, so
+	// they are computed together.
+	const float *splitCos = mSplitCos.data();
+	const float *splitSin = mSplitSin.data();
+	const float half = 0.5f * SPECTRAL_SCALE;
+
+	const float dcReal = real[0], dcImag = imag[0];
+	real[0] = SPECTRAL_SCALE * ( dcReal + dcImag );
+	imag[0] = SPECTRAL_SCALE * ( dcReal - dcImag ); // nyquist
+
+	for( size_t k = 1; k <= sizeOverTwo / 2; k++ ) {
+		const size_t j = sizeOverTwo - k;
+
+		const float evenReal = half * ( real[k] + real[j] );
+		const float evenImag = half * ( imag[k] - imag[j] );
+		const float oddReal = half * ( imag[k] + imag[j] );
+		const float oddImag = half * ( real[j] - real[k] );
+
+		const float c = splitCos[k], s = splitSin[k];
+		const float twiddledReal = c * oddReal + s * oddImag;
+		const float twiddledImag = c * oddImag - s * oddReal;
+
+		real[k] = evenReal + twiddledReal;
+		imag[k] = IMAG_SIGN * ( evenImag + twiddledImag );
+		real[j] = evenReal - twiddledReal;
+		imag[j] = IMAG_SIGN * ( twiddledImag - evenImag );
+	}
+}
+
+void Fft::Plan::inverse( const float *real, const float *imag, float *waveform, float *scratch ) const
+{
+	const size_t sizeOverTwo = mSize / 2;
+	float *scratchReal = scratch;
+	float *scratchImag = scratch + sizeOverTwo;
+	float *waveformReal = waveform;
+	float *waveformImag = waveform + sizeOverTwo;
+
+	// waveform is used as the other buffer of the complex FFT, which has to finish in the scratch buffer so that it can be unpacked into waveform.
+	const bool evenNumStages = hasEvenNumStages();
+	float *zr = evenNumStages ? scratchReal : waveformReal;
+	float *zi = evenNumStages ? scratchImag : waveformImag;
+
+	// the reverse of the recombination in forward(), also scaling by 1 / N.
+	const float *splitCos = mSplitCos.data();
+	const float *splitSin = mSplitSin.data();
+	const float scale = 1.0f / ( float( mSize ) * SPECTRAL_SCALE );
+
+	zr[0] = scale * ( real[0] + imag[0] );
+	zi[0] = scale * ( real[0] - imag[0] );
+
+	for( size_t k = 1; k <= sizeOverTwo / 2; k++ ) {
+		const size_t j = sizeOverTwo - k;
+
+		const float sumReal = real[k] + real[j];
+		const float sumImag = IMAG_SIGN * ( imag[k] - imag[j] );
+		const float diffReal = real[k] - real[j];
+		const float diffImag = IMAG_SIGN * ( imag[k] + imag[j] );
+
+		const float c = splitCos[k], s = splitSin[k];
+		const float twiddledReal = c * diffReal - s * diffImag;
+		const float twiddledImag = s * diffReal + c * diffImag;
+
+		zr[k] = scale * ( sumReal - twiddledImag );
+		zi[k] = scale * ( sumImag + twiddledReal );
+		zr[j] = scale * ( sumReal + twiddledImag );
+		zi[j] = scale * ( twiddledReal - sumImag );
+	}
+
+	// the inverse complex FFT is the forward one with the real and imaginary parts swapped, on both input and output
+	if( evenNumStages )
+		transform( scratchImag, scratchReal, waveformImag, waveformReal );
+	else
+		transform( waveformImag, waveformReal, scratchImag, scratchReal );
+
+	for( size_t j = 0; j < sizeOverTwo; j++ ) {
+		waveform[j * 2] = scratchReal[j];
+		waveform[j * 2 + 1] = scratchImag[j];
+	}
+}
+
+struct Fft::PlanCache {
+	mutex								mMutex;
+	map<size_t, weak_ptr<const Plan> >	mPlans;
+};
+
+Fft::PlanCache& Fft::getPlanCache()
+{
+	static PlanCache sPlanCache;
+	return sPlanCache;
+}
+
+shared_ptr<const Fft::Plan> Fft::getPlan( size_t fftSize )
+{
+	PlanCache &cache = getPlanCache();
+	lock_guard<mutex> lock( cache.mMutex );
+
+	weak_ptr<const Plan> &cached = cache.mPlans[fftSize];
+	shared_ptr<const Plan> plan = cached.lock();
+	if( ! plan ) {
+		plan = make_shared<Plan>( fftSize );
+		cached = plan;
+	}
+
+	return plan;
+}
+
+size_t Fft::getNumCachedPlans()
+{
+	PlanCache &cache = getPlanCache();
+	lock_guard<mutex> lock( cache.mMutex );
+
+	size_t result = 0;
+	for( auto it = cache.mPlans.begin(); it != cache.mPlans.end(); ) {
+		if( it->second.expired() )
+			it = cache.mPlans.erase( it );
+		else {
+			++result;
+			++it;
+		}
+	}
+
+	return result;
+}
+
+float Fft::getSpectralScale()
+{
+	return SPECTRAL_SCALE;
+}
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - Fft
+// ----------------------------------------------------------------------------------------------------
+
 Fft::Fft( size_t fftSize )
 : mSize( fftSize )
 {
-	if( mSize < 2 || ! isPowerOf2( mSize ) )
+	if( ! isSizeSupported( mSize ) )
 		throw AudioExc( "invalid fft size" );
 
 	mSizeOverTwo = mSize / 2;
+	mPlan = getPlan( mSize );
 
 	init();
 }
 
+bool Fft::isSizeSupported( size_t fftSize )
+{
+	if( fftSize < 2 || fftSize % 2 )
+		return false;
+
+	size_t remainder = fftSize / 2;
+	const size_t factors[] = { 2, 3, 5 };
+	for( size_t factor : factors ) {
+		while( remainder % factor == 0 )
+			remainder /= factor;
+	}
+
+	return remainder == 1;
+}
+
+size_t Fft::getNextSupportedSize( size_t fftSize )
+{
+	size_t result = max<size_t>( fftSize, 2 );
+	while( ! isSizeSupported( result ) )
+		result++;
+
+	return result;
+}
+
+void Fft::forward( const Buffer *waveform, BufferSpectral *spectral )
+{
+	CI_ASSERT( waveform->getNumFrames() == mSize );
+	CI_ASSERT( spectral->getNumFrames() == mSizeOverTwo );
+
+	forward( waveform->getData(), spectral->getReal(), spectral->getImag() );
+}
+
+void Fft::inverse( const BufferSpectral *spectral, Buffer *waveform )
+{
+	CI_ASSERT( waveform->getNumFrames() == mSize );
+	CI_ASSERT( spectral->getNumFrames() == mSizeOverTwo );
+
+	inverse( spectral->getReal(), spectral->getImag(), waveform->getData() );
+}
+
+void Fft::forwardBatch( const float *waveforms, float *spectra, size_t count )
+{
+	for( size_t i = 0; i < count; i++ ) {
+		float *real = spectra + i * mSize;
+		forward( waveforms + i * mSize, real, real + mSizeOverTwo );
+	}
+}
+
+void Fft::inverseBatch( const float *spectra, float *waveforms, size_t count )
+{
+	for( size_t i = 0; i < count; i++ ) {
+		const float *real = spectra + i * mSize;
+		inverse( real, real + mSizeOverTwo, waveforms + i * mSize );
+	}
+}
+
+void Fft::forwardMultichannel( const Buffer *waveform, vector<BufferSpectral> *spectra )
+{
+	CI_ASSERT( waveform->getNumFrames() == mSize );
+
+	const size_t numChannels = waveform->getNumChannels();
+	if( spectra->size() != numChannels )
+		spectra->resize( numChannels, BufferSpectral( mSize ) );
+
+	for( size_t ch = 0; ch < numChannels; ch++ ) {
+		BufferSpectral &spectral = (*spectra)[ch];
+		CI_ASSERT( spectral.getNumFrames() == mSizeOverTwo );
+
+		forward( waveform->getChannel( ch ), spectral.getReal(), spectral.getImag() );
+	}
+}
+
+void Fft::inverseMultichannel( const vector<BufferSpectral> &spectra, Buffer *waveform )
+{
+	CI_ASSERT( waveform->getNumFrames() == mSize );
+	CI_ASSERT( spectra.size() >= waveform->getNumChannels() );
+
+	for( size_t ch = 0; ch < waveform->getNumChannels(); ch++ ) {
+		const BufferSpectral &spectral = spectra[ch];
+		CI_ASSERT( spectral.getNumFrames() == mSizeOverTwo );
+
+		inverse( spectral.getReal(), spectral.getImag(), waveform->getChannel( ch ) );
+	}
+}
+
 #if defined( CINDER_AUDIO_VDSP )
 
 void Fft::init()
 {
+	mScratch = Buffer( mSize );
 	mSplitComplexResult.realp = (float *)malloc( mSizeOverTwo * sizeof( float ) );
 	mSplitComplexResult.imagp = (float *)malloc( mSizeOverTwo * sizeof( float ) );
-
-	mLog2FftSize = log2f( mSize );
-	mFftSetup = vDSP_create_fftsetup( mLog2FftSize, FFT_RADIX2 );
-	CI_ASSERT( mFftSetup );
 }
 
 Fft::~Fft()
 {
 	free( mSplitComplexResult.realp );
 	free( mSplitComplexResult.imagp );
-	vDSP_destroy_fftsetup( mFftSetup );
 }
 
-void Fft::forward( const Buffer *waveform, BufferSpectral *spectral )
+void Fft::forward( const float *waveform, float *real, float *imag )
 {
-	CI_ASSERT( waveform->getNumFrames() == mSize );
-	CI_ASSERT( spectral->getNumFrames() == mSizeOverTwo );
+	if( mPlan->mMixedRadix ) {
+		mPlan->forward( waveform, real, imag, mScratch.getData() );
+		return;
+	}
 
-	mSplitComplexSignal.realp = spectral->getReal();
-	mSplitComplexSignal.imagp = spectral->getImag();
+	mSplitComplexSignal.realp = real;
+	mSplitComplexSignal.imagp = imag;
 
 	// in-place transfrom is okay here because we already first copy the data from waveform -> spectral
-	vDSP_ctoz( (::DSPComplex *)waveform->getData(), 2, &mSplitComplexSignal, 1, mSizeOverTwo );
-	vDSP_fft_zrip( mFftSetup, &mSplitComplexSignal, 1, mLog2FftSize, FFT_FORWARD );
+	vDSP_ctoz( (::DSPComplex *)waveform, 2, &mSplitComplexSignal, 1, mSizeOverTwo );
+	vDSP_fft_zrip( mPlan->mFftSetup, &mSplitComplexSignal, 1, mPlan->mLog2FftSize, FFT_FORWARD );
 }
 
-void Fft::inverse( const BufferSpectral *spectral, Buffer *waveform )
+void Fft::inverse( const float *real, const float *imag, float *waveform )
 {
-	CI_ASSERT( waveform->getNumFrames() == mSize );
-	CI_ASSERT( spectral->getNumFrames() == mSizeOverTwo );
+	if( mPlan->mMixedRadix ) {
+		mPlan->inverse( real, imag, waveform, mScratch.getData() );
+		return;
+	}
 
-	mSplitComplexSignal.realp = const_cast<float *>( spectral->getReal() );
-	mSplitComplexSignal.imagp = const_cast<float *>( spectral->getImag() );
-	float *data = waveform->getData();
+	mSplitComplexSignal.realp = const_cast<float *>( real );
+	mSplitComplexSignal.imagp = const_cast<float *>( imag );
 
 	// use out-of-place transfrom so as to not overwrite spectral
-	vDSP_fft_zrop( mFftSetup, &mSplitComplexSignal, 1, &mSplitComplexResult, 1, mLog2FftSize, FFT_INVERSE );
-	vDSP_ztoc( &mSplitComplexResult, 1, (::DSPComplex *)data, 2, mSizeOverTwo );
+	vDSP_fft_zrop( mPlan->mFftSetup, &mSplitComplexSignal, 1, &mSplitComplexResult, 1, mPlan->mLog2FftSize, FFT_INVERSE );
+	vDSP_ztoc( &mSplitComplexResult, 1, (::DSPComplex *)waveform, 2, mSizeOverTwo );
 
 	float scale = 1.0f / float( 2 * mSize );
-	vDSP_vsmul( data, 1, &scale, data, 1, mSize );
+	vDSP_vsmul( waveform, 1, &scale, waveform, 1, mSize );
 }
 
-#elif defined( CINDER_AUDIO_FFT_OOURA )
+#else
 
 void Fft::init()
 {
-	mOouraIp = (int *)calloc( 2 + (int)sqrt( mSizeOverTwo ), sizeof( int ) );
-	mOouraW = (float *)calloc( mSizeOverTwo, sizeof( float ) );
-	mBufferCopy = Buffer( mSize );
+	mScratch = Buffer( mSize );
 }
 
 Fft::~Fft()
 {
-	free( mOouraIp );
-	free( mOouraW );
 }
 
-void Fft::forward( const Buffer *waveform, BufferSpectral *spectral )
+void Fft::forward( const float *waveform, float *real, float *imag )
 {
-	CI_ASSERT( waveform->getNumFrames() == mSize );
-	CI_ASSERT( spectral->getNumFrames() == mSizeOverTwo );
-
-	mBufferCopy.copy( *waveform );
-
-	float *a = mBufferCopy.getData();
-	float *real = spectral->getReal();
-	float *imag = spectral->getImag();
+#if defined( CINDER_AUDIO_FFT_OOURA )
+	if( ! mPlan->mMixedRadix ) {
+		float *a = mScratch.getData();
+		memcpy( a, waveform, mSize * sizeof( float ) );
 
-	ooura::rdft( (int)mSize, 1, a, mOouraIp, mOouraW );
+		ooura::rdft( (int)mSize, 1, a, const_cast<int *>( mPlan->mIp.data() ), const_cast<float *>( mPlan->mW.data() ) );
 
-	real[0] = a[0];
-	imag[0] = a[1];
+		real[0] = a[0];
+		imag[0] = a[1];
 
-	for( size_t k = 1; k < mSizeOverTwo; k++ ) {
-		real[k] = a[k * 2];
-		imag[k] = a[k * 2 + 1];
+		for( size_t k = 1; k < mSizeOverTwo; k++ ) {
+			real[k] = a[k * 2];
+			imag[k] = a[k * 2 + 1];
+		}
+		return;
 	}
+#endif
+
+	mPlan->forward( waveform, real, imag, mScratch.getData() );
 }
 
-void Fft::inverse( const BufferSpectral *spectral, Buffer *waveform )
+void Fft::inverse( const float *real, const float *imag, float *waveform )
 {
-	CI_ASSERT( waveform->getNumFrames() == mSize );
-	CI_ASSERT( spectral->getNumFrames() == mSizeOverTwo );
-
-	mBufferCopy.copy( *spectral );
+#if defined( CINDER_AUDIO_FFT_OOURA )
+	if( ! mPlan->mMixedRadix ) {
+		float *a = waveform;
 
-	float *real = mBufferCopy.getData();
-	float *imag = &mBufferCopy.getData()[mSizeOverTwo];
-	float *a = waveform->getData();
+		a[0] = real[0];
+		a[1] = imag[0];
 
-	a[0] = real[0];
-	a[1] = imag[0];
+		for( size_t k = 1; k < mSizeOverTwo; k++ ) {
+			a[k * 2] = real[k];
+			a[k * 2 + 1] = imag[k];
+		}
 
-	for( size_t k = 1; k < mSizeOverTwo; k++ ) {
-		a[k * 2] = real[k];
-		a[k * 2 + 1] = imag[k];
+		// the tables are only read, since the Plan already initialized them
+		ooura::rdft( (int)mSize, -1, a, const_cast<int *>( mPlan->mIp.data() ), const_cast<float *>( mPlan->mW.data() ) );
+		dsp::mul( a, 2.0f / (float)mSize, a, mSize );
+		return;
 	}
+#endif
 
-	ooura::rdft( (int)mSize, -1, a, mOouraIp, mOouraW );
-	dsp::mul( a, 2.0f / (float)mSize, a, mSize );
+	mPlan->inverse( real, imag, waveform, mScratch.getData() );
 }
 
-#endif // defined( CINDER_AUDIO_FFT_OOURA )
+#endif // defined( CINDER_AUDIO_VDSP )
 
 } } } // namespace cinder::audio2::dsp
\ No newline at end of file
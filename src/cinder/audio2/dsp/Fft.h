@@ -32,13 +32,17 @@
 
 #if defined( CINDER_AUDIO_VDSP )
 	#include <Accelerate/Accelerate.h>
-#else
-	#define CINDER_AUDIO_FFT_OOURA
 #endif
 
 namespace cinder { namespace audio2 { namespace dsp {
 
 //! Real Discrete Fourier Transform (DFT)
+//!
+//! Any even size whose half has no prime factors other than 2, 3 and 5 is supported, such as 480 or 960. Powers of two use vDSP on
+//! OS X and iOS (or Ooura's FFT if CINDER_AUDIO_FFT_OOURA is defined), all other sizes use a mixed-radix FFT.
+//!
+//! The twiddle factors and other tables for a given size are computed once and shared by all Fft's of that size, for as long as
+//! any of them exist. An Fft instance can only be used by one thread at a time, but separate instances can be used concurrently.
 class Fft {
 public:
 	Fft( size_t fftSize );
@@ -49,22 +53,51 @@ public:
 	//! Computes the Inverse DFT of \a spectral, filling \a waveform with time-domain audio data
 	void inverse( const BufferSpectral *spectral, Buffer *waveform );
 
+	//! Computes the Forward DFT of the getSize() samples in \a waveform, filling the getSize() / 2 element arrays \a real and \a imag.
+	void forward( const float *waveform, float *real, float *imag );
+	//! Computes the Inverse DFT of the getSize() / 2 element arrays \a real and \a imag, filling the getSize() samples in \a waveform.
+	void inverse( const float *real, const float *imag, float *waveform );
+
+	//! Computes the Forward DFT of \a count waveforms, each getSize() samples and stored one after the other in \a waveforms, filling
+	//! \a count spectra stored one after the other in \a spectra, each laid out as in a BufferSpectral (getSize() / 2 real values followed by getSize() / 2 imaginary values).
+	void forwardBatch( const float *waveforms, float *spectra, size_t count );
+	//! Computes the Inverse DFT of \a count spectra laid out as in forwardBatch(), filling \a count waveforms.
+	void inverseBatch( const float *spectra, float *waveforms, size_t count );
+
+	//! Computes the Forward DFT of each channel of \a waveform, filling the corresponding element of \a spectra, which is resized to match if necessary.
+	void forwardMultichannel( const Buffer *waveform, std::vector<BufferSpectral> *spectra );
+	//! Computes the Inverse DFT of each element of \a spectra, filling the corresponding channel of \a waveform.
+	void inverseMultichannel( const std::vector<BufferSpectral> &spectra, Buffer *waveform );
+
 	size_t getSize() const	{ return mSize; }
 
+	//! Returns whether \a fftSize is supported: an even number whose half has no prime factors other than 2, 3 and 5.
+	static bool		isSizeSupported( size_t fftSize );
+	//! Returns the smallest supported size that is at least \a fftSize.
+	static size_t	getNextSupportedSize( size_t fftSize );
+
+	//! Returns the number of distinct sizes that currently have tables shared between Fft's.
+	static size_t getNumCachedPlans();
+	//! Returns the factor by which forward() scales spectra relative to an unscaled DFT (2 with vDSP, 1 otherwise). inverse() undoes it, so the
+	//! product of two spectra is scaled by it once more than a spectrum is.
+	static float getSpectralScale();
+
 protected:
 	void init();
 
-	size_t				mSize, mSizeOverTwo;
+	struct Plan;
+	struct PlanCache;
+
+	static PlanCache&					getPlanCache();
+	static std::shared_ptr<const Plan>	getPlan( size_t fftSize );
+
+	size_t						mSize, mSizeOverTwo;
+	std::shared_ptr<const Plan>	mPlan;
 
 #if defined( CINDER_AUDIO_VDSP )
-	size_t				mLog2FftSize;
-	::FFTSetup			mFftSetup;
 	::DSPSplitComplex	mSplitComplexSignal, mSplitComplexResult;
-#elif defined( CINDER_AUDIO_FFT_OOURA )
-	Buffer				mBufferCopy;
-	int					*mOouraIp;
-	float				*mOouraW;
 #endif
+	Buffer				mScratch;
 };
 
 } } } // namespace cinder::audio2::dsp
\ No newline at end of file
@@ -0,0 +1,112 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#include "cinder/audio2/dsp/NoiseGenerator.h"
+#include "cinder/audio2/dsp/DspSimd.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace {
+
+// Murmur3's finalizer, which spreads the bits of nearby seeds over the whole state. It maps only 0 to 0.
+inline uint32_t hashSeed( uint32_t x )
+{
+	x ^= x >> 16;
+	x *= 0x85ebca6b;
+	x ^= x >> 13;
+	x *= 0xc2b2ae35;
+	x ^= x >> 16;
+	return x;
+}
+
+} // anonymous namespace
+
+namespace cinder { namespace audio2 { namespace dsp {
+
+NoiseGenerator::NoiseGenerator( uint32_t seed )
+{
+	static_assert( sizeof( mStates ) / sizeof( mStates[0] ) == NUM_NOISE_GENERATORS, "one state is needed for each noise generator" );
+
+	setSeed( seed );
+}
+
+// Each generator starts from a different hash of the seed, none of which can be zero, so that the generators are uncorrelated.
+void NoiseGenerator::setSeed( uint32_t seed )
+{
+	mSeed = seed;
+	mNextState = 0;
+
+	for( size_t i = 0; i < NUM_NOISE_GENERATORS; i++ ) {
+		const uint32_t state = hashSeed( seed + uint32_t( i + 1 ) * 0x9e3779b9 );
+		mStates[i] = state ? state : 1;
+	}
+
+	fill( mPink, mPink + 7, 0.0f );
+	mBrown = 0;
+}
+
+void NoiseGenerator::fillWhite( float *array, size_t length )
+{
+	getSimdKernels().noise( mStates, mNextState, array, length );
+	mNextState = ( mNextState + length ) % NUM_NOISE_GENERATORS;
+}
+
+// The filter coefficients are from http://www.musicdsp.org/files/pink.txt
+void NoiseGenerator::fillPink( float *array, size_t length )
+{
+	fillWhite( array, length );
+
+	float b0 = mPink[0], b1 = mPink[1], b2 = mPink[2], b3 = mPink[3], b4 = mPink[4], b5 = mPink[5], b6 = mPink[6];
+	for( size_t i = 0; i < length; i++ ) {
+		const float white = array[i];
+		b0 = 0.99886f * b0 + white * 0.0555179f;
+		b1 = 0.99332f * b1 + white * 0.0750759f;
+		b2 = 0.96900f * b2 + white * 0.1538520f;
+		b3 = 0.86650f * b3 + white * 0.3104856f;
+		b4 = 0.55000f * b4 + white * 0.5329522f;
+		b5 = -0.7616f * b5 - white * 0.0168980f;
+		array[i] = ( b0 + b1 + b2 + b3 + b4 + b5 + b6 + white * 0.5362f ) * 0.11f;
+		b6 = white * 0.115926f;
+	}
+
+	mPink[0] = b0; mPink[1] = b1; mPink[2] = b2; mPink[3] = b3; mPink[4] = b4; mPink[5] = b5; mPink[6] = b6;
+}
+
+void NoiseGenerator::fillBrown( float *array, size_t length )
+{
+	fillWhite( array, length );
+
+	float brown = mBrown;
+	for( size_t i = 0; i < length; i++ ) {
+		brown = ( brown + 0.02f * array[i] ) * ( 1 / 1.02f );
+		array[i] = brown * 3.5f;
+	}
+
+	mBrown = brown;
+}
+
+} } } // namespace cinder::audio2::dsp
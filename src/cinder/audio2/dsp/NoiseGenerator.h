@@ -0,0 +1,64 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace cinder { namespace audio2 { namespace dsp {
+
+//! \brief Generates white, pink or brown noise from a seed.
+//!
+//! The white noise comes from 16 xorshift generators that take turns, which the SIMD kernels advance together so that each instruction
+//! produces several samples. The output only depends on the seed and the number of samples generated since, not on the instruction set
+//! or how the samples are split between calls, so offline renders are reproducible. Each NoiseGenerator has its own state and can be used
+//! on any thread. Pink and brown noise filter the white noise, one sample at a time.
+class NoiseGenerator {
+  public:
+	//! Constructs a NoiseGenerator whose samples are determined by \a seed.
+	NoiseGenerator( uint32_t seed = 1 );
+
+	//! Restarts the noise from \a seed, clearing the pink and brown noise filters.
+	void		setSeed( uint32_t seed );
+	uint32_t	getSeed() const		{ return mSeed; }
+
+	//! Fills \a array with \a length samples of uniform white noise in the range [-1:1).
+	void	fillWhite( float *array, size_t length );
+	//! Fills \a array with \a length samples of pink noise, which falls off by 3 dB per octave. The white noise is filtered by a sum of one-pole
+	//! lowpass filters, after Paul Kellet's refined method, and scaled to peak at about 1.
+	void	fillPink( float *array, size_t length );
+	//! Fills \a array with \a length samples of brown noise, which falls off by 6 dB per octave. The white noise is integrated with a leak, so that it
+	//! doesn't drift away from 0, and scaled to peak at about 1.
+	void	fillBrown( float *array, size_t length );
+
+  private:
+	uint32_t	mSeed;
+	uint32_t	mStates[16]; // one for each of the generators that take turns, see noise() in DspSimdKernels.h
+	size_t		mNextState;
+	float		mPink[7], mBrown;
+};
+
+} } } // namespace cinder::audio2::dsp
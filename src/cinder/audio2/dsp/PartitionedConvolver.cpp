@@ -0,0 +1,362 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/audio2/dsp/PartitionedConvolver.h"
+#include "cinder/audio2/dsp/Dsp.h"
+#include "cinder/audio2/CinderAssert.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace cinder { namespace audio2 { namespace dsp {
+
+namespace {
+
+// Transforms \a numPartitions partitions of \a partitionSize frames from each channel of \a impulseResponse, starting at \a beginFrame.
+// Each partition is zero-padded to 2 * partitionSize, and the spectra are scaled to cancel the scaling of the Fft::forward() spectra they are multiplied with.
+Buffer transformPartitions( const Buffer &impulseResponse, size_t beginFrame, size_t partitionSize, size_t numPartitions )
+{
+	const size_t fftSize = 2 * partitionSize;
+	const size_t numFrames = impulseResponse.getNumFrames();
+
+	Fft fft( fftSize );
+	Buffer waveforms( fftSize * numPartitions );
+	Buffer result( fftSize * numPartitions, impulseResponse.getNumChannels() );
+
+	for( size_t ch = 0; ch < impulseResponse.getNumChannels(); ch++ ) {
+		waveforms.zero();
+		for( size_t i = 0; i < numPartitions; i++ ) {
+			size_t frame = min( numFrames, beginFrame + i * partitionSize );
+			size_t count = min( partitionSize, numFrames - frame );
+			copy( impulseResponse.getChannel( ch ) + frame, impulseResponse.getChannel( ch ) + frame + count, waveforms.getData() + i * fftSize );
+		}
+
+		fft.forwardBatch( waveforms.getData(), result.getChannel( ch ), numPartitions );
+	}
+
+	dsp::mul( result.getData(), 1.0f / Fft::getSpectralScale(), result.getData(), result.getSize() );
+	return result;
+}
+
+// Multiplies the spectra \a a and \a b, each \a size real values followed by \a size imaginary values, and adds the product to \a result.
+// As with Fft, the first imaginary value holds the real nyquist bin, which is multiplied separately.
+inline void mulAddSpectra( const float *a, const float *b, float *result, size_t size )
+{
+	result[0] += a[0] * b[0];
+	result[size] += a[size] * b[size];
+	dsp::mulAddComplex( a + 1, a + size + 1, b + 1, b + size + 1, result + 1, result + size + 1, size - 1 );
+}
+
+} // anonymous namespace
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - ImpulseResponse
+// ----------------------------------------------------------------------------------------------------
+
+ImpulseResponse::ImpulseResponse( const Buffer &impulseResponse, size_t headPartitionSize, size_t tailPartitionSize )
+	: mNumChannels( impulseResponse.getNumChannels() ), mNumFrames( impulseResponse.getNumFrames() ), mHeadPartitionSize( headPartitionSize ),
+	mTailPartitionSize( tailPartitionSize ), mNumTailPartitions( 0 )
+{
+	CI_ASSERT( Fft::isSizeSupported( 2 * headPartitionSize ) );
+	CI_ASSERT( ! tailPartitionSize || ( tailPartitionSize % headPartitionSize == 0 && Fft::isSizeSupported( 2 * tailPartitionSize ) ) );
+
+	// the head covers the first two tail partitions, so that a tail partition's output isn't needed until a whole tail partition after its input.
+	size_t headFrames = tailPartitionSize ? min( mNumFrames, 2 * tailPartitionSize ) : mNumFrames;
+	mNumHeadPartitions = max<size_t>( 1, ( headFrames + headPartitionSize - 1 ) / headPartitionSize );
+	mHeadSpectra = transformPartitions( impulseResponse, 0, headPartitionSize, mNumHeadPartitions );
+
+	if( headFrames < mNumFrames ) {
+		mNumTailPartitions = ( mNumFrames - headFrames + tailPartitionSize - 1 ) / tailPartitionSize;
+		mTailSpectra = transformPartitions( impulseResponse, headFrames, tailPartitionSize, mNumTailPartitions );
+	}
+}
+
+// ----------------------------------------------------------------------------------------------------
+// MARK: - PartitionedConvolver
+// ----------------------------------------------------------------------------------------------------
+
+PartitionedConvolver::Segment::Segment( const Buffer *spectra, size_t partitionSize, size_t numPartitions, size_t numChannels )
+	: mSpectra( spectra ), mPartitionSize( partitionSize ), mNumPartitions( numPartitions ), mIndex( 0 ), mFft( 2 * partitionSize ),
+	mInput( 2 * partitionSize, numChannels ), mDelayLine( 2 * partitionSize * numPartitions, numChannels ), mSum( 2 * partitionSize ),
+	mWaveform( 2 * partitionSize ), mOutput( partitionSize, numChannels )
+{
+}
+
+PartitionedConvolver::PartitionedConvolver( const ImpulseResponseRef &impulseResponse, size_t numChannels, bool isTailAsync )
+	: mImpulseResponse( impulseResponse ), mNumChannels( numChannels ), mHeadFrame( 0 ), mIsTailAsync( isTailAsync ), mTailFramesMissed( 0 ),
+	mTailFramesSilent( 0 ), mTailState( TAIL_RUNNING ), mNumTailUnderruns( 0 )
+{
+	const size_t numImpulseChannels = impulseResponse->getNumChannels();
+	if( numChannels > 1 && numImpulseChannels == numChannels * numChannels ) {
+		for( size_t input = 0; input < numChannels; input++ ) {
+			for( size_t output = 0; output < numChannels; output++ )
+				mPaths.push_back( { input, output, input * numChannels + output } );
+		}
+	}
+	else {
+		for( size_t ch = 0; ch < numChannels; ch++ )
+			mPaths.push_back( { ch, ch, ch % numImpulseChannels } );
+	}
+
+	const size_t partitionSize = impulseResponse->getHeadPartitionSize();
+	mHead.reset( new Segment( &impulseResponse->getHeadSpectra(), partitionSize, impulseResponse->getNumHeadPartitions(), numChannels ) );
+
+	if( impulseResponse->getNumTailPartitions() ) {
+		const size_t tailPartitionSize = impulseResponse->getTailPartitionSize();
+		mTail.reset( new Segment( &impulseResponse->getTailSpectra(), tailPartitionSize, impulseResponse->getNumTailPartitions(), numChannels ) );
+		mTailScratch = Buffer( partitionSize );
+
+		// The tail's output starts two tail partitions into the impulse response, so that is how much of it is silent before reading from the output
+		// ring buffers. Both leave room for the tail to fall behind by another two tail partitions.
+		mTailFramesSilent = 2 * tailPartitionSize;
+		mTailInputs.reserve( numChannels );
+		mTailOutputs.reserve( numChannels );
+		for( size_t ch = 0; ch < numChannels; ch++ ) {
+			mTailInputs.emplace_back( 4 * tailPartitionSize );
+			mTailOutputs.emplace_back( 4 * tailPartitionSize );
+		}
+	}
+}
+
+PartitionedConvolver::~PartitionedConvolver()
+{
+}
+
+void PartitionedConvolver::process( const Buffer *input, Buffer *output )
+{
+	CI_ASSERT( input->getNumChannels() >= mNumChannels && output->getNumChannels() >= mNumChannels );
+	CI_ASSERT( input->getNumFrames() == output->getNumFrames() );
+
+	const size_t partitionSize = mHead->mPartitionSize;
+	const size_t numFrames = input->getNumFrames();
+
+	// Input is gathered into the current partition, while the output of the previous one is read out. All input is read
+	// before writing output, which is either the same Buffer or an independent one.
+	for( size_t frame = 0; frame < numFrames; ) {
+		const size_t count = min( numFrames - frame, partitionSize - mHeadFrame );
+		for( size_t ch = 0; ch < mNumChannels; ch++ ) {
+			const float *channel = input->getChannel( ch ) + frame;
+			copy( channel, channel + count, mHead->mInput.getChannel( ch ) + partitionSize + mHeadFrame );
+		}
+		for( size_t ch = 0; ch < mNumChannels; ch++ ) {
+			const float *channel = mHead->mOutput.getChannel( ch ) + mHeadFrame;
+			copy( channel, channel + count, output->getChannel( ch ) + frame );
+		}
+
+		frame += count;
+		mHeadFrame += count;
+		if( mHeadFrame == partitionSize ) {
+			processHeadPartition();
+			mHeadFrame = 0;
+		}
+	}
+}
+
+void PartitionedConvolver::processHeadPartition()
+{
+	if( mTail )
+		writeTailInput();
+
+	processSegment( mHead.get() );
+
+	if( mTail ) {
+		if( ! mIsTailAsync )
+			processTail();
+
+		addTailOutput( &mHead->mOutput );
+	}
+}
+
+void PartitionedConvolver::processTail()
+{
+	CI_ASSERT( mTail );
+
+	if( mTailState == TAIL_RESET_REQUESTED ) {
+		resetTail();
+		mTailState = TAIL_RESET_DONE;
+	}
+
+	// the input ring buffers are written in channel order, so once the last one has a whole partition, they all do.
+	const size_t partitionSize = mTail->mPartitionSize;
+	while( mTailInputs.back().getAvailableRead() >= partitionSize ) {
+		for( size_t ch = 0; ch < mNumChannels; ch++ )
+			mTailInputs[ch].read( mTail->mInput.getChannel( ch ) + partitionSize, partitionSize );
+
+		processSegment( mTail.get() );
+
+		for( size_t ch = 0; ch < mNumChannels; ch++ )
+			mTailOutputs[ch].write( mTail->mOutput.getChannel( ch ), partitionSize );
+	}
+}
+
+bool PartitionedConvolver::isTailPending() const
+{
+	return mTail && ( mTailState == TAIL_RESET_REQUESTED || mTailInputs.back().getAvailableRead() >= mTail->mPartitionSize );
+}
+
+// Passes the current head partition of input on to the tail. If it doesn't fit, the tail has fallen too far behind to catch up, so processTail() is asked
+// to start it over and no more input is passed on until it has. Then the output still left from before is discarded, and the tail starts out silent again.
+void PartitionedConvolver::writeTailInput()
+{
+	if( mTailState == TAIL_RESET_REQUESTED )
+		return;
+
+	if( mTailState == TAIL_RESET_DONE ) {
+		// processTail() emptied the input, so it writes no more output until this partition is written.
+		discardTailOutput();
+		mTailFramesMissed = 0;
+		mTailFramesSilent = 2 * mTail->mPartitionSize;
+		mTailState = TAIL_RUNNING;
+	}
+
+	const size_t partitionSize = mHead->mPartitionSize;
+	for( size_t ch = 0; ch < mNumChannels; ch++ ) {
+		if( ! mTailInputs[ch].write( mHead->mInput.getChannel( ch ) + partitionSize, partitionSize ) ) {
+			mTailState = TAIL_RESET_REQUESTED;
+			return;
+		}
+	}
+}
+
+// Adds one head partition of tail output to \a output. If the tail is late, it is left out and as much of its output is skipped once it catches up,
+// so that the rest stays aligned with the head.
+void PartitionedConvolver::addTailOutput( Buffer *output )
+{
+	const size_t partitionSize = mHead->mPartitionSize;
+	if( mTailState != TAIL_RUNNING ) {
+		discardTailOutput();
+		mNumTailUnderruns++;
+		return;
+	}
+
+	if( mTailFramesSilent ) {
+		mTailFramesSilent -= partitionSize;
+		return;
+	}
+
+	size_t available = mTailOutputs.back().getAvailableRead();
+
+	while( mTailFramesMissed && available ) {
+		size_t count = min( mTailFramesMissed, min( available, partitionSize ) );
+		for( size_t ch = 0; ch < mNumChannels; ch++ )
+			mTailOutputs[ch].read( mTailScratch.getData(), count );
+
+		mTailFramesMissed -= count;
+		available -= count;
+	}
+
+	if( mTailFramesMissed || available < partitionSize ) {
+		mTailFramesMissed += partitionSize;
+		mNumTailUnderruns++;
+		return;
+	}
+
+	for( size_t ch = 0; ch < mNumChannels; ch++ ) {
+		mTailOutputs[ch].read( mTailScratch.getData(), partitionSize );
+		dsp::add( output->getChannel( ch ), mTailScratch.getData(), output->getChannel( ch ), partitionSize );
+	}
+}
+
+// Discards all of the tail's output that is ready. Called from the audio thread.
+void PartitionedConvolver::discardTailOutput()
+{
+	const size_t partitionSize = mHead->mPartitionSize;
+	for( size_t ch = 0; ch < mNumChannels; ch++ ) {
+		size_t available;
+		while( ( available = mTailOutputs[ch].getAvailableRead() ) != 0 )
+			mTailOutputs[ch].read( mTailScratch.getData(), min( available, partitionSize ) );
+	}
+}
+
+// Discards the tail's input and clears its state, as if it had only been given silence. Called from processTail(), while the audio thread isn't writing input.
+void PartitionedConvolver::resetTail()
+{
+	const size_t spectrumSize = 2 * mTail->mPartitionSize;
+	for( size_t ch = 0; ch < mNumChannels; ch++ ) {
+		size_t available;
+		while( ( available = mTailInputs[ch].getAvailableRead() ) != 0 )
+			mTailInputs[ch].read( mTail->mInput.getChannel( ch ), min( available, spectrumSize ) );
+	}
+
+	mTail->mInput.zero();
+	mTail->mDelayLine.zero();
+	mTail->mIndex = 0;
+}
+
+// Transforms the current partition of input into the delay line, then sums the products of the delay line and the impulse response's spectra for each
+// output channel. The last half of their inverse transform is the output, while the first half is discarded as it wraps around (overlap-save).
+void PartitionedConvolver::processSegment( Segment *segment )
+{
+	const size_t partitionSize = segment->mPartitionSize;
+	const size_t spectrumSize = 2 * partitionSize;
+	const size_t numPartitions = segment->mNumPartitions;
+
+	for( size_t ch = 0; ch < mNumChannels; ch++ ) {
+		float *input = segment->mInput.getChannel( ch );
+		float *spectrum = segment->mDelayLine.getChannel( ch ) + segment->mIndex * spectrumSize;
+		segment->mFft.forward( input, spectrum, spectrum + partitionSize );
+		copy( input + partitionSize, input + spectrumSize, input );
+	}
+
+	float *sum = segment->mSum.getData();
+	for( size_t output = 0; output < mNumChannels; output++ ) {
+		segment->mSum.zero();
+		for( const Path &path : mPaths ) {
+			if( path.mOutput != output )
+				continue;
+
+			const float *delayLine = segment->mDelayLine.getChannel( path.mInput );
+			const float *spectra = segment->mSpectra->getChannel( path.mImpulseChannel );
+			for( size_t i = 0; i < numPartitions; i++ ) {
+				size_t delayIndex = segment->mIndex >= i ? segment->mIndex - i : segment->mIndex + numPartitions - i;
+				mulAddSpectra( delayLine + delayIndex * spectrumSize, spectra + i * spectrumSize, sum, partitionSize );
+			}
+		}
+
+		segment->mFft.inverse( sum, sum + partitionSize, segment->mWaveform.getData() );
+		copy( segment->mWaveform.getData() + partitionSize, segment->mWaveform.getData() + spectrumSize, segment->mOutput.getChannel( output ) );
+	}
+
+	segment->mIndex = ( segment->mIndex + 1 ) % numPartitions;
+}
+
+size_t PartitionedConvolver::getPartitionSize( size_t framesPerBlock )
+{
+	return Fft::getNextSupportedSize( 2 * max<size_t>( framesPerBlock, 1 ) ) / 2;
+}
+
+size_t PartitionedConvolver::getTailPartitionSize( size_t partitionSize, size_t minFrames )
+{
+	if( ! minFrames )
+		return 0;
+
+	size_t result = partitionSize;
+	while( result < minFrames )
+		result *= 2;
+
+	return result;
+}
+
+} } } // namespace cinder::audio2::dsp
@@ -0,0 +1,150 @@
+/*
+ Copyright (c) 2014, The Cinder Project
+
+ This code is intended to be used with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/audio2/Buffer.h"
+#include "cinder/audio2/dsp/Fft.h"
+#include "cinder/audio2/dsp/RingBuffer.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace cinder { namespace audio2 { namespace dsp {
+
+typedef std::shared_ptr<const class ImpulseResponse>	ImpulseResponseRef;
+
+//! \brief An impulse response split into partitions, each transformed to the frequency domain for use with a PartitionedConvolver.
+//!
+//! The head partitions are getHeadPartitionSize() frames. Without tail partitions, they cover the whole impulse response. Otherwise they only cover
+//! the first 2 * getTailPartitionSize() frames, and the rest is split into partitions of getTailPartitionSize() frames, which a PartitionedConvolver
+//! can process away from the audio thread. ImpulseResponse's are immutable, so one can be shared by any number of PartitionedConvolver's.
+class ImpulseResponse {
+  public:
+	//! Partitions each channel of \a impulseResponse. 2 * \a headPartitionSize must be a size supported by Fft. \a tailPartitionSize is either 0, for
+	//! uniform partitions, or \a headPartitionSize multiplied by a power of two. \see PartitionedConvolver::getPartitionSize()
+	ImpulseResponse( const Buffer &impulseResponse, size_t headPartitionSize, size_t tailPartitionSize = 0 );
+
+	size_t	getNumChannels() const			{ return mNumChannels; }
+	size_t	getNumFrames() const			{ return mNumFrames; }
+	size_t	getHeadPartitionSize() const	{ return mHeadPartitionSize; }
+	size_t	getTailPartitionSize() const	{ return mTailPartitionSize; }
+	size_t	getNumHeadPartitions() const	{ return mNumHeadPartitions; }
+	size_t	getNumTailPartitions() const	{ return mNumTailPartitions; }
+
+	//! Returns the spectra of the head partitions. Each channel holds getNumHeadPartitions() spectra of 2 * getHeadPartitionSize() floats, laid out as in a
+	//! BufferSpectral and scaled so that their products with Fft::forward() spectra transform back to the convolution with Fft::inverse().
+	const Buffer&	getHeadSpectra() const	{ return mHeadSpectra; }
+	//! Returns the spectra of the tail partitions, laid out as getHeadSpectra() with getNumTailPartitions() spectra of 2 * getTailPartitionSize() floats per channel.
+	const Buffer&	getTailSpectra() const	{ return mTailSpectra; }
+
+  private:
+	size_t	mNumChannels, mNumFrames, mHeadPartitionSize, mTailPartitionSize, mNumHeadPartitions, mNumTailPartitions;
+	Buffer	mHeadSpectra, mTailSpectra;
+};
+
+//! \brief Convolves multichannel audio with an ImpulseResponse, using partitioned overlap-save FFT convolution.
+//!
+//! The output is delayed by getLatencyFrames(), which is one head partition, however many frames are passed to each call to process(). The tail
+//! partitions are processed by processTail(), either from within process() or, when constructed with \a isTailAsync set to true, by another thread that calls
+//! it whenever isTailPending(). The output of a tail partition isn't needed until a whole tail partition after its input is complete, which is how long
+//! that thread has to process it. If it is later than that, the tail is left out of the output until it catches up. If it falls so far behind that its input
+//! no longer fits, the tail starts over from the next head partition, as if the input had been silent until then. \see getNumTailUnderruns()
+//!
+//! The channels are routed according to the number of channels M of the ImpulseResponse, with N channels of audio:
+//! - If N > 1 and M = N * N, each output channel o is the sum of every input channel i convolved with channel i * N + o. For example, a true stereo impulse
+//!   response has the four channels left to left, left to right, right to left and right to right.
+//! - Otherwise, each channel c is convolved with channel c % M, so a mono impulse response is used for all channels.
+class PartitionedConvolver {
+  public:
+	PartitionedConvolver( const ImpulseResponseRef &impulseResponse, size_t numChannels, bool isTailAsync = false );
+	~PartitionedConvolver();
+
+	//! Convolves the first getNumChannels() channels of \a input into \a output, which can be the same Buffer.
+	void process( const Buffer *input, Buffer *output );
+	//! Processes all tail partitions that have complete input. Must not be called from more than one thread at a time, or at all if the tail isn't asynchronous.
+	void processTail();
+	//! Returns whether a tail partition has complete input, or the tail has to start over. Can be called from any thread, but only stays true until processTail() is called.
+	bool isTailPending() const;
+
+	//! Returns whether the ImpulseResponse has tail partitions.
+	bool		hasTail() const					{ return mTail != nullptr; }
+	bool		isTailAsync() const				{ return mIsTailAsync; }
+	//! Returns the number of head partitions for which the tail was late, and left out of the output.
+	uint64_t	getNumTailUnderruns() const		{ return mNumTailUnderruns; }
+	//! Returns the number of frames that the output is delayed by.
+	size_t		getLatencyFrames() const		{ return mImpulseResponse->getHeadPartitionSize(); }
+	size_t		getNumChannels() const			{ return mNumChannels; }
+
+	const ImpulseResponseRef&	getImpulseResponse() const	{ return mImpulseResponse; }
+
+	//! Returns the smallest head partition size for blocks of \a framesPerBlock frames, which is at least \a framesPerBlock and supported by Fft at twice its size.
+	static size_t getPartitionSize( size_t framesPerBlock );
+	//! Returns the smallest tail partition size of at least \a minFrames frames for \a partitionSize head partitions, or 0 if \a minFrames is 0.
+	static size_t getTailPartitionSize( size_t partitionSize, size_t minFrames );
+
+  private:
+	// The routing of one input channel through one channel of the ImpulseResponse into one output channel.
+	struct Path {
+		size_t mInput, mOutput, mImpulseChannel;
+	};
+
+	// The state of the head or the tail.
+	struct Segment {
+		Segment( const Buffer *spectra, size_t partitionSize, size_t numPartitions, size_t numChannels );
+
+		const Buffer	*mSpectra;
+		size_t			mPartitionSize, mNumPartitions, mIndex;
+		Fft				mFft;
+		Buffer			mInput;			// per channel, the previous partition of input followed by the current one
+		Buffer			mDelayLine;		// per channel, the spectra of the last mNumPartitions partitions of input, the current one at mIndex
+		Buffer			mSum, mWaveform, mOutput;
+	};
+
+	void processSegment( Segment *segment );
+	void processHeadPartition();
+	void writeTailInput();
+	void addTailOutput( Buffer *output );
+	void discardTailOutput();
+	void resetTail();
+
+	// Restarting the tail is requested by the audio thread and done by processTail(), after which the audio thread continues.
+	enum TailState { TAIL_RUNNING, TAIL_RESET_REQUESTED, TAIL_RESET_DONE };
+
+	ImpulseResponseRef				mImpulseResponse;
+	size_t							mNumChannels, mHeadFrame;
+	std::vector<Path>				mPaths;
+	std::unique_ptr<Segment>		mHead, mTail;
+
+	bool							mIsTailAsync;
+	std::vector<RingBuffer>			mTailInputs, mTailOutputs;	// from the audio thread to the tail and back, one per channel
+	Buffer							mTailScratch;
+	size_t							mTailFramesMissed, mTailFramesSilent;
+	std::atomic<TailState>			mTailState;
+	std::atomic<uint64_t>			mNumTailUnderruns;
+};
+
+} } } // namespace cinder::audio2::dsp
@@ -23,12 +23,19 @@ POSSIBILITY OF SUCH DAMAGE.
 
 #include "cinder/audio2/dsp/WaveTable.h"
 #include "cinder/audio2/dsp/Dsp.h"
+#include "cinder/audio2/dsp/DspSimd.h"
+#include "cinder/audio2/dsp/Fft.h"
 #include "cinder/audio2/Utilities.h"
+#include "cinder/audio2/Exception.h"
 #include "cinder/audio2/Debug.h"
 #include "cinder/CinderMath.h"
 
 #include "cinder/Timer.h" // TEMP
 
+#include <algorithm>
+#include <map>
+#include <mutex>
+
 using namespace std;
 
 namespace {
@@ -70,11 +77,58 @@ inline float tableLookup( const float *table, size_t tableSize, float phase )
 	float val2 = table[index2];
 	float frac = lookup - (float)index1;
 
-	return val2 + frac * ( val2 - val1 );
+	return val1 + frac * ( val2 - val1 );
 }
 
 #endif
 
+// The number of samples that lookupBandlimited() reads from the same tables when the frequency varies.
+const size_t TABLE_SELECT_FRAMES = 32;
+
+// Throws if \a tableSize can't be indexed by the high bits of a fixed-point phase.
+void checkTableSize( size_t tableSize )
+{
+	if( tableSize < 2 || ( tableSize & ( tableSize - 1 ) ) != 0 )
+		throw ci::audio2::AudioExc( "wavetable size must be a power of two" );
+}
+
+// Returns log2( tableSize ), the number of bits of a fixed-point phase that index the table.
+inline size_t calcTableBits( size_t tableSize )
+{
+	CI_ASSERT_MSG( tableSize >= 2 && ( tableSize & ( tableSize - 1 ) ) == 0, "table size must be a power of two" );
+
+	size_t result = 0;
+	while( ( size_t( 1 ) << result ) < tableSize )
+		result++;
+
+	return result;
+}
+
+// Converts a phase in cycles to 32-bit fixed-point, wrapping it to [0:1).
+inline uint32_t toFixedPhase( double phase )
+{
+	return uint32_t( int64_t( phase * 4294967296.0 ) );
+}
+
+inline float fromFixedPhase( uint32_t phase )
+{
+	return float( double( phase ) / 4294967296.0 );
+}
+
+// Fills phases with length fixed-point phases starting at phase, advancing by the frequencies in freqArray, which are scaled to phase
+// increments by phaseScale = 2^32 / sampleRate. Returns the phase following the last one. The increments are limited to half a cycle
+// either way, so that they fit in an int32_t, which converts from float much faster than a wider integer.
+inline uint32_t accumulatePhases( uint32_t phase, const float *freqArray, float phaseScale, uint32_t *phases, size_t length )
+{
+	for( size_t i = 0; i < length; i++ ) {
+		phases[i] = phase;
+		const float phaseIncr = std::min( std::max( freqArray[i] * phaseScale, -2147483648.0f ), 2147483520.0f );
+		phase += uint32_t( int32_t( phaseIncr ) );
+	}
+
+	return phase;
+}
+
 } // anonymous namespace
 
 namespace cinder { namespace audio2 { namespace dsp {
@@ -86,6 +140,7 @@ namespace cinder { namespace audio2 { namespace dsp {
 WaveTable::WaveTable( size_t sampleRate, size_t tableSize )
 	: mTableSize( tableSize )
 {
+	checkTableSize( tableSize );
 	setSampleRate( sampleRate );
 }
 
@@ -99,6 +154,8 @@ void WaveTable::setSampleRate( size_t sampleRate )
 
 void WaveTable::resize( size_t tableSize )
 {
+	checkTableSize( tableSize );
+
 	if( mTableSize == tableSize && mBuffer.getNumFrames() == tableSize )
 		return;
 
@@ -139,30 +196,28 @@ float WaveTable::lookup( float phase ) const
 
 float WaveTable::lookup( float *outputArray, size_t outputLength, float currentPhase, float freq ) const
 {
-	const float phaseIncr = freq * mSamplePeriod;
-	const float *table = mBuffer.getData();
-	const size_t tableSize = mTableSize;
+	const uint32_t phase = toFixedPhase( currentPhase );
+	const uint32_t phaseIncr = toFixedPhase( double( freq ) / double( mSampleRate ) );
 
-	for( size_t i = 0; i < outputLength; i++ ) {
-		outputArray[i] = tableLookup( table, tableSize, currentPhase );
-		currentPhase = wrap( currentPhase + phaseIncr );
-	}
+	getSimdKernels().wavetable( mBuffer.getData(), nullptr, 0, calcTableBits( mTableSize ), phase, phaseIncr, outputArray, outputLength );
 
-	return currentPhase;
+	return fromFixedPhase( phase + uint32_t( outputLength ) * phaseIncr );
 }
 
 float WaveTable::lookup( float *outputArray, size_t outputLength, float currentPhase, const float *freqArray ) const
 {
-	const size_t tableSize = mTableSize;
-	const float samplePeriod = mSamplePeriod;
-	const float *table = mBuffer.getData();
-
-	for( size_t i = 0; i < outputLength; i++ ) {
-		outputArray[i] = tableLookup( table, tableSize, currentPhase );
-		currentPhase = wrap( currentPhase + freqArray[i] * samplePeriod );
+	const size_t tableBits = calcTableBits( mTableSize );
+	const float phaseScale = float( 4294967296.0 / double( mSampleRate ) );
+	uint32_t phase = toFixedPhase( currentPhase );
+
+	uint32_t phases[TABLE_SELECT_FRAMES];
+	for( size_t i = 0; i < outputLength; i += TABLE_SELECT_FRAMES ) {
+		const size_t length = std::min( TABLE_SELECT_FRAMES, outputLength - i );
+		phase = accumulatePhases( phase, freqArray + i, phaseScale, phases, length );
+		getSimdKernels().wavetablePhases( mBuffer.getData(), nullptr, 0, tableBits, phases, outputArray + i, length );
 	}
-	
-	return currentPhase;
+
+	return fromFixedPhase( phase );
 }
 
 void WaveTable::copyTo( float *array ) const
@@ -172,6 +227,7 @@ void WaveTable::copyTo( float *array ) const
 
 void WaveTable::copyFrom( const float *array )
 {
+	resize( mTableSize );
 	memcpy( mBuffer.getData(), array, mTableSize * sizeof( float ) );
 }
 
@@ -179,6 +235,70 @@ void WaveTable::copyFrom( const float *array )
 // MARK: - WaveTable2d
 // ----------------------------------------------------------------------------------------------------
 
+struct WaveTable2d::Cache {
+	typedef tuple<WaveformType, size_t, size_t, size_t>	Key; // waveform, sample rate, table size, number of tables
+
+	mutex									mMutex;
+	map<Key, weak_ptr<const WaveTable2d> >	mTables;
+};
+
+WaveTable2d::Cache& WaveTable2d::getCache()
+{
+	static Cache sCache;
+	return sCache;
+}
+
+WaveTable2dConstRef WaveTable2d::getBandlimited( WaveformType type, size_t sampleRate, size_t tableSize, size_t numTables )
+{
+	Cache &cache = getCache();
+	const Cache::Key key( type, sampleRate, tableSize, numTables );
+
+	{
+		lock_guard<mutex> lock( cache.mMutex );
+
+		auto it = cache.mTables.find( key );
+		if( it != cache.mTables.end() ) {
+			WaveTable2dConstRef result = it->second.lock();
+			if( result )
+				return result;
+		}
+	}
+
+	// The tables are filled without holding the lock, so that other threads can look up tables in the meantime. If another thread filled
+	// the same set concurrently, the one that finished first is shared and this one is discarded.
+	WaveTable2dRef waveTable( new WaveTable2d( sampleRate, tableSize, numTables ) );
+	waveTable->fillBandlimited( type );
+
+	lock_guard<mutex> lock( cache.mMutex );
+
+	weak_ptr<const WaveTable2d> &cached = cache.mTables[key];
+	WaveTable2dConstRef result = cached.lock();
+	if( ! result ) {
+		result = waveTable;
+		cached = result;
+	}
+
+	return result;
+}
+
+size_t WaveTable2d::getNumCachedBandlimited()
+{
+	Cache &cache = getCache();
+	lock_guard<mutex> lock( cache.mMutex );
+
+	size_t result = 0;
+	for( auto it = cache.mTables.begin(); it != cache.mTables.end(); ) {
+		if( it->second.expired() )
+			it = cache.mTables.erase( it );
+		else {
+			++result;
+			++it;
+		}
+	}
+
+	return result;
+}
+
 WaveTable2d::WaveTable2d( size_t sampleRate, size_t tableSize, size_t numTables )
 	: WaveTable( sampleRate, tableSize ), mNumTables( numTables )
 {
@@ -186,6 +306,8 @@ WaveTable2d::WaveTable2d( size_t sampleRate, size_t tableSize, size_t numTables
 
 void WaveTable2d::resize( size_t tableSize, size_t numTables )
 {
+	checkTableSize( tableSize );
+
 	bool needsResize = false;
 	if( mTableSize != tableSize || mBuffer.getNumFrames() != tableSize ) {
 		mTableSize = tableSize;
@@ -208,25 +330,29 @@ void WaveTable2d::fillBandlimited( WaveformType type )
 
 	resize( mTableSize, mNumTables );
 
+	// Fft supports every power of two
+	Fft fft( mTableSize );
+	SpectralSynthesis spectral( &fft );
+
 	for( size_t i = 0; i < mNumTables; i++ ) {
 		float *table = mBuffer.getChannel( i );
 
 		// last table always has only one partial
 		if( i == mNumTables - 1 ) {
-			fillBandLimitedTable( type, table, 1 );
+			fillBandLimitedTable( type, table, 1, &spectral );
 //			CI_LOG_V( "\t[" << i << "] LAST, nyquist / 4 and above, max partials: 1 " );
 			break;
 		}
 
 		size_t maxPartialsForFreq = getMaxHarmonicsForTable( i );
-		fillBandLimitedTable( type, table, maxPartialsForFreq );
+		fillBandLimitedTable( type, table, maxPartialsForFreq, &spectral );
 	}
 
 	CI_LOG_V( "filled " << mNumTables << " tables of size: " << mTableSize << ", seconds: " << timer.getSeconds() );
 }
 
 // note: for at least sawtooth and square, this must be recomputed for every table so that gibbs reduction is accurate
-void WaveTable2d::fillBandLimitedTable( WaveformType type, float *table, size_t numPartials )
+void WaveTable2d::fillBandLimitedTable( WaveformType type, float *table, size_t numPartials, SpectralSynthesis *spectral )
 {
 	vector<float> partials;
 	if( type == WaveformType::SINE )
@@ -265,10 +391,38 @@ void WaveTable2d::fillBandLimitedTable( WaveformType type, float *table, size_t
 			CI_ASSERT_NOT_REACHABLE();
 	}
 
-	fillSinesum( table, mTableSize, partials );
+	if( spectral )
+		spectral->fill( table, partials );
+	else
+		fillSinesum( table, mTableSize, partials );
+
 	dsp::normalize( table, mTableSize );
 }
 
+WaveTable2d::SpectralSynthesis::SpectralSynthesis( Fft *fft )
+	: mFft( fft ), mReal( fft->getSize() / 2, 0 ), mImag( fft->getSize() / 2, 0 )
+{
+	const size_t size = fft->getSize();
+	vector<float> unitSine( size );
+
+	mImag[1] = 1;
+	mFft->inverse( mReal.data(), mImag.data(), unitSine.data() );
+
+	mUnitSineScale = 0;
+	for( size_t i = 0; i < size; i++ )
+		mUnitSineScale += unitSine[i] * sin( 2 * M_PI * double( i ) / double( size ) );
+	mUnitSineScale /= double( size / 2 );
+}
+
+void WaveTable2d::SpectralSynthesis::fill( float *array, const vector<float> &partials )
+{
+	std::fill( mImag.begin(), mImag.end(), 0.0f );
+	for( size_t p = 0; p < partials.size() && p + 1 < mImag.size(); p++ )
+		mImag[p + 1] = float( partials[p] / mUnitSineScale );
+
+	mFft->inverse( mReal.data(), mImag.data(), array );
+}
+
 size_t WaveTable2d::getMaxHarmonicsForTable( size_t tableIndex ) const
 {
 	const float nyquist = (float)mSampleRate * 0.5f;
@@ -302,32 +456,12 @@ const float* WaveTable2d::getBandLimitedTable( float f0 ) const
 
 std::tuple<const float*, const float*, float> WaveTable2d::getBandLimitedTablesLerp( float f0 ) const
 {
-	float *table1, *table2;
-	float factor;
-
-	const float f0Midi = toMidi( fabsf( f0 ) );
-
-	if( f0Midi <= mMinMidiRange ) {
-		table1 = table2 = const_cast<float *>( mBuffer.getChannel( 0 ) );
-		factor = 0;
-	}
-	else if( f0Midi >= mMaxMidiRange ) {
-		table1 = table2 = const_cast<float *>( mBuffer.getChannel( mNumTables - 1 ) );
-		factor = 1;
-	}
-	else {
-
-		float index = calcTableIndex( f0Midi, mMinMidiRange, mMaxMidiRange, mNumTables );
+	const float index = calcBandlimitedTableIndex( f0 );
 
-		size_t tableIndex1 = (size_t)index;
-		size_t tableIndex2 = ( tableIndex1 + 1 ) & ( mTableSize - 1 );
+	const size_t tableIndex1 = (size_t)index;
+	const size_t tableIndex2 = std::min( tableIndex1 + 1, mNumTables - 1 );
 
-		table1 = const_cast<float *>( mBuffer.getChannel( tableIndex1 ) );
-		table2 = const_cast<float *>( mBuffer.getChannel( tableIndex2 ) );
-		factor = index - (float)tableIndex1;
-	}
-
-	return make_tuple( table1, table2, factor );
+	return make_tuple( mBuffer.getChannel( tableIndex1 ), mBuffer.getChannel( tableIndex2 ), index - (float)tableIndex1 );
 }
 
 float WaveTable2d::lookupBandlimited( float phase, float f0 ) const
@@ -336,99 +470,128 @@ float WaveTable2d::lookupBandlimited( float phase, float f0 ) const
 	return tableLookup( table, mTableSize, phase );
 }
 
-#if 1
-
-// no table interpolation
-
+// The second table is only read when it contributes, at the kernel's expense of an extra gather per sample.
 float WaveTable2d::lookupBandlimited( float *outputArray, size_t outputLength, float currentPhase, float f0 ) const
 {
-	const float phaseIncr = f0 * mSamplePeriod;
-	const float *table = getBandLimitedTable( f0 );
-	const size_t tableSize = mTableSize;
+	const uint32_t phase = toFixedPhase( currentPhase );
+	const uint32_t phaseIncr = toFixedPhase( double( f0 ) / double( mSampleRate ) );
 
-	for( size_t i = 0; i < outputLength; i++ ) {
-		outputArray[i] = tableLookup( table, tableSize, currentPhase );
-		currentPhase = wrap( currentPhase + phaseIncr );
-	}
+	auto tables = getBandLimitedTablesLerp( f0 );
+	const float *table2 = get<2>( tables ) > 0 ? get<1>( tables ) : nullptr;
+	getSimdKernels().wavetable( get<0>( tables ), table2, get<2>( tables ), calcTableBits( mTableSize ), phase, phaseIncr, outputArray, outputLength );
 
-	return currentPhase;
+	return fromFixedPhase( phase + uint32_t( outputLength ) * phaseIncr );
 }
 
 float WaveTable2d::lookupBandlimited( float *outputArray, size_t outputLength, float currentPhase, const float *f0Array ) const
 {
-	const size_t tableSize = mTableSize;
-	const float samplePeriod = mSamplePeriod;
+	const size_t tableBits = calcTableBits( mTableSize );
+	const float phaseScale = float( 4294967296.0 / double( mSampleRate ) );
+	uint32_t phase = toFixedPhase( currentPhase );
+
+	uint32_t phases[TABLE_SELECT_FRAMES];
+	for( size_t i = 0; i < outputLength; i += TABLE_SELECT_FRAMES ) {
+		const size_t length = std::min( TABLE_SELECT_FRAMES, outputLength - i );
 
-	for( size_t i = 0; i < outputLength; i++ ) {
-		const float f0 = f0Array[i];
-		const float *table = getBandLimitedTable( f0 );
+		float maxF0 = 0;
+		for( size_t j = 0; j < length; j++ )
+			maxF0 = std::max( maxF0, fabsf( f0Array[i + j] ) );
 
-		outputArray[i] = tableLookup( table, tableSize, currentPhase );
-		currentPhase = wrap( currentPhase + f0 * samplePeriod );
+		auto tables = getBandLimitedTablesLerp( maxF0 );
+		const float *table2 = get<2>( tables ) > 0 ? get<1>( tables ) : nullptr;
+
+		phase = accumulatePhases( phase, f0Array + i, phaseScale, phases, length );
+		getSimdKernels().wavetablePhases( get<0>( tables ), table2, get<2>( tables ), tableBits, phases, outputArray + i, length );
 	}
 
-	return currentPhase;
+	return fromFixedPhase( phase );
 }
 
-#else
+void WaveTable2d::copyTo( float *array, size_t tableIndex ) const
+{
+	CI_ASSERT( tableIndex < mNumTables );
 
-// table interpoloation
+	memcpy( array, mBuffer.getChannel( tableIndex ), mTableSize * sizeof( float ) );
+}
 
-float WaveTable2d::lookupBandlimited( float *outputArray, size_t outputLength, float currentPhase, float f0 ) const
+void WaveTable2d::copyFrom( const float *array, size_t tableIndex )
 {
-	const float phaseIncr = f0 * mSamplePeriod;
-	const size_t tableSize = mTableSize;
-	auto tables = getBandLimitedTablesLerp( f0 );
-
+	CI_ASSERT( tableIndex < mNumTables );
 
-	for( size_t i = 0; i < outputLength; i++ ) {
-		float a = tableLookup( get<0>( tables ), tableSize, currentPhase );
-		float b = tableLookup( get<1>( tables ), tableSize, currentPhase );
-		outputArray[i] = lerp( a, b, get<2>( tables ) );
-		currentPhase = wrap( currentPhase + phaseIncr );
-	}
+	memcpy( mBuffer.getChannel( tableIndex ), array, mTableSize * sizeof( float ) );
+}
 
-	return currentPhase;
+void WaveTable2d::calcLimits()
+{
+	mMinMidiRange = toMidi( 20 );
+	mMaxMidiRange = toMidi( (float)mSampleRate / 4.0f ); // everything above can only have one partial
 }
 
-float WaveTable2d::lookupBandlimited( float *outputArray, size_t outputLength, float currentPhase, const float *f0Array ) const
+// ----------------------------------------------------------------------------------------------------
+// MARK: - WaveTableBank
+// ----------------------------------------------------------------------------------------------------
+
+WaveTableBank::WaveTableBank( size_t numOscillators )
+	: mTableBits( 0 )
 {
-	const size_t tableSize = mTableSize;
-	const float samplePeriod = mSamplePeriod;
+	setNumOscillators( numOscillators );
+}
 
-	for( size_t i = 0; i < outputLength; i++ ) {
-		const float f0 = f0Array[i];
-		auto tables = getBandLimitedTablesLerp( f0 );
+void WaveTableBank::setNumOscillators( size_t numOscillators )
+{
+	mFreqs.resize( numOscillators, 0 );
+	mAmps.resize( numOscillators, 0 );
+	mTargetAmps.resize( numOscillators, 0 );
+	mPhases.resize( numOscillators, 0 );
+	mPhaseIncrs.resize( numOscillators, 0 );
+	mTableIndices.resize( numOscillators, 0 );
+}
 
-		float a = tableLookup( get<0>( tables ), tableSize, currentPhase );
-		float b = tableLookup( get<1>( tables ), tableSize, currentPhase );
-		outputArray[i] = lerp( a, b, get<2>( tables ) );
-		currentPhase = wrap( currentPhase + f0 * samplePeriod );
-	}
+void WaveTableBank::setWaveTable( const WaveTable2dConstRef &waveTable )
+{
+	mWaveTable = waveTable;
+	if( ! mWaveTable )
+		return;
 
-	return currentPhase;
+	mTableBits = calcTableBits( mWaveTable->getTableSize() );
+	for( size_t i = 0; i < mFreqs.size(); i++ )
+		updateOscillator( i );
 }
 
-#endif
+void WaveTableBank::setFreq( size_t index, float freq )
+{
+	mFreqs.at( index ) = freq;
+	if( mWaveTable )
+		updateOscillator( index );
+}
 
-void WaveTable2d::copyTo( float *array, size_t tableIndex ) const
+void WaveTableBank::setPhase( size_t index, float phase )
 {
-	CI_ASSERT( tableIndex < mNumTables );
+	mPhases.at( index ) = toFixedPhase( phase );
+}
 
-	memcpy( array, mBuffer.getChannel( tableIndex ), mTableSize * sizeof( float ) );
+float WaveTableBank::getPhase( size_t index ) const
+{
+	return fromFixedPhase( mPhases.at( index ) );
 }
 
-void WaveTable2d::copyFrom( const float *array, size_t tableIndex )
+// The table index is rounded up, to the table with fewer partials, so that none of them alias.
+void WaveTableBank::updateOscillator( size_t index )
 {
-	CI_ASSERT( tableIndex < mNumTables );
+	const float freq = mFreqs[index];
+	const size_t tableIndex = size_t( ceilf( mWaveTable->calcBandlimitedTableIndex( freq ) ) );
 
-	memcpy( mBuffer.getChannel( tableIndex ), array, mTableSize * sizeof( float ) );
+	mPhaseIncrs[index] = toFixedPhase( double( freq ) / double( mWaveTable->getSampleRate() ) );
+	mTableIndices[index] = uint32_t( min( tableIndex, mWaveTable->getNumTables() - 1 ) );
 }
 
-void WaveTable2d::calcLimits()
+void WaveTableBank::process( float *dest, size_t length )
 {
-	mMinMidiRange = toMidi( 20 );
-	mMaxMidiRange = toMidi( (float)mSampleRate / 4.0f ); // everything above can only have one partial
+	if( ! mWaveTable )
+		return;
+
+	getSimdKernels().wavetableBank( mWaveTable->getTable( 0 ), mTableBits, mTableIndices.data(), mPhases.data(), mPhaseIncrs.data(), mAmps.data(), mTargetAmps.data(),
+									mFreqs.size(), dest, length );
 }
 
 } } } // namespace cinder::audio2::dsp
\ No newline at end of file
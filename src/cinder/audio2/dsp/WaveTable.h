@@ -28,16 +28,27 @@
 
 #include <vector>
 #include <tuple>
+#include <cstdint>
 
 namespace cinder { namespace audio2 { namespace dsp {
 
+class Fft;
+
 typedef std::shared_ptr<class WaveTable>		WaveTableRef;
 typedef std::shared_ptr<class WaveTable2d>		WaveTable2dRef;
+typedef std::shared_ptr<const WaveTable2d>		WaveTable2dConstRef;
+typedef std::shared_ptr<class WaveTableBank>	WaveTableBankRef;
 
+//! \brief A single cycle of a waveform, read by linear interpolation.
+//!
+//! The table size must be a power of two. The lookups that fill an array run on the SIMD kernels (see DspSimd.h), with a 32-bit fixed-point
+//! phase accumulator, so the phase wraps around without any cost. Phases passed in and returned are in the range [0:1).
 class WaveTable {
   public:
+	//! Constructs a WaveTable of \a tableSize samples, which must be a power of two. Throws AudioExc otherwise.
 	WaveTable( size_t mSampleRate, size_t tableSize );
 
+	//! Sets the number of samples in the table to \a tableSize, which must be a power of two. Throws AudioExc otherwise.
 	void resize( size_t tableSize );
 
 	void fillSine();
@@ -49,7 +60,9 @@ class WaveTable {
 	size_t getTableSize() const	{ return mTableSize; }
 
 	float lookup( float phase ) const;
+	//! Fills \a outputArray with \a outputLength samples at \a freq Hertz, starting at \a currentPhase. Returns the phase following the last sample.
 	float lookup( float *outputArray, size_t outputLength, float currentPhase, float freq ) const;
+	//! As above, with the frequency of each sample in \a freqArray.
 	float lookup( float *outputArray, size_t outputLength, float currentPhase, const float *freqArray ) const;
 
 	void copyTo( float *array ) const;
@@ -63,18 +76,33 @@ class WaveTable {
 	BufferDynamic	mBuffer;
 };
 
+//! \brief A set of band-limited tables of one waveform, each holding as many partials as fit below nyquist for a range of fundamental frequencies.
+//!
+//! The table size must be a power of two, as with WaveTable, and the tables are synthesized with an inverse FFT of their partials. getBandlimited()
+//! returns tables that are shared by every caller asking for the same parameters, so that many oscillators only build and store them once.
 class WaveTable2d : public WaveTable {
   public:
 	WaveTable2d( size_t sampleRate, size_t tableSize, size_t numTables );
 
-	//! Adjusts the parameters effecting table size and calculate.
+	//! Returns a WaveTable2d filled with fillBandlimited( \a type ), shared with all other callers that ask for the same parameters, for as long as any of them hold onto it.
+	//! The returned tables are const, copy them into a WaveTable2d of your own to modify them. Can be called from any thread other than the audio thread.
+	//! Only the first call for a set of parameters fills the tables, and the cache is not locked while doing so, so calling this ahead of time from a worker thread
+	//! means that initializing or reconfiguring oscillators later on will not need to.
+	static WaveTable2dConstRef	getBandlimited( WaveformType type, size_t sampleRate, size_t tableSize, size_t numTables );
+	//! Returns the number of distinct sets of tables that are currently shared by getBandlimited().
+	static size_t				getNumCachedBandlimited();
+
+	//! Adjusts the parameters effecting table size and calculate. Throws AudioExc if \a tableSize isn't a power of two.
 	//! \note This does not update the data, call fill() afterwards to refresh the table contents.
 	void resize( size_t tableSize, size_t numTables );
 
 	void fillBandlimited( WaveformType type );
 
 	float lookupBandlimited( float phase, float f0 ) const;
+	//! Fills \a outputArray with \a outputLength samples at \a f0 Hertz, starting at \a currentPhase. Returns the phase following the last sample.
+	//! The two tables whose partials are closest to fitting below nyquist at \a f0 are crossfaded, so sweeps don't step between tables.
 	float lookupBandlimited( float *outputArray, size_t outputLength, float currentPhase, float f0 ) const;
+	//! As above, with the frequency of each sample in \a f0Array. The tables are chosen once per 32 samples, for the highest frequency among them.
 	float lookupBandlimited( float *outputArray, size_t outputLength, float currentPhase, const float *f0Array ) const;
 
 	void copyTo( float *array, size_t tableIndex ) const;
@@ -83,10 +111,26 @@ class WaveTable2d : public WaveTable {
 	float calcBandlimitedTableIndex( float f0 ) const;
 
 	size_t getNumTables() const	{ return mNumTables; }
+	//! Returns the samples of table \a tableIndex. The tables are laid out one after another, so this can also be indexed past the end of a table into the ones that follow.
+	const float*	getTable( size_t tableIndex ) const	{ return mBuffer.getChannel( tableIndex ); }
 
   protected:
+	// Synthesizes sums of sines with the inverse of \a fft, from a spectrum that is reused for every table. How the imaginary parts are scaled and signed
+	// depends on the Fft implementation, so that is measured once, from the inverse of a single partial.
+	struct SpectralSynthesis {
+		SpectralSynthesis( Fft *fft );
+
+		//! Fills \a array with the sum of sines whose amplitudes are \a partials. Partials at or above the table's nyquist are dropped.
+		void fill( float *array, const std::vector<float> &partials );
+
+		Fft					*mFft;
+		std::vector<float>	mReal, mImag;
+		double				mUnitSineScale;
+	};
+
 	void		calcLimits();
-	void		fillBandLimitedTable( WaveformType type, float *table, size_t numPartials );
+	//! Fills \a table with \a numPartials of waveform \a type, with \a spectral if it isn't null and otherwise by summing sines directly.
+	void		fillBandLimitedTable( WaveformType type, float *table, size_t numPartials, SpectralSynthesis *spectral );
 	size_t		getMaxHarmonicsForTable( size_t tableIndex ) const;
 
 	const float*	getBandLimitedTable( float f0 ) const;
@@ -94,6 +138,52 @@ class WaveTable2d : public WaveTable {
 
 	size_t			mNumTables;
 	float			mMinMidiRange, mMaxMidiRange;
+
+  private:
+	struct Cache;
+
+	static Cache&	getCache();
+};
+
+//! \brief Any number of oscillators that read from the same WaveTable2d, summed into one output.
+//!
+//! The oscillators are stored as a structure of arrays (phases, phase increments, amplitudes and table indices), and process() renders all
+//! of them into the output with one SIMD kernel, which makes each oscillator far cheaper than a separate lookup followed by a sum. An oscillator
+//! reads the one band-limited table whose partials all fit below nyquist at its frequency, rather than crossfading between two as
+//! WaveTable2d::lookupBandlimited() does, so frequency changes step between tables. Oscillators are silent until their amplitude is set.
+class WaveTableBank {
+  public:
+	WaveTableBank( size_t numOscillators = 0 );
+
+	//! Sets the number of oscillators. Existing oscillators are kept, new ones start out silent at phase 0. Allocates.
+	void	setNumOscillators( size_t numOscillators );
+	size_t	getNumOscillators() const	{ return mFreqs.size(); }
+
+	//! Sets the band-limited tables that all oscillators read from, choosing again the table and phase increment of each oscillator for the sample rate of \a waveTable.
+	void	setWaveTable( const WaveTable2dConstRef &waveTable );
+	const WaveTable2dConstRef&	getWaveTable() const	{ return mWaveTable; }
+
+	//! Sets the frequency of oscillator \a index in Hertz, which takes effect immediately and keeps its phase.
+	void	setFreq( size_t index, float freq );
+	float	getFreq( size_t index ) const	{ return mFreqs.at( index ); }
+	//! Sets the amplitude of oscillator \a index, which it ramps to linearly over the next call to process() so that changes don't click.
+	void	setAmp( size_t index, float amp )	{ mTargetAmps.at( index ) = amp; }
+	//! Returns the amplitude last set for oscillator \a index.
+	float	getAmp( size_t index ) const	{ return mTargetAmps.at( index ); }
+	//! Sets the phase of oscillator \a index, in the range [0:1).
+	void	setPhase( size_t index, float phase );
+	float	getPhase( size_t index ) const;
+
+	//! Adds \a length samples of the sum of all oscillators to \a dest. Does nothing if no table has been set.
+	void	process( float *dest, size_t length );
+
+  private:
+	void	updateOscillator( size_t index );
+
+	WaveTable2dConstRef		mWaveTable;
+	size_t					mTableBits;
+	std::vector<float>		mFreqs, mAmps, mTargetAmps;
+	std::vector<uint32_t>	mPhases, mPhaseIncrs, mTableIndices;
 };
 
 } } } // namespace cinder::audio2::dsp
\ No newline at end of file
@@ -430,7 +430,7 @@ LineOutWasapi::LineOutWasapi( const DeviceRef &device, const Format &format )
 
 void LineOutWasapi::initialize()
 {
-	setupProcessWithSumming();
+	setupInternalBuffer();
 	mInterleavedBuffer = BufferInterleaved( getFramesPerBlock(), mNumChannels );
 
 	mRenderImpl->init();
@@ -468,15 +468,7 @@ void LineOutWasapi::renderInputs()
 	if( ! ctx )
 		return;
 
-	lock_guard<mutex> lock( ctx->getMutex() );
-
-	// verify context still exists, since its destructor may have been holding the lock
-	ctx = getContext();
-	if( ! ctx )
-		return;
-
-	mInternalBuffer.zero();
-	pullInputs( &mInternalBuffer );
+	processGraph();
 
 	if( checkNotClipping() )
 		mInternalBuffer.zero();
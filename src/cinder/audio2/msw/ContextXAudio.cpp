@@ -114,7 +114,7 @@ void LineOutXAudio::initialize()
 {
 	CI_ASSERT_MSG( getNumChannels() <= 2, "number of channels greater than 2 is not supported." );
 
-	setupProcessWithSumming();
+	setupInternalBuffer();
 	size_t numSamples = mInternalBuffer.getSize();
 
 	memset( &mXAudioBuffer, 0, sizeof( mXAudioBuffer ) );
@@ -184,15 +184,7 @@ void LineOutXAudio::submitNextBuffer()
 	if( ! ctx )
 		return;
 
-	lock_guard<mutex> lock( ctx->getMutex() );
-
-	// verify context still exists, since its destructor may have been holding the lock
-	ctx = getContext();
-	if( ! ctx )
-		return;
-
-	mInternalBuffer.zero();
-	pullInputs( &mInternalBuffer );
+	processGraph();
 
 	if( checkNotClipping() )
 		mInternalBuffer.zero();
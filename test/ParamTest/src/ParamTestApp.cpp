@@ -134,13 +134,13 @@ void ParamTestApp::testDelay()
 // apply a ramp from 220 to 880 over 2 seconds and then after a 1 second delay, cancel it. result should be ~ 550: 220 + (880 - 220) / 2.
 void ParamTestApp::testAppendCancel()
 {
-	audio2::RampRef ramp = mGen->getParamFreq()->applyRamp( 220, 880, 2 );
+	audio2::Ramp ramp = mGen->getParamFreq()->applyRamp( 220, 880, 2 );
 
 	CI_LOG_V( "num ramps: " << mGen->getParamFreq()->getNumRamps() );
 
 	timeline().add( [ramp] {
 		CI_LOG_V( "canceling." );
-		ramp->cancel();
+		ramp.cancel();
 	}, (float)getElapsedSeconds() + 1 );
 }
 
@@ -319,11 +319,10 @@ void ParamTestApp::writeParamEval( audio2::Param *param )
 {
 	auto ctx = audio2::master();
 	float duration = param->findDuration();
-	float currTime = (float)ctx->getNumProcessedSeconds();
 	size_t sampleRate = ctx->getSampleRate();
 	audio2::Buffer audioBuffer( (size_t)duration * sampleRate );
 
-	param->eval( currTime, audioBuffer.getData(), audioBuffer.getSize(), sampleRate );
+	param->eval( ctx->getNumProcessedFrames(), audioBuffer.getData(), audioBuffer.getSize() );
 
 	auto target = audio2::TargetFile::create( "param.wav", sampleRate, 1 );
 	target->write( &audioBuffer );
@@ -41,7 +41,6 @@ public:
 
 	audio2::GainRef				mGain;
 	audio2::ScopeSpectralRef	mScope;
-	audio2::dsp::WaveTable2dRef	mWaveTable;
 	vector<audio2::GenRef>		mGenBank;
 
 	vector<TestWidget *>	mWidgets;
@@ -140,18 +139,8 @@ audio2::GenRef StressTestApp::makeSelectedGenType()
 
 audio2::GenRef StressTestApp::makeOsc( audio2::WaveformType type )
 {
-	auto ctx = audio2::master();
-	auto result = ctx->makeNode( new audio2::GenOscillator( audio2::GenOscillator::Format().waveform( type ) ) );
-
-	if( mWaveTable )
-		result->setWaveTable( mWaveTable );
-	else {
-		ctx->initializeNode( result );
-
-		mWaveTable = result->getWaveTable();
-	}
-
-	return result;
+	// the band-limited tables are shared by all GenOscillator's with the same waveform
+	return audio2::master()->makeNode( new audio2::GenOscillator( audio2::GenOscillator::Format().waveform( type ) ) );
 }
 
 void StressTestApp::setupUI()
@@ -245,22 +234,14 @@ void StressTestApp::processTap( Vec2i pos )
 			mSelectedGenType = SINE;
 		else if( currentTest == "triangle" )
 			mSelectedGenType = TRIANGLE;
-		else if( currentTest == "osc sine" ) {
+		else if( currentTest == "osc sine" )
 			mSelectedGenType = OSC_SINE;
-			mWaveTable.reset();
-		}
-		else if( currentTest == "osc sawtooth" ) {
+		else if( currentTest == "osc sawtooth" )
 			mSelectedGenType = OSC_SAW;
-			mWaveTable.reset();
-		}
-		else if( currentTest == "osc square" ) {
+		else if( currentTest == "osc square" )
 			mSelectedGenType = OSC_SQUARE;
-			mWaveTable.reset();
-		}
-		else if( currentTest == "osc triangle" ) {
+		else if( currentTest == "osc triangle" )
 			mSelectedGenType = OSC_TRIANGLE;
-			mWaveTable.reset();
-		}
 	}
 	else
 		processDrag( pos );
@@ -0,0 +1,448 @@
+// Measures how rendering scales with the number of Node's and render threads, by timing a ContextOffline that renders a bank
+// of voices (GenTriangle -> FilterLowPass -> Gain -> Pan2d) which are summed at the output. Also measures the throughput of the
+// dsp kernels with each supported SIMD instruction set, of the FFT, of multichannel biquads, of wavetable oscillators, of filter cascades and
+// of partitioned convolution.
+//
+// usage: Audio2Benchmark [max render threads] [seconds of audio per run]
+
+#include "cinder/audio2/ContextOffline.h"
+#include "cinder/audio2/Gen.h"
+#include "cinder/audio2/Filter.h"
+#include "cinder/audio2/NodeEffect.h"
+#include "cinder/audio2/dsp/BiquadBank.h"
+#include "cinder/audio2/dsp/Dsp.h"
+#include "cinder/audio2/dsp/Fft.h"
+#include "cinder/audio2/dsp/NoiseGenerator.h"
+#include "cinder/audio2/dsp/PartitionedConvolver.h"
+#include "cinder/audio2/dsp/WaveTable.h"
+#include "cinder/Rand.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <vector>
+
+using namespace ci;
+using namespace ci::audio2;
+using namespace std;
+
+const size_t SAMPLE_RATE = 44100;
+const size_t FRAMES_PER_BLOCK = 512;
+
+// Returns the number of seconds it took to render \a renderSeconds of audio.
+double renderVoices( size_t numVoices, size_t numRenderThreads, double renderSeconds )
+{
+	auto ctx = make_shared<ContextOffline>( SAMPLE_RATE, FRAMES_PER_BLOCK, 2 );
+	ctx->setNumRenderThreads( numRenderThreads );
+
+	for( size_t i = 0; i < numVoices; i++ ) {
+		auto osc = ctx->makeNode( new GenTriangle( 55.0f * ( 1 + i % 24 ) ) );
+		auto lowPass = ctx->makeNode( new FilterLowPass );
+		auto gain = ctx->makeNode( new Gain( 1.0f / numVoices ) );
+		auto pan = ctx->makeNode( new Pan2d );
+
+		lowPass->setFreq( 1000 );
+		pan->setPos( float( i ) / numVoices );
+
+		osc >> lowPass >> gain >> pan >> ctx->getOutput();
+		osc->start();
+	}
+
+	Buffer buffer( FRAMES_PER_BLOCK, 2 );
+	size_t numBlocks = size_t( renderSeconds * SAMPLE_RATE / FRAMES_PER_BLOCK );
+
+	// warm up, so that the render threads are spinning and caches are primed.
+	for( size_t i = 0; i < 16; i++ )
+		ctx->render( &buffer );
+
+	auto begin = chrono::high_resolution_clock::now();
+
+	for( size_t i = 0; i < numBlocks; i++ )
+		ctx->render( &buffer );
+
+	return chrono::duration<double>( chrono::high_resolution_clock::now() - begin ).count();
+}
+
+// Returns the number of times per second that \a fn can be called.
+template <typename FnT>
+double measureCallsPerSecond( const FnT &fn, double measureSeconds )
+{
+	size_t numCalls = 0;
+	double seconds = 0;
+
+	auto begin = chrono::high_resolution_clock::now();
+	while( seconds < measureSeconds ) {
+		for( size_t i = 0; i < 1024; i++ )
+			fn();
+
+		numCalls += 1024;
+		seconds = chrono::duration<double>( chrono::high_resolution_clock::now() - begin ).count();
+	}
+
+	return numCalls / seconds;
+}
+
+void measureDspKernels( double measureSeconds )
+{
+	const size_t length = FRAMES_PER_BLOCK;
+	const size_t bytes = length * sizeof( float );
+
+	vector<float> a( length, 0.5f ), b( length, 0.25f ), result( length );
+	volatile float reduction = 0;
+
+	dsp::SimdInstructionSet detected = dsp::getSimdInstructionSet();
+	const dsp::SimdInstructionSet instructionSets[] = { dsp::SIMD_NONE, dsp::SIMD_SSE2, dsp::SIMD_AVX2, dsp::SIMD_AVX512, dsp::SIMD_NEON };
+
+	cout << "dsp kernels, " << length << " samples per call. throughput is in GB/s, followed by the speedup over SIMD_NONE." << endl << endl;
+
+	const char *kernelNames[] = { "fill", "add", "mul", "addMul", "mulAdd", "sum", "rms" };
+	cout << setw( 8 ) << "kernel";
+	for( dsp::SimdInstructionSet instructionSet : instructionSets ) {
+		if( dsp::isSimdInstructionSetSupported( instructionSet ) )
+			cout << setw( 20 ) << dsp::simdInstructionSetToString( instructionSet );
+	}
+	cout << endl;
+
+	cout << fixed << setprecision( 2 );
+	for( size_t k = 0; k < sizeof( kernelNames ) / sizeof( kernelNames[0] ); k++ ) {
+		cout << setw( 8 ) << kernelNames[k];
+
+		double scalarThroughput = 0;
+		for( dsp::SimdInstructionSet instructionSet : instructionSets ) {
+			if( ! dsp::setSimdInstructionSet( instructionSet ) )
+				continue;
+
+			double throughput = 0;
+			switch( k ) {
+				case 0: throughput = bytes * measureCallsPerSecond( [&] { dsp::fill( 0.5f, result.data(), length ); }, measureSeconds ) / 1e9; break;
+				case 1: throughput = 3 * bytes * measureCallsPerSecond( [&] { dsp::add( a.data(), b.data(), result.data(), length ); }, measureSeconds ) / 1e9; break;
+				case 2: throughput = 3 * bytes * measureCallsPerSecond( [&] { dsp::mul( a.data(), b.data(), result.data(), length ); }, measureSeconds ) / 1e9; break;
+				case 3: throughput = 3 * bytes * measureCallsPerSecond( [&] { dsp::addMul( a.data(), b.data(), 0.5f, result.data(), length ); }, measureSeconds ) / 1e9; break;
+				case 4: throughput = 2 * bytes * measureCallsPerSecond( [&] { dsp::mulAdd( a.data(), 0.5f, 0.25f, result.data(), length ); }, measureSeconds ) / 1e9; break;
+				case 5: throughput = bytes * measureCallsPerSecond( [&] { reduction = dsp::sum( a.data(), length ); }, measureSeconds ) / 1e9; break;
+				case 6: throughput = bytes * measureCallsPerSecond( [&] { reduction = dsp::rms( a.data(), length ); }, measureSeconds ) / 1e9; break;
+			}
+
+			if( instructionSet == dsp::SIMD_NONE ) {
+				scalarThroughput = throughput;
+				cout << setw( 20 ) << throughput;
+			}
+			else
+				cout << setw( 12 ) << throughput << " (" << setw( 4 ) << throughput / scalarThroughput << "x)";
+		}
+		cout << endl;
+	}
+	cout << endl;
+
+	dsp::setSimdInstructionSet( detected );
+}
+
+void measureFft( double measureSeconds )
+{
+	cout << "fft, microseconds per forward and inverse transform, and per forward transform of 8 channels with forwardBatch()." << endl << endl;
+	cout << setw( 8 ) << "size" << setw( 12 ) << "forward" << setw( 12 ) << "inverse" << setw( 12 ) << "batch" << endl;
+
+	// each mixed-radix size is listed just before the power of two above it
+	const size_t sizes[] = { 256, 480, 512, 960, 1024, 3840, 4096, 15360, 16384 };
+
+	cout << fixed << setprecision( 2 );
+	for( size_t sizeFft : sizes ) {
+		const size_t numChannels = 8;
+
+		dsp::Fft fft( sizeFft );
+		Buffer waveform( sizeFft, numChannels );
+		Buffer spectra( sizeFft, numChannels );
+		for( size_t i = 0; i < waveform.getSize(); i++ )
+			waveform[i] = float( i % 7 ) / 7;
+
+		const double forward = measureCallsPerSecond( [&] { fft.forward( waveform.getData(), spectra.getData(), spectra.getData() + sizeFft / 2 ); }, measureSeconds );
+		const double inverse = measureCallsPerSecond( [&] { fft.inverse( spectra.getData(), spectra.getData() + sizeFft / 2, waveform.getChannel( 1 ) ); }, measureSeconds );
+		const double batch = measureCallsPerSecond( [&] { fft.forwardBatch( waveform.getData(), spectra.getData(), numChannels ); }, measureSeconds );
+
+		cout << setw( 8 ) << sizeFft << setw( 12 ) << 1e6 / forward << setw( 12 ) << 1e6 / inverse << setw( 12 ) << 1e6 / batch << endl;
+	}
+	cout << endl;
+}
+
+void measureBiquads( double measureSeconds )
+{
+	const size_t numChannels = 64;
+
+	cout << "biquads, microseconds per block of " << numChannels << " channels, filtered one channel at a time with dsp::Biquad, then by dsp::BiquadBank in double and float precision." << endl << endl;
+	cout << setw( 12 ) << "simd" << setw( 12 ) << "Biquad" << setw( 12 ) << "double" << setw( 12 ) << "float" << endl;
+
+	Buffer buffer( FRAMES_PER_BLOCK, numChannels );
+	for( size_t i = 0; i < buffer.getSize(); i++ )
+		buffer[i] = float( i % 5 ) / 5 - 0.4f;
+
+	vector<dsp::Biquad> biquads( numChannels );
+	dsp::BiquadBank bank( numChannels );
+	for( size_t ch = 0; ch < numChannels; ch++ ) {
+		biquads[ch].setLowpassParams( 0.01 + 0.01 * ch, 3 );
+		bank.setCoefficients( ch, biquads[ch] );
+	}
+
+	dsp::SimdInstructionSet detected = dsp::getSimdInstructionSet();
+	const dsp::SimdInstructionSet instructionSets[] = { dsp::SIMD_NONE, dsp::SIMD_SSE2, dsp::SIMD_AVX2, dsp::SIMD_AVX512, dsp::SIMD_NEON };
+
+	cout << fixed << setprecision( 2 );
+	for( dsp::SimdInstructionSet instructionSet : instructionSets ) {
+		if( ! dsp::setSimdInstructionSet( instructionSet ) )
+			continue;
+
+		const double perChannel = measureCallsPerSecond( [&] {
+			for( size_t ch = 0; ch < numChannels; ch++ )
+				biquads[ch].process( buffer.getChannel( ch ), buffer.getChannel( ch ), FRAMES_PER_BLOCK );
+		}, measureSeconds );
+
+		bank.setPrecision( dsp::BiquadBank::DOUBLE );
+		const double bankDouble = measureCallsPerSecond( [&] { bank.process( &buffer, &buffer ); }, measureSeconds );
+		bank.setPrecision( dsp::BiquadBank::FLOAT );
+		const double bankFloat = measureCallsPerSecond( [&] { bank.process( &buffer, &buffer ); }, measureSeconds );
+
+		cout << setw( 12 ) << dsp::simdInstructionSetToString( instructionSet ) << setw( 12 ) << 1e6 / perChannel << setw( 12 ) << 1e6 / bankDouble << setw( 12 ) << 1e6 / bankFloat << endl;
+	}
+	cout << endl;
+
+	dsp::setSimdInstructionSet( detected );
+}
+
+void measureWaveTables( double measureSeconds )
+{
+	auto waveTable = dsp::WaveTable2d::getBandlimited( WaveformType::SAWTOOTH, SAMPLE_RATE, 4096, 40 );
+
+	cout << "wavetable oscillators, the number of band-limited sawtooth oscillators that one core can run in real-time, at a constant frequency and swept." << endl << endl;
+	cout << setw( 12 ) << "simd" << setw( 12 ) << "constant" << setw( 12 ) << "swept" << endl;
+
+	Buffer buffer( FRAMES_PER_BLOCK );
+	vector<float> f0Array( FRAMES_PER_BLOCK );
+	for( size_t i = 0; i < f0Array.size(); i++ )
+		f0Array[i] = 100 + 4000 * float( i ) / f0Array.size();
+
+	const double blocksPerSecond = double( SAMPLE_RATE ) / FRAMES_PER_BLOCK;
+	float phase = 0;
+
+	dsp::SimdInstructionSet detected = dsp::getSimdInstructionSet();
+	const dsp::SimdInstructionSet instructionSets[] = { dsp::SIMD_NONE, dsp::SIMD_SSE2, dsp::SIMD_AVX2, dsp::SIMD_AVX512, dsp::SIMD_NEON };
+
+	cout << fixed << setprecision( 0 );
+	for( dsp::SimdInstructionSet instructionSet : instructionSets ) {
+		if( ! dsp::setSimdInstructionSet( instructionSet ) )
+			continue;
+
+		const double constant = measureCallsPerSecond( [&] { phase = waveTable->lookupBandlimited( buffer.getData(), FRAMES_PER_BLOCK, phase, 261.6f ); }, measureSeconds );
+		const double swept = measureCallsPerSecond( [&] { phase = waveTable->lookupBandlimited( buffer.getData(), FRAMES_PER_BLOCK, phase, f0Array.data() ); }, measureSeconds );
+
+		cout << setw( 12 ) << dsp::simdInstructionSetToString( instructionSet ) << setw( 12 ) << constant / blocksPerSecond << setw( 12 ) << swept / blocksPerSecond << endl;
+	}
+	cout << endl;
+
+	dsp::setSimdInstructionSet( detected );
+}
+
+// Returns the microseconds per block of rendering a stereo GenTriangle through an 8th order lowpass, built from four FilterLowPass Node's or, if
+// \a subBlockFrames is non-zero, from one FilterCascade with four sections. If \a modulated, the cutoff frequencies are swept at audio rate.
+double renderFilterChain( size_t subBlockFrames, bool modulated, double measureSeconds )
+{
+	auto ctx = make_shared<ContextOffline>( SAMPLE_RATE, FRAMES_PER_BLOCK, 2 );
+	auto osc = ctx->makeNode( new GenTriangle( 220, Node::Format().channels( 2 ) ) );
+	osc->start();
+
+	const uint64_t sweepFrames = 60 * SAMPLE_RATE;
+	if( subBlockFrames ) {
+		auto cascade = ctx->makeNode( new FilterCascade( 4, Node::Format().channels( 2 ) ) );
+		cascade->setSubBlockFrames( subBlockFrames );
+		for( size_t i = 0; i < 4; i++ ) {
+			if( modulated )
+				cascade->getParamFreq( i )->applyRampFrames( 200, 8000, sweepFrames );
+			else
+				cascade->getParamFreq( i )->setValue( 1000 );
+		}
+
+		osc >> cascade >> ctx->getOutput();
+	}
+	else {
+		NodeRef node = osc;
+		for( size_t i = 0; i < 4; i++ ) {
+			auto lowPass = ctx->makeNode( new FilterLowPass( Node::Format().channels( 2 ) ) );
+			lowPass->setFreq( 1000 );
+			node = node >> lowPass;
+		}
+
+		node >> ctx->getOutput();
+	}
+
+	Buffer buffer( FRAMES_PER_BLOCK, 2 );
+	const double blocks = measureCallsPerSecond( [&] { ctx->render( &buffer ); }, measureSeconds );
+	return 1e6 / blocks;
+}
+
+void measureFilterCascade( double measureSeconds )
+{
+	cout << "filter cascade, microseconds per block of rendering a stereo oscillator through an 8th order lowpass." << endl << endl;
+
+	cout << fixed << setprecision( 2 );
+	cout << setw( 48 ) << "4 FilterLowPass Node's" << setw( 12 ) << renderFilterChain( 0, false, measureSeconds ) << endl;
+	cout << setw( 48 ) << "FilterCascade, static" << setw( 12 ) << renderFilterChain( 32, false, measureSeconds ) << endl;
+	cout << setw( 48 ) << "FilterCascade, swept every 32 frames" << setw( 12 ) << renderFilterChain( 32, true, measureSeconds ) << endl;
+	cout << setw( 48 ) << "FilterCascade, swept every 8 frames" << setw( 12 ) << renderFilterChain( 8, true, measureSeconds ) << endl;
+	cout << endl;
+}
+
+// Returns the microseconds per block of rendering \a numOscillators sine oscillators, either as GenOscillator Node's summed at the output or as one GenBank.
+double renderOscillators( size_t numOscillators, bool bank, double measureSeconds )
+{
+	auto ctx = make_shared<ContextOffline>( SAMPLE_RATE, FRAMES_PER_BLOCK, 1 );
+	const float amp = 1.0f / numOscillators;
+
+	if( bank ) {
+		auto genBank = ctx->makeNode( new GenBank( numOscillators ) );
+		for( size_t i = 0; i < numOscillators; i++ )
+			genBank->set( i, 100 + 10 * float( i ), amp );
+
+		genBank >> ctx->getOutput();
+		genBank->start();
+	}
+	else {
+		for( size_t i = 0; i < numOscillators; i++ ) {
+			auto osc = ctx->makeNode( new GenOscillator( 100 + 10 * float( i ) ) );
+			auto gain = ctx->makeNode( new Gain( amp ) );
+			osc >> gain >> ctx->getOutput();
+			osc->start();
+		}
+	}
+
+	Buffer buffer( FRAMES_PER_BLOCK );
+	const double blocks = measureCallsPerSecond( [&] { ctx->render( &buffer ); }, measureSeconds );
+	return 1e6 / blocks;
+}
+
+void measureOscillatorBank( double measureSeconds )
+{
+	const size_t numOscillators = 1000;
+
+	// holds onto the tables shared by the oscillators, so that they are filled once and before any output
+	auto sineTables = dsp::WaveTable2d::getBandlimited( WaveformType::SINE, SAMPLE_RATE, 4096, 40 );
+
+	cout << "oscillator bank, microseconds per block of rendering " << numOscillators << " sine oscillators with their own frequency and amplitude." << endl << endl;
+
+	cout << fixed << setprecision( 2 );
+	cout << setw( 48 ) << "GenOscillator and Gain Node's" << setw( 12 ) << renderOscillators( numOscillators, false, measureSeconds ) << endl;
+
+	dsp::SimdInstructionSet detected = dsp::getSimdInstructionSet();
+	const dsp::SimdInstructionSet instructionSets[] = { dsp::SIMD_NONE, dsp::SIMD_SSE2, dsp::SIMD_AVX2, dsp::SIMD_AVX512, dsp::SIMD_NEON };
+
+	for( dsp::SimdInstructionSet instructionSet : instructionSets ) {
+		if( ! dsp::setSimdInstructionSet( instructionSet ) )
+			continue;
+
+		cout << setw( 48 ) << "GenBank, " + string( dsp::simdInstructionSetToString( instructionSet ) ) << setw( 12 ) << renderOscillators( numOscillators, true, measureSeconds ) << endl;
+	}
+	cout << endl;
+
+	dsp::setSimdInstructionSet( detected );
+}
+
+void measureNoise( double measureSeconds )
+{
+	cout << "noise, microseconds per block of generating white noise with ci::randFloat() and with a NoiseGenerator, and of filtering it to pink and brown noise." << endl << endl;
+
+	Buffer buffer( FRAMES_PER_BLOCK );
+	float *data = buffer.getData();
+	dsp::NoiseGenerator generator;
+
+	cout << fixed << setprecision( 2 );
+	cout << setw( 48 ) << "ci::randFloat()" << setw( 12 ) << 1e6 / measureCallsPerSecond( [&] { for( size_t i = 0; i < FRAMES_PER_BLOCK; i++ ) data[i] = randFloat( -1, 1 ); }, measureSeconds ) << endl;
+
+	dsp::SimdInstructionSet detected = dsp::getSimdInstructionSet();
+	const dsp::SimdInstructionSet instructionSets[] = { dsp::SIMD_NONE, dsp::SIMD_SSE2, dsp::SIMD_AVX2, dsp::SIMD_AVX512, dsp::SIMD_NEON };
+
+	for( dsp::SimdInstructionSet instructionSet : instructionSets ) {
+		if( ! dsp::setSimdInstructionSet( instructionSet ) )
+			continue;
+
+		cout << setw( 48 ) << "white, " + string( dsp::simdInstructionSetToString( instructionSet ) ) << setw( 12 ) << 1e6 / measureCallsPerSecond( [&] { generator.fillWhite( data, FRAMES_PER_BLOCK ); }, measureSeconds ) << endl;
+	}
+
+	dsp::setSimdInstructionSet( detected );
+
+	cout << setw( 48 ) << "pink" << setw( 12 ) << 1e6 / measureCallsPerSecond( [&] { generator.fillPink( data, FRAMES_PER_BLOCK ); }, measureSeconds ) << endl;
+	cout << setw( 48 ) << "brown" << setw( 12 ) << 1e6 / measureCallsPerSecond( [&] { generator.fillBrown( data, FRAMES_PER_BLOCK ); }, measureSeconds ) << endl;
+	cout << endl;
+}
+
+void measureConvolver( double measureSeconds )
+{
+	const size_t impulseFrames = 4 * SAMPLE_RATE;
+	const double blockMicroseconds = 1e6 * FRAMES_PER_BLOCK / SAMPLE_RATE;
+
+	cout << "convolver, microseconds per block of a 4 second true stereo impulse response, including the tail partitions, and the percentage of real-time." << endl << endl;
+	cout << setw( 16 ) << "tail partition" << setw( 12 ) << "block" << setw( 12 ) << "percent" << endl;
+
+	Buffer impulseResponse( impulseFrames, 4 );
+	for( size_t i = 0; i < impulseResponse.getSize(); i++ )
+		impulseResponse[i] = float( i % 7 ) / 7;
+
+	Buffer buffer( FRAMES_PER_BLOCK, 2 );
+	for( size_t i = 0; i < buffer.getSize(); i++ )
+		buffer[i] = float( i % 5 ) / 5;
+
+	const size_t partitionSize = dsp::PartitionedConvolver::getPartitionSize( FRAMES_PER_BLOCK );
+	const size_t tailPartitionSizes[] = { 0, 4096, 16384 };
+
+	cout << fixed << setprecision( 2 );
+	for( size_t tailPartitionSize : tailPartitionSizes ) {
+		auto partitioned = make_shared<dsp::ImpulseResponse>( impulseResponse, partitionSize, tailPartitionSize );
+		dsp::PartitionedConvolver convolver( partitioned, 2 );
+
+		const double blocks = measureCallsPerSecond( [&] { convolver.process( &buffer, &buffer ); }, measureSeconds );
+		cout << setw( 16 ) << tailPartitionSize << setw( 12 ) << 1e6 / blocks << setw( 12 ) << 100 * 1e6 / blocks / blockMicroseconds << endl;
+	}
+	cout << endl;
+}
+
+int main( int argc, char *argv[] )
+{
+	size_t maxRenderThreads = argc > 1 ? atoi( argv[1] ) : max<size_t>( thread::hardware_concurrency(), 2 ) - 1;
+	double renderSeconds = argc > 2 ? atof( argv[2] ) : 10.0;
+
+	const size_t voiceCounts[] = { 1, 4, 16, 64, 256 };
+
+	measureDspKernels( min( renderSeconds / 10, 0.5 ) );
+	measureFft( min( renderSeconds / 10, 0.5 ) );
+	measureBiquads( min( renderSeconds / 10, 0.5 ) );
+	measureWaveTables( min( renderSeconds / 10, 0.5 ) );
+	measureFilterCascade( min( renderSeconds / 10, 0.5 ) );
+	measureOscillatorBank( min( renderSeconds / 10, 0.5 ) );
+	measureNoise( min( renderSeconds / 10, 0.5 ) );
+	measureConvolver( min( renderSeconds / 10, 0.5 ) );
+
+	cout << "rendering " << renderSeconds << " seconds of audio, " << FRAMES_PER_BLOCK << " frames per block." << endl;
+	cout << "times are in seconds, followed by the speedup over serial rendering." << endl << endl;
+
+	cout << setw( 8 ) << "voices";
+	for( size_t numThreads = 0; numThreads <= maxRenderThreads; numThreads++ )
+		cout << setw( 20 ) << ( numThreads ? to_string( numThreads ) + " threads" : string( "serial" ) );
+	cout << endl;
+
+	cout << fixed << setprecision( 3 );
+	for( size_t numVoices : voiceCounts ) {
+		cout << setw( 8 ) << numVoices;
+
+		double serialSeconds = 0;
+		for( size_t numThreads = 0; numThreads <= maxRenderThreads; numThreads++ ) {
+			double seconds = renderVoices( numVoices, numThreads, renderSeconds );
+			if( ! numThreads ) {
+				serialSeconds = seconds;
+				cout << setw( 20 ) << seconds;
+			}
+			else
+				cout << setw( 12 ) << seconds << " (" << setw( 4 ) << setprecision( 2 ) << serialSeconds / seconds << "x)" << setprecision( 3 );
+		}
+		cout << endl;
+	}
+
+	return 0;
+}
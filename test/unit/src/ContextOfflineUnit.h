@@ -0,0 +1,841 @@
+#pragma once
+
+#include "cinder/audio2/ContextOffline.h"
+#include "cinder/audio2/NodeEffect.h"
+#include "cinder/audio2/SamplePlayer.h"
+#include "cinder/audio2/Scope.h"
+#include "cinder/audio2/Exception.h"
+#include "cinder/audio2/RenderGraph.h"
+#include "cinder/audio2/RealtimeCheck.h"
+#include "utils.h"
+
+#include <thread>
+
+BOOST_AUTO_TEST_SUITE( test_context_offline )
+
+using namespace ci;
+using namespace ci::audio2;
+
+// keeps values well below NodeOutput's clip detection threshold for the number of frames rendered in these tests.
+const float FRAME_STEP = 0.001f;
+
+// Outputs a ramp that increases by FRAME_STEP for every frame processed, so rendered results can be checked sample by sample.
+CallbackProcessorRef makeFrameCounter( const ContextRef &ctx, const std::shared_ptr<size_t> &frame = std::make_shared<size_t>( 0 ) )
+{
+	auto result = ctx->makeNode( new CallbackProcessor( [frame] ( Buffer *buffer, size_t sampleRate ) {
+		for( size_t i = 0; i < buffer->getNumFrames(); i++ )
+			buffer->getData()[i] = float( (*frame)++ ) * FRAME_STEP;
+	}, Node::Format().channels( 1 ) ) );
+
+	result->start();
+	return result;
+}
+
+BOOST_AUTO_TEST_CASE( test_render_partial_block )
+{
+	auto ctx = std::make_shared<ContextOffline>( 44100, 64, 1 );
+	auto counter = makeFrameCounter( ctx );
+	auto gain = ctx->makeNode( new Gain( 0.5f ) );
+
+	counter >> gain >> ctx->getOutput();
+
+	Buffer buffer( 100, 1 );
+	ctx->render( &buffer );
+
+	BOOST_CHECK( ctx->isEnabled() );
+	BOOST_CHECK( ! ctx->isRealTime() );
+	BOOST_CHECK_EQUAL( ctx->getNumProcessedFrames(), 128 );
+	for( size_t i = 0; i < buffer.getNumFrames(); i++ )
+		BOOST_REQUIRE_CLOSE( buffer[i] + 1, i * FRAME_STEP * 0.5f + 1, 0.0001f );
+
+	// the next render continues from where the last full block ended.
+	ctx->render( &buffer );
+	BOOST_CHECK_EQUAL( ctx->getNumProcessedFrames(), 256 );
+	BOOST_REQUIRE_CLOSE( buffer[0], 128 * FRAME_STEP * 0.5f, 0.0001f );
+}
+
+BOOST_AUTO_TEST_CASE( test_render_summing )
+{
+	auto ctx = std::make_shared<ContextOffline>( 44100, 32, 2 );
+	auto counter1 = makeFrameCounter( ctx );
+	auto counter2 = makeFrameCounter( ctx );
+
+	counter1 >> ctx->getOutput();
+	counter2 >> ctx->getOutput();
+
+	BOOST_CHECK( ! ctx->getOutput()->getProcessInPlace() );
+
+	Buffer buffer( 64, 2 );
+	ctx->render( &buffer );
+
+	// mono inputs are up-mixed to the stereo output before summing.
+	for( size_t ch = 0; ch < buffer.getNumChannels(); ch++ ) {
+		for( size_t i = 0; i < buffer.getNumFrames(); i++ )
+			BOOST_REQUIRE_CLOSE( buffer.getChannel( ch )[i] + 1, i * FRAME_STEP * 2 + 1, 0.0001f );
+	}
+}
+
+BOOST_AUTO_TEST_CASE( test_disabled_input_is_silent )
+{
+	auto ctx = std::make_shared<ContextOffline>( 44100, 32, 1 );
+	auto counter = makeFrameCounter( ctx );
+	counter >> ctx->getOutput();
+	counter->stop();
+
+	Buffer buffer( 32, 1 );
+	fillRandom( &buffer );
+	ctx->render( &buffer );
+
+	for( size_t i = 0; i < buffer.getNumFrames(); i++ )
+		BOOST_REQUIRE_EQUAL( buffer[i], 0.0f );
+}
+
+BOOST_AUTO_TEST_CASE( test_shared_input_processed_once )
+{
+	auto ctx = std::make_shared<ContextOffline>( 44100, 32, 1 );
+	auto frame = std::make_shared<size_t>( 0 );
+	auto counter = makeFrameCounter( ctx, frame );
+	auto gain1 = ctx->makeNode( new Gain( 0.25f ) );
+	auto gain2 = ctx->makeNode( new Gain( 0.5f ) );
+
+	counter >> gain1 >> ctx->getOutput();
+	counter >> gain2 >> ctx->getOutput();
+
+	Buffer buffer( 64, 1 );
+	ctx->render( &buffer );
+
+	BOOST_CHECK_EQUAL( *frame, 64 );
+	for( size_t i = 0; i < buffer.getNumFrames(); i++ )
+		BOOST_REQUIRE_CLOSE( buffer[i] + 1, i * FRAME_STEP * 0.75f + 1, 0.0001f );
+}
+
+BOOST_AUTO_TEST_CASE( test_auto_pulled_and_disconnected )
+{
+	auto ctx = std::make_shared<ContextOffline>( 44100, 32, 1 );
+	auto frame = std::make_shared<size_t>( 0 );
+	auto counter = makeFrameCounter( ctx, frame );
+	auto scope = ctx->makeNode( new Scope );
+
+	// Scope has no outputs, so it is pulled by the Context.
+	counter >> scope;
+
+	Buffer buffer( 64, 1 );
+	ctx->render( &buffer );
+	BOOST_CHECK_EQUAL( *frame, 64 );
+
+	counter->disconnectAll();
+	ctx->render( &buffer );
+	BOOST_CHECK_EQUAL( *frame, 64 );
+}
+
+BOOST_AUTO_TEST_CASE( test_scope_spectral_fft_size )
+{
+	auto ctx = std::make_shared<ContextOffline>( 48000, 480, 1 );
+	auto counter = makeFrameCounter( ctx );
+	auto scope = ctx->makeNode( new ScopeSpectral( ScopeSpectral::Format().windowSize( 480 ) ) );
+	auto padded = ctx->makeNode( new ScopeSpectral( ScopeSpectral::Format().windowSize( 441 ) ) );
+
+	counter >> scope;
+	counter >> padded;
+
+	Buffer buffer( 480, 1 );
+	ctx->render( &buffer );
+
+	// 10 ms windows at 48 kHz are analyzed as they are, other sizes are padded to the next size that Fft supports
+	BOOST_CHECK_EQUAL( scope->getWindowSize(), 480 );
+	BOOST_CHECK_EQUAL( scope->getFftSize(), 480 );
+	BOOST_CHECK_EQUAL( scope->getMagSpectrum().size(), 240 );
+	BOOST_CHECK_EQUAL( padded->getWindowSize(), 441 );
+	BOOST_CHECK_EQUAL( padded->getFftSize(), 450 );
+}
+
+BOOST_AUTO_TEST_CASE( test_disconnected_node_released )
+{
+	auto ctx = std::make_shared<ContextOffline>( 44100, 32, 1 );
+	auto counter = makeFrameCounter( ctx );
+	std::weak_ptr<Node> counterWeak = counter;
+
+	counter >> ctx->getOutput();
+
+	Buffer buffer( 32, 1 );
+	ctx->render( &buffer );
+
+	// the published RenderGraph no longer references counter, and nothing is rendering, so it is released immediately.
+	counter->disconnectAll();
+	counter.reset();
+	BOOST_CHECK( counterWeak.expired() );
+}
+
+BOOST_AUTO_TEST_CASE( test_set_buffer_between_renders )
+{
+	auto ctx = std::make_shared<ContextOffline>( 44100, 32, 1 );
+
+	BufferRef buffer1 = std::make_shared<Buffer>( 64, 1 );
+	BufferRef buffer2 = std::make_shared<Buffer>( 64, 1 );
+	std::fill( buffer1->getData(), buffer1->getData() + 64, 0.25f );
+	std::fill( buffer2->getData(), buffer2->getData() + 64, 0.5f );
+
+	auto player = ctx->makeNode( new BufferPlayer( buffer1 ) );
+	player >> ctx->getOutput();
+	player->start();
+
+	Buffer rendered( 32, 1 );
+	ctx->render( &rendered );
+	BOOST_CHECK_EQUAL( rendered[31], 0.25f );
+
+	std::weak_ptr<Buffer> buffer1Weak = buffer1;
+	player->setBuffer( buffer2 );
+	buffer1.reset();
+	BOOST_CHECK( buffer1Weak.expired() );
+
+	ctx->render( &rendered );
+	BOOST_CHECK_EQUAL( rendered[0], 0.5f );
+}
+
+// Renders 8 frame counters, each through its own Gain and mixed at the output, into \a result.
+void renderVoices( size_t numRenderThreads, Buffer *result )
+{
+	auto ctx = std::make_shared<ContextOffline>( 44100, 32, 2 );
+	ctx->setNumRenderThreads( numRenderThreads );
+
+	for( size_t i = 0; i < 8; i++ ) {
+		auto counter = makeFrameCounter( ctx );
+		auto gain = ctx->makeNode( new Gain( 0.1f * ( i + 1 ) ) );
+		counter >> gain >> ctx->getOutput();
+	}
+
+	for( size_t i = 0; i < 4; i++ )
+		ctx->render( result );
+}
+
+BOOST_AUTO_TEST_CASE( test_parallel_render_matches_serial )
+{
+	Buffer serial( 64, 2 );
+	Buffer parallel( 64, 2 );
+
+	renderVoices( 0, &serial );
+	renderVoices( 3, &parallel );
+
+	for( size_t i = 0; i < serial.getSize(); i++ )
+		BOOST_REQUIRE_EQUAL( serial.getData()[i], parallel.getData()[i] );
+}
+
+BOOST_AUTO_TEST_CASE( test_parallel_jobs_compiled )
+{
+	auto ctx = std::make_shared<ContextOffline>( 44100, 32, 1 );
+	auto renderPool = std::make_shared<RenderPool>( 2 );
+
+	auto counter1 = makeFrameCounter( ctx );
+	auto counter2 = makeFrameCounter( ctx );
+	auto gain = ctx->makeNode( new Gain );
+
+	counter1 >> gain >> ctx->getOutput();
+	counter2 >> ctx->getOutput();
+
+	BOOST_CHECK_EQUAL( RenderGraph( ctx->getOutput(), std::set<NodeRef>(), 32 ).getNumParallelJobs(), 0 );
+	BOOST_CHECK_EQUAL( RenderGraph( ctx->getOutput(), std::set<NodeRef>(), 32, renderPool ).getNumParallelJobs(), 2 );
+
+	// counter1 now has two outputs, so only counter2 is independent and there is nothing to run in parallel.
+	counter1 >> ctx->getOutput();
+	BOOST_CHECK_EQUAL( RenderGraph( ctx->getOutput(), std::set<NodeRef>(), 32, renderPool ).getNumParallelJobs(), 0 );
+}
+
+BOOST_AUTO_TEST_CASE( test_buffers_pooled )
+{
+	auto ctx = std::make_shared<ContextOffline>( 44100, 32, 1 );
+
+	// each bus sums two frame counters and is then summed at the output. Only one bus is processed at a time, so they can share Buffer's.
+	for( size_t i = 0; i < 4; i++ ) {
+		auto bus = ctx->makeNode( new Gain( 0.5f ) );
+		makeFrameCounter( ctx ) >> bus;
+		makeFrameCounter( ctx ) >> bus;
+		bus >> ctx->getOutput();
+	}
+
+	Buffer buffer( 64, 1 );
+	ctx->render( &buffer );
+
+	for( size_t i = 0; i < buffer.getNumFrames(); i++ )
+		BOOST_REQUIRE_CLOSE( buffer[i] + 1, i * FRAME_STEP * 4 + 1, 0.0001f );
+
+	auto renderGraph = ctx->getRenderGraph();
+	BOOST_REQUIRE( renderGraph );
+
+	// the output's internal and summing buffers, plus an internal and summing buffer for each bus.
+	BOOST_CHECK_EQUAL( renderGraph->getNumBufferSlots(), 10 );
+	// the output's internal buffer, its summing buffer, and one internal and summing buffer shared by all buses.
+	BOOST_CHECK_EQUAL( renderGraph->getNumBuffersUsed(), 4 );
+	BOOST_CHECK_LT( renderGraph->getNumBytesPooled(), renderGraph->getNumBytesUnpooled() );
+}
+
+BOOST_AUTO_TEST_CASE( test_summing_param_processor )
+{
+	auto ctx = std::make_shared<ContextOffline>( 44100, 32, 1 );
+
+	auto makeConstant = [ctx]( float value ) {
+		auto result = ctx->makeNode( new CallbackProcessor( [value] ( Buffer *buffer, size_t sampleRate ) {
+			std::fill( buffer->getData(), buffer->getData() + buffer->getSize(), value );
+		}, Node::Format().channels( 1 ) ) );
+
+		result->start();
+		return result;
+	};
+
+	auto gain = ctx->makeNode( new Gain( 0.0f ) );
+	makeConstant( 1.0f ) >> gain >> ctx->getOutput();
+
+	// bus is summed outside of the RenderGraph when the Param pulls its processor, so it needs its own Buffer's.
+	auto bus = ctx->makeNode( new Gain( 1.0f ) );
+	auto processor = ctx->makeNode( new Gain( 1.0f ) );
+	makeConstant( 0.25f ) >> bus;
+	makeConstant( 0.25f ) >> bus >> processor;
+	gain->getParam()->setProcessor( processor );
+
+	Buffer buffer( 32, 1 );
+	ctx->render( &buffer );
+	BOOST_CHECK_EQUAL( buffer[0], 0.5f );
+	BOOST_CHECK_EQUAL( buffer[31], 0.5f );
+
+	// inputs connected afterwards are also set up to be pulled by the Param.
+	makeConstant( 0.25f ) >> bus;
+
+	ctx->render( &buffer );
+	BOOST_CHECK_EQUAL( buffer[0], 0.75f );
+	BOOST_CHECK_EQUAL( buffer[31], 0.75f );
+}
+
+// Passes its input through and counts how many times it was processed, with a tail of \a tailFrames at 44100 hz.
+class ProcessCounter : public Node {
+  public:
+	ProcessCounter( size_t tailFrames ) : Node( Format().channels( 1 ) ), mTailFrames( tailFrames ), mNumProcessed( 0 )	{}
+
+	double getTailSeconds() const override	{ return mTailFrames / 44100.0; }
+	size_t getNumProcessed() const			{ return mNumProcessed; }
+
+  protected:
+	void process( Buffer *buffer ) override	{ mNumProcessed++; }
+
+  private:
+	size_t mTailFrames, mNumProcessed;
+};
+
+BOOST_AUTO_TEST_CASE( test_silent_nodes_sleep )
+{
+	auto ctx = std::make_shared<ContextOffline>( 44100, 32, 1 );
+	auto counter1 = makeFrameCounter( ctx );
+	auto counter2 = makeFrameCounter( ctx );
+	auto gain = ctx->makeNode( new Gain( 0.5f ) );
+
+	// summing, with a tail of 2.5 blocks.
+	auto sleeper = ctx->makeNode( new ProcessCounter( 80 ) );
+	sleeper->start();
+
+	counter1 >> gain >> sleeper >> ctx->getOutput();
+	counter2 >> sleeper;
+
+	Buffer buffer( 128, 1 );
+	ctx->render( &buffer );
+	BOOST_CHECK_EQUAL( sleeper->getNumProcessed(), 4 );
+
+	// processed until the input has been silent for longer than the tail, the output stays silent.
+	counter1->stop();
+	counter2->stop();
+	ctx->render( &buffer );
+	BOOST_CHECK_EQUAL( sleeper->getNumProcessed(), 7 );
+	for( size_t i = 0; i < buffer.getNumFrames(); i++ )
+		BOOST_REQUIRE_EQUAL( buffer[i], 0 );
+
+	// wakes up as soon as any input is not silent.
+	counter2->start();
+	ctx->render( &buffer );
+	BOOST_CHECK_EQUAL( sleeper->getNumProcessed(), 11 );
+	BOOST_CHECK_GT( buffer[0], 0 );
+}
+
+BOOST_AUTO_TEST_CASE( test_delay_tail_rendered )
+{
+	const size_t delayFrames = 40;
+	auto ctx = std::make_shared<ContextOffline>( 44100, 32, 1 );
+	auto counter = makeFrameCounter( ctx );
+	auto delay = ctx->makeNode( new Delay );
+	delay->setDelaySeconds( delayFrames / 44100.0f );
+	delay->start();
+
+	counter >> delay >> ctx->getOutput();
+
+	// the counter runs for two blocks, after which the delay line must still be flushed before the Delay sleeps.
+	Buffer buffer( 64, 1 );
+	ctx->render( &buffer );
+	counter->stop();
+	for( int i = 0; i < 3; i++ ) {
+		size_t startFrame = ( i + 1 ) * buffer.getNumFrames();
+		ctx->render( &buffer );
+
+		for( size_t frame = startFrame; frame < startFrame + buffer.getNumFrames(); frame++ ) {
+			float expected = frame - delayFrames < 64 ? ( frame - delayFrames ) * FRAME_STEP : 0;
+			BOOST_REQUIRE_CLOSE( buffer[frame - startFrame] + 1, expected + 1, 0.0001f );
+		}
+	}
+
+	// once the delay line is flushed, it resumes without any left-over samples.
+	counter->start();
+	ctx->render( &buffer );
+	for( size_t i = 0; i < delayFrames; i++ )
+		BOOST_REQUIRE_EQUAL( buffer[i], 0 );
+	BOOST_CHECK_GT( buffer[delayFrames], 0 );
+}
+
+// Outputs 1's, so that a Gain following it outputs the value of its Param.
+CallbackProcessorRef makeUnitSource( const ContextRef &ctx )
+{
+	auto result = ctx->makeNode( new CallbackProcessor( [] ( Buffer *buffer, size_t sampleRate ) {
+		std::fill( buffer->getData(), buffer->getData() + buffer->getSize(), 1.0f );
+	}, Node::Format().channels( 1 ) ) );
+
+	result->start();
+	return result;
+}
+
+BOOST_AUTO_TEST_CASE( test_param_ramps )
+{
+	auto ctx = std::make_shared<ContextOffline>( 44100, 32, 1 );
+	auto gain = ctx->makeNode( new Gain( 0 ) );
+	makeUnitSource( ctx ) >> gain >> ctx->getOutput();
+	Param *param = gain->getParam();
+
+	// a 64 frame ramp from 0 to 1, followed by one back to 0.5.
+	Ramp ramp = param->applyRamp( 0, 1, 64 / 44100.0f );
+	param->appendRamp( 0.5f, 64 / 44100.0f );
+	BOOST_CHECK( ramp.isValid() );
+	BOOST_CHECK_EQUAL( param->getNumRamps(), 2 );
+
+	Buffer buffer( 128, 1 );
+	ctx->render( &buffer );
+	BOOST_CHECK_CLOSE( buffer[32], 0.5f, 1.0f );
+	BOOST_CHECK_CLOSE( buffer[96], 0.75f, 1.0f );
+
+	ctx->render( &buffer );
+	BOOST_CHECK_CLOSE( buffer[0], 0.5f, 0.0001f );
+	BOOST_CHECK_CLOSE( param->getValue(), 0.5f, 0.0001f );
+	BOOST_CHECK( ramp.isComplete() );
+	BOOST_CHECK_EQUAL( param->getNumRamps(), 0 );
+
+	// a canceled ramp holds the value it reached.
+	ramp = param->applyRamp( 0, 128 / 44100.0f );
+	ctx->render( &buffer );
+	ramp.cancel();
+	BOOST_CHECK( ramp.isComplete() );
+	ctx->render( &buffer );
+	BOOST_CHECK_CLOSE( buffer[0], buffer[127], 0.0001f );
+	BOOST_CHECK_CLOSE( buffer[0], param->getValue(), 0.0001f );
+
+	// setting the value discards all ramps.
+	param->applyRamp( 1, 1 );
+	param->setValue( 0.25f );
+	BOOST_CHECK_EQUAL( param->getNumRamps(), 0 );
+	ctx->render( &buffer );
+	BOOST_CHECK_CLOSE( buffer[127], 0.25f, 0.0001f );
+}
+
+BOOST_AUTO_TEST_CASE( test_param_ramp_frames )
+{
+	auto ctx = std::make_shared<ContextOffline>( 44100, 32, 1 );
+	auto gain = ctx->makeNode( new Gain( 0.25f ) );
+	makeUnitSource( ctx ) >> gain >> ctx->getOutput();
+	Param *param = gain->getParam();
+
+	// ramps start and end on exact frames, regardless of block boundaries.
+	param->applyRampFrames( 0, 1, 20, Param::Options().delayFrames( 10 ) );
+	Buffer buffer( 64, 1 );
+	ctx->render( &buffer );
+	BOOST_CHECK_EQUAL( buffer[9], 0.25f );
+	BOOST_CHECK_EQUAL( buffer[10], 0 );
+	BOOST_CHECK_CLOSE( buffer[20], 0.5f, 0.0001f );
+	BOOST_CHECK_EQUAL( buffer[30], 1 );
+
+	// frame positions remain exact long after float seconds would have lost block resolution (2^40 frames is about 290 days at 44.1k).
+	const uint64_t farFrame = uint64_t( 1 ) << 40;
+	param->applyRampFrames( 0, 1, 4, Param::Options().delayFrames( farFrame - ctx->getNumProcessedFrames() + 1 ) );
+	float values[8];
+	param->eval( farFrame, values, 8 );
+	BOOST_CHECK_EQUAL( values[0], 1 );
+	BOOST_CHECK_EQUAL( values[1], 0 );
+	BOOST_CHECK_CLOSE( values[3], 0.5f, 0.0001f );
+	BOOST_CHECK_EQUAL( values[5], 1 );
+}
+
+BOOST_AUTO_TEST_CASE( test_param_ramp_curves )
+{
+	auto ctx = std::make_shared<ContextOffline>( 44100, 32, 1 );
+	auto gain = ctx->makeNode( new Gain( 0 ) );
+	Param *param = gain->getParam();
+	const uint64_t frame = ctx->getNumProcessedFrames();
+	float values[128];
+
+	// each curve is evaluated over a 100 frame ramp and compared at frame 25, in the middle of a block.
+	param->applyRampFrames( 1, 3, 100, Param::Options().curve( Ramp::LINEAR ) );
+	param->eval( frame, values, 128 );
+	BOOST_CHECK_CLOSE( values[25], 1.5f, 0.001f );
+	BOOST_CHECK_EQUAL( values[100], 3 );
+
+	param->applyRampFrames( 1, 3, 100, Param::Options().curve( Ramp::IN_QUAD ) );
+	param->eval( frame, values, 128 );
+	BOOST_CHECK_CLOSE( values[25], 1.125f, 0.001f );
+
+	param->applyRampFrames( 1, 3, 100, Param::Options().curve( Ramp::OUT_QUAD ) );
+	param->eval( frame, values, 128 );
+	BOOST_CHECK_CLOSE( values[25], 1.875f, 0.001f );
+
+	param->applyRampFrames( 1, 16, 100, Param::Options().curve( Ramp::EXPONENTIAL ) );
+	param->eval( frame, values, 128 );
+	BOOST_CHECK_CLOSE( values[25], 2.0f, 0.001f );
+	BOOST_CHECK_CLOSE( values[99], powf( 16, 0.99f ), 0.001f );
+
+	param->applyRampFrames( 1, 0, 100, Param::Options().curve( Ramp::TARGET ).timeConstant( 25 / 44100.0f ) );
+	param->eval( frame, values, 128 );
+	BOOST_CHECK_CLOSE( values[25], expf( -1 ), 0.01f );
+	BOOST_CHECK_EQUAL( values[100], 0 );
+
+	BufferRef curve( new Buffer( 3, 1 ) );
+	curve->getData()[0] = 0;
+	curve->getData()[1] = 1;
+	curve->getData()[2] = 0.5f;
+	param->applyRampFrames( 1, 3, 100, Param::Options().valueCurve( curve ) );
+	param->eval( frame, values, 128 );
+	BOOST_CHECK_CLOSE( values[25], 2.0f, 0.001f );
+	BOOST_CHECK_CLOSE( values[75], 2.5f, 0.001f );
+
+	param->applyRampFrames( 1, 3, 100, Param::Options().rampFn( [] ( float *array, size_t count, float t, float tIncr, const std::pair<float, float> &valueRange ) {
+		for( size_t i = 0; i < count; i++ )
+			array[i] = t + tIncr * i;
+	} ) );
+	param->eval( frame, values, 128 );
+	BOOST_CHECK_CLOSE( values[25], 0.25f, 0.001f );
+
+	// the built-in ramp functions map to their curves.
+	BOOST_CHECK_EQUAL( Param::Options().rampFn( &rampOutQuad ).getCurve(), Ramp::OUT_QUAD );
+	BOOST_CHECK_EQUAL( Param::Options().rampFn( &rampLinear ).getCurve(), Ramp::LINEAR );
+}
+
+BOOST_AUTO_TEST_CASE( test_param_control_rate )
+{
+	auto ctx = std::make_shared<ContextOffline>( 44100, 32, 1 );
+	auto gain = ctx->makeNode( new Gain( 0 ) );
+	makeUnitSource( ctx ) >> gain >> ctx->getOutput();
+	Param *param = gain->getParam();
+
+	// a linear ramp is reproduced exactly by interpolating values evaluated every 8 frames.
+	param->setRate( Param::CONTROL_RATE, 8 );
+	param->applyRampFrames( 0, 1, 64 );
+	Buffer buffer( 96, 1 );
+	ctx->render( &buffer );
+	BOOST_CHECK_SMALL( buffer[4] - 4 / 64.0f, 0.00001f );
+	BOOST_CHECK_SMALL( buffer[37] - 37 / 64.0f, 0.00001f );
+	BOOST_CHECK_EQUAL( buffer[64], 1 );
+	BOOST_CHECK_EQUAL( param->getNumRamps(), 0 );
+
+	param->applyRampFrames( 0, 1, 64 );
+	BOOST_CHECK_EQUAL( param->evalCheapest(), Param::CONTROL_VALUES );
+	BOOST_CHECK_EQUAL( param->getNumControlValues(), 5 );
+	BOOST_CHECK_EQUAL( param->getControlFrames(), 8 );
+	BOOST_CHECK_SMALL( param->getControlValues()[4] - 0.5f, 0.00001f );
+
+	// automatic rate only evaluates Ramp's at audio rate if they are steeper than the threshold.
+	param->setRate( Param::AUTO_RATE );
+	param->applyRampFrames( 0, 1, 44100 );
+	BOOST_CHECK_EQUAL( param->evalCheapest(), Param::CONTROL_VALUES );
+	BOOST_CHECK_EQUAL( param->getNumControlValues(), 2 );
+	param->applyRampFrames( 0, 1, 64 );
+	BOOST_CHECK_EQUAL( param->evalCheapest(), Param::AUDIO_VALUES );
+
+	param->setValue( 0.5f );
+	BOOST_CHECK_EQUAL( param->evalCheapest(), Param::CONSTANT );
+}
+
+BOOST_AUTO_TEST_CASE( test_modulation_matrix )
+{
+	auto ctx = std::make_shared<ContextOffline>( 44100, 32, 1 );
+	auto gain1 = ctx->makeNode( new Gain );
+	auto gain2 = ctx->makeNode( new Gain );
+	makeUnitSource( ctx ) >> gain1 >> gain2 >> ctx->getOutput();
+
+	auto counterFrame = std::make_shared<size_t>( 0 );
+	auto matrix = ctx->getModulationMatrix();
+	matrix->addSource( "lfo", makeFrameCounter( ctx, counterFrame ) );
+	BOOST_CHECK( matrix->connect( "lfo", gain1->getParam(), 2, 0.5f ) );
+	BOOST_CHECK( matrix->connect( "lfo", gain2->getParam() ) );
+	BOOST_CHECK( ! matrix->connect( "missing", gain2->getParam() ) );
+	BOOST_CHECK_EQUAL( matrix->getNumRoutes(), 2 );
+	BOOST_CHECK( gain2->getParam()->isModulated() );
+
+	// the source is computed once per block, however many Param's it drives.
+	Buffer buffer( 64, 1 );
+	ctx->render( &buffer );
+	BOOST_CHECK_EQUAL( *counterFrame, 64 );
+	float lfo = 40 * FRAME_STEP;
+	BOOST_CHECK_CLOSE( buffer[40], ( 0.5f + 2 * lfo ) * lfo, 0.001f );
+
+	// updating the depth and offset doesn't replace the route.
+	BOOST_CHECK( matrix->connect( "lfo", gain1->getParam(), 1, 0 ) );
+	matrix->disconnect( gain2->getParam() );
+	BOOST_CHECK( ! gain2->getParam()->isModulated() );
+	gain2->setValue( 0.5f );
+	ctx->render( &buffer );
+	lfo = ( 64 + 40 ) * FRAME_STEP;
+	BOOST_CHECK_CLOSE( buffer[40], lfo * 0.5f, 0.001f );
+
+	matrix->removeSource( "lfo" );
+	BOOST_CHECK_EQUAL( matrix->getNumRoutes(), 0 );
+	BOOST_CHECK_EQUAL( matrix->getNumSources(), 0 );
+}
+
+BOOST_AUTO_TEST_CASE( test_param_ramp_capacity )
+{
+	auto ctx = std::make_shared<ContextOffline>( 44100, 32, 1 );
+	auto gain = ctx->makeNode( new Gain( 0 ) );
+	Param *param = gain->getParam();
+
+	for( size_t i = 0; i < Param::MAX_NUM_RAMPS; i++ )
+		BOOST_REQUIRE( param->appendRamp( float( i ), 1 ).isValid() );
+
+	BOOST_CHECK( ! param->appendRamp( 0, 1 ).isValid() );
+
+	// applying a ramp replaces the others, so it always succeeds.
+	BOOST_CHECK( param->applyRamp( 0, 1 ).isValid() );
+	BOOST_CHECK_EQUAL( param->getNumRamps(), 1 );
+}
+
+BOOST_AUTO_TEST_CASE( test_prepare )
+{
+	auto ctx = std::make_shared<ContextOffline>( 44100, 32, 1 );
+	auto frame = std::make_shared<size_t>( 0 );
+	auto counter = makeFrameCounter( ctx, frame );
+	auto delay = ctx->makeNode( new Delay );
+	delay->setDelaySeconds( 10 / 44100.0f );
+	delay->setMaxDelaySeconds( 100 / 44100.0f );
+	delay->start();
+
+	counter >> delay >> ctx->getOutput();
+	ctx->prepare( 64 );
+
+	// lengthening the delay within its max no longer reallocates the delay line, so the published RenderGraph is left untouched.
+	auto renderGraph = ctx->getRenderGraph();
+	BOOST_REQUIRE( renderGraph );
+	delay->setDelaySeconds( 100 / 44100.0f );
+	BOOST_CHECK( ctx->getRenderGraph() == renderGraph );
+
+	Buffer buffer( 128, 1 );
+	ctx->render( &buffer );
+	for( size_t i = 0; i <= 100; i++ )
+		BOOST_REQUIRE_EQUAL( buffer[i], 0 );
+	BOOST_CHECK_CLOSE( buffer[101], FRAME_STEP, 0.0001f );
+
+	// the length can also change while the Delay is rendering on another thread, which only ever outputs the counter's past values.
+	// The counter soon exceeds the clip threshold, which would otherwise silence the output.
+	ctx->getOutput()->enableClipDetection( false );
+	std::atomic<bool> rendering( true );
+	size_t numInvalidSamples = 0;
+	std::thread renderThread( [&] {
+		Buffer block( 32, 1 );
+		while( rendering ) {
+			ctx->render( &block );
+			for( size_t i = 0; i < block.getNumFrames(); i++ ) {
+				if( ! ( block[i] >= 0 && block[i] <= *frame * FRAME_STEP ) )
+					numInvalidSamples++;
+			}
+		}
+	} );
+
+	for( size_t i = 0; i < 2000; i++ )
+		delay->setDelaySeconds( ( i % 2 ? 10 : 100 ) / 44100.0f );
+
+	rendering = false;
+	renderThread.join();
+	BOOST_CHECK_EQUAL( numInvalidSamples, 0 );
+	BOOST_CHECK( ctx->getRenderGraph() == renderGraph );
+
+	// the last length set is applied at the start of the next block.
+	size_t firstFrame = *frame;
+	delay->setDelaySeconds( 10 / 44100.0f );
+	ctx->render( &buffer );
+	for( size_t i = 10; i < buffer.getNumFrames(); i++ )
+		BOOST_REQUIRE_CLOSE( buffer[i], ( firstFrame + i - 10 ) * FRAME_STEP, 0.0001f );
+
+	// beyond the max, the delay line has to grow while the RenderGraph is suspended.
+	delay->setDelaySeconds( 200 / 44100.0f );
+	BOOST_CHECK( ctx->getRenderGraph() != renderGraph );
+}
+
+BOOST_AUTO_TEST_CASE( test_scheduled_start_stop )
+{
+	auto ctx = std::make_shared<ContextOffline>( 44100, 32, 1 );
+	auto counter = makeFrameCounter( ctx );
+	auto gain = ctx->makeNode( new Gain( 0.5f ) );
+	counter >> gain >> ctx->getOutput();
+
+	// the counter only advances while it is processed, the disabled Gain passes its input through.
+	counter->stop();
+	gain->stop();
+	counter->start( 40 / 44100.0 );
+	counter->stop( 100 / 44100.0 );
+	gain->start( 50 / 44100.0 );
+
+	Buffer buffer( 128, 1 );
+	ctx->render( &buffer );
+	for( size_t i = 0; i < buffer.getNumFrames(); i++ ) {
+		float expected = 0;
+		if( i >= 40 && i < 100 )
+			expected = ( i - 40 ) * FRAME_STEP * ( i < 50 ? 1.0f : 0.5f );
+
+		BOOST_REQUIRE_CLOSE( buffer[i] + 1, expected + 1, 0.0001f );
+	}
+
+	BOOST_CHECK( ! counter->isEnabled() );
+	BOOST_CHECK( gain->isEnabled() );
+
+	// times that have already passed apply immediately, canceled events are never applied.
+	counter->start( 0.0 );
+	BOOST_CHECK( counter->isEnabled() );
+	counter->stop( 200 / 44100.0 );
+	counter->cancelScheduled();
+	ctx->render( &buffer );
+	BOOST_CHECK( counter->isEnabled() );
+}
+
+BOOST_AUTO_TEST_CASE( test_profile )
+{
+	auto ctx = std::make_shared<ContextOffline>( 44100, 32, 1 );
+	auto counter = makeFrameCounter( ctx );
+	auto gain = ctx->makeNode( new Gain( 0.5f ) );
+	counter >> gain >> ctx->getOutput();
+
+	Buffer buffer( 128, 1 );
+	ctx->render( &buffer );
+	BOOST_CHECK( ctx->getProfile().empty() );
+
+	ctx->setProfilingEnabled();
+	ctx->render( &buffer );
+
+	auto profile = ctx->getProfile();
+	BOOST_REQUIRE_EQUAL( profile.size(), 3 );
+	for( const auto &nodeProfile : profile ) {
+		BOOST_CHECK_EQUAL( nodeProfile.getNumCalls(), 4 );
+		BOOST_CHECK_LE( nodeProfile.getMinNanoseconds(), nodeProfile.getMeanNanoseconds() );
+		BOOST_CHECK_LE( nodeProfile.getMeanNanoseconds(), nodeProfile.getMaxNanoseconds() );
+		BOOST_CHECK_LE( nodeProfile.getP99Nanoseconds(), nodeProfile.getMaxNanoseconds() );
+	}
+
+	BOOST_CHECK_GE( profile.front().getTotalNanoseconds(), profile.back().getTotalNanoseconds() );
+
+	// a reset is applied the next time each Node is processed.
+	ctx->resetProfile();
+	BOOST_CHECK_EQUAL( ctx->getProfile().front().getNumCalls(), 0 );
+
+	Buffer block( 32, 1 );
+	ctx->render( &block );
+	BOOST_CHECK_EQUAL( ctx->getProfile().front().getNumCalls(), 1 );
+
+	ctx->setProfilingEnabled( false );
+	BOOST_CHECK( ctx->getProfile().empty() );
+}
+
+#if defined( CI_AUDIO_ENABLE_REALTIME_CHECKS )
+
+// Passes its input through and keeps a history of its first sample, which allocates as the history grows.
+class HistoryRecorder : public Node {
+  public:
+	HistoryRecorder() : Node( Format().channels( 1 ) )	{}
+
+	std::string getName() override			{ return "HistoryRecorder"; }
+
+  protected:
+	void process( Buffer *buffer ) override	{ mHistory.push_back( buffer->getData()[0] ); }
+
+  private:
+	std::vector<float>	mHistory;
+};
+
+BOOST_AUTO_TEST_CASE( test_realtime_check )
+{
+	BOOST_REQUIRE( RealtimeCheck::isAvailable() );
+
+	auto ctx = std::make_shared<ContextOffline>( 44100, 32, 1 );
+	auto counter = makeFrameCounter( ctx );
+	auto gain = ctx->makeNode( new Gain( 0.5f ) );
+	counter >> gain >> ctx->getOutput();
+	ctx->prepare();
+
+	// neither processing nor evaluating and completing a Param's ramps allocates or locks.
+	RealtimeCheck::clearViolations();
+	Buffer buffer( 128, 1 );
+	ctx->render( &buffer );
+	gain->getParam()->applyRamp( 1, 0.001f );
+	ctx->render( &buffer );
+	ctx->render( &buffer );
+	BOOST_CHECK_EQUAL( RealtimeCheck::getNumViolations(), 0 );
+
+	auto recorder = ctx->makeNode( new HistoryRecorder );
+	recorder->start();
+	gain->disconnectAllOutputs();
+	gain >> recorder >> ctx->getOutput();
+	ctx->prepare();
+
+	RealtimeCheck::clearViolations();
+	ctx->render( &buffer );
+
+	auto violations = RealtimeCheck::getViolations();
+	BOOST_REQUIRE( ! violations.empty() );
+	BOOST_CHECK( violations[0].getType() == RealtimeViolation::Type::ALLOCATION );
+	BOOST_CHECK_EQUAL( violations[0].getNodeName(), "HistoryRecorder" );
+	BOOST_CHECK( ! violations[0].getBacktrace().empty() );
+}
+
+#if defined( __GLIBC__ )
+
+#include <malloc.h>
+
+BOOST_AUTO_TEST_CASE( test_realtime_check_aligned_allocations )
+{
+	RealtimeCheck::clearViolations();
+
+	{
+		CI_AUDIO_REALTIME_SCOPE();
+
+		void *ptr = nullptr;
+		BOOST_CHECK_EQUAL( posix_memalign( &ptr, 64, 100 ), 0 );
+		free( ptr );
+		free( memalign( 64, 100 ) );
+		free( aligned_alloc( 64, 128 ) );
+	}
+
+	// each allocation and its deallocation are reported
+	auto violations = RealtimeCheck::getViolations();
+	BOOST_REQUIRE_EQUAL( violations.size(), 6 );
+	for( size_t i = 0; i < violations.size(); i++ )
+		BOOST_CHECK( violations[i].getType() == ( i % 2 ? RealtimeViolation::Type::DEALLOCATION : RealtimeViolation::Type::ALLOCATION ) );
+}
+
+#endif // defined( __GLIBC__ )
+
+#endif // defined( CI_AUDIO_ENABLE_REALTIME_CHECKS )
+
+BOOST_AUTO_TEST_CASE( test_disconnect_after_context_destroyed )
+{
+	auto ctx = std::make_shared<ContextOffline>( 44100, 32, 1 );
+	auto counter = makeFrameCounter( ctx );
+	auto gain = ctx->makeNode( new Gain( 0.5f ) );
+	counter >> gain;
+
+	// Nodes can outlive their Context, after which disconnecting them does nothing.
+	ctx.reset();
+	BOOST_CHECK( ! gain->getContext() );
+	gain->disconnectAllInputs();
+}
+
+BOOST_AUTO_TEST_CASE( test_hardware_nodes_unsupported )
+{
+	auto ctx = std::make_shared<ContextOffline>();
+	BOOST_CHECK_THROW( ctx->createLineOut( DeviceRef() ), AudioContextExc );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,227 @@
+#pragma once
+
+#include "cinder/audio2/ContextOffline.h"
+#include "cinder/audio2/Convolver.h"
+#include "cinder/audio2/SamplePlayer.h"
+#include "cinder/audio2/dsp/PartitionedConvolver.h"
+#include "utils.h"
+
+BOOST_AUTO_TEST_SUITE( test_convolver )
+
+using namespace ci;
+using namespace ci::audio2;
+
+// Returns a decaying random impulse response, quiet enough that convolving random input stays well below NodeOutput's clip detection threshold.
+BufferRef makeImpulseResponse( size_t numFrames, size_t numChannels )
+{
+	auto result = std::make_shared<Buffer>( numFrames, numChannels );
+	fillRandom( result.get() );
+	for( size_t ch = 0; ch < numChannels; ch++ ) {
+		for( size_t i = 0; i < numFrames; i++ )
+			result->getChannel( ch )[i] *= 0.05f * ( 1.0f - float( i ) / float( numFrames ) );
+	}
+
+	return result;
+}
+
+// Returns \a input convolved with \a impulseResponse by direct summation and delayed by \a latencyFrames, routing channels as dsp::PartitionedConvolver does.
+Buffer convolveDirect( const Buffer &input, const Buffer &impulseResponse, size_t latencyFrames )
+{
+	const size_t numChannels = input.getNumChannels();
+	const size_t numImpulseChannels = impulseResponse.getNumChannels();
+	const bool isTrueMultichannel = numChannels > 1 && numImpulseChannels == numChannels * numChannels;
+
+	Buffer result( input.getNumFrames(), numChannels );
+	for( size_t output = 0; output < numChannels; output++ ) {
+		for( size_t frame = latencyFrames; frame < input.getNumFrames(); frame++ ) {
+			double sum = 0;
+			for( size_t inputCh = 0; inputCh < numChannels; inputCh++ ) {
+				if( ! isTrueMultichannel && inputCh != output )
+					continue;
+
+				const float *x = input.getChannel( inputCh );
+				const float *h = impulseResponse.getChannel( isTrueMultichannel ? inputCh * numChannels + output : output % numImpulseChannels );
+				const size_t n = frame - latencyFrames;
+				for( size_t k = 0; k <= n && k < impulseResponse.getNumFrames(); k++ )
+					sum += double( x[n - k] ) * double( h[k] );
+			}
+
+			result.getChannel( output )[frame] = float( sum );
+		}
+	}
+
+	return result;
+}
+
+// Processes \a input in blocks of \a blockFrames into \a output, calling \a afterBlock with the index of each block once it is processed.
+void processInBlocks( dsp::PartitionedConvolver *convolver, const Buffer &input, Buffer *output, size_t blockFrames, const std::function<void( size_t )> &afterBlock = nullptr )
+{
+	Buffer block( blockFrames, input.getNumChannels() );
+	for( size_t frame = 0, i = 0; frame < input.getNumFrames(); frame += blockFrames, i++ ) {
+		block.copyOffset( input, blockFrames, 0, frame );
+		convolver->process( &block, &block );
+		output->copyOffset( block, blockFrames, frame, 0 );
+
+		if( afterBlock )
+			afterBlock( i );
+	}
+}
+
+BOOST_AUTO_TEST_CASE( test_partitioned_matches_direct )
+{
+	auto impulseResponse = makeImpulseResponse( 700, 1 );
+	Buffer input( 2400 );
+	fillRandom( &input );
+
+	// block sizes that don't match the partition size are buffered, without changing the latency.
+	const size_t sizes[][3] = { { 32, 0, 32 }, { 32, 0, 20 }, { 32, 64, 32 }, { 32, 128, 48 }, { 30, 0, 30 }, { 30, 60, 30 } };
+	for( const auto &size : sizes ) {
+		const size_t partitionSize = size[0], tailPartitionSize = size[1], blockFrames = size[2];
+		auto partitioned = std::make_shared<dsp::ImpulseResponse>( *impulseResponse, partitionSize, tailPartitionSize );
+		dsp::PartitionedConvolver convolver( partitioned, 1 );
+		BOOST_CHECK_EQUAL( convolver.hasTail(), tailPartitionSize != 0 );
+		BOOST_CHECK_EQUAL( convolver.getLatencyFrames(), partitionSize );
+
+		Buffer output( input.getNumFrames() );
+		processInBlocks( &convolver, input, &output, blockFrames );
+
+		Buffer expected = convolveDirect( input, *impulseResponse, partitionSize );
+		float maxErr = maxError( expected, output );
+		BOOST_CHECK_MESSAGE( maxErr < 0.0001f, "partition size: " << partitionSize << ", tail partition size: " << tailPartitionSize << ", block frames: " << blockFrames << ", max error: " << maxErr );
+	}
+}
+
+BOOST_AUTO_TEST_CASE( test_partitioned_multichannel )
+{
+	Buffer input( 1280, 2 );
+	fillRandom( &input );
+
+	// a true stereo impulse response mixes both channels into each, a stereo one convolves each channel separately.
+	for( size_t numImpulseChannels : { 4, 2, 1 } ) {
+		auto impulseResponse = makeImpulseResponse( 300, numImpulseChannels );
+		dsp::PartitionedConvolver convolver( std::make_shared<dsp::ImpulseResponse>( *impulseResponse, 32, 64 ), 2 );
+
+		Buffer output( input.getNumFrames(), 2 );
+		processInBlocks( &convolver, input, &output, 32 );
+
+		float maxErr = maxError( convolveDirect( input, *impulseResponse, 32 ), output );
+		BOOST_CHECK_MESSAGE( maxErr < 0.0001f, "impulse response channels: " << numImpulseChannels << ", max error: " << maxErr );
+	}
+}
+
+BOOST_AUTO_TEST_CASE( test_partitioned_async_tail )
+{
+	auto impulseResponse = makeImpulseResponse( 700, 1 );
+	auto partitioned = std::make_shared<dsp::ImpulseResponse>( *impulseResponse, 32, 64 );
+	Buffer input( 2400 );
+	fillRandom( &input );
+	Buffer expected = convolveDirect( input, *impulseResponse, 32 );
+
+	// the tail is only processed when asked to, here after each block as a background thread would.
+	dsp::PartitionedConvolver convolver( partitioned, 1, true );
+	BOOST_CHECK( convolver.isTailAsync() );
+
+	Buffer output( input.getNumFrames() );
+	processInBlocks( &convolver, input, &output, 32, [&] ( size_t block ) {
+		if( convolver.isTailPending() )
+			convolver.processTail();
+	} );
+
+	BOOST_CHECK_LT( maxError( expected, output ), 0.0001f );
+	BOOST_CHECK_EQUAL( convolver.getNumTailUnderruns(), 0 );
+
+	// when the tail falls behind, it is left out until it catches up, after which it is aligned with the head again.
+	dsp::PartitionedConvolver lateConvolver( partitioned, 1, true );
+	processInBlocks( &lateConvolver, input, &output, 32, [&] ( size_t block ) {
+		if( ( block < 10 || block >= 14 ) && lateConvolver.isTailPending() )
+			lateConvolver.processTail();
+	} );
+
+	BOOST_CHECK_GT( lateConvolver.getNumTailUnderruns(), 0 );
+	float maxErr = 0;
+	for( size_t i = 1200; i < output.getNumFrames(); i++ )
+		maxErr = std::max( maxErr, std::fabs( output[i] - expected[i] ) );
+	BOOST_CHECK_LT( maxErr, 0.0001f );
+}
+
+BOOST_AUTO_TEST_CASE( test_partitioned_async_tail_restarts )
+{
+	auto impulseResponse = makeImpulseResponse( 2000, 1 );
+	auto partitioned = std::make_shared<dsp::ImpulseResponse>( *impulseResponse, 64, 256 );
+	Buffer input( 64 * 200 );
+	fillRandom( &input );
+	Buffer expected = convolveDirect( input, *impulseResponse, 64 );
+
+	// a stall of 40 blocks overflows the tail's input, so the tail starts over from there as if the earlier input had been silent. It is exact again once
+	// the input since then covers the impulse response, and doesn't fall behind anymore.
+	dsp::PartitionedConvolver convolver( partitioned, 1, true );
+	uint64_t underrunsAfterStall = 0;
+	Buffer output( input.getNumFrames() );
+	processInBlocks( &convolver, input, &output, 64, [&] ( size_t block ) {
+		if( ( block < 20 || block >= 60 ) && convolver.isTailPending() )
+			convolver.processTail();
+		if( block == 70 )
+			underrunsAfterStall = convolver.getNumTailUnderruns();
+	} );
+
+	BOOST_CHECK_GT( underrunsAfterStall, 0 );
+	BOOST_CHECK_EQUAL( convolver.getNumTailUnderruns(), underrunsAfterStall );
+
+	float maxErr = 0;
+	for( size_t i = 64 * 70 + 2000 + 64; i < output.getNumFrames(); i++ )
+		maxErr = std::max( maxErr, std::fabs( output[i] - expected[i] ) );
+	BOOST_CHECK_LT( maxErr, 0.0001f );
+}
+
+BOOST_AUTO_TEST_CASE( test_convolver_node )
+{
+	auto impulseResponse = makeImpulseResponse( 700, 1 );
+	auto input = std::make_shared<Buffer>( 2400 );
+	fillRandom( input.get() );
+	Buffer expected = convolveDirect( *input, *impulseResponse, 32 );
+
+	// with an offline Context, the tail partitions are processed on the rendering thread.
+	for( size_t tailPartitionFrames : { 0, 64 } ) {
+		auto ctx = std::make_shared<ContextOffline>( 44100, 32, 1 );
+		auto player = ctx->makeNode( new BufferPlayer( input ) );
+		auto convolver = ctx->makeNode( new Convolver( impulseResponse ) );
+		convolver->setTailPartitionFrames( tailPartitionFrames );
+		player >> convolver >> ctx->getOutput();
+		player->start();
+
+		Buffer output( input->getNumFrames() );
+		ctx->render( &output );
+
+		BOOST_CHECK_EQUAL( convolver->getLatencyFrames(), 32 );
+		BOOST_CHECK_CLOSE( convolver->getTailSeconds(), ( 700 + 32 ) / 44100.0, 0.0001 );
+		float maxErr = maxError( expected, output );
+		BOOST_CHECK_MESSAGE( maxErr < 0.0001f, "tail partition frames: " << tailPartitionFrames << ", max error: " << maxErr );
+	}
+}
+
+BOOST_AUTO_TEST_CASE( test_convolver_shares_impulse_responses )
+{
+	const size_t numCached = Convolver::getNumCachedImpulseResponses();
+
+	auto ctx = std::make_shared<ContextOffline>( 44100, 32, 1 );
+	auto impulseResponse = makeImpulseResponse( 100, 1 );
+	auto convolverA = ctx->makeNode( new Convolver( impulseResponse ) );
+	auto convolverB = ctx->makeNode( new Convolver( impulseResponse ) );
+	convolverA >> ctx->getOutput();
+	convolverB >> ctx->getOutput();
+
+	Buffer output( 64 );
+	ctx->render( &output );
+	BOOST_CHECK_EQUAL( Convolver::getNumCachedImpulseResponses(), numCached + 1 );
+
+	// replacing the impulse response while rendering, the previous one is released once neither Convolver uses it.
+	convolverA->setImpulseResponse( makeImpulseResponse( 100, 1 ) );
+	ctx->render( &output );
+	BOOST_CHECK_EQUAL( Convolver::getNumCachedImpulseResponses(), numCached + 2 );
+
+	convolverB->setImpulseResponse( convolverA->getImpulseResponse() );
+	ctx->render( &output );
+	BOOST_CHECK_EQUAL( Convolver::getNumCachedImpulseResponses(), numCached + 1 );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
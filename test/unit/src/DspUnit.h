@@ -0,0 +1,242 @@
+#pragma once
+
+#include "cinder/audio2/Buffer.h"
+#include "cinder/audio2/dsp/Dsp.h"
+#include "cinder/audio2/dsp/BiquadBank.h"
+#include "utils.h"
+
+BOOST_AUTO_TEST_SUITE( test_dsp )
+
+using namespace ci;
+using namespace ci::audio2;
+
+// Renders every dispatched dsp function into \a result (one channel each), reading from \a source starting \a offset frames in so that
+// the unaligned head and tail of each kernel are exercised.
+void renderDspFunctions( const Buffer &source, size_t offset, size_t length, Buffer *result )
+{
+	const float *a = source.getChannel( 0 ) + offset;
+	const float *b = source.getChannel( 1 ) + offset;
+
+	result->zero();
+	dsp::fill( 0.5f, result->getChannel( 0 ) + offset, length );
+	dsp::add( a, 0.3f, result->getChannel( 1 ) + offset, length );
+	dsp::add( a, b, result->getChannel( 2 ) + offset, length );
+	dsp::sub( a, 0.3f, result->getChannel( 3 ) + offset, length );
+	dsp::sub( a, b, result->getChannel( 4 ) + offset, length );
+	dsp::mul( a, 0.3f, result->getChannel( 5 ) + offset, length );
+	dsp::mul( a, b, result->getChannel( 6 ) + offset, length );
+	dsp::addMul( a, b, 0.3f, result->getChannel( 7 ) + offset, length );
+	dsp::mulAdd( a, 0.3f, 0.7f, result->getChannel( 8 ) + offset, length );
+
+	float *real = result->getChannel( 11 ) + offset;
+	float *imag = result->getChannel( 12 ) + offset;
+	std::copy( b, b + length, real );
+	std::copy( a, a + length, imag );
+	dsp::mulAddComplex( a, b, b, a, real, imag, length );
+
+	float *reductions = result->getChannel( 9 );
+	reductions[0] = dsp::sum( a, length );
+	reductions[1] = length ? dsp::rms( a, length ) : 0;
+
+	float *normalized = result->getChannel( 10 ) + offset;
+	std::copy( a, a + length, normalized );
+	dsp::normalize( normalized, length );
+}
+
+BOOST_AUTO_TEST_CASE( test_simd_instruction_sets )
+{
+	const dsp::SimdInstructionSet detected = dsp::getSimdInstructionSet();
+	BOOST_CHECK( dsp::isSimdInstructionSetSupported( detected ) );
+	BOOST_CHECK( dsp::isSimdInstructionSetSupported( dsp::SIMD_NONE ) );
+
+	Buffer source( 80, 2 );
+	fillRandom( &source );
+
+	Buffer expected( 80, 13 ), result( 80, 13 );
+	const dsp::SimdInstructionSet instructionSets[] = { dsp::SIMD_SSE2, dsp::SIMD_AVX2, dsp::SIMD_AVX512, dsp::SIMD_NEON };
+	for( dsp::SimdInstructionSet instructionSet : instructionSets ) {
+		if( ! dsp::isSimdInstructionSetSupported( instructionSet ) )
+			continue;
+
+		for( size_t offset = 0; offset < 4; offset++ ) {
+			for( size_t length = 0; length <= 70; length += 7 ) {
+				dsp::setSimdInstructionSet( dsp::SIMD_NONE );
+				renderDspFunctions( source, offset, length, &expected );
+
+				BOOST_REQUIRE( dsp::setSimdInstructionSet( instructionSet ) );
+				renderDspFunctions( source, offset, length, &result );
+
+				// element-wise functions round exactly as scalar code does, only reductions are summed in a different order.
+				float maxErr = 0, maxReductionErr = 0;
+				for( size_t ch = 0; ch < expected.getNumChannels(); ch++ ) {
+					for( size_t i = 0; i < expected.getNumFrames(); i++ ) {
+						const float err = fabsf( expected.getChannel( ch )[i] - result.getChannel( ch )[i] );
+						if( ch == 9 )
+							maxReductionErr = std::max( maxReductionErr, err );
+						else
+							maxErr = std::max( maxErr, err );
+					}
+				}
+				BOOST_CHECK_MESSAGE( maxErr == 0, dsp::simdInstructionSetToString( instructionSet ) << ", offset: " << offset << ", length: " << length << ", max error: " << maxErr );
+				BOOST_CHECK_MESSAGE( maxReductionErr < 0.00001f, dsp::simdInstructionSetToString( instructionSet ) << ", offset: " << offset << ", length: " << length << ", max reduction error: " << maxReductionErr );
+			}
+		}
+	}
+
+	BOOST_CHECK( dsp::setSimdInstructionSet( detected ) );
+}
+
+// Sets filter i of \a bank and \a biquads[i] to a different lowpass or highpass filter.
+void setBiquadBankFilters( dsp::BiquadBank *bank, std::vector<dsp::Biquad> *biquads )
+{
+	for( size_t i = 0; i < bank->getNumFilters(); i++ ) {
+		double frequency = 0.01 + 0.04 * ( i % 20 );
+		if( i % 2 )
+			(*biquads)[i].setHighpassParams( frequency, 3 );
+		else
+			(*biquads)[i].setLowpassParams( frequency, 6 );
+
+		bank->setCoefficients( i, (*biquads)[i] );
+	}
+}
+
+// The filters are processed in two blocks, which aren't a multiple of any vector width, and compared against dsp::Biquad. 37 filters fill two
+// AVX-512 vectors and leave some lanes for the narrower instruction sets.
+BOOST_AUTO_TEST_CASE( test_biquad_bank )
+{
+	const dsp::SimdInstructionSet detected = dsp::getSimdInstructionSet();
+	const size_t numFilters = 37;
+
+	Buffer source( 400, numFilters );
+	fillRandom( &source );
+
+	const dsp::SimdInstructionSet instructionSets[] = { dsp::SIMD_NONE, dsp::SIMD_SSE2, dsp::SIMD_AVX2, dsp::SIMD_AVX512, dsp::SIMD_NEON };
+	const dsp::BiquadBank::Precision precisions[] = { dsp::BiquadBank::DOUBLE, dsp::BiquadBank::FLOAT };
+	for( dsp::SimdInstructionSet instructionSet : instructionSets ) {
+		if( ! dsp::isSimdInstructionSetSupported( instructionSet ) )
+			continue;
+
+		BOOST_REQUIRE( dsp::setSimdInstructionSet( instructionSet ) );
+		for( dsp::BiquadBank::Precision precision : precisions ) {
+			dsp::BiquadBank bank( numFilters, precision );
+			std::vector<dsp::Biquad> biquads( numFilters );
+			setBiquadBankFilters( &bank, &biquads );
+
+			Buffer expected( source.getNumFrames(), numFilters ), result( source.getNumFrames(), numFilters );
+			for( size_t ch = 0; ch < numFilters; ch++ )
+				biquads[ch].process( source.getChannel( ch ), expected.getChannel( ch ), source.getNumFrames() );
+
+			const size_t firstBlockFrames = 100;
+			std::vector<const float *> sources;
+			std::vector<float *> dests;
+			for( size_t ch = 0; ch < numFilters; ch++ ) {
+				sources.push_back( source.getChannel( ch ) );
+				dests.push_back( result.getChannel( ch ) );
+			}
+			bank.process( sources.data(), dests.data(), firstBlockFrames );
+
+			for( size_t ch = 0; ch < numFilters; ch++ ) {
+				sources[ch] += firstBlockFrames;
+				dests[ch] += firstBlockFrames;
+			}
+			bank.process( sources.data(), dests.data(), source.getNumFrames() - firstBlockFrames );
+
+			float maxErr = maxError( expected, result );
+			float tolerance = precision == dsp::BiquadBank::DOUBLE ? 0.00001f : 0.001f;
+			BOOST_CHECK_MESSAGE( maxErr < tolerance, dsp::simdInstructionSetToString( instructionSet ) << ", precision: " << precision << ", max error: " << maxErr );
+		}
+	}
+
+	BOOST_CHECK( dsp::setSimdInstructionSet( detected ) );
+}
+
+// Switching precision keeps the filter state, and the same source can be passed for every filter.
+BOOST_AUTO_TEST_CASE( test_biquad_bank_precision_switch )
+{
+	const size_t numFilters = 5, numFrames = 256;
+
+	Buffer source( numFrames, 1 );
+	fillRandom( &source );
+
+	dsp::BiquadBank bank( numFilters );
+	std::vector<dsp::Biquad> biquads( numFilters );
+	setBiquadBankFilters( &bank, &biquads );
+
+	Buffer expected( numFrames, numFilters ), result( numFrames, numFilters );
+	std::vector<const float *> sources( numFilters, source.getData() );
+	std::vector<float *> dests;
+	for( size_t ch = 0; ch < numFilters; ch++ ) {
+		biquads[ch].process( source.getData(), expected.getChannel( ch ), numFrames );
+		dests.push_back( result.getChannel( ch ) );
+	}
+
+	for( size_t frame = 0; frame < numFrames; frame += 64 ) {
+		bank.setPrecision( ( frame / 64 ) % 2 ? dsp::BiquadBank::FLOAT : dsp::BiquadBank::DOUBLE );
+		bank.process( sources.data(), dests.data(), 64 );
+
+		for( size_t ch = 0; ch < numFilters; ch++ ) {
+			sources[ch] += 64;
+			dests[ch] += 64;
+		}
+	}
+
+	float maxErr = maxError( expected, result );
+	BOOST_CHECK_MESSAGE( maxErr < 0.001f, "max error: " << maxErr );
+
+	// after a reset, the output only depends on new input. Buffers are filtered in place.
+	bank.reset();
+	bank.setPrecision( dsp::BiquadBank::DOUBLE );
+	for( size_t ch = 0; ch < numFilters; ch++ ) {
+		biquads[ch].reset();
+		biquads[ch].process( source.getData(), expected.getChannel( ch ), numFrames );
+		std::copy( source.getData(), source.getData() + numFrames, result.getChannel( ch ) );
+	}
+	bank.process( &result, &result );
+
+	maxErr = maxError( expected, result );
+	BOOST_CHECK_MESSAGE( maxErr < 0.00001f, "max error after reset: " << maxErr );
+}
+
+// A filter can continue from where one in another bank left off, in either precision.
+BOOST_AUTO_TEST_CASE( test_biquad_bank_state )
+{
+	const size_t numFilters = 5, numFrames = 256, firstBlockFrames = 100;
+
+	Buffer source( numFrames, numFilters );
+	fillRandom( &source );
+
+	const dsp::BiquadBank::Precision precisions[] = { dsp::BiquadBank::DOUBLE, dsp::BiquadBank::FLOAT };
+	for( dsp::BiquadBank::Precision precision : precisions ) {
+		dsp::BiquadBank first( numFilters, precision ), second( numFilters, precision );
+		std::vector<dsp::Biquad> biquads( numFilters );
+		setBiquadBankFilters( &first, &biquads );
+		setBiquadBankFilters( &second, &biquads );
+
+		Buffer expected( numFrames, numFilters ), result( numFrames, numFilters );
+		std::vector<const float *> sources;
+		std::vector<float *> dests;
+		for( size_t ch = 0; ch < numFilters; ch++ ) {
+			biquads[ch].process( source.getChannel( ch ), expected.getChannel( ch ), numFrames );
+			sources.push_back( source.getChannel( ch ) );
+			dests.push_back( result.getChannel( ch ) );
+		}
+
+		first.process( sources.data(), dests.data(), firstBlockFrames );
+
+		for( size_t ch = 0; ch < numFilters; ch++ ) {
+			double s1, s2;
+			first.getState( ch, &s1, &s2 );
+			second.setState( ch, s1, s2 );
+
+			sources[ch] += firstBlockFrames;
+			dests[ch] += firstBlockFrames;
+		}
+		second.process( sources.data(), dests.data(), numFrames - firstBlockFrames );
+
+		float maxErr = maxError( expected, result );
+		float tolerance = precision == dsp::BiquadBank::DOUBLE ? 0.00001f : 0.001f;
+		BOOST_CHECK_MESSAGE( maxErr < tolerance, "precision: " << precision << ", max error: " << maxErr );
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -2,6 +2,7 @@
 
 #include "utils.h"
 #include "cinder/audio2/dsp/Fft.h"
+#include "cinder/audio2/Exception.h"
 
 #include <iostream>
 
@@ -48,4 +49,140 @@ BOOST_AUTO_TEST_CASE( test_round_trip )
 		computeRoundTrip( 2 << i );
 }
 
+BOOST_AUTO_TEST_CASE( test_round_trip_mixed_radix )
+{
+	const size_t sizes[] = { 6, 10, 12, 30, 90, 250, 480, 960, 1920, 3000, 7680 };
+	for( size_t sizeFft : sizes )
+		computeRoundTrip( sizeFft );
+}
+
+BOOST_AUTO_TEST_CASE( test_supported_sizes )
+{
+	BOOST_CHECK( dsp::Fft::isSizeSupported( 2 ) );
+	BOOST_CHECK( dsp::Fft::isSizeSupported( 480 ) );
+	BOOST_CHECK( dsp::Fft::isSizeSupported( 960 ) );
+	BOOST_CHECK( dsp::Fft::isSizeSupported( 4096 ) );
+
+	BOOST_CHECK( ! dsp::Fft::isSizeSupported( 0 ) );
+	BOOST_CHECK( ! dsp::Fft::isSizeSupported( 15 ) );
+	BOOST_CHECK( ! dsp::Fft::isSizeSupported( 14 ) );
+	BOOST_CHECK( ! dsp::Fft::isSizeSupported( 882 ) );
+
+	BOOST_CHECK_EQUAL( dsp::Fft::getNextSupportedSize( 0 ), 2 );
+	BOOST_CHECK_EQUAL( dsp::Fft::getNextSupportedSize( 480 ), 480 );
+	BOOST_CHECK_EQUAL( dsp::Fft::getNextSupportedSize( 882 ), 900 );
+	BOOST_CHECK_EQUAL( dsp::Fft::getNextSupportedSize( 1023 ), 1024 );
+
+	BOOST_CHECK_THROW( dsp::Fft fft( 14 ), AudioExc );
+}
+
+// Compares against a DFT computed in double precision, in the same format as Fft: real[0] is DC and imag[0] is nyquist. With vDSP
+// everything is scaled by 2, otherwise the imaginary parts are negated.
+BOOST_AUTO_TEST_CASE( test_against_dft )
+{
+#if defined( CINDER_AUDIO_VDSP )
+	const double scale = 2, imagSign = 1;
+#else
+	const double scale = 1, imagSign = -1;
+#endif
+
+	const size_t sizes[] = { 2, 4, 8, 16, 32, 64, 128, 256, 512, 1024, 6, 10, 12, 18, 30, 60, 90, 120, 250, 480, 960 };
+	const dsp::SimdInstructionSet detected = dsp::getSimdInstructionSet();
+	const dsp::SimdInstructionSet instructionSets[] = { dsp::SIMD_NONE, dsp::SIMD_SSE2, dsp::SIMD_AVX2, dsp::SIMD_AVX512, dsp::SIMD_NEON };
+
+	for( dsp::SimdInstructionSet instructionSet : instructionSets ) {
+		if( ! dsp::setSimdInstructionSet( instructionSet ) )
+			continue;
+
+		for( size_t sizeFft : sizes ) {
+			dsp::Fft fft( sizeFft );
+			Buffer waveform( sizeFft );
+			BufferSpectral spectral( sizeFft );
+
+			fillRandom( &waveform );
+			fft.forward( &waveform, &spectral );
+
+			BufferSpectral expected( sizeFft );
+			for( size_t k = 0; k <= sizeFft / 2; k++ ) {
+				double re = 0, im = 0;
+				for( size_t j = 0; j < sizeFft; j++ ) {
+					double phase = 2 * M_PI * double( ( j * k ) % sizeFft ) / double( sizeFft );
+					re += waveform[j] * cos( phase );
+					im -= waveform[j] * sin( phase );
+				}
+
+				if( k == sizeFft / 2 )
+					expected.getImag()[0] = float( scale * re );
+				else {
+					expected.getReal()[k] = float( scale * re );
+					if( k )
+						expected.getImag()[k] = float( scale * imagSign * im );
+				}
+			}
+
+			// the error grows with the magnitude of the bins, which is on the order of sqrt( sizeFft )
+			float maxErr = maxError( spectral, expected );
+			BOOST_CHECK_MESSAGE( maxErr < 0.00001f * float( scale ) * sqrt( float( sizeFft ) ), dsp::simdInstructionSetToString( instructionSet ) << ", sizeFft: " << sizeFft << ", max error: " << maxErr );
+		}
+	}
+
+	dsp::setSimdInstructionSet( detected );
+}
+
+BOOST_AUTO_TEST_CASE( test_batch_and_multichannel )
+{
+	const size_t sizeFft = 512;
+	const size_t numChannels = 3;
+
+	dsp::Fft fft( sizeFft );
+	Buffer waveform( sizeFft, numChannels );
+	fillRandom( &waveform );
+
+	// each channel transformed on its own
+	Buffer channel( sizeFft );
+	std::vector<BufferSpectral> expected( numChannels, BufferSpectral( sizeFft ) );
+	for( size_t ch = 0; ch < numChannels; ch++ ) {
+		std::copy( waveform.getChannel( ch ), waveform.getChannel( ch ) + sizeFft, channel.getData() );
+		fft.forward( &channel, &expected[ch] );
+	}
+
+	std::vector<BufferSpectral> spectra;
+	fft.forwardMultichannel( &waveform, &spectra );
+	BOOST_REQUIRE_EQUAL( spectra.size(), numChannels );
+
+	Buffer batchSpectra( sizeFft, numChannels );
+	fft.forwardBatch( waveform.getData(), batchSpectra.getData(), numChannels );
+
+	for( size_t ch = 0; ch < numChannels; ch++ ) {
+		BOOST_CHECK_EQUAL( maxError( spectra[ch], expected[ch] ), 0 );
+		BOOST_CHECK( std::equal( expected[ch].getData(), expected[ch].getData() + sizeFft, batchSpectra.getChannel( ch ) ) );
+	}
+
+	Buffer roundTrip( sizeFft, numChannels );
+	fft.inverseMultichannel( spectra, &roundTrip );
+	BOOST_CHECK( maxError( roundTrip, waveform ) < ACCEPTABLE_FLOAT_ERROR );
+
+	roundTrip.zero();
+	fft.inverseBatch( batchSpectra.getData(), roundTrip.getData(), numChannels );
+	BOOST_CHECK( maxError( roundTrip, waveform ) < ACCEPTABLE_FLOAT_ERROR );
+}
+
+BOOST_AUTO_TEST_CASE( test_plan_cache )
+{
+	const size_t numPlans = dsp::Fft::getNumCachedPlans();
+	{
+		std::vector<std::unique_ptr<dsp::Fft> > ffts;
+		for( size_t i = 0; i < 64; i++ )
+			ffts.emplace_back( new dsp::Fft( 2048 ) );
+
+		BOOST_CHECK_EQUAL( dsp::Fft::getNumCachedPlans(), numPlans + 1 );
+
+		ffts.emplace_back( new dsp::Fft( 4096 ) );
+		BOOST_CHECK_EQUAL( dsp::Fft::getNumCachedPlans(), numPlans + 2 );
+	}
+
+	// plans are released along with the last Fft that uses them
+	BOOST_CHECK_EQUAL( dsp::Fft::getNumCachedPlans(), numPlans );
+}
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
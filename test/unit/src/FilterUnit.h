@@ -0,0 +1,182 @@
+#pragma once
+
+#include "cinder/audio2/ContextOffline.h"
+#include "cinder/audio2/Filter.h"
+#include "utils.h"
+
+BOOST_AUTO_TEST_SUITE( test_filter )
+
+using namespace ci;
+using namespace ci::audio2;
+
+const size_t FILTER_SAMPLE_RATE = 48000;
+
+// Outputs a sine at \a freq Hertz with an amplitude of 0.5.
+CallbackProcessorRef makeSine( const ContextRef &ctx, float freq )
+{
+	auto phase = std::make_shared<double>( 0 );
+	auto result = ctx->makeNode( new CallbackProcessor( [phase, freq] ( Buffer *buffer, size_t sampleRate ) {
+		for( size_t i = 0; i < buffer->getNumFrames(); i++ ) {
+			buffer->getData()[i] = 0.5f * float( sin( *phase ) );
+			*phase += 2 * M_PI * freq / sampleRate;
+		}
+	}, Node::Format().channels( 1 ) ) );
+
+	result->start();
+	return result;
+}
+
+// Returns the gain of \a filter at \a freq Hertz, measured over its steady state output once the transient has decayed.
+float measureGain( const FilterCascadeRef &filter, ContextOffline *ctx, float freq )
+{
+	makeSine( filter->getContext(), freq ) >> filter >> ctx->getOutput();
+	filter->start();
+
+	Buffer buffer( FILTER_SAMPLE_RATE / 10, 1 );
+	ctx->render( &buffer );
+	ctx->render( &buffer );
+
+	double sumSquares = 0;
+	for( size_t i = 0; i < buffer.getNumFrames(); i++ )
+		sumSquares += buffer[i] * buffer[i];
+
+	// the rms of the input is 0.5 / sqrt( 2 ).
+	return float( sqrt( sumSquares / buffer.getNumFrames() ) / ( 0.5 / sqrt( 2.0 ) ) );
+}
+
+// Returns the gain of a FilterCascade with one section of \a mode, measured at \a measureFreq.
+float measureSectionGain( FilterCascade::Mode mode, float freq, float q, float gain, float measureFreq )
+{
+	auto ctx = std::make_shared<ContextOffline>( FILTER_SAMPLE_RATE, 64, 1 );
+	auto filter = ctx->makeNode( new FilterCascade( 1 ) );
+	filter->setMode( 0, mode );
+	filter->getParamFreq( 0 )->setValue( freq );
+	filter->getParamQ( 0 )->setValue( q );
+	filter->getParamGain( 0 )->setValue( gain );
+
+	return measureGain( filter, ctx.get(), measureFreq );
+}
+
+BOOST_AUTO_TEST_CASE( test_cascade_section_modes )
+{
+	const float sixDb = std::pow( 10.0f, 6.0f / 20.0f );
+
+	// a Butterworth lowpass is -3 dB at its cutoff.
+	BOOST_CHECK_CLOSE( measureSectionGain( FilterBiquad::LOWPASS, 1000, 0.7071f, 0, 1000 ), 0.7071f, 1.0f );
+	BOOST_CHECK_CLOSE( measureSectionGain( FilterBiquad::LOWPASS, 1000, 0.7071f, 0, 50 ), 1.0f, 1.0f );
+	BOOST_CHECK_CLOSE( measureSectionGain( FilterBiquad::HIGHPASS, 1000, 0.7071f, 0, 1000 ), 0.7071f, 1.0f );
+	BOOST_CHECK_SMALL( measureSectionGain( FilterBiquad::HIGHPASS, 1000, 0.7071f, 0, 20 ), 0.001f );
+	BOOST_CHECK_CLOSE( measureSectionGain( FilterBiquad::BANDPASS, 1000, 2, 0, 1000 ), 1.0f, 1.0f );
+	BOOST_CHECK_SMALL( measureSectionGain( FilterBiquad::NOTCH, 1000, 2, 0, 1000 ), 0.01f );
+	BOOST_CHECK_CLOSE( measureSectionGain( FilterBiquad::ALLPASS, 1000, 2, 0, 3000 ), 1.0f, 1.0f );
+	BOOST_CHECK_CLOSE( measureSectionGain( FilterBiquad::PEAKING, 1000, 2, 6, 1000 ), sixDb, 1.0f );
+	BOOST_CHECK_CLOSE( measureSectionGain( FilterBiquad::PEAKING, 1000, 2, -6, 1000 ), 1 / sixDb, 1.0f );
+	BOOST_CHECK_CLOSE( measureSectionGain( FilterBiquad::LOWSHELF, 1000, 0.7071f, 6, 20 ), sixDb, 1.0f );
+	BOOST_CHECK_CLOSE( measureSectionGain( FilterBiquad::LOWSHELF, 1000, 0.7071f, -6, 20 ), 1 / sixDb, 1.0f );
+	BOOST_CHECK_CLOSE( measureSectionGain( FilterBiquad::HIGHSHELF, 1000, 0.7071f, 6, 20000 ), sixDb, 1.0f );
+	BOOST_CHECK_CLOSE( measureSectionGain( FilterBiquad::HIGHSHELF, 1000, 0.7071f, -6, 20000 ), 1 / sixDb, 1.0f );
+	BOOST_CHECK_CLOSE( measureSectionGain( FilterBiquad::CUSTOM, 1000, 0.7071f, 0, 5000 ), 1.0f, 1.0f );
+}
+
+BOOST_AUTO_TEST_CASE( test_cascade_sections_in_series )
+{
+	// two Butterworth lowpass sections are -6 dB at their cutoff, and four Q's of an 8th order Butterworth filter are -3 dB.
+	auto ctx = std::make_shared<ContextOffline>( FILTER_SAMPLE_RATE, 64, 1 );
+	auto filter = ctx->makeNode( new FilterCascade( 2 ) );
+	for( size_t i = 0; i < 2; i++ )
+		filter->getParamFreq( i )->setValue( 2000 );
+
+	BOOST_CHECK_EQUAL( filter->getNumSections(), 2 );
+	BOOST_CHECK_CLOSE( measureGain( filter, ctx.get(), 2000 ), 0.5f, 1.0f );
+	BOOST_CHECK_GT( filter->getTailSeconds(), 0 );
+	BOOST_CHECK_LT( filter->getTailSeconds(), 0.1 );
+
+	ctx = std::make_shared<ContextOffline>( FILTER_SAMPLE_RATE, 64, 1 );
+	filter = ctx->makeNode( new FilterCascade( 4 ) );
+	const float butterworthQs[] = { 0.5098f, 0.6013f, 0.9000f, 2.5629f };
+	for( size_t i = 0; i < 4; i++ ) {
+		filter->getParamFreq( i )->setValue( 2000 );
+		filter->getParamQ( i )->setValue( butterworthQs[i] );
+	}
+
+	BOOST_CHECK_CLOSE( measureGain( filter, ctx.get(), 2000 ), 0.7071f, 1.0f );
+}
+
+// Renders a sine through four sections, the third one swept, either as one FilterCascade or as a FilterCascade per section.
+Buffer renderSections( bool oneNode )
+{
+	// 100 frames per block leaves frames after the whole chunks that the constant sections are pipelined over.
+	auto ctx = std::make_shared<ContextOffline>( FILTER_SAMPLE_RATE, 100, 2 );
+	const float freqs[] = { 500, 2000, 1000, 4000 };
+	const FilterCascade::Mode modes[] = { FilterBiquad::LOWPASS, FilterBiquad::PEAKING, FilterBiquad::LOWPASS, FilterBiquad::HIGHSHELF };
+
+	std::vector<FilterCascadeRef> filters;
+	NodeRef node = makeSine( ctx, 1000 );
+	for( size_t i = 0; i < 4; i++ ) {
+		if( oneNode && i > 0 )
+			filters.push_back( filters.back() );
+		else {
+			filters.push_back( ctx->makeNode( new FilterCascade( oneNode ? 4 : 1, Node::Format().channels( 2 ) ) ) );
+			node = node >> filters.back();
+			filters.back()->start();
+		}
+
+		const size_t section = oneNode ? i : 0;
+		filters[i]->setMode( section, modes[i] );
+		filters[i]->getParamFreq( section )->setValue( freqs[i] );
+		filters[i]->getParamGain( section )->setValue( 6 );
+	}
+	node >> ctx->getOutput();
+
+	Buffer result( 1000, 2 );
+	filters[2]->getParamFreq( oneNode ? 2 : 0 )->applyRampFrames( 200, 8000, 500 );
+	ctx->render( &result );
+	return result;
+}
+
+BOOST_AUTO_TEST_CASE( test_cascade_constant_sections )
+{
+	// runs of constant sections are pipelined through one BiquadBank, which matches running each section on its own.
+	Buffer oneNode = renderSections( true );
+	Buffer nodePerSection = renderSections( false );
+
+	BOOST_CHECK_SMALL( maxError( oneNode, nodePerSection ), 0.00001f );
+}
+
+// Renders a sine through a lowpass section whose cutoff is ramped from 200 to 8000 Hz, with coefficients computed every \a subBlockFrames frames
+// and the cutoff evaluated at \a rate.
+Buffer renderSweep( size_t subBlockFrames, Param::Rate rate )
+{
+	auto ctx = std::make_shared<ContextOffline>( FILTER_SAMPLE_RATE, 64, 1 );
+	auto filter = ctx->makeNode( new FilterCascade( 1 ) );
+	filter->setSubBlockFrames( subBlockFrames );
+	filter->getParamQ( 0 )->setValue( 4 );
+	filter->getParamFreq( 0 )->setValue( 200 );
+	filter->getParamFreq( 0 )->setRate( rate, 16 );
+	makeSine( ctx, 1000 ) >> filter >> ctx->getOutput();
+	filter->start();
+
+	Buffer result( 4800, 1 );
+	filter->getParamFreq( 0 )->applyRampFrames( 200, 8000, result.getNumFrames() );
+	ctx->render( &result );
+	return result;
+}
+
+BOOST_AUTO_TEST_CASE( test_cascade_modulation )
+{
+	// coefficients interpolated over sub-blocks stay close to coefficients computed every frame, to within about 1% of the resonant peak.
+	Buffer exact = renderSweep( 1, Param::AUDIO_RATE );
+	Buffer interpolated = renderSweep( 32, Param::AUDIO_RATE );
+	Buffer controlRate = renderSweep( 32, Param::CONTROL_RATE );
+
+	BOOST_CHECK_SMALL( maxError( exact, interpolated ), 0.02f );
+	BOOST_CHECK_SMALL( maxError( exact, controlRate ), 0.02f );
+
+	// the sweep passes through the resonance at 1000 Hz, which boosts the sine by about Q.
+	float peak = 0;
+	for( size_t i = 0; i < exact.getNumFrames(); i++ )
+		peak = std::max( peak, std::fabs( exact[i] ) );
+	BOOST_CHECK_GT( peak, 1.0f );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "cinder/audio2/ContextOffline.h"
+#include "cinder/audio2/Gen.h"
+#include "cinder/audio2/dsp/NoiseGenerator.h"
+#include "cinder/audio2/dsp/DspSimd.h"
+#include "utils.h"
+
+BOOST_AUTO_TEST_SUITE( test_noise )
+
+using namespace ci;
+using namespace ci::audio2;
+
+// Returns the mean absolute difference between neighbouring samples, which is lower the more a noise is weighted towards low frequencies.
+float meanStep( const Buffer &buffer )
+{
+	double sum = 0;
+	for( size_t i = 1; i < buffer.getSize(); i++ )
+		sum += fabs( buffer[i] - buffer[i - 1] );
+
+	return float( sum / ( buffer.getSize() - 1 ) );
+}
+
+BOOST_AUTO_TEST_CASE( test_white_distribution )
+{
+	dsp::NoiseGenerator generator;
+	Buffer buffer( 1 << 16 );
+	generator.fillWhite( buffer.getData(), buffer.getSize() );
+
+	double sum = 0, sumSquares = 0;
+	for( size_t i = 0; i < buffer.getSize(); i++ ) {
+		BOOST_REQUIRE( buffer[i] >= -1 && buffer[i] < 1 );
+		sum += buffer[i];
+		sumSquares += buffer[i] * buffer[i];
+	}
+
+	BOOST_CHECK_SMALL( sum / buffer.getSize(), 0.01 );
+	BOOST_CHECK_CLOSE( sqrt( sumSquares / buffer.getSize() ), 1 / sqrt( 3.0 ), 1.0 );
+}
+
+BOOST_AUTO_TEST_CASE( test_white_reproducible )
+{
+	const size_t length = 1000;
+	const dsp::SimdInstructionSet detected = dsp::getSimdInstructionSet();
+	BOOST_REQUIRE( dsp::setSimdInstructionSet( dsp::SIMD_NONE ) );
+
+	Buffer expected( length );
+	dsp::NoiseGenerator generator( 7 );
+	generator.fillWhite( expected.getData(), length );
+
+	// the samples only depend on the seed, not on the instruction set or how they are split between calls
+	const dsp::SimdInstructionSet instructionSets[] = { dsp::SIMD_NONE, dsp::SIMD_SSE2, dsp::SIMD_AVX2, dsp::SIMD_AVX512, dsp::SIMD_NEON };
+	for( dsp::SimdInstructionSet instructionSet : instructionSets ) {
+		if( ! dsp::isSimdInstructionSetSupported( instructionSet ) )
+			continue;
+
+		BOOST_REQUIRE( dsp::setSimdInstructionSet( instructionSet ) );
+
+		Buffer split( length );
+		generator.setSeed( 7 );
+		for( size_t pos = 0, count = 1; pos < length; pos += count, count += 6 )
+			generator.fillWhite( split.getData() + pos, std::min( count, length - pos ) );
+
+		BOOST_CHECK_MESSAGE( maxError( expected, split ) == 0, dsp::simdInstructionSetToString( instructionSet ) << ", max error: " << maxError( expected, split ) );
+	}
+
+	BOOST_CHECK( dsp::setSimdInstructionSet( detected ) );
+
+	// other seeds, including neighbouring ones, give other samples
+	Buffer other( length );
+	dsp::NoiseGenerator otherGenerator( 8 );
+	otherGenerator.fillWhite( other.getData(), length );
+	BOOST_CHECK( maxError( expected, other ) > 1 );
+	BOOST_CHECK_EQUAL( otherGenerator.getSeed(), 8 );
+}
+
+BOOST_AUTO_TEST_CASE( test_colored )
+{
+	dsp::NoiseGenerator generator;
+	Buffer white( 1 << 16 ), pink( 1 << 16 ), brown( 1 << 16 );
+	generator.fillWhite( white.getData(), white.getSize() );
+	generator.fillPink( pink.getData(), pink.getSize() );
+	generator.fillBrown( brown.getData(), brown.getSize() );
+
+	for( size_t i = 0; i < white.getSize(); i++ ) {
+		BOOST_REQUIRE_SMALL( pink[i], 1.2f );
+		BOOST_REQUIRE_SMALL( brown[i], 1.2f );
+	}
+
+	// each is weighted further towards low frequencies than the last
+	BOOST_CHECK_LT( meanStep( pink ), meanStep( white ) * 0.5f );
+	BOOST_CHECK_LT( meanStep( brown ), meanStep( pink ) * 0.5f );
+	BOOST_CHECK_GT( meanStep( brown ), 0 );
+
+	// restarting from the same seed also clears the filters
+	Buffer pink2( pink.getSize() );
+	generator.setSeed( generator.getSeed() );
+	generator.fillWhite( pink2.getData(), pink2.getSize() );
+	generator.fillPink( pink2.getData(), pink2.getSize() );
+	BOOST_CHECK_EQUAL( maxError( pink, pink2 ), 0 );
+}
+
+BOOST_AUTO_TEST_CASE( test_gen_noise )
+{
+	auto render = [] ( GenNoise::Type type, uint32_t seed ) {
+		auto ctx = std::make_shared<ContextOffline>( 44100, 64, 1 );
+		auto noise = ctx->makeNode( new GenNoise( type ) );
+		noise >> ctx->getOutput();
+		noise->setSeed( seed );
+		noise->start();
+
+		Buffer buffer( 1000 );
+		ctx->render( &buffer );
+		return buffer;
+	};
+
+	BOOST_CHECK_EQUAL( maxError( render( GenNoise::BROWN, 3 ), render( GenNoise::BROWN, 3 ) ), 0 );
+	BOOST_CHECK( maxError( render( GenNoise::WHITE, 3 ), render( GenNoise::PINK, 3 ) ) > 0 );
+	BOOST_CHECK( maxError( render( GenNoise::WHITE, 3 ), render( GenNoise::WHITE, 4 ) ) > 0 );
+
+	// each GenNoise gets its own seed unless one is given
+	auto ctx = std::make_shared<ContextOffline>( 44100, 64, 1 );
+	auto noise = ctx->makeNode( new GenNoise );
+	auto noise2 = ctx->makeNode( new GenNoise );
+	BOOST_CHECK_NE( noise->getSeed(), noise2->getSeed() );
+	BOOST_CHECK_EQUAL( noise->getType(), GenNoise::WHITE );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
@@ -0,0 +1,330 @@
+#pragma once
+
+#include "cinder/audio2/ContextOffline.h"
+#include "cinder/audio2/Gen.h"
+#include "cinder/audio2/dsp/WaveTable.h"
+#include "cinder/audio2/dsp/Fft.h"
+#include "cinder/audio2/dsp/DspSimd.h"
+#include "cinder/audio2/dsp/Dsp.h"
+#include "cinder/audio2/Exception.h"
+#include "utils.h"
+
+BOOST_AUTO_TEST_SUITE( test_wavetable )
+
+using namespace ci;
+using namespace ci::audio2;
+
+// Exposes the table synthesis of WaveTable2d, so that filling a table from its spectrum can be compared to summing its partials directly.
+struct WaveTable2dTester : public dsp::WaveTable2d {
+	WaveTable2dTester( size_t tableSize ) : dsp::WaveTable2d( 44100, tableSize, 1 )	{}
+
+	void fillTable( WaveformType type, float *table, size_t numPartials, dsp::Fft *fft )
+	{
+		if( fft ) {
+			SpectralSynthesis spectral( fft );
+			fillBandLimitedTable( type, table, numPartials, &spectral );
+		}
+		else
+			fillBandLimitedTable( type, table, numPartials, nullptr );
+	}
+};
+
+BOOST_AUTO_TEST_CASE( test_bandlimited_spectral_synthesis )
+{
+	const size_t tableSize = 1024;
+	WaveTable2dTester tester( tableSize );
+	dsp::Fft fft( tableSize );
+
+	const WaveformType types[] = { WaveformType::SINE, WaveformType::SQUARE, WaveformType::SAWTOOTH, WaveformType::TRIANGLE };
+	const size_t partialCounts[] = { 1, 2, 7, 60 };
+
+	for( WaveformType type : types ) {
+		for( size_t numPartials : partialCounts ) {
+			Buffer sinesum( tableSize ), spectral( tableSize );
+			tester.fillTable( type, sinesum.getData(), numPartials, nullptr );
+			tester.fillTable( type, spectral.getData(), numPartials, &fft );
+
+			BOOST_CHECK_SMALL( maxError( sinesum, spectral ), 0.001f );
+		}
+	}
+
+	// the sine table must start at zero and rise, as it does when summed directly
+	Buffer sine( tableSize );
+	tester.fillTable( WaveformType::SINE, sine.getData(), 1, &fft );
+	for( size_t i = 0; i < tableSize; i++ )
+		BOOST_REQUIRE_SMALL( sine[i] - float( sin( 2 * M_PI * i / tableSize ) ), 0.0001f );
+}
+
+BOOST_AUTO_TEST_CASE( test_bandlimited_cache )
+{
+	const size_t numCached = dsp::WaveTable2d::getNumCachedBandlimited();
+
+	{
+		auto saw = dsp::WaveTable2d::getBandlimited( WaveformType::SAWTOOTH, 44100, 512, 8 );
+		auto saw2 = dsp::WaveTable2d::getBandlimited( WaveformType::SAWTOOTH, 44100, 512, 8 );
+		auto sawOtherRate = dsp::WaveTable2d::getBandlimited( WaveformType::SAWTOOTH, 48000, 512, 8 );
+		auto square = dsp::WaveTable2d::getBandlimited( WaveformType::SQUARE, 44100, 512, 8 );
+
+		// the shared tables can't be modified.
+		BOOST_STATIC_ASSERT(( std::is_const<decltype( saw )::element_type>::value ));
+
+		BOOST_CHECK( saw == saw2 );
+		BOOST_CHECK( saw != sawOtherRate );
+		BOOST_CHECK( saw != square );
+		BOOST_CHECK_EQUAL( dsp::WaveTable2d::getNumCachedBandlimited(), numCached + 3 );
+
+		// the shared tables are the same as ones filled separately
+		dsp::WaveTable2d expected( 44100, 512, 8 );
+		expected.fillBandlimited( WaveformType::SAWTOOTH );
+
+		Buffer a( 512 ), b( 512 );
+		for( size_t i = 0; i < 8; i++ ) {
+			saw->copyTo( a.getData(), i );
+			expected.copyTo( b.getData(), i );
+			BOOST_CHECK_SMALL( maxError( a, b ), ACCEPTABLE_FLOAT_ERROR );
+		}
+	}
+
+	// released once no one holds onto them
+	BOOST_CHECK_EQUAL( dsp::WaveTable2d::getNumCachedBandlimited(), numCached );
+}
+
+BOOST_AUTO_TEST_CASE( test_oscillators_share_tables )
+{
+	auto ctx = std::make_shared<ContextOffline>( 44100, 512, 1 );
+	auto osc1 = ctx->makeNode( new GenOscillator( 440, GenOscillator::Format().waveform( WaveformType::SAWTOOTH ) ) );
+	auto osc2 = ctx->makeNode( new GenOscillator( 220, GenOscillator::Format().waveform( WaveformType::SAWTOOTH ) ) );
+	auto osc3 = ctx->makeNode( new GenOscillator( 220, GenOscillator::Format().waveform( WaveformType::SQUARE ) ) );
+
+	ctx->initializeNode( osc1 );
+	ctx->initializeNode( osc2 );
+	ctx->initializeNode( osc3 );
+
+	BOOST_CHECK( osc1->getWaveTable() == osc2->getWaveTable() );
+	BOOST_CHECK( osc1->getWaveTable() != osc3->getWaveTable() );
+
+	osc3->setWaveform( WaveformType::SAWTOOTH );
+	BOOST_CHECK( osc1->getWaveTable() == osc3->getWaveTable() );
+}
+
+BOOST_AUTO_TEST_CASE( test_table_size_power_of_two )
+{
+	BOOST_CHECK_THROW( dsp::WaveTable( 44100, 1000 ), AudioExc );
+	BOOST_CHECK_THROW( dsp::WaveTable2d( 44100, 0, 8 ), AudioExc );
+
+	dsp::WaveTable2d table( 44100, 512, 8 );
+	BOOST_CHECK_THROW( table.resize( 768, 8 ), AudioExc );
+	BOOST_CHECK_THROW( table.WaveTable::resize( 100 ), AudioExc );
+	BOOST_CHECK_EQUAL( table.getTableSize(), 512 );
+
+	table.resize( 1024, 8 );
+	BOOST_CHECK_EQUAL( table.getTableSize(), 1024 );
+}
+
+BOOST_AUTO_TEST_CASE( test_lookup_sine )
+{
+	const size_t sampleRate = 44100;
+	const float freq = 441;
+	dsp::WaveTable table( sampleRate, 4096 );
+	table.fillSine();
+
+	const dsp::SimdInstructionSet detected = dsp::getSimdInstructionSet();
+	const dsp::SimdInstructionSet instructionSets[] = { dsp::SIMD_NONE, dsp::SIMD_SSE2, dsp::SIMD_AVX2, dsp::SIMD_AVX512, dsp::SIMD_NEON };
+	for( dsp::SimdInstructionSet instructionSet : instructionSets ) {
+		if( ! dsp::isSimdInstructionSetSupported( instructionSet ) )
+			continue;
+
+		BOOST_REQUIRE( dsp::setSimdInstructionSet( instructionSet ) );
+
+		// odd lengths, in two calls, so that the phase is carried over and the last samples are less than a vector
+		Buffer expected( 1001 ), constant( 1001 ), varying( 1001 );
+		for( size_t i = 0; i < expected.getSize(); i++ )
+			expected[i] = float( sin( 2 * M_PI * freq * i / sampleRate + 0.5 ) );
+
+		float phase = float( 0.5 / ( 2 * M_PI ) );
+		phase = table.lookup( constant.getData(), 517, phase, freq );
+		table.lookup( constant.getData() + 517, 484, phase, freq );
+
+		std::vector<float> freqs( 1001, freq );
+		phase = float( 0.5 / ( 2 * M_PI ) );
+		phase = table.lookup( varying.getData(), 517, phase, freqs.data() );
+		table.lookup( varying.getData() + 517, 484, phase, freqs.data() );
+
+		BOOST_CHECK_MESSAGE( maxError( expected, constant ) < 0.0001f, dsp::simdInstructionSetToString( instructionSet ) << ", max error: " << maxError( expected, constant ) );
+		BOOST_CHECK_MESSAGE( maxError( expected, varying ) < 0.0001f, dsp::simdInstructionSetToString( instructionSet ) << ", max error: " << maxError( expected, varying ) );
+	}
+
+	BOOST_CHECK( dsp::setSimdInstructionSet( detected ) );
+}
+
+// The tables are crossfaded by the same amount in every instruction set, and whether the frequency is constant or varying, as long as it is the same.
+BOOST_AUTO_TEST_CASE( test_lookup_bandlimited )
+{
+	auto table = dsp::WaveTable2d::getBandlimited( WaveformType::SAWTOOTH, 44100, 2048, 40 );
+	const float freqs[] = { 10, 261.6f, 1234.5f, 15000, -440 };
+
+	const dsp::SimdInstructionSet detected = dsp::getSimdInstructionSet();
+	BOOST_REQUIRE( dsp::setSimdInstructionSet( dsp::SIMD_NONE ) );
+
+	std::vector<Buffer> expected;
+	for( float freq : freqs ) {
+		expected.push_back( Buffer( 300 ) );
+		table->lookupBandlimited( expected.back().getData(), 300, 0.25f, freq );
+	}
+
+	const dsp::SimdInstructionSet instructionSets[] = { dsp::SIMD_NONE, dsp::SIMD_SSE2, dsp::SIMD_AVX2, dsp::SIMD_AVX512, dsp::SIMD_NEON };
+	for( dsp::SimdInstructionSet instructionSet : instructionSets ) {
+		if( ! dsp::isSimdInstructionSetSupported( instructionSet ) )
+			continue;
+
+		BOOST_REQUIRE( dsp::setSimdInstructionSet( instructionSet ) );
+
+		for( size_t f = 0; f < expected.size(); f++ ) {
+			Buffer constant( 300 ), varying( 300 );
+			std::vector<float> f0Array( 300, freqs[f] );
+			table->lookupBandlimited( constant.getData(), 300, 0.25f, freqs[f] );
+			table->lookupBandlimited( varying.getData(), 300, 0.25f, f0Array.data() );
+
+			BOOST_CHECK_MESSAGE( maxError( expected[f], constant ) < 0.00001f, dsp::simdInstructionSetToString( instructionSet ) << ", freq: " << freqs[f] );
+			BOOST_CHECK_MESSAGE( maxError( expected[f], varying ) < 0.00001f, dsp::simdInstructionSetToString( instructionSet ) << ", freq: " << freqs[f] );
+		}
+	}
+
+	BOOST_CHECK( dsp::setSimdInstructionSet( detected ) );
+
+	// sweeping through all of the tables stays within [-1:1]
+	Buffer sweep( 4410 );
+	std::vector<float> f0Array( sweep.getSize() );
+	for( size_t i = 0; i < f0Array.size(); i++ )
+		f0Array[i] = 20 + 20000 * float( i ) / f0Array.size();
+
+	table->lookupBandlimited( sweep.getData(), sweep.getSize(), 0, f0Array.data() );
+	for( size_t i = 0; i < sweep.getSize(); i++ )
+		BOOST_REQUIRE_SMALL( sweep[i], 1.01f );
+}
+
+// Each oscillator of the bank sounds like a single table lookup of the band-limited table it reads, scaled by its amplitude.
+BOOST_AUTO_TEST_CASE( test_bank_lookup )
+{
+	auto table = dsp::WaveTable2d::getBandlimited( WaveformType::SAWTOOTH, 44100, 2048, 40 );
+	const float freqs[] = { 55, 261.6f, 1234.5f, 9000, -440, 10900 };
+	const float amps[] = { 0.5f, 0.25f, 1, 0.1f, 0.3f, 0.2f };
+	const float phases[] = { 0, 0.25f, 0.5f, 0.1f, 0.9f, 0.3f };
+	const size_t numOscillators = 6;
+
+	const dsp::SimdInstructionSet detected = dsp::getSimdInstructionSet();
+	const dsp::SimdInstructionSet instructionSets[] = { dsp::SIMD_NONE, dsp::SIMD_SSE2, dsp::SIMD_AVX2, dsp::SIMD_AVX512, dsp::SIMD_NEON };
+	for( dsp::SimdInstructionSet instructionSet : instructionSets ) {
+		if( ! dsp::isSimdInstructionSetSupported( instructionSet ) )
+			continue;
+
+		BOOST_REQUIRE( dsp::setSimdInstructionSet( instructionSet ) );
+
+		dsp::WaveTableBank bank( numOscillators );
+		bank.setWaveTable( table );
+		for( size_t i = 0; i < numOscillators; i++ ) {
+			bank.setFreq( i, freqs[i] );
+			bank.setAmp( i, amps[i] );
+			bank.setPhase( i, phases[i] );
+		}
+
+		// ramp up to the amplitudes in a single sample
+		float first = 0;
+		bank.process( &first, 1 );
+
+		Buffer expected( 1001 ), result( 1001 );
+		for( size_t i = 0; i < numOscillators; i++ ) {
+			dsp::WaveTable single( 44100, 2048 );
+			const size_t tableIndex = std::min( size_t( ceilf( table->calcBandlimitedTableIndex( freqs[i] ) ) ), table->getNumTables() - 1 );
+			single.copyFrom( table->getTable( tableIndex ) );
+
+			Buffer oscillator( expected.getSize() );
+			single.lookup( oscillator.getData(), oscillator.getSize(), bank.getPhase( i ), freqs[i] );
+			dsp::mul( oscillator.getData(), amps[i], oscillator.getData(), oscillator.getSize() );
+			dsp::add( expected.getData(), oscillator.getData(), expected.getData(), expected.getSize() );
+		}
+
+		// odd lengths, in two calls, so that the phases are carried over and the last samples are less than a vector
+		bank.process( result.getData(), 517 );
+		bank.process( result.getData() + 517, 484 );
+
+		BOOST_CHECK_MESSAGE( maxError( expected, result ) < 0.001f, dsp::simdInstructionSetToString( instructionSet ) << ", max error: " << maxError( expected, result ) );
+	}
+
+	BOOST_CHECK( dsp::setSimdInstructionSet( detected ) );
+}
+
+BOOST_AUTO_TEST_CASE( test_bank_amp_ramp )
+{
+	const dsp::SimdInstructionSet detected = dsp::getSimdInstructionSet();
+	const dsp::SimdInstructionSet instructionSets[] = { dsp::SIMD_NONE, dsp::SIMD_SSE2, dsp::SIMD_AVX2, dsp::SIMD_AVX512, dsp::SIMD_NEON };
+	for( dsp::SimdInstructionSet instructionSet : instructionSets ) {
+		if( ! dsp::isSimdInstructionSetSupported( instructionSet ) )
+			continue;
+
+		BOOST_REQUIRE( dsp::setSimdInstructionSet( instructionSet ) );
+
+		// a sine held at its peak, so that the output is the amplitude
+		dsp::WaveTableBank bank( 1 );
+		bank.setWaveTable( dsp::WaveTable2d::getBandlimited( WaveformType::SINE, 44100, 4096, 40 ) );
+		bank.setPhase( 0, 0.25f );
+		bank.setAmp( 0, 1 );
+
+		Buffer ramp( 101 ), held( 101 );
+		bank.process( ramp.getData(), ramp.getSize() );
+		bank.process( held.getData(), held.getSize() );
+
+		for( size_t i = 0; i < ramp.getSize(); i++ ) {
+			BOOST_REQUIRE_SMALL( ramp[i] - float( i ) / float( ramp.getSize() ), 0.0001f );
+			BOOST_REQUIRE_SMALL( held[i] - 1, 0.0001f );
+		}
+
+		// silent oscillators are skipped, but keep advancing, here by 1.01 cycles
+		bank.setFreq( 0, 441 );
+		bank.setAmp( 0, 0 );
+		bank.process( ramp.getData(), ramp.getSize() );
+		const float phase = bank.getPhase( 0 );
+		bank.process( held.getData(), held.getSize() );
+
+		float phaseDiff = bank.getPhase( 0 ) - phase - 0.01f;
+		phaseDiff -= roundf( phaseDiff );
+		BOOST_CHECK_SMALL( phaseDiff, 0.00001f );
+	}
+
+	BOOST_CHECK( dsp::setSimdInstructionSet( detected ) );
+}
+
+BOOST_AUTO_TEST_CASE( test_gen_bank )
+{
+	auto ctx = std::make_shared<ContextOffline>( 44100, 64, 1 );
+	auto bank = ctx->makeNode( new GenBank( 3 ) );
+	bank >> ctx->getOutput();
+	bank->start();
+
+	bank->set( 0, 441, 0.5f );
+	bank->setFreq( 1, 882 );
+	bank->setAmp( 1, 0.25f );
+
+	BOOST_CHECK_EQUAL( bank->getFreq( 1 ), 882 );
+	BOOST_CHECK_EQUAL( bank->getAmp( 1 ), 0.25f );
+	BOOST_CHECK_EQUAL( bank->getAmp( 2 ), 0 );
+
+	// the changes are applied at the start of the first block, over which the amplitudes ramp up
+	Buffer buffer( 4410 );
+	ctx->render( &buffer );
+
+	float maxErr = 0;
+	for( size_t i = 64; i < buffer.getSize(); i++ ) {
+		const double t = double( i ) / 44100;
+		const float expected = float( 0.5 * sin( 2 * M_PI * 441 * t ) + 0.25 * sin( 2 * M_PI * 882 * t ) );
+		maxErr = std::max( maxErr, fabsf( buffer[i] - expected ) );
+	}
+	BOOST_CHECK_SMALL( maxErr, 0.0001f );
+
+	// the tables are shared with oscillators of the same waveform
+	auto osc = ctx->makeNode( new GenOscillator( 440 ) );
+	ctx->initializeNode( osc );
+	BOOST_CHECK( bank->getWaveTable() == osc->getWaveTable() );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
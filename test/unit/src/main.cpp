@@ -6,5 +6,11 @@
 // so they are included as headers.
 
 #include "BufferUnit.h"
+#include "ConvolverUnit.h"
+#include "DspUnit.h"
 #include "FftUnit.h"
-#include "RingbufferUnit.h"
\ No newline at end of file
+#include "FilterUnit.h"
+#include "NoiseUnit.h"
+#include "RingbufferUnit.h"
+#include "WaveTableUnit.h"
+#include "ContextOfflineUnit.h"
\ No newline at end of file